@@ -9,9 +9,13 @@
 #define BLOCKSCI_WITHOUT_SINGLETON
 
 #include <blocksci/blocksci.hpp>
+#include <range/v3/view/any_view.hpp>
+#include <range/v3/view/iota.hpp>
 #include <range/v3/view/slice.hpp>
+#include <range/v3/view/transform.hpp>
 #include <clipp.h>
 
+#include <cstring>
 #include <numeric>
 
 using namespace blocksci;
@@ -28,24 +32,51 @@ uint32_t calculateNonzeroLocktimeMultithreaded(Blockchain &chain, int start, int
 uint32_t calculateNonzeroLocktimeRandom(Blockchain &chain, const std::vector<uint32_t> &indexes);
 int64_t calculateMaxFeeRandom(Blockchain &chain, const std::vector<uint32_t> &indexes);
 
+uint32_t coldStartOpenChain(const std::string &dataLocation);
+uint32_t coldStartTxHashLookup(const std::string &dataLocation);
+
+double measureDispatchOverhead(unsigned int callCount);
+int64_t calculateMaxFeeSmallRanges(Blockchain &chain, int start, int stop);
+int64_t calculateMaxOutputKernel(Blockchain &chain, int start, int stop);
+int64_t calculateMaxInputKernel(Blockchain &chain, int start, int stop);
+int64_t calculateMaxFeeKernel(Blockchain &chain, int start, int stop);
+uint32_t convertTxHashesHex(Blockchain &chain, int start, int stop);
+uint32_t convertTxHashesBinaryParallel(Blockchain &chain, int start, int stop);
+int64_t topBalanceSingleThreaded(Blockchain &chain);
+int64_t topBalanceParallel(Blockchain &chain);
+
 template <typename Func, typename... Args>
 auto timeFunc(std::string name, Func func, Args&& ...args) -> decltype(func(args...));
 
 int main(int argc, char * argv[]) {
     bool includeRandom = false;
+    bool includeRanking = false;
+    bool includeHashConversion = false;
     std::string dataLocation;
     int endBlock = -1;
+    unsigned int threadCount = 0;
 
     auto cli = (
         clipp::value("data location", dataLocation),
         clipp::option("--with-random").set(includeRandom).doc("Include random order benchmarks"),
-        clipp::option("-m", "--max-block") & clipp::value("Run benchmark up to the given block", endBlock)
+        clipp::option("--with-ranking").set(includeRanking).doc("Include address ranking benchmarks, which require the address index"),
+        clipp::option("--with-hash-conversion").set(includeHashConversion).doc("Include benchmarks converting the hashes of the last 1000 blocks"),
+        clipp::option("-m", "--max-block") & clipp::value("Run benchmark up to the given block", endBlock),
+        clipp::option("-t", "--threads") & clipp::value("Number of threads used by the parallel benchmarks", threadCount)
     );
     auto res = parse(argc, argv, cli);
     if (res.any_error()) {
         std::cout << "Invalid command line parameter\n" << clipp::make_man_page(cli, argv[0]);
         return 0;
     }
+    
+    if (threadCount > 0) {
+        ThreadPool::instance().setThreadCount(threadCount);
+    }
+    
+    timeFunc("coldStartOpenChain", coldStartOpenChain, dataLocation);
+    timeFunc("coldStartTxHashLookup", coldStartTxHashLookup, dataLocation);
+    
     Blockchain chain(dataLocation);
     
     int startBlock = 0;
@@ -68,6 +99,21 @@ int main(int argc, char * argv[]) {
     auto maxInput2 = timeFunc("calculateMaxInputMultithreaded", calculateMaxInputMultithreaded, chain, startBlock, endBlock);
     auto maxFee1 = timeFunc("calculateMaxFeeSingleThreaded", calculateMaxFeeSingleThreaded, chain, startBlock, endBlock);
     auto maxFee2 = timeFunc("calculateMaxFeeMultithreaded", calculateMaxFeeMultithreaded, chain, startBlock, endBlock);
+    
+    std::cout << "Aggregate kernels using " << kernels::activeInstructionSet() << "\n";
+    auto maxOutput3 = timeFunc("calculateMaxOutputKernel", calculateMaxOutputKernel, chain, startBlock, endBlock);
+    auto maxInput3 = timeFunc("calculateMaxInputKernel", calculateMaxInputKernel, chain, startBlock, endBlock);
+    auto maxFee3 = timeFunc("calculateMaxFeeKernel", calculateMaxFeeKernel, chain, startBlock, endBlock);
+    
+    std::cout << "Thread pool dispatch overhead with " << ThreadPool::instance().threadCount() << " threads: " << measureDispatchOverhead(10000) << " us per call\n";
+    timeFunc("calculateMaxFeeSmallRanges", calculateMaxFeeSmallRanges, chain, startBlock, endBlock);
+
+    if (includeHashConversion) {
+        // Converting every hash of a full chain needs tens of gigabytes, so only the most recent blocks are converted
+        auto hashStartBlock = std::max(startBlock, endBlock - 1000);
+        timeFunc("convertTxHashesHex", convertTxHashesHex, chain, hashStartBlock, endBlock);
+        timeFunc("convertTxHashesBinaryParallel", convertTxHashesBinaryParallel, chain, hashStartBlock, endBlock);
+    }
 
     if (includeRandom) {
         uint32_t maxTxNum = chain[endBlock - 1].endTxIndex();
@@ -79,10 +125,16 @@ int main(int argc, char * argv[]) {
         timeFunc("calculateNonzeroLocktimeRandom", calculateNonzeroLocktimeRandom, chain, indexes);
     }
     
+    if (includeRanking) {
+        auto topBalance1 = timeFunc("topBalanceSingleThreaded", topBalanceSingleThreaded, chain);
+        auto topBalance2 = timeFunc("topBalanceParallel", topBalanceParallel, chain);
+        std::cout << "Top Balance = (" << topBalance1 << ", " << topBalance2 << ")\n";
+    }
+    
     std::cout << "Nonzero Locktime = (" << maxSize1 << ", " << maxSize2 << ")\n";
-    std::cout << "Max Output = (" << maxOutput1 << ", " << maxOutput2 << ")\n";
-    std::cout << "Max Input = (" << maxInput1 << ", " << maxInput2 << ")\n";
-    std::cout << "Max Fee = (" << maxFee1 << ", " << maxFee2 << ")\n";
+    std::cout << "Max Output = (" << maxOutput1 << ", " << maxOutput2 << ", " << maxOutput3 << ")\n";
+    std::cout << "Max Input = (" << maxInput1 << ", " << maxInput2 << ", " << maxInput3 << ")\n";
+    std::cout << "Max Fee = (" << maxFee1 << ", " << maxFee2 << ", " << maxFee3 << ")\n";
     return 0;
 }
 
@@ -196,6 +248,118 @@ uint32_t calculateNonzeroLocktimeRandom(Blockchain &chain, const std::vector<uin
     return nonzeroCount;
 }
 
+// Time of a parallel call with no work, covering waking the workers, handing out chunks and waiting for completion
+double measureDispatchOverhead(unsigned int callCount) {
+    auto &pool = ThreadPool::instance();
+    auto taskCount = pool.threadCount() * internal::chunksPerThread;
+    auto begin = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < callCount; i++) {
+        pool.parallelFor(taskCount, [](size_t) {});
+    }
+    auto endTime = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - begin).count() / 1000.0 / callCount;
+}
+
+// Many short parallel queries, dominated by per-call scheduling cost rather than by the work itself
+int64_t calculateMaxFeeSmallRanges(Blockchain &chain, int start, int stop) {
+    int64_t curMax = 0;
+    for (int rangeStart = start; rangeStart < stop; rangeStart += 100) {
+        curMax = std::max(curMax, calculateMaxFeeMultithreaded(chain, rangeStart, std::min(rangeStart + 100, stop)));
+    }
+    return curMax;
+}
+
+// Same queries as the multithreaded versions, run by the vectorized kernels over the raw inout arrays
+int64_t calculateMaxOutputKernel(Blockchain &chain, int start, int stop) {
+    auto summary = outputValueSummary(chain, start, stop);
+    return summary.count > 0 ? summary.max : 0;
+}
+
+int64_t calculateMaxInputKernel(Blockchain &chain, int start, int stop) {
+    auto summary = inputValueSummary(chain, start, stop);
+    return summary.count > 0 ? summary.max : 0;
+}
+
+int64_t calculateMaxFeeKernel(Blockchain &chain, int start, int stop) {
+    auto summary = feeSummary(chain, start, stop);
+    return summary.count > 0 ? summary.max : 0;
+}
+
+// The conversion done by the Python bindings when returning tx hashes as a numpy array, before and after binary output
+namespace {
+    // Elements converted by each parallel task, matching the numpy conversion of the Python bindings
+    constexpr uint32_t conversionChunkSize = 1 << 14;
+
+    using TxHashRange = ranges::any_view<uint256, ranges::category::random_access | ranges::category::sized>;
+
+    // The type erased range of transaction hashes the Python bindings convert for tx_columns and hashes()
+    TxHashRange txHashRange(Blockchain &chain, int start, int stop) {
+        auto &access = chain.getAccess();
+        auto firstTx = chain[start].firstTxIndex();
+        auto endTx = chain[stop - 1].endTxIndex();
+        return ranges::view::iota(firstTx, endTx) | ranges::view::transform([&access](uint32_t txNum) {
+            return Transaction(txNum, access).getHash();
+        });
+    }
+
+    // Converts the range into out in parallel chunks, in the same way as the numpy conversion of the Python bindings
+    template <typename Item, typename Converter>
+    std::vector<Item> convertParallel(TxHashRange range, Converter converter) {
+        auto rangeSize = static_cast<size_t>(ranges::size(range));
+        std::vector<Item> out(rangeSize);
+        auto first = ranges::begin(range);
+        ThreadPool::instance().parallelFor((rangeSize + conversionChunkSize - 1) / conversionChunkSize, [&](size_t chunk) {
+            auto chunkStart = chunk * conversionChunkSize;
+            auto chunkEnd = std::min(rangeSize, chunkStart + conversionChunkSize);
+            auto it = first + static_cast<std::ptrdiff_t>(chunkStart);
+            for (auto i = chunkStart; i < chunkEnd; ++i, ++it) {
+                out[i] = converter(*it);
+            }
+        });
+        return out;
+    }
+}
+
+uint32_t convertTxHashesHex(Blockchain &chain, int start, int stop) {
+    auto hashes = convertParallel<std::array<char, 64>>(txHashRange(chain, start, stop), [](const uint256 &hash) {
+        auto hexStr = hash.GetHex();
+        std::array<char, 64> ret;
+        std::copy_n(hexStr.begin(), 64, ret.begin());
+        return ret;
+    });
+    return static_cast<uint32_t>(hashes.size());
+}
+
+uint32_t convertTxHashesBinaryParallel(Blockchain &chain, int start, int stop) {
+    auto hashes = convertParallel<std::array<char, 32>>(txHashRange(chain, start, stop), [](const uint256 &hash) {
+        std::array<char, 32> ret;
+        std::memcpy(ret.data(), hash.begin(), 32);
+        return ret;
+    });
+    return static_cast<uint32_t>(hashes.size());
+}
+
+int64_t topBalanceSingleThreaded(Blockchain &chain) {
+    auto top = mostValuableAddresses(chain);
+    return top.empty() ? 0 : top.rbegin()->first;
+}
+
+int64_t topBalanceParallel(Blockchain &chain) {
+    auto top = topAddresses(chain, 100);
+    return top.empty() ? 0 : top.front().value;
+}
+
+// Opening a chain only maps the chain files, the remaining indexes are opened on first use
+uint32_t coldStartOpenChain(const std::string &dataLocation) {
+    Blockchain chain(dataLocation);
+    return chain.size();
+}
+
+uint32_t coldStartTxHashLookup(const std::string &dataLocation) {
+    Blockchain chain(dataLocation);
+    auto &access = chain.getAccess();
+    return access.getHashIndex().getTxIndex(*access.getChain().getTxHash(0));
+}
 
 template <typename Func, typename... Args>
 auto timeFunc(std::string name, Func func, Args&& ...args) -> decltype(func(args...)) {
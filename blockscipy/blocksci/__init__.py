@@ -4,6 +4,7 @@ from .blockchain_info import *
 from .blocktrail import *
 from .opreturn import *
 from .pickler import *
+from .kernel_cache import KernelCache
 
 from multiprocess import Pool
 from functools import reduce
@@ -11,6 +12,7 @@ import operator
 import datetime
 import dateparser
 from dateutil.relativedelta import relativedelta
+import numpy as np
 import pandas as pd
 import psutil
 import tempfile
@@ -21,12 +23,14 @@ import os
 import inspect
 import copy
 import io
+import secrets
 
 version = "0.5.0"
 
 sys.modules['blocksci.cluster'] = cluster
 sys.modules['blocksci.heuristics'] = heuristics
 sys.modules['blocksci.heuristics.change'] = heuristics.change
+sys.modules['blocksci.predicate'] = predicate
 
 class _NoDefault(object):
     def __repr__(self):
@@ -34,9 +38,7 @@ class _NoDefault(object):
 
 missing_param = _NoDefault()
 
-def mapreduce_block_ranges(chain, mapFunc, reduceFunc, init=missing_param,  start=None, end=None, cpu_count=psutil.cpu_count()):
-    """Initialized multithreaded map reduce function over a stream of block ranges
-    """
+def _block_bounds(chain, start, end):
     if start is None:
         start = 0
         if end is None:
@@ -45,6 +47,12 @@ def mapreduce_block_ranges(chain, mapFunc, reduceFunc, init=missing_param,  star
         blocks = chain.range(start, end)
         start = blocks[0].height
         end = blocks[-1].height
+    return start, end
+
+def mapreduce_block_ranges(chain, mapFunc, reduceFunc, init=missing_param,  start=None, end=None, cpu_count=psutil.cpu_count()):
+    """Initialized multithreaded map reduce function over a stream of block ranges
+    """
+    start, end = _block_bounds(chain, start, end)
 
     if cpu_count == 1:
         return mapFunc(chain[start:end])
@@ -119,7 +127,17 @@ def filter_blocks(self, filterFunc, start = None, end = None, cpu_count=psutil.c
 
 def filter_txes(self, filterFunc, start = None, end = None, cpu_count=psutil.cpu_count()):
     """Return all transactions in range which match the given criteria
+
+    filterFunc may also be a blocksci.predicate.TxPredicate such as
+    (predicate.fee > 10000) & predicate.any_output(predicate.value > 10**8)
+    which is evaluated natively in a single parallel pass over the chain
     """
+    if isinstance(filterFunc, predicate.TxPredicate):
+        if start is None:
+            start = 0
+        if end is None:
+            end = len(self)
+        return self._filter_txes_predicate(filterFunc, start, end)
     def mapFunc(blocks):
         return [tx for block in blocks for tx in block if filterFunc(tx)]
     def reduceFunc(accum, new_val):
@@ -127,12 +145,187 @@ def filter_txes(self, filterFunc, start = None, end = None, cpu_count=psutil.cpu
         return accum
     return mapreduce_block_ranges(self, mapFunc, reduceFunc, missing_param, start, end, cpu_count)
 
+# Ranges of chain objects are sent between processes as the native columns that identify their members
+_range_encodings = [
+    ((BlockRange, BlockIterator), "blocks", ("height",)),
+    ((TxRange, TxIterator), "txes", ("index",)),
+    ((InputRange, InputIterator), "inputs", ("tx_index", "index")),
+    ((OutputRange, OutputIterator), "outputs", ("tx_index", "index")),
+]
+
+def _encode_value(value):
+    for types, kind, fields in _range_encodings:
+        if isinstance(value, types):
+            return kind, [np.ascontiguousarray(getattr(value, field)) for field in fields]
+    if isinstance(value, np.ndarray) and not value.dtype.hasobject:
+        return "array", [np.ascontiguousarray(value)]
+    return None, value
+
+def _decode_value(chain, kind, columns):
+    if kind == "blocks":
+        return chain._blocks_from_heights(columns[0])
+    elif kind == "txes":
+        return chain._txes_from_indexes(columns[0])
+    elif kind == "inputs":
+        return chain._inputs_from_pointers(columns[0], columns[1])
+    elif kind == "outputs":
+        return chain._outputs_from_pointers(columns[0], columns[1])
+    elif kind == "array":
+        return columns[0]
+    return columns
+
+def _encode_result(result):
+    """Split a map result into (key, kind, columns) entries, where kind is None for values that must be pickled"""
+    keyed = isinstance(result, dict)
+    items = result.items() if keyed else [(None, result)]
+    return keyed, [(key,) + _encode_value(value) for key, value in items]
+
+def _write_shared_result(result, name):
+    """Copy the columns of a map result into a new shared memory block with the given name, pickling only the values
+    without a native encoding"""
+    # Imported here since shared memory needs Python 3.8
+    from multiprocessing import resource_tracker, shared_memory
+    keyed, entries = _encode_result(result)
+    layout = []
+    size = 0
+    for key, kind, columns in entries:
+        if kind is None:
+            file = io.BytesIO()
+            Pickler(file).dump(columns)
+            layout.append((key, None, file.getvalue()))
+            continue
+        specs = []
+        for column in columns:
+            specs.append((column.dtype.str, column.shape, size))
+            size += (column.nbytes + 63) // 64 * 64
+        layout.append((key, kind, specs))
+    memory = shared_memory.SharedMemory(name=name, create=True, size=max(size, 1))
+    # The parent owns the block. Left registered, the resource tracker of this worker would unlink it when the pool
+    # shuts down. Pool comes from multiprocess, but shared_memory registers with the tracker of the stdlib
+    # multiprocessing package, so that is the one it is removed from
+    resource_tracker.unregister(memory._name, "shared_memory")
+    try:
+        for (key, kind, columns), (_, _, specs) in zip(entries, layout):
+            if kind is None:
+                continue
+            for column, (dtype, shape, offset) in zip(columns, specs):
+                target = np.ndarray(shape, dtype=column.dtype, buffer=memory.buf, offset=offset)
+                target[...] = column
+                del target
+    finally:
+        memory.close()
+    return keyed, layout
+
+def _read_shared_result(chain, name, shared):
+    """Return the entries of a result written by _write_shared_result, with columns copied out of the shared memory block"""
+    from multiprocessing import shared_memory
+    keyed, layout = shared
+    memory = shared_memory.SharedMemory(name=name)
+    try:
+        entries = []
+        for key, kind, specs in layout:
+            if kind is None:
+                entries.append((key, None, Unpickler(io.BytesIO(specs), chain).load()))
+            else:
+                columns = [np.ndarray(shape, dtype=np.dtype(dtype), buffer=memory.buf, offset=offset).copy() for dtype, shape, offset in specs]
+                entries.append((key, kind, columns))
+        return keyed, entries
+    finally:
+        memory.close()
+
+def _unlink_shared_result(name):
+    """Remove the shared memory block with the given name, if the worker got as far as creating it"""
+    from multiprocessing import shared_memory
+    try:
+        memory = shared_memory.SharedMemory(name=name)
+    except FileNotFoundError:
+        return
+    memory.close()
+    memory.unlink()
+
+def _decode_result(chain, keyed, entries):
+    values = {key: _decode_value(chain, kind, columns) for key, kind, columns in entries}
+    return values if keyed else values[None]
+
+def _combine_results(chain, results, reduceFunc, init):
+    if reduceFunc is not None:
+        decoded = [_decode_result(chain, keyed, entries) for keyed, entries in results]
+        if type(init) == type(missing_param):
+            return reduce(reduceFunc, decoded)
+        return reduce(reduceFunc, decoded, init)
+
+    keyed = results[0][0]
+    if any(result_keyed != keyed for result_keyed, _ in results):
+        raise ValueError("mapFunc must return a dict for every block range or for none of them")
+
+    # Segments are merged by key, since a dict returned for one range may omit keys or order them differently
+    by_key = {}
+    for _, entries in results:
+        for key, kind, columns in entries:
+            by_key.setdefault(key, []).append((kind, columns))
+    combined = []
+    for key, segment_values in by_key.items():
+        kinds = {kind for kind, _ in segment_values}
+        if len(kinds) != 1:
+            raise ValueError("mapFunc returned values of different types for key {!r} in different block ranges".format(key))
+        kind = kinds.pop()
+        values = [columns for _, columns in segment_values]
+        if kind is None:
+            combined.append((key, None, reduce(operator.add, values)))
+        else:
+            combined.append((key, kind, [np.concatenate(columns) for columns in zip(*values)]))
+    return _decode_result(chain, keyed, combined)
+
+def mapreduce_block_columns(chain, mapFunc, reduceFunc=None, init=missing_param, start=None, end=None, cpu_count=psutil.cpu_count()):
+    """Multiprocess map reduce over block ranges which returns results through shared memory instead of pickles
+
+    mapFunc is called with a range of blocks and returns a numpy array, a range of blocks, txes, inputs or outputs, or
+    a dict mapping names to those. Workers write the heights, tx indexes or (tx_index, index) pointers identifying the
+    members of each range into a shared memory block and the parent rebuilds the ranges from them in bulk. Values of
+    any other type are pickled.
+
+    Without a reduceFunc, the values of each segment are combined by key: columns are concatenated in chain order and
+    pickled values are combined with +. Otherwise the results of the segments are rebuilt separately and reduced with
+    reduceFunc.
+
+    Requires Python 3.8 or later.
+    """
+    start, end = _block_bounds(chain, start, end)
+
+    if cpu_count == 1:
+        result = mapFunc(chain[start:end])
+        if reduceFunc is None or type(init) == type(missing_param):
+            return result
+        return reduceFunc(init, result)
+
+    raw_segments = chain._segment_indexes(start, end, cpu_count)
+    config = chain._config
+
+    # The parent names every block up front so that it can remove them all, even those of failed or killed workers
+    token = secrets.token_hex(4)
+    names = ["blocksci_{}_{}_{}".format(os.getpid(), token, i) for i in range(len(raw_segments) - 1)]
+
+    def real_map_func(input):
+        local_chain = Blockchain(input[1])
+        return _write_shared_result(mapFunc(local_chain[input[0][0]:input[0][1]]), input[2])
+
+    try:
+        with Pool(cpu_count - 1) as p:
+            futures = [p.apply_async(real_map_func, ((raw_segment, config, name),)) for raw_segment, name in zip(raw_segments[1:], names)]
+            first = _encode_result(mapFunc(chain[raw_segments[0][0]:raw_segments[0][1]]))
+            results = [first] + [_read_shared_result(chain, name, future.get()) for name, future in zip(names, futures)]
+    finally:
+        for name in names:
+            _unlink_shared_result(name)
+    return _combine_results(chain, results, reduceFunc, init)
+
 Blockchain.map_blocks = map_blocks
 Blockchain.filter_blocks = filter_blocks
 Blockchain.filter_txes = filter_txes
 Blockchain.mapreduce_block_ranges = mapreduce_block_ranges
 Blockchain.mapreduce_blocks = mapreduce_blocks
 Blockchain.mapreduce_txes = mapreduce_txes
+Blockchain.mapreduce_block_columns = mapreduce_block_columns
 
 def heights_to_dates(self, df):
     """
@@ -144,12 +337,6 @@ def block_range(self, start, end=None) -> BlockRange:
     """
     Return the range of blocks mined between the given dates
     """
-    if self.block_times is None:
-        self.block_times = pd.DataFrame([block.time for block in self], columns=["date"])
-        self.block_times["height"] = self.block_times.index
-        self.block_times.index = self.block_times["date"]
-        del self.block_times["date"]
-
     start_date = pd.to_datetime(start)
     if end is None:
         res = dateparser.DateDataParser().get_date_data(start)
@@ -162,15 +349,30 @@ def block_range(self, start, end=None) -> BlockRange:
     else:
         end = pd.to_datetime(end)
 
-    oldest = self.block_times[self.block_times.index >= start_date].iloc[0][0]
-    newest = self.block_times[self.block_times.index <= end].iloc[-1][0] + 1
-
+    oldest, newest = self.height_range(start_date.to_pydatetime(), end.to_pydatetime())
     return self[oldest:newest]
 
+def tx_dataframe(self, fields, start=0, end=-1):
+    """
+    Return a pandas data frame with the given fields of every transaction in blocks [start, end), extracted in a single native pass (See Blockchain.tx_columns)
+    """
+    return pd.DataFrame(self.tx_columns(fields, start, end))
+
+def input_dataframe(self, fields, start=0, end=-1):
+    """
+    Return a pandas data frame indexed by (tx_index, index) with the given fields of every input in blocks [start, end) (See Blockchain.input_columns)
+    """
+    return pd.DataFrame(self.input_columns(fields, start, end)).set_index(['tx_index', 'index'])
+
+def output_dataframe(self, fields, start=0, end=-1):
+    """
+    Return a pandas data frame indexed by (tx_index, index) with the given fields of every output in blocks [start, end) (See Blockchain.output_columns)
+    """
+    return pd.DataFrame(self.output_columns(fields, start, end)).set_index(['tx_index', 'index'])
+
 old_init = Blockchain.__init__
 def new_init(self, loc):
     old_init(self, loc)
-    self.block_times = None
     self.cpp = CPP(self)
     ec2_instance_path = "/home/ubuntu/BlockSci/IS_EC2"
     tx_heated_path = "/home/ubuntu/BlockSci/TX_DATA_HEATED"
@@ -187,116 +389,134 @@ def new_init(self, loc):
 Blockchain.__init__ = new_init
 Blockchain.range = block_range
 Blockchain.heights_to_dates = heights_to_dates
-
-first_miner_run = True
+Blockchain.tx_dataframe = tx_dataframe
+Blockchain.input_dataframe = input_dataframe
+Blockchain.output_dataframe = output_dataframe
 
 class DummyClass:
     pass
 
 loaderDirectory = os.path.dirname(os.path.abspath(inspect.getsourcefile(DummyClass)))
-def get_miner(block) -> str:
+
+# Tags missing from Blockchain-Known-Pools, which only label blocks that no known tag or payout address matches
+additional_miner_tags = [
+    ("EclipseMC", "EclipseMC"),
+    ("poolserverj", "poolserverj"),
+    ("/stratumPool/", "stratumPool"),
+    ("/stratum/", "stratum"),
+    ("/nodeStratum/", "nodeStratum"),
+    ("BitLC", "BitLC"),
+    ("/TangPool/", "TangPool"),
+    ("/Tangpool/", "TangPool"),
+    ("pool.mkalinin.ru", "pool.mkalinin.ru"),
+    ("For Pierce and Paul", "Pierce and Paul"),
+    ("50btc.com", "50btc.com"),
+    ("七彩神仙鱼", "F2Pool")
+]
+
+# MinerTaggers keyed by the data directory of the chain that resolved their payout addresses
+miner_taggers = {}
+
+def get_miner_tagger(access) -> MinerTagger:
     """
-    Get the miner of the block based on the text in the coinbase transaction
+    Return the MinerTagger built from Blockchain-Known-Pools, resolving its payout addresses with the given chain
     """
-    global first_miner_run
-    global tagged_addresses
-    global pool_data
-    global coinbase_tag_re
-    if first_miner_run:
+    data_directory = access._config.data_directory
+    tagger = miner_taggers.get(data_directory)
+    if tagger is None:
         import json
         with open(loaderDirectory + "/Blockchain-Known-Pools/pools.json") as f:
             pool_data = json.load(f)
-        addresses = [block._access.address_from_string(addr_string) for addr_string in pool_data["payout_addresses"]]
-        tagged_addresses = {pointer: pool_data["payout_addresses"][address] for address in addresses if address in pool_data["payout_addresses"]}
-        coinbase_tag_re = re.compile('|'.join(map(re.escape, pool_data["coinbase_tags"])))
-        first_miner_run = False
-    coinbase = block.coinbase_param.decode("utf_8", "replace")
-    tag_matches = re.findall(coinbase_tag_re, coinbase)
-    if len(tag_matches) > 0:
-        return pool_data["coinbase_tags"][tag_matches[0]]["name"]
-    for txout in block.coinbase_tx.outs:
-        if txout.address in tagged_addresses:
-            return tagged_addresses[txout.address]["name"]
-    
-    additional_miners = {
-        "EclipseMC" : "EclipseMC",
-        "poolserverj" : "poolserverj",
-        "/stratumPool/" : "stratumPool",
-        "/stratum/" : "stratum",
-        "/nodeStratum/" : "nodeStratum",
-        "BitLC" : "BitLC",
-        "/TangPool/" : "TangPool",
-        "/Tangpool/" : "TangPool",
-        "pool.mkalinin.ru" : "pool.mkalinin.ru",
-        "For Pierce and Paul" : "Pierce and Paul",
-        "50btc.com" : "50btc.com",
-        "七彩神仙鱼" : "F2Pool"
-    }
-    
-    for miner in additional_miners:
-        if miner in coinbase:
-            return additional_miners[miner]
-    
-    return "Unknown"
+        coinbase_tags = [(tag, info["name"]) for tag, info in pool_data["coinbase_tags"].items()]
+        payout_addresses = []
+        for address_string, info in pool_data["payout_addresses"].items():
+            address = access.address_from_string(address_string)
+            if address is not None:
+                payout_addresses.append((address, info["name"]))
+        tagger = MinerTagger(coinbase_tags, payout_addresses, additional_miner_tags)
+        miner_taggers[data_directory] = tagger
+    return tagger
 
+def get_miner(block) -> str:
+    """
+    Get the miner of the block based on the text in the coinbase transaction
+    """
+    return get_miner_tagger(block._access).label(block)
+
+def miners(self, start=0, end=-1, cache_path=None):
+    """
+    Return a pandas categorical of the miner of every block in [start, end), matched natively in parallel (See Block.miner).
+    If cache_path is given, the miners of the whole chain are cached in that file and only blocks added since are matched
+    """
+    tagger = get_miner_tagger(self)
+    if cache_path is None:
+        codes = tagger.label_blocks(self, start, end)
+    else:
+        start = len(self) + start + 1 if start < 0 else start
+        end = len(self) + end + 1 if end < 0 else end
+        codes = tagger.update_side_file(self, cache_path)[start:end]
+    return pd.Categorical.from_codes(codes, categories=tagger.labels)
+
+Blockchain.miners = miners
 Block.miner = get_miner
 
 class CPP(object):
-    def __init__(self, chain):
-        self.dynamicFunctionCounter = 0
-        self.module_directory = tempfile.TemporaryDirectory()
-        sys.path.append(self.module_directory.name)
-        self.saved_tx_filters = {}
-        self.chain = chain
+    """
+    Compile C++ expressions into native kernels which run over a range of the chain in parallel.
 
-    def generate_module_name(self):
-        module_name = "dynamicCode" + str(self.dynamicFunctionCounter)
-        self.dynamicFunctionCounter += 1
-        return module_name
+    Expressions refer to the current object as block, tx, input or output depending on the
+    type iterated over. Compiled kernels are stored in a KernelCache shared between sessions
+    so each distinct expression is only compiled once.
+    """
+    object_types = {
+        "block" : "Block",
+        "tx" : "Transaction",
+        "input" : "Input",
+        "output" : "Output"
+    }
 
-    def filter_tx(self, code, start=None, end=None):
+    def __init__(self, chain, cache_dir=None):
+        self.chain = chain
+        self.cache = KernelCache(cache_dir)
+
+    def _range(self, start, end):
         if start is None:
             start = 0
         if end is None:
             end = len(self.chain)
-        if code not in self.saved_tx_filters:
-            from string import Template
-            filein = open(loaderDirectory + '/filterTxesExtension.cpp')
-            template = Template(filein.read())
-            module_name = self.generate_module_name()
-            filled_template = template.safe_substitute({"module_name":module_name, "func_def" : code})
-            makefile = self.create_makefile(module_name)
-            func = self.build_function(filled_template, makefile, module_name)
-            self.saved_tx_filters[code] = func
-        return self.saved_tx_filters[code](self.chain, start, end)
-
-    def create_makefile(self, module_name):
-        from string import Template
-        import os
-        filein = open(loaderDirectory + '/templateMakefile')
-        template = Template(filein.read())
-        subs = {
-            "module_name" : module_name,
-            "install_location" : self.module_directory.name,
-            "srcname" : module_name + ".cpp",
-            "python_blocksci_dir":loaderDirectory
-        }
-        return template.safe_substitute(subs)
-
-    def build_function(self, full_code, makefile, module_name):
-        builddir = tempfile.TemporaryDirectory()
-        with open(builddir.name + '/' + module_name + ".cpp", 'w') as f:
-            f.write(full_code)
-        with open(builddir.name + '/CMakeLists.txt', 'w') as f:
-            f.write(makefile)
-        process = subprocess.Popen(["cmake", "."], cwd=builddir.name, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
-        out, err = process.communicate()
-        print(err.decode('utf8'))
-        process = subprocess.Popen(["make"], cwd=builddir.name, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
-        out, err = process.communicate()
-        print(err.decode('utf8'))
-        process = subprocess.Popen(["make", "install"], cwd=builddir.name, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
-        out, err = process.communicate()
-        print(err.decode('utf8'))
-        mod = importlib.import_module(module_name)
-        return getattr(mod, "func")
\ No newline at end of file
+        return start, end
+
+    def _object_substitutions(self, over):
+        if over not in self.object_types:
+            raise ValueError("over must be one of " + ", ".join(self.object_types))
+        return {"object_type" : self.object_types[over], "var_name" : over}
+
+    def filter(self, code, over="tx", start=None, end=None):
+        """
+        Return a list of the objects in the block range for which the boolean expression code is true
+        """
+        subs = self._object_substitutions(over)
+        subs["func_def"] = code
+        start, end = self._range(start, end)
+        return self.cache.load("filter.cpp", subs)(self.chain, start, end)
+
+    def map(self, code, result_type="int64_t", over="tx", start=None, end=None):
+        """
+        Return a numpy array holding the value of code, which must have the arithmetic type result_type, for every object in the block range
+        """
+        subs = self._object_substitutions(over)
+        subs.update({"func_def" : code, "result_type" : result_type})
+        start, end = self._range(start, end)
+        return self.cache.load("map.cpp", subs)(self.chain, start, end)
+
+    def reduce(self, code, reduce_code, init="0", result_type="int64_t", over="tx", start=None, end=None):
+        """
+        Combine the value of code for every object in the block range using reduce_code, an expression over a and b, starting from init
+        """
+        subs = self._object_substitutions(over)
+        subs.update({"func_def" : code, "reduce_def" : reduce_code, "init_def" : init, "result_type" : result_type})
+        start, end = self._range(start, end)
+        return self.cache.load("reduce.cpp", subs)(self.chain, start, end)
+
+    def filter_tx(self, code, start=None, end=None):
+        return self.filter(code, "tx", start, end)
@@ -0,0 +1,160 @@
+"""
+On disk cache of the C++ kernels compiled by blocksci.CPP
+
+Compiled extension modules are keyed by a hash of their source and of the
+BlockSci build they were compiled against, so each distinct kernel is only
+built once per installation and is reused by later sessions. Builds are
+serialized with a per-kernel file lock and published with an atomic rename,
+which makes the cache safe to share between concurrent processes.
+"""
+
+import ctypes.util
+import fcntl
+import hashlib
+import importlib.machinery
+import importlib.util
+import os
+import platform
+import shutil
+import subprocess
+import sys
+import tempfile
+from string import Template
+
+from . import _blocksci
+
+template_directory = os.path.join(os.path.dirname(os.path.abspath(__file__)), "kernel_templates")
+package_directory = os.path.dirname(os.path.abspath(__file__))
+
+def default_cache_directory():
+    """
+    Return the directory used for compiled kernels, taken from BLOCKSCI_KERNEL_CACHE if it is set
+    """
+    if "BLOCKSCI_KERNEL_CACHE" in os.environ:
+        return os.environ["BLOCKSCI_KERNEL_CACHE"]
+    cache_home = os.environ.get("XDG_CACHE_HOME", os.path.join(os.path.expanduser("~"), ".cache"))
+    return os.path.join(cache_home, "blocksci", "kernels")
+
+def library_path():
+    """
+    Return the path of the libblocksci shared library loaded by this process, which kernels link against, or None if
+    it can't be determined
+    """
+    try:
+        with open("/proc/self/maps") as maps:
+            for line in maps:
+                parts = line.split(None, 5)
+                if len(parts) == 6 and os.path.basename(parts[5].strip()).startswith("libblocksci"):
+                    return parts[5].strip()
+    except OSError:
+        pass
+    path = ctypes.util.find_library("blocksci")
+    if path is not None and os.path.isabs(path) and os.path.exists(path):
+        return path
+    return None
+
+def build_id():
+    """
+    Identify the BlockSci build that kernels are compiled against. Rebuilding or
+    reinstalling the Python module or libblocksci changes the id and so invalidates
+    previously built kernels.
+    """
+    hasher = hashlib.sha256()
+    parts = [sys.version, platform.machine()]
+    for path in [_blocksci.__file__, library_path()]:
+        if path is None:
+            parts.append("")
+            continue
+        stat = os.stat(path)
+        parts += [path, str(stat.st_size), str(stat.st_mtime_ns)]
+    for part in parts:
+        hasher.update(part.encode("utf8"))
+        hasher.update(b"\0")
+    return hasher.hexdigest()
+
+def _read_template(name):
+    with open(os.path.join(template_directory, name)) as f:
+        return f.read()
+
+class KernelCache(object):
+    def __init__(self, directory=None):
+        self.directory = directory if directory is not None else default_cache_directory()
+        os.makedirs(self.directory, exist_ok=True)
+        self.loaded = {}
+        self.build_id = build_id()
+
+    def kernel_key(self, template_name, substitutions):
+        hasher = hashlib.sha256()
+        hasher.update(self.build_id.encode("utf8"))
+        for name in [template_name, "kernel_common.hpp", "templateMakefile"]:
+            hasher.update(_read_template(name).encode("utf8"))
+        for key in sorted(substitutions):
+            hasher.update(key.encode("utf8") + b"\0" + str(substitutions[key]).encode("utf8") + b"\0")
+        return hasher.hexdigest()[:32]
+
+    def load(self, template_name, substitutions):
+        """
+        Return the func entry point of the kernel generated from the given template, compiling it if it isn't cached
+        """
+        key = self.kernel_key(template_name, substitutions)
+        if key not in self.loaded:
+            module_name = "blocksci_kernel_" + key
+            path = self._find_module(module_name)
+            if path is None:
+                with open(os.path.join(self.directory, module_name + ".lock"), "w") as lock_file:
+                    fcntl.flock(lock_file, fcntl.LOCK_EX)
+                    try:
+                        # Another process may have finished building while we waited for the lock
+                        path = self._find_module(module_name)
+                        if path is None:
+                            path = self._build(module_name, template_name, substitutions)
+                    finally:
+                        fcntl.flock(lock_file, fcntl.LOCK_UN)
+            spec = importlib.util.spec_from_file_location(module_name, path)
+            module = importlib.util.module_from_spec(spec)
+            spec.loader.exec_module(module)
+            self.loaded[key] = getattr(module, "func")
+        return self.loaded[key]
+
+    def clear(self):
+        """
+        Delete every cached kernel
+        """
+        self.loaded = {}
+        shutil.rmtree(self.directory, ignore_errors=True)
+        os.makedirs(self.directory, exist_ok=True)
+
+    def _find_module(self, module_name):
+        for suffix in importlib.machinery.EXTENSION_SUFFIXES:
+            path = os.path.join(self.directory, module_name + suffix)
+            if os.path.exists(path):
+                return path
+        return None
+
+    def _build(self, module_name, template_name, substitutions):
+        with tempfile.TemporaryDirectory() as build_dir:
+            install_dir = os.path.join(build_dir, "install")
+            source = Template(_read_template(template_name)).safe_substitute(dict(substitutions, module_name=module_name))
+            makefile = Template(_read_template("templateMakefile")).safe_substitute({
+                "module_name" : module_name,
+                "install_location" : install_dir,
+                "python_blocksci_dir" : package_directory
+            })
+            with open(os.path.join(build_dir, module_name + ".cpp"), "w") as f:
+                f.write(source)
+            with open(os.path.join(build_dir, "CMakeLists.txt"), "w") as f:
+                f.write(makefile)
+            shutil.copy(os.path.join(template_directory, "kernel_common.hpp"), build_dir)
+            for command in [["cmake", "-DCMAKE_BUILD_TYPE=Release", "."], ["make"], ["make", "install"]]:
+                process = subprocess.run(command, cwd=build_dir, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+                if process.returncode != 0:
+                    raise RuntimeError("Failed to compile kernel:\n" + process.stdout.decode("utf8") + process.stderr.decode("utf8"))
+            built = [name for name in os.listdir(install_dir) if name.startswith(module_name)]
+            if len(built) != 1:
+                raise RuntimeError("Kernel build did not produce a module")
+            # Copy next to the final location then rename so that other processes never see a partial file
+            staging = os.path.join(self.directory, "." + built[0] + "." + str(os.getpid()))
+            shutil.copy(os.path.join(install_dir, built[0]), staging)
+            final_path = os.path.join(self.directory, built[0])
+            os.replace(staging, final_path)
+            return final_path
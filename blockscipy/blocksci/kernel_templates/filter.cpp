@@ -0,0 +1,17 @@
+#include "kernel_common.hpp"
+
+using namespace blocksci;
+namespace py = pybind11;
+
+using ObjectType = ${object_type};
+
+static bool testFunc(const ObjectType &${var_name}) {
+    return ${func_def};
+}
+
+PYBIND11_MODULE(${module_name}, m) {
+    m.def("func", [](Blockchain &chain, int start, int stop) {
+        py::gil_scoped_release release;
+        return blocksci_kernel::filterChain<ObjectType>(chain, start, stop, testFunc);
+    });
+}
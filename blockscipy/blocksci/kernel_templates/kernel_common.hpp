@@ -0,0 +1,141 @@
+//
+//  kernel_common.hpp
+//  blocksci
+//
+//  Shared helpers for the kernels compiled on demand by blocksci.CPP
+//
+
+#ifndef blocksci_kernel_common_hpp
+#define blocksci_kernel_common_hpp
+
+#include <blocksci/blocksci.hpp>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include <vector>
+
+namespace blocksci_kernel {
+    using namespace blocksci;
+
+    // Calls func on every object of type T inside the given blocks
+    template <typename T>
+    struct Visitor;
+
+    template <>
+    struct Visitor<Block> {
+        template <typename Func>
+        static void visit(const std::vector<Block> &segment, Func &&func) {
+            for (auto &block : segment) {
+                func(block);
+            }
+        }
+    };
+
+    template <>
+    struct Visitor<Transaction> {
+        template <typename Func>
+        static void visit(const std::vector<Block> &segment, Func &&func) {
+            for (auto &block : segment) {
+                RANGES_FOR(auto tx, block) {
+                    func(tx);
+                }
+            }
+        }
+    };
+
+    template <>
+    struct Visitor<Input> {
+        template <typename Func>
+        static void visit(const std::vector<Block> &segment, Func &&func) {
+            Visitor<Transaction>::visit(segment, [&](const Transaction &tx) {
+                RANGES_FOR(auto input, tx.inputs()) {
+                    func(input);
+                }
+            });
+        }
+    };
+
+    template <>
+    struct Visitor<Output> {
+        template <typename Func>
+        static void visit(const std::vector<Block> &segment, Func &&func) {
+            Visitor<Transaction>::visit(segment, [&](const Transaction &tx) {
+                RANGES_FOR(auto output, tx.outputs()) {
+                    func(output);
+                }
+            });
+        }
+    };
+
+    template <typename T>
+    std::vector<T> &appendVector(std::vector<T> &vec1, std::vector<T> &vec2) {
+        vec1.reserve(vec1.size() + vec2.size());
+        vec1.insert(vec1.end(), std::make_move_iterator(vec2.begin()), std::make_move_iterator(vec2.end()));
+        return vec1;
+    }
+
+    template <typename T, typename TestFunc>
+    std::vector<T> filterChain(Blockchain &chain, BlockHeight start, BlockHeight stop, TestFunc testFunc) {
+        auto mapFunc = [&](const std::vector<Block> &segment) {
+            std::vector<T> matches;
+            Visitor<T>::visit(segment, [&](const T &item) {
+                if (testFunc(item)) {
+                    matches.push_back(item);
+                }
+            });
+            return matches;
+        };
+        return chain.mapReduce<std::vector<T>>(start, stop, mapFunc, appendVector<T>);
+    }
+
+    template <typename T, typename ResultType, typename MapFunc>
+    pybind11::array_t<ResultType> mapChain(Blockchain &chain, BlockHeight start, BlockHeight stop, MapFunc mapFunc) {
+        std::vector<ResultType> results;
+        {
+            pybind11::gil_scoped_release release;
+            auto segmentFunc = [&](const std::vector<Block> &segment) {
+                std::vector<ResultType> mapped;
+                Visitor<T>::visit(segment, [&](const T &item) {
+                    mapped.push_back(mapFunc(item));
+                });
+                return mapped;
+            };
+            results = chain.mapReduce<std::vector<ResultType>>(start, stop, segmentFunc, appendVector<ResultType>);
+        }
+        return pybind11::array_t<ResultType>(results.size(), results.data());
+    }
+
+    // Segment results start out empty so that the user supplied initial value is only folded in once
+    template <typename ResultType>
+    struct PartialResult {
+        bool valid = false;
+        ResultType value{};
+    };
+
+    template <typename T, typename ResultType, typename MapFunc, typename ReduceFunc>
+    ResultType reduceChain(Blockchain &chain, BlockHeight start, BlockHeight stop, ResultType init, MapFunc mapFunc, ReduceFunc reduceFunc) {
+        using Partial = PartialResult<ResultType>;
+        auto segmentFunc = [&](const std::vector<Block> &segment) {
+            Partial res;
+            Visitor<T>::visit(segment, [&](const T &item) {
+                auto mapped = mapFunc(item);
+                res.value = res.valid ? reduceFunc(res.value, mapped) : mapped;
+                res.valid = true;
+            });
+            return res;
+        };
+        auto combineFunc = [&](Partial &a, Partial &b) -> Partial & {
+            if (b.valid) {
+                a.value = a.valid ? reduceFunc(a.value, b.value) : b.value;
+                a.valid = true;
+            }
+            return a;
+        };
+        auto res = chain.mapReduce<Partial>(start, stop, segmentFunc, combineFunc);
+        return res.valid ? reduceFunc(init, res.value) : init;
+    }
+}
+
+#endif /* blocksci_kernel_common_hpp */
@@ -0,0 +1,17 @@
+#include "kernel_common.hpp"
+
+using namespace blocksci;
+namespace py = pybind11;
+
+using ObjectType = ${object_type};
+using ResultType = ${result_type};
+
+static ResultType mapFunc(const ObjectType &${var_name}) {
+    return ${func_def};
+}
+
+PYBIND11_MODULE(${module_name}, m) {
+    m.def("func", [](Blockchain &chain, int start, int stop) {
+        return blocksci_kernel::mapChain<ObjectType, ResultType>(chain, start, stop, mapFunc);
+    });
+}
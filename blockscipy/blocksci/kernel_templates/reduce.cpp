@@ -0,0 +1,22 @@
+#include "kernel_common.hpp"
+
+using namespace blocksci;
+namespace py = pybind11;
+
+using ObjectType = ${object_type};
+using ResultType = ${result_type};
+
+static ResultType mapFunc(const ObjectType &${var_name}) {
+    return ${func_def};
+}
+
+static ResultType reduceFunc(const ResultType &a, const ResultType &b) {
+    return ${reduce_def};
+}
+
+PYBIND11_MODULE(${module_name}, m) {
+    m.def("func", [](Blockchain &chain, int start, int stop) {
+        py::gil_scoped_release release;
+        return blocksci_kernel::reduceChain<ObjectType, ResultType>(chain, start, stop, ResultType(${init_def}), mapFunc, reduceFunc);
+    });
+}
@@ -0,0 +1,52 @@
+//
+//  batch_iterator_py.cpp
+//  blocksci
+//
+
+#include "batch_iterator_py.hpp"
+
+#include <blocksci/chain/block.hpp>
+#include <blocksci/chain/chain_access.hpp>
+#include <blocksci/chain/input.hpp>
+#include <blocksci/chain/output.hpp>
+#include <blocksci/chain/transaction.hpp>
+#include <blocksci/util/data_access.hpp>
+
+namespace {
+    constexpr size_t pageSize = 4096;
+
+    // Reads one byte per page so the kernel maps the whole view in before Python asks for it
+    void touchPages(const blocksci::MappedView &view) {
+        volatile char sink = 0;
+        for (size_t offset = 0; offset < view.size; offset += pageSize) {
+            sink += view.data[offset];
+        }
+        if (view.size > 0) {
+            sink += view.data[view.size - 1];
+        }
+    }
+}
+
+size_t prefetchChainData(const blocksci::Block &block) {
+    auto view = block.getAccess().getChain().txDataView(block.firstTxIndex(), block.endTxIndex());
+    touchPages(view);
+    return view.size;
+}
+
+size_t prefetchChainData(const blocksci::Transaction &tx) {
+    auto view = tx.getAccess().getChain().txDataView(tx.txNum, tx.txNum + 1);
+    touchPages(view);
+    return view.size;
+}
+
+size_t prefetchChainData(const blocksci::Input &input) {
+    volatile int64_t value = input.getValue();
+    (void)value;
+    return sizeof(blocksci::Inout);
+}
+
+size_t prefetchChainData(const blocksci::Output &output) {
+    volatile int64_t value = output.getValue();
+    (void)value;
+    return sizeof(blocksci::Inout);
+}
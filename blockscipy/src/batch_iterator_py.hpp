@@ -0,0 +1,156 @@
+//
+//  batch_iterator_py.hpp
+//  blocksci
+//
+
+#ifndef batch_iterator_py_hpp
+#define batch_iterator_py_hpp
+
+#include "range_conversion.hpp"
+
+#include <blocksci/chain/chain_fwd.hpp>
+
+#include <pybind11/pybind11.h>
+
+#include <range/v3/utility/optional.hpp>
+
+#include <future>
+#include <type_traits>
+#include <utility>
+#include <typeinfo>
+#include <vector>
+
+// Objects per batch when a range is iterated over from Python
+constexpr size_t defaultIterationBatchSize = 512;
+
+// Most chain data faulted in ahead of Python for each batch, since a batch of large blocks can span gigabytes
+constexpr size_t maxReadAheadBytes = size_t{1} << 26;
+
+// Touch the chain data an object refers to so that its pages are resident by the time Python reads it, returning its size
+size_t prefetchChainData(const blocksci::Block &block);
+size_t prefetchChainData(const blocksci::Transaction &tx);
+size_t prefetchChainData(const blocksci::Input &input);
+size_t prefetchChainData(const blocksci::Output &output);
+
+template <typename T>
+size_t prefetchChainData(const T &) {
+    return 0;
+}
+
+template <typename T>
+size_t prefetchChainData(const ranges::optional<T> &item) {
+    return item ? prefetchChainData(*item) : 0;
+}
+
+/* Iterates over a range in lists of Python objects. While Python consumes one batch, a background task reads the next
+ * batch of native objects and faults in up to maxReadAheadBytes of the chain data they refer to, so each batch costs one
+ * call into C++ and the reads of upcoming blocks overlap with Python's processing. Batches read while Python waits,
+ * like the first, aren't prefetched since Python reads them right away. Ranges of Python objects are read without
+ * prefetching since they need the GIL */
+template <typename Range>
+class BatchIterator {
+    using iterator = decltype(std::declval<Range &>().begin());
+    using sentinel = decltype(std::declval<Range &>().end());
+    using value_type = std::decay_t<decltype(*std::declval<iterator &>())>;
+    static constexpr bool background = !holdsPythonObjects<value_type>();
+
+    iterator it;
+    sentinel end;
+    size_t batchSize;
+    std::future<std::vector<value_type>> pending;
+
+    std::vector<value_type> readBatch(bool prefetch) {
+        std::vector<value_type> batch;
+        batch.reserve(batchSize);
+        size_t prefetched = 0;
+        for (; batch.size() < batchSize && it != end; ++it) {
+            batch.push_back(*it);
+            if (prefetch && prefetched < maxReadAheadBytes) {
+                prefetched += prefetchChainData(batch.back());
+            }
+        }
+        return batch;
+    }
+
+public:
+    BatchIterator(Range &range, size_t batchSize_) : it(range.begin()), end(range.end()), batchSize(batchSize_ > 0 ? batchSize_ : 1) {}
+
+    // Only moved before the first batch is read, when no background task refers to this iterator yet
+    BatchIterator(BatchIterator &&) = default;
+
+    // The background task refers to this iterator, so it must finish first
+    ~BatchIterator() {
+        if (pending.valid()) {
+            pybind11::gil_scoped_release release;
+            pending.wait();
+        }
+    }
+
+    pybind11::list next() {
+        std::vector<value_type> batch;
+        if constexpr (background) {
+            pybind11::gil_scoped_release release;
+            batch = pending.valid() ? pending.get() : readBatch(false);
+            if (!batch.empty()) {
+                pending = std::async(std::launch::async, [this]() { return readBatch(true); });
+            }
+        } else {
+            batch = readBatch(false);
+        }
+        if (batch.empty()) {
+            throw pybind11::stop_iteration();
+        }
+        pybind11::list list(batch.size());
+        for (size_t i = 0; i < batch.size(); i++) {
+            list[i] = pybind11::cast(std::move(batch[i]));
+        }
+        return list;
+    }
+};
+
+/* Python iterator over the objects of a range, handing out the batches of a BatchIterator one object at a time. It is
+ * a registered class rather than an itertools.chain over the batches so that keep_alive can weakly reference it */
+template <typename Range>
+class ObjectBatchIterator {
+    BatchIterator<Range> batches;
+    pybind11::list batch;
+    size_t position = 0;
+
+public:
+    ObjectBatchIterator(Range &range, size_t batchSize) : batches(range, batchSize) {}
+
+    pybind11::object next() {
+        if (position == batch.size()) {
+            // Batches are never empty, the end of the range raises StopIteration instead
+            batch = batches.next();
+            position = 0;
+        }
+        return batch[position++];
+    }
+};
+
+// Registered on first use for each iterator type, as pybind11::make_iterator does
+template <typename Iterator>
+pybind11::object castIterator(Iterator &&iterator, const char *name) {
+    if (!pybind11::detail::get_type_info(typeid(Iterator), false)) {
+        pybind11::class_<Iterator>(pybind11::handle(), name, pybind11::module_local())
+        .def("__iter__", [](Iterator &it) -> Iterator & { return it; })
+        .def("__next__", &Iterator::next)
+        ;
+    }
+    return pybind11::cast(std::move(iterator));
+}
+
+// Python iterator over lists of up to batchSize objects from the range, which must outlive it
+template <typename Range>
+pybind11::object iterateBatches(Range &range, size_t batchSize) {
+    return castIterator(BatchIterator<Range>{range, batchSize}, "BatchIterator");
+}
+
+// Python iterator over the objects in the range, which are read from C++ in batches and must outlive it
+template <typename Range>
+pybind11::object iterateBatched(Range &range) {
+    return castIterator(ObjectBatchIterator<Range>{range, defaultIterationBatchSize}, "ObjectBatchIterator");
+}
+
+#endif /* batch_iterator_py_hpp */
@@ -16,4 +16,7 @@ using namespace blocksci;
 
 void addBlockRangeMethods(RangeClasses<Block> &classes) {
     addRangeMethods(classes);
+    auto getHash = [](const Block &block) { return block.getHash(); };
+    addHashesMethod(classes.iterator, getHash);
+    addHashesMethod(classes.range, getHash);
 }
\ No newline at end of file
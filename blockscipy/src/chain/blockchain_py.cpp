@@ -7,19 +7,226 @@
 //
 
 #include "blockchain_py.hpp"
+#include "batch_iterator_py.hpp"
 #include "caster_py.hpp"
+#include "column_conversion_py.hpp"
+#include "handles_py.hpp"
+#include "range_conversion.hpp"
 #include "self_apply_py.hpp"
 
+#include <blocksci/chain/arrow_export.hpp>
+#include <blocksci/chain/chain_access.hpp>
+#include <blocksci/chain/chain_columns.hpp>
+#include <blocksci/chain/input.hpp>
+#include <blocksci/chain/output.hpp>
+#include <blocksci/chain/tx_predicate.hpp>
+#include <blocksci/chain/utxo_set.hpp>
+#include <blocksci/core/address_info.hpp>
+#include <blocksci/core/raw_block.hpp>
+#include <blocksci/core/raw_transaction.hpp>
+#include <blocksci/index/address_ranking.hpp>
+#include <blocksci/index/hash_index.hpp>
+#include <blocksci/scripts/script_access.hpp>
+
+#include <pybind11/chrono.h>
+#include <pybind11/numpy.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
 namespace py = pybind11;
 
 using namespace blocksci;
 
+namespace {
+    uint32_t typeMaskFromList(const std::vector<AddressType::Enum> &types) {
+        if (types.empty()) {
+            return kernels::allAddressTypes;
+        }
+        uint32_t mask = 0;
+        for (auto type : types) {
+            mask |= uint32_t{1} << static_cast<uint32_t>(type);
+        }
+        return mask;
+    }
+
+    py::dict summaryToDict(const ValueSummary &summary) {
+        py::dict ret;
+        ret["total"] = summary.total;
+        ret["count"] = summary.count;
+        if (summary.count > 0) {
+            ret["min"] = summary.min;
+            ret["max"] = summary.max;
+        } else {
+            ret["min"] = py::none();
+            ret["max"] = py::none();
+        }
+        return ret;
+    }
+
+    py::dict histogramToDict(const AddressTypeHistogram &histogram) {
+        py::dict ret;
+        for (size_t i = 0; i < AddressType::size; i++) {
+            if (histogram.counts[i] > 0) {
+                ret[py::cast(static_cast<AddressType::Enum>(i))] = py::make_tuple(histogram.counts[i], histogram.values[i]);
+            }
+        }
+        return ret;
+    }
+
+    py::dict inoutColumnsToDict(InoutColumns &&columns) {
+        py::dict ret;
+        ret["tx_index"] = columnToArray(std::move(columns.txIndexes));
+        ret["index"] = columnToArray(std::move(columns.indexes));
+        ret["block_height"] = columnToArray(std::move(columns.heights));
+        for (size_t i = 0; i < columns.fields.size(); i++) {
+            ret[py::str(fieldName(columns.fields[i]))] = columnToArray(std::move(columns.values[i]));
+        }
+        return ret;
+    }
+
+    template <typename Func>
+    py::dict extractInoutColumns(Blockchain &chain, const std::vector<std::string> &fieldNames, BlockHeight start, BlockHeight end, Func func) {
+        std::vector<InoutField> fields;
+        for (auto &name : fieldNames) {
+            fields.push_back(inoutFieldFromName(name));
+        }
+        start = resolveHeight(chain, start);
+        end = resolveHeight(chain, end);
+        InoutColumns columns;
+        {
+            py::gil_scoped_release release;
+            columns = func(chain, start, end, fields);
+        }
+        return inoutColumnsToDict(std::move(columns));
+    }
+
+    /* Accepts a 1d numpy array of sizeof(Hash) byte strings or a (n, sizeof(Hash)) uint8 array holding hashes in their
+     * internal byte order, or any sequence of hex strings as displayed by BlockSci */
+    template <typename Hash>
+    std::vector<Hash> hashesFromPython(const py::object &hashes) {
+        std::vector<Hash> ret;
+        if (py::isinstance<py::array>(hashes)) {
+            auto array = py::array::ensure(hashes, py::array::c_style);
+            auto kind = array.dtype().kind();
+            bool byteStrings = (kind == 'S' || kind == 'V') && array.ndim() == 1 && array.itemsize() == sizeof(Hash);
+            bool byteMatrix = kind == 'u' && array.ndim() == 2 && array.itemsize() == 1 && array.shape(1) == sizeof(Hash);
+            if (byteStrings || byteMatrix) {
+                ret.resize(static_cast<size_t>(array.shape(0)));
+                if (!ret.empty()) {
+                    memcpy(ret.data(), array.data(), ret.size() * sizeof(Hash));
+                }
+                return ret;
+            }
+        }
+        for (auto item : hashes) {
+            auto hex = item.cast<std::string>();
+            bool isHex = std::all_of(hex.begin(), hex.end(), [](char c) { return std::isxdigit(static_cast<unsigned char>(c)) != 0; });
+            if (hex.size() != 2 * sizeof(Hash) || !isHex) {
+                throw py::value_error("Hashes must be given as " + std::to_string(2 * sizeof(Hash)) + " character hex strings or as " + std::to_string(sizeof(Hash)) + " byte numpy values");
+            }
+            Hash hash;
+            hash.SetHex(hex);
+            ret.push_back(hash);
+        }
+        return ret;
+    }
+
+    py::dtype recordDtype(const std::vector<std::tuple<const char *, std::string, size_t>> &fields, size_t itemSize) {
+        py::list names, formats, offsets;
+        for (auto &field : fields) {
+            names.append(std::get<0>(field));
+            formats.append(std::get<1>(field));
+            offsets.append(std::get<2>(field));
+        }
+        return py::dtype{names, formats, offsets, static_cast<py::ssize_t>(itemSize)};
+    }
+
+    py::dtype blockHeaderDtype() {
+        return recordDtype({
+            {"first_tx_index", "<u4", offsetof(RawBlock, firstTxIndex)},
+            {"tx_count", "<u4", offsetof(RawBlock, numTxes)},
+            {"height", "<u4", offsetof(RawBlock, height)},
+            {"hash", "V32", offsetof(RawBlock, hash)},
+            {"version", "<i4", offsetof(RawBlock, version)},
+            {"timestamp", "<u4", offsetof(RawBlock, timestamp)},
+            {"bits", "<u4", offsetof(RawBlock, bits)},
+            {"nonce", "<u4", offsetof(RawBlock, nonce)},
+            {"total_size", "<u4", offsetof(RawBlock, realSize)},
+            {"base_size", "<u4", offsetof(RawBlock, baseSize)},
+            {"coinbase_offset", "<u8", offsetof(RawBlock, coinbaseOffset)}
+        }, sizeof(RawBlock));
+    }
+
+    py::dtype txHeaderDtype() {
+        return recordDtype({
+            {"total_size", "<u4", offsetof(RawTransaction, realSize)},
+            {"base_size", "<u4", offsetof(RawTransaction, baseSize)},
+            {"locktime", "<u4", offsetof(RawTransaction, locktime)},
+            {"input_count", "<u2", offsetof(RawTransaction, inputCount)},
+            {"output_count", "<u2", offsetof(RawTransaction, outputCount)}
+        }, sizeof(RawTransaction));
+    }
+
+    // The value is held in the low 60 bits of value_and_type and the address type in the top 4
+    py::dtype inoutDtype() {
+        static_assert(sizeof(Inout) == 16, "Inout records are read as two uint32 fields followed by a uint64");
+        return recordDtype({
+            {"linked_tx_index", "<u4", 0},
+            {"address_num", "<u4", 4},
+            {"value_and_type", "<u8", 8}
+        }, sizeof(Inout));
+    }
+
+    py::dtype scriptHotDtype() {
+        return recordDtype({
+            {"tx_first_seen", "<u4", offsetof(ScriptHotData, txFirstSeen)},
+            {"tx_first_spent", "<u4", offsetof(ScriptHotData, txFirstSpent)},
+            {"types_seen", "<u4", offsetof(ScriptHotData, typesSeen)}
+        }, sizeof(ScriptHotData));
+    }
+
+    // Read only array over mapped chain data, which keeps the mapping alive for as long as numpy references it
+    py::array mappedArray(const MappedView &view, const py::dtype &dtype) {
+        auto owned = std::make_unique<std::shared_ptr<const void>>(view.owner);
+        py::capsule owner{owned.get(), [](void *ptr) {
+            delete reinterpret_cast<std::shared_ptr<const void> *>(ptr);
+        }};
+        owned.release();
+        auto itemSize = static_cast<py::ssize_t>(dtype.itemsize());
+        py::array array{dtype, {static_cast<py::ssize_t>(view.size) / itemSize}, {itemSize}, view.data, owner};
+        array.attr("flags").attr("writeable") = false;
+        return array;
+    }
+
+    template <AddressType::Enum type>
+    py::array_t<uint32_t> lookupAddressHashes(Blockchain &chain, const py::object &hashes) {
+        auto addressHashes = hashesFromPython<typename AddressInfo<type>::IDType>(hashes);
+        std::vector<uint32_t> addressNums;
+        {
+            py::gil_scoped_release release;
+            addressNums = chain.getAccess().getHashIndex().lookupAddresses<type>(addressHashes.data(), addressHashes.size());
+        }
+        return columnToArray(addressNums);
+    }
+
+}
+
 void init_blockchain(py::class_<Blockchain> &cl) {
     cl
     .def("__len__", [](Blockchain &chain) { return chain.size(); })
     .def("__bool__", [](Blockchain &range) { return !ranges::empty(range); })
-    .def("__iter__", [](Blockchain &chain) { return pybind11::make_iterator(chain.begin(), chain.end()); },
+    .def("__iter__", [](Blockchain &chain) { return iterateBatched(chain); },
          pybind11::keep_alive<0, 1>())
+    .def("batches", [](Blockchain &chain, size_t batchSize) { return iterateBatches(chain, batchSize); },
+         pybind11::arg("batch_size") = defaultIterationBatchSize, pybind11::keep_alive<0, 1>(),
+         "Returns an iterator over lists of up to batch_size blocks, the next of which is read in the background")
     .def("__getitem__", [](Blockchain &chain, int64_t posIndex) {
         auto chainSize = static_cast<int64_t>(chain.size());
         if (posIndex < 0) {
@@ -55,6 +262,232 @@ void init_blockchain(py::class_<Blockchain> &cl) {
         return chain.scripts(type);
     }, py::arg("address_type"), "Return a range of all addresses of the given type")
     .def("most_valuable_addresses", mostValuableAddresses, "Get a list of the top 100 most valuable addresses")
+    .def("top_addresses", [](Blockchain &chain, size_t k, AddressRankMetric metric, ranges::optional<BlockHeight> height) {
+        if (height) {
+            height = resolveHeight(chain, *height);
+        }
+        std::vector<RankedAddress> ranked;
+        {
+            py::gil_scoped_release release;
+            ranked = topAddresses(chain, k, metric, height);
+        }
+        py::list pyRanked;
+        for (auto &entry : ranked) {
+            pyRanked.append(py::make_tuple(entry.address.getScript().wrapped, entry.value));
+        }
+        return pyRanked;
+    }, py::arg("k") = 100, py::arg("metric") = AddressRankMetric::Balance, py::arg("height") = py::none(),
+    "Return a list of (address, value) pairs for the k addresses with the highest balance or total received value, ordered from highest to lowest. If height is given, values are computed over the blocks below that height, where negative heights count back from the end of the chain")
+    .def("balances", [](Blockchain &, std::vector<Address> addresses, BlockHeight height) {
+        py::array_t<int64_t> ret{addresses.size()};
+        auto data = ret.mutable_data();
+        {
+            py::gil_scoped_release release;
+            for (size_t i = 0; i < addresses.size(); i++) {
+                data[i] = addresses[i].calculateBalance(height);
+            }
+        }
+        return ret;
+    }, py::arg("addresses"), py::arg("height") = -1,
+    "Return a numpy array of the balance of each of the given addresses at the height (Defaults to the full chain). Uses the balance index when the parser has built it")
+    .def("balance_history", [](Blockchain &, const Address &address) {
+        return address.getBalanceHistory();
+    }, py::arg("address"), "Return a list of (height, balance) pairs for each block that changed the balance of the address, as recorded in the balance index")
+    .def("tx_indexes_from_hashes", [](Blockchain &chain, const py::object &hashes) {
+        auto txHashes = hashesFromPython<uint256>(hashes);
+        std::vector<uint32_t> txNums;
+        {
+            py::gil_scoped_release release;
+            txNums = chain.getAccess().getHashIndex().getTxIndexes(txHashes.data(), txHashes.size());
+        }
+        return columnToArray(txNums);
+    }, py::arg("hashes"),
+    "Return a numpy array of the index of the transaction with each of the given hashes, or 0 where no transaction has that hash. Hashes can be hex strings or a numpy array of 32 byte values in internal byte order. The lookups are batched and run in parallel")
+    .def("address_indexes_from_hashes", [](Blockchain &chain, const py::object &hashes, AddressType::Enum type) {
+        switch (type) {
+            // Every address derived from a public key is indexed under its pubkey hash
+            case AddressType::PUBKEY:
+            case AddressType::PUBKEYHASH:
+            case AddressType::MULTISIG_PUBKEY:
+            case AddressType::WITNESS_PUBKEYHASH:
+                return lookupAddressHashes<AddressType::PUBKEYHASH>(chain, hashes);
+            case AddressType::SCRIPTHASH:
+                return lookupAddressHashes<AddressType::SCRIPTHASH>(chain, hashes);
+            case AddressType::WITNESS_SCRIPTHASH:
+                return lookupAddressHashes<AddressType::WITNESS_SCRIPTHASH>(chain, hashes);
+            default:
+                throw py::value_error("Addresses of type " + addressName(type) + " can't be looked up by hash");
+        }
+    }, py::arg("hashes"), py::arg("address_type"),
+    "Return a numpy array of the address number of each of the given address hashes, or 0 where the hash is unknown. Hashes are 20 bytes, or 32 bytes for witness script hashes, given as hex strings or a numpy array in internal byte order. The lookups are batched and run in parallel")
+    .def("height_at_time", &Blockchain::heightAtTime, py::arg("time"), "Return the height of the first block whose timestamp is at or after the given datetime, or the length of the chain if there is none")
+    .def("height_range", &Blockchain::heightRange, py::arg("start"), py::arg("end"), "Return the (start, stop) heights of the blocks mined from the first block at or after start to the last block at or before end")
+    .def("median_time_past", &Blockchain::medianTimePast, py::arg("height"), "Return the median timestamp of the block at the given height and its 10 predecessors")
+    .def("utxo_set", [](Blockchain &chain, BlockHeight height, const ranges::optional<std::string> &cacheDirectory) {
+        height = resolveHeight(chain, height);
+        py::gil_scoped_release release;
+        if (cacheDirectory) {
+            return UtxoSnapshotCache{*cacheDirectory}.get(chain, height);
+        }
+        return UtxoSet::compute(chain, height);
+    }, py::arg("height") = -1, py::arg("cache_dir") = py::none(),
+    "Return the set of outputs that were unspent after the blocks [0, height). If cache_dir is given, the set is derived from the nearest snapshot saved there and saved itself for later queries")
+    .def("tx_columns", [](Blockchain &chain, const std::vector<std::string> &fieldNames, BlockHeight start, BlockHeight end, bool binary) {
+        std::vector<TxField> fields;
+        bool includeHashes = false;
+        for (auto &name : fieldNames) {
+            if (name == "hash") {
+                includeHashes = true;
+            } else {
+                fields.push_back(txFieldFromName(name));
+            }
+        }
+        start = resolveHeight(chain, start);
+        end = resolveHeight(chain, end);
+        TxColumns columns;
+        {
+            py::gil_scoped_release release;
+            columns = txColumns(chain, start, end, fields, includeHashes);
+        }
+        py::dict ret;
+        size_t fieldNum = 0;
+        for (auto &name : fieldNames) {
+            if (name == "hash") {
+                if (binary) {
+                    ret["hash"] = convertHashRangeToBinary(columns.hashes);
+                } else {
+                    ret["hash"] = convertRangeToPython(columns.hashes);
+                }
+            } else {
+                ret[py::str(name)] = columnToArray(std::move(columns.values[fieldNum++]));
+            }
+        }
+        return ret;
+    }, py::arg("fields"), py::arg("start") = 0, py::arg("end") = -1, py::arg("binary") = false,
+    "Return a dictionary mapping each of the given field names to a numpy array of that field for every transaction in blocks [start, end), extracted in a single parallel pass. The fields are hash, index, block_height, input_count, output_count, size_bytes, total_size, base_size, weight, locktime, input_value, output_value and fee. Hashes are hex strings, or raw bytes in internal byte order if binary is set")
+    .def("input_columns", [](Blockchain &chain, const std::vector<std::string> &fieldNames, BlockHeight start, BlockHeight end) {
+        return extractInoutColumns(chain, fieldNames, start, end, inputColumns);
+    }, py::arg("fields"), py::arg("start") = 0, py::arg("end") = -1,
+    "Return a dictionary of numpy arrays holding the tx_index, index and block_height of every input in blocks [start, end) along with each of the given fields, extracted in a single parallel pass. The fields are value, address_type, address_num, linked_tx_index (the spent transaction) and age")
+    .def("output_columns", [](Blockchain &chain, const std::vector<std::string> &fieldNames, BlockHeight start, BlockHeight end) {
+        return extractInoutColumns(chain, fieldNames, start, end, outputColumns);
+    }, py::arg("fields"), py::arg("start") = 0, py::arg("end") = -1,
+    "Return a dictionary of numpy arrays holding the tx_index, index and block_height of every output in blocks [start, end) along with each of the given fields, extracted in a single parallel pass. The fields are value, address_type, address_num, linked_tx_index (the spending transaction or 0) and age (-1 if unspent)")
+    .def("gather_tx_columns", [](Blockchain &chain, const ColumnArray<uint32_t> &txIndexes, const std::vector<std::string> &fieldNames) {
+        auto txNums = columnFromArray(txIndexes);
+        return gatherColumns(fieldNames, txFieldFromName, [&](const std::vector<TxField> &fields) {
+            return gatherTxFields(chain.getAccess(), txNums, fields);
+        });
+    }, py::arg("tx_indexes"), py::arg("fields"),
+    "Return a dictionary mapping each of the given field names to a numpy array of that field for the transactions with the given indexes, in the order given. The lookups run in parallel in index order. The fields are those of tx_columns other than hash")
+    .def("gather_input_columns", [](Blockchain &chain, const ColumnArray<uint32_t> &txIndexes, const ColumnArray<uint16_t> &indexes, const std::vector<std::string> &fieldNames) {
+        auto pointers = pointersFromArrays<InputPointer>(txIndexes, indexes);
+        return gatherColumns(fieldNames, inoutFieldFromName, [&](const std::vector<InoutField> &fields) {
+            return gatherInputFields(chain.getAccess(), pointers, fields);
+        });
+    }, py::arg("tx_indexes"), py::arg("indexes"), py::arg("fields"),
+    "Return a dictionary mapping each of the given field names to a numpy array of that field for the inputs with the given transaction indexes and input indexes, in the order given. The lookups run in parallel in pointer order. The fields are those of input_columns")
+    .def("gather_output_columns", [](Blockchain &chain, const ColumnArray<uint32_t> &txIndexes, const ColumnArray<uint16_t> &indexes, const std::vector<std::string> &fieldNames) {
+        auto pointers = pointersFromArrays<OutputPointer>(txIndexes, indexes);
+        return gatherColumns(fieldNames, inoutFieldFromName, [&](const std::vector<InoutField> &fields) {
+            return gatherOutputFields(chain.getAccess(), pointers, fields);
+        });
+    }, py::arg("tx_indexes"), py::arg("indexes"), py::arg("fields"),
+    "Return a dictionary mapping each of the given field names to a numpy array of that field for the outputs with the given transaction indexes and output indexes, in the order given. The lookups run in parallel in pointer order. The fields are those of output_columns")
+    .def("export_arrow", [](Blockchain &chain, const std::string &directory, BlockHeight partitionBlocks) {
+        py::gil_scoped_release release;
+        return exportArrow(chain, directory, partitionBlocks);
+    }, py::arg("directory"), py::arg("partition_blocks") = defaultArrowPartitionBlocks,
+    "Export the blocks, transactions, inputs, outputs and newly seen addresses of the chain as Arrow IPC (Feather v2) files at directory/<table>/<start>-<end>.arrow, one per partition of partition_blocks blocks, which Spark, DuckDB and pandas read directly. Calling it again on the same directory only exports blocks added since, after dropping partitions replaced by a reorg. Since exported partitions are never rewritten, outputs and addresses leave out when they are spent, which output_columns and the inputs give instead. Returns the number of blocks exported")
+    .def("block_header_array", [](Blockchain &chain) {
+        return mappedArray(chain.getAccess().getChain().blockView(), blockHeaderDtype());
+    }, "Return a read only numpy view of the headers of every block, indexed by height, with the dtype blocksci.block_header_dtype. The view reads the mapped chain files directly and stays valid when reload appends blocks, but reading it after a rollback or reorg has truncated the files crashes the process. It only covers the blocks loaded when it was created")
+    .def("tx_hash_array", [](Blockchain &chain) {
+        return mappedArray(chain.getAccess().getChain().txHashView(), py::dtype{"V32"});
+    }, "Return a read only numpy view of the hash of every transaction in internal byte order, indexed by tx index. The view reads the mapped chain files directly and stays valid when reload appends blocks, but reading it after a rollback or reorg has truncated the files crashes the process. It only covers the transactions loaded when it was created")
+    .def("script_hot_array", [](Blockchain &chain, AddressType::Enum type) {
+        return mappedArray(chain.getAccess().getScripts().scriptHotView(dedupType(type)), scriptHotDtype());
+    }, py::arg("address_type"), "Return a read only numpy view of the first seen tx index, first spent tx index and bitmask of types seen of the scripts underlying the given address type, where the row of address number n is n - 1. A first spent tx index at or past the number of loaded transactions is a spend the parser has not published yet and means unspent. Data directories parsed before these columns existed may cover only some of the scripts. Like the other mapped views, it must not be read after a rollback or reorg")
+    .def("tx_record_array", [](Blockchain &chain, BlockHeight start, BlockHeight end) {
+        auto &access = chain.getAccess().getChain();
+        start = resolveHeight(chain, start);
+        end = resolveHeight(chain, end);
+        uint32_t firstTx = 0;
+        uint32_t endTx = 0;
+        if (start < end) {
+            firstTx = access.getBlock(start)->firstTxIndex;
+            auto lastBlock = access.getBlock(end - 1);
+            endTx = lastBlock->firstTxIndex + lastBlock->numTxes;
+        }
+        auto view = access.txDataView(firstTx, endTx);
+        std::vector<int64_t> txOffsets(endTx - firstTx + 1, 0);
+        {
+            py::gil_scoped_release release;
+            int64_t record = 0;
+            for (size_t i = 0; i < txOffsets.size() - 1; i++) {
+                txOffsets[i] = record;
+                auto tx = reinterpret_cast<const RawTransaction *>(view.data + static_cast<size_t>(record) * sizeof(Inout));
+                record += 1 + tx->inputCount + tx->outputCount;
+            }
+            txOffsets.back() = record;
+        }
+        return py::make_tuple(mappedArray(view, inoutDtype()), columnToArray(std::move(txOffsets)));
+    }, py::arg("start") = 0, py::arg("end") = -1,
+    "Return a read only numpy view of the serialized transactions of blocks [start, end) as 16 byte records with the dtype blocksci.inout_dtype, along with an array of the record offset of each transaction followed by the total record count. The record at a transaction's offset is its header, which can be read with records[offset:offset + 1].view(blocksci.tx_header_dtype), and its inputs then its outputs follow it. Like the other mapped views, it must not be read after a rollback or reorg")
+    .def("_blocks_from_heights", [](Blockchain &chain, const ColumnArray<uint32_t> &heights) -> SizedRange<Block> {
+        return rangeFromRecords(columnFromArray(heights), [&chain](uint32_t height) { return chain[static_cast<BlockHeight>(height)]; });
+    }, py::arg("heights"), "Return a range of the blocks with the given heights")
+    .def("_txes_from_indexes", [](Blockchain &chain, const ColumnArray<uint32_t> &txIndexes) -> SizedRange<Transaction> {
+        auto &access = chain.getAccess();
+        return rangeFromRecords(columnFromArray(txIndexes), [&access](uint32_t txNum) { return Transaction{txNum, access}; });
+    }, py::arg("tx_indexes"), "Return a range of the transactions with the given indexes")
+    .def("_inputs_from_pointers", [](Blockchain &chain, const ColumnArray<uint32_t> &txIndexes, const ColumnArray<uint16_t> &indexes) -> SizedRange<Input> {
+        auto &access = chain.getAccess();
+        return rangeFromRecords(pointersFromArrays<InputPointer>(txIndexes, indexes), [&access](const InputPointer &pointer) { return Input{pointer, access}; });
+    }, py::arg("tx_indexes"), py::arg("indexes"), "Return a range of the inputs with the given transaction indexes and input indexes")
+    .def("_outputs_from_pointers", [](Blockchain &chain, const ColumnArray<uint32_t> &txIndexes, const ColumnArray<uint16_t> &indexes) -> SizedRange<Output> {
+        auto &access = chain.getAccess();
+        return rangeFromRecords(pointersFromArrays<OutputPointer>(txIndexes, indexes), [&access](const OutputPointer &pointer) { return Output{pointer, access}; });
+    }, py::arg("tx_indexes"), py::arg("indexes"), "Return a range of the outputs with the given transaction indexes and output indexes")
+    .def("tx_handles", [](Blockchain &chain, const ColumnArray<uint32_t> &txIndexes) {
+        return TxHandleList{columnFromArray(txIndexes), &chain.getAccess()};
+    }, py::arg("tx_indexes"), "Return a compact list of handles to the transactions with the given indexes, which store only the indexes until they are accessed")
+    .def("input_handles", [](Blockchain &chain, const ColumnArray<uint32_t> &txIndexes, const ColumnArray<uint16_t> &indexes) {
+        return InputHandleList{pointersFromArrays<InputPointer>(txIndexes, indexes), &chain.getAccess()};
+    }, py::arg("tx_indexes"), py::arg("indexes"), "Return a compact list of handles to the inputs with the given transaction indexes and input indexes, which store only the pointers until they are accessed")
+    .def("output_handles", [](Blockchain &chain, const ColumnArray<uint32_t> &txIndexes, const ColumnArray<uint16_t> &indexes) {
+        return OutputHandleList{pointersFromArrays<OutputPointer>(txIndexes, indexes), &chain.getAccess()};
+    }, py::arg("tx_indexes"), py::arg("indexes"), "Return a compact list of handles to the outputs with the given transaction indexes and output indexes, which store only the pointers until they are accessed")
+    .def("address_handles", [](Blockchain &chain, const ColumnArray<uint32_t> &addressNums, AddressType::Enum type) {
+        AddressHandleList list;
+        list.access = &chain.getAccess();
+        list.ids.reserve(static_cast<size_t>(addressNums.size()));
+        for (py::ssize_t i = 0; i < addressNums.size(); i++) {
+            list.ids.push_back(AddressId{addressNums.data()[i], type});
+        }
+        return list;
+    }, py::arg("address_nums"), py::arg("address_type"), "Return a compact list of handles to the addresses of the given type with the given address numbers, which store only the numbers until they are accessed")
+    .def("_filter_txes_predicate", [](Blockchain &chain, const TxPredicate &predicate, BlockHeight start, BlockHeight end) {
+        py::gil_scoped_release release;
+        return filter(chain, start, end, predicate);
+    }, py::arg("predicate"), py::arg("start"), py::arg("end"), "Return all transactions in blocks [start, end) matching the given native predicate")
+    .def("output_value_summary", [](Blockchain &chain, BlockHeight start, BlockHeight end, const std::vector<AddressType::Enum> &types) {
+        return summaryToDict(outputValueSummary(chain, resolveHeight(chain, start), resolveHeight(chain, end), typeMaskFromList(types)));
+    }, py::arg("start") = 0, py::arg("end") = -1, py::arg("address_types") = std::vector<AddressType::Enum>{},
+    "Return the total, count, min and max value of the outputs in blocks [start, end), optionally restricted to the given address types")
+    .def("input_value_summary", [](Blockchain &chain, BlockHeight start, BlockHeight end, const std::vector<AddressType::Enum> &types) {
+        return summaryToDict(inputValueSummary(chain, resolveHeight(chain, start), resolveHeight(chain, end), typeMaskFromList(types)));
+    }, py::arg("start") = 0, py::arg("end") = -1, py::arg("address_types") = std::vector<AddressType::Enum>{},
+    "Return the total, count, min and max value of the inputs in blocks [start, end), optionally restricted to the given address types")
+    .def("fee_summary", [](Blockchain &chain, BlockHeight start, BlockHeight end) {
+        return summaryToDict(feeSummary(chain, resolveHeight(chain, start), resolveHeight(chain, end)));
+    }, py::arg("start") = 0, py::arg("end") = -1, "Return the total, count, min and max fee of the non-coinbase transactions in blocks [start, end)")
+    .def("output_type_histogram", [](Blockchain &chain, BlockHeight start, BlockHeight end) {
+        return histogramToDict(outputTypeHistogram(chain, resolveHeight(chain, start), resolveHeight(chain, end)));
+    }, py::arg("start") = 0, py::arg("end") = -1, "Return a dictionary mapping each address type to the number and total value of outputs of that type in blocks [start, end)")
+    .def("input_type_histogram", [](Blockchain &chain, BlockHeight start, BlockHeight end) {
+        return histogramToDict(inputTypeHistogram(chain, resolveHeight(chain, start), resolveHeight(chain, end)));
+    }, py::arg("start") = 0, py::arg("end") = -1, "Return a dictionary mapping each address type to the number and total value of inputs of that type in blocks [start, end)")
     ;
 
     applyMethodsToSelf(cl, AddBlockchainMethods{});
@@ -74,9 +507,21 @@ void init_data_access(py::module &m) {
             return DataConfiguration(t[0].cast<std::string>(), t[1].cast<bool>(), t[2].cast<BlockHeight>());
         }
     ))
+    .def_readonly("data_directory", &DataConfiguration::dataDirectory, "Directory holding the parsed chain data")
+    ;
+
+    m.attr("block_header_dtype") = blockHeaderDtype();
+    m.attr("tx_header_dtype") = txHeaderDtype();
+    m.attr("inout_dtype") = inoutDtype();
+    m.attr("script_hot_dtype") = scriptHotDtype();
+
+    py::enum_<AddressRankMetric>(m, "AddressRankMetric", "Values that addresses can be ranked by with Blockchain.top_addresses")
+    .value("balance", AddressRankMetric::Balance)
+    .value("received", AddressRankMetric::Received)
     ;
 
     py::class_<DataAccess> (m, "_DataAccess", "Private class for accessing blockchain data")
+    .def_property_readonly("_config", [](DataAccess &access) -> DataConfiguration { return access.config; }, "Returns the configuration settings for this blockchain")
     .def("tx_with_index", [](DataAccess &access, uint32_t index) {
         return Transaction{index, access};
     }, "This functions gets the transaction with given index.")
@@ -95,12 +540,21 @@ void init_data_access(py::module &m) {
         }
     }, "Construct an address object from an address string")
     .def("addresses_with_prefix", [](DataAccess &access, const std::string &addressPrefix) {
+        std::vector<Address> addresses;
+        {
+            py::gil_scoped_release release;
+            addresses = getAddressesWithPrefix(addressPrefix, access);
+        }
         py::list pyAddresses;
-        auto addresses = getAddressesWithPrefix(addressPrefix, access);
         for (auto &address : addresses) {
             pyAddresses.append(address.getScript().wrapped);
         }
         return pyAddresses;
-    }, "Find all addresses beginning with the given prefix")
+    }, "Find all addresses beginning with the given prefix, using the address prefix index built by the parser")
+    ;
+    
+    m.def("thread_count", []() { return ThreadPool::instance().threadCount(); }, "Number of threads used by native parallel chain operations")
+    .def("set_thread_count", [](unsigned int threadCount) { ThreadPool::instance().setThreadCount(threadCount); }, py::arg("thread_count"), "Set the number of threads used by native parallel chain operations (defaults to BLOCKSCI_THREADS or the number of cores)")
+    .def("kernel_instruction_set", kernels::activeInstructionSet, "Instruction set (avx512, avx2 or scalar) selected for the native aggregate kernels on this machine")
     ;
 }
@@ -45,13 +45,17 @@ struct AddBlockchainMethods {
             }
         }, "Construct an address object from an address string", pybind11::arg("address_string"));
         func(method_tag, "addresses_with_prefix", [](Blockchain &chain, const std::string &addressPrefix) {
+            std::vector<Address> addresses;
+            {
+                pybind11::gil_scoped_release release;
+                addresses = getAddressesWithPrefix(addressPrefix, chain.getAccess());
+            }
             pybind11::list pyAddresses;
-            auto addresses = getAddressesWithPrefix(addressPrefix, chain.getAccess());
             for (auto &address : addresses) {
                 pyAddresses.append(address.getScript().wrapped);
             }
             return pyAddresses;
-        }, "Find all addresses beginning with the given prefix", pybind11::arg("prefix"));
+        }, "Find all addresses beginning with the given prefix, using the address prefix index built by the parser", pybind11::arg("prefix"));
     }
 };
 
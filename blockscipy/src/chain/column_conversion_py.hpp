@@ -0,0 +1,109 @@
+//
+//  column_conversion_py.hpp
+//  blocksci
+//
+
+#ifndef column_conversion_py_hpp
+#define column_conversion_py_hpp
+
+#include <blocksci/chain/blockchain.hpp>
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include <range/v3/view/any_view.hpp>
+#include <range/v3/view/iota.hpp>
+#include <range/v3/view/transform.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Conversions between native columns and numpy arrays used across the chain bindings
+
+/* Negative heights count back from the end of the chain like Python indexes, with -1 standing for the end of the
+ * chain. Heights past the end are clamped to it, while negative heights before the start of the chain raise IndexError */
+inline blocksci::BlockHeight resolveHeight(blocksci::Blockchain &chain, blocksci::BlockHeight height) {
+    auto size = static_cast<blocksci::BlockHeight>(chain.size());
+    if (height < 0) {
+        height = size + height + 1;
+        if (height < 0) {
+            throw pybind11::index_error("block height out of range");
+        }
+    }
+    return std::min(height, size);
+}
+
+template <typename T>
+pybind11::array_t<T> columnToArray(const std::vector<T> &column) {
+    return pybind11::array_t<T>{column.size(), column.data()};
+}
+
+// Hands the column over to numpy without copying it
+template <typename T>
+pybind11::array_t<T> columnToArray(std::vector<T> &&column) {
+    auto owned = std::make_unique<std::vector<T>>(std::move(column));
+    auto size = owned->size();
+    auto data = owned->data();
+    pybind11::capsule owner{owned.get(), [](void *ptr) {
+        delete reinterpret_cast<std::vector<T> *>(ptr);
+    }};
+    owned.release();
+    return pybind11::array_t<T>{size, data, owner};
+}
+
+template <typename Field, typename Gather>
+pybind11::dict gatherColumns(const std::vector<std::string> &fieldNames, Field (*fieldFromName)(const std::string &), Gather gather) {
+    std::vector<Field> fields;
+    for (auto &name : fieldNames) {
+        fields.push_back(fieldFromName(name));
+    }
+    std::vector<std::vector<int64_t>> values;
+    {
+        pybind11::gil_scoped_release release;
+        values = gather(fields);
+    }
+    pybind11::dict ret;
+    for (size_t i = 0; i < fieldNames.size(); i++) {
+        ret[pybind11::str(fieldNames[i])] = columnToArray(std::move(values[i]));
+    }
+    return ret;
+}
+
+template <typename T>
+using SizedRange = ranges::any_view<T, ranges::category::random_access | ranges::category::sized>;
+
+template <typename T>
+using ColumnArray = pybind11::array_t<T, pybind11::array::c_style | pybind11::array::forcecast>;
+
+template <typename T>
+std::vector<T> columnFromArray(const ColumnArray<T> &array) {
+    return std::vector<T>(array.data(), array.data() + array.size());
+}
+
+template <typename Pointer>
+std::vector<Pointer> pointersFromArrays(const ColumnArray<uint32_t> &txIndexes, const ColumnArray<uint16_t> &indexes) {
+    if (txIndexes.size() != indexes.size()) {
+        throw pybind11::value_error("tx_index and index arrays must have the same length");
+    }
+    std::vector<Pointer> pointers;
+    pointers.reserve(static_cast<size_t>(txIndexes.size()));
+    for (pybind11::ssize_t i = 0; i < txIndexes.size(); i++) {
+        pointers.emplace_back(txIndexes.data()[i], indexes.data()[i]);
+    }
+    return pointers;
+}
+
+// Range which builds each object from its native record on access, keeping the records alive for as long as it exists
+template <typename Record, typename Func>
+auto rangeFromRecords(std::vector<Record> &&records, Func func) {
+    auto shared = std::make_shared<std::vector<Record>>(std::move(records));
+    return ranges::view::ints(size_t{0}, shared->size()) | ranges::view::transform([shared, func](size_t i) {
+        return func((*shared)[i]);
+    });
+}
+
+#endif /* column_conversion_py_hpp */
@@ -0,0 +1,305 @@
+//
+//  handles_py.cpp
+//  blocksci
+//
+
+#include "handles_py.hpp"
+#include "caster_py.hpp"
+#include "column_conversion_py.hpp"
+#include "range_conversion.hpp"
+
+#include <blocksci/address/address.hpp>
+#include <blocksci/chain/chain_access.hpp>
+#include <blocksci/chain/chain_columns.hpp>
+#include <blocksci/core/address_info.hpp>
+#include <blocksci/core/script_data.hpp>
+#include <blocksci/scripts/script_access.hpp>
+#include <blocksci/util/data_access.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+using namespace blocksci;
+
+namespace {
+    void checkTxIndex(uint32_t txNum, DataAccess &access) {
+        if (txNum >= access.getChain().maxLoadedTx()) {
+            throw std::out_of_range("Transaction index " + std::to_string(txNum) + " out of range");
+        }
+    }
+
+    void checkAddressId(const AddressId &id, DataAccess &access) {
+        if (id.scriptNum == 0 || id.scriptNum > access.getScripts().scriptCount(dedupType(id.type))) {
+            throw std::out_of_range("Address number " + std::to_string(id.scriptNum) + " of type " + addressName(id.type) + " out of range");
+        }
+    }
+
+    template <typename Pointer>
+    void checkPointer(const Pointer &pointer, DataAccess &access) {
+        checkTxIndex(pointer.txNum, access);
+        if (!pointer.isValid(access.getChain())) {
+            throw std::out_of_range(pointer.toString() + " out of range");
+        }
+    }
+
+    Transaction resolveHandle(uint32_t txNum, DataAccess &access) {
+        checkTxIndex(txNum, access);
+        return Transaction{txNum, access};
+    }
+
+    Input resolveHandle(const InputPointer &pointer, DataAccess &access) {
+        checkPointer(pointer, access);
+        return Input{pointer, access};
+    }
+
+    Output resolveHandle(const OutputPointer &pointer, DataAccess &access) {
+        checkPointer(pointer, access);
+        return Output{pointer, access};
+    }
+
+    Address resolveHandle(const AddressId &id, DataAccess &access) {
+        checkAddressId(id, access);
+        return Address{id.scriptNum, id.type, access};
+    }
+
+    py::tuple identifierTuple(uint32_t txNum) {
+        return py::make_tuple(txNum);
+    }
+
+    py::tuple identifierTuple(const InoutPointer &pointer) {
+        return py::make_tuple(pointer.txNum, pointer.inoutNum);
+    }
+
+    py::tuple identifierTuple(const AddressId &id) {
+        return py::make_tuple(id.scriptNum, id.type);
+    }
+
+    std::string identifierString(uint32_t txNum) {
+        return "index=" + std::to_string(txNum);
+    }
+
+    std::string identifierString(const InoutPointer &pointer) {
+        return "tx_index=" + std::to_string(pointer.txNum) + ", index=" + std::to_string(pointer.inoutNum);
+    }
+
+    std::string identifierString(const AddressId &id) {
+        return "address_num=" + std::to_string(id.scriptNum) + ", type=" + addressName(id.type);
+    }
+
+    // Fields of address handle lists, read from the hot script columns
+    enum class AddressHandleField {
+        FirstTxIndex, RevealedTxIndex
+    };
+
+    AddressHandleField addressHandleFieldFromName(const std::string &name) {
+        if (name == "first_tx_index") {
+            return AddressHandleField::FirstTxIndex;
+        } else if (name == "revealed_tx_index") {
+            return AddressHandleField::RevealedTxIndex;
+        }
+        throw std::invalid_argument("Unknown address field " + name);
+    }
+
+    std::vector<std::vector<int64_t>> gatherAddressFields(DataAccess &access, const std::vector<AddressId> &ids, const std::vector<AddressHandleField> &fields) {
+        std::vector<std::vector<int64_t>> values(fields.size(), std::vector<int64_t>(ids.size()));
+        auto &scripts = access.getScripts();
+        for (size_t row = 0; row < ids.size(); row++) {
+            checkAddressId(ids[row], access);
+            auto hotData = scripts.getScriptHotData(ids[row].scriptNum, dedupType(ids[row].type));
+            for (size_t i = 0; i < fields.size(); i++) {
+                switch (fields[i]) {
+                    case AddressHandleField::FirstTxIndex:
+                        values[i][row] = hotData.txFirstSeen;
+                        break;
+                    case AddressHandleField::RevealedTxIndex:
+                        values[i][row] = hotData.hasBeenSpentBefore(access.getChain().maxLoadedTx()) ? int64_t{hotData.txFirstSpent} : -1;
+                        break;
+                }
+            }
+        }
+        return values;
+    }
+
+    template <typename Id, typename Field, typename Gather>
+    py::dict gatherHandleColumns(const HandleList<Id> &list, const std::vector<std::string> &fieldNames, Field (*fieldFromName)(const std::string &), Gather gather) {
+        return gatherColumns(fieldNames, fieldFromName, [&](const std::vector<Field> &fields) {
+            if (list.ids.empty()) {
+                return std::vector<std::vector<int64_t>>(fields.size());
+            }
+            return gather(*list.access, list.ids, fields);
+        });
+    }
+
+    py::dict handleColumns(const TxHandleList &list, const std::vector<std::string> &fieldNames) {
+        return gatherHandleColumns(list, fieldNames, txFieldFromName, gatherTxFields);
+    }
+
+    py::dict handleColumns(const InputHandleList &list, const std::vector<std::string> &fieldNames) {
+        return gatherHandleColumns(list, fieldNames, inoutFieldFromName, gatherInputFields);
+    }
+
+    py::dict handleColumns(const OutputHandleList &list, const std::vector<std::string> &fieldNames) {
+        return gatherHandleColumns(list, fieldNames, inoutFieldFromName, gatherOutputFields);
+    }
+
+    py::dict handleColumns(const AddressHandleList &list, const std::vector<std::string> &fieldNames) {
+        return gatherHandleColumns(list, fieldNames, addressHandleFieldFromName, gatherAddressFields);
+    }
+
+    // Column of the identifiers of a list, such as the tx index of each output
+    template <typename Id, typename Func>
+    auto identifierColumn(const HandleList<Id> &list, Func func) {
+        std::vector<decltype(func(list.ids.front()))> column;
+        column.reserve(list.ids.size());
+        for (auto &id : list.ids) {
+            column.push_back(func(id));
+        }
+        return columnToArray(std::move(column));
+    }
+
+    // Private names are never forwarded so that protocol lookups by Python and numpy behave as for any other object
+    void checkForwardedAttribute(const std::string &name) {
+        if (name.empty() || name[0] == '_') {
+            throw py::attribute_error(name);
+        }
+    }
+
+    template <typename Id>
+    py::class_<Handle<Id>> addHandleClass(py::module &m, const char *name, const char *objectName, const char *docstring) {
+        using HandleType = Handle<Id>;
+        py::class_<HandleType> cl(m, name, docstring);
+        cl
+        .def_property_readonly(objectName, [](const HandleType &handle) {
+            return resolveHandle(handle.id, *handle.access);
+        }, "Returns the full object the handle refers to")
+        .def("__getattr__", [](const HandleType &handle, const std::string &attr) {
+            checkForwardedAttribute(attr);
+            return py::getattr(py::cast(resolveHandle(handle.id, *handle.access)), attr.c_str());
+        }, "Attributes of the full object are read through the handle")
+        .def("__eq__", [](const HandleType &a, const HandleType &b) { return a.id == b.id; }, py::is_operator())
+        .def("__hash__", [](const HandleType &handle) { return py::hash(identifierTuple(handle.id)); })
+        .def("__repr__", [name](const HandleType &handle) {
+            return std::string{name} + "(" + identifierString(handle.id) + ")";
+        })
+        ;
+        return cl;
+    }
+
+    template <typename Id>
+    py::class_<HandleList<Id>> addHandleListClass(py::module &m, const char *name, const char *docstring) {
+        using List = HandleList<Id>;
+        py::class_<List> cl(m, name, docstring);
+        cl
+        .def("__len__", [](const List &list) { return list.ids.size(); })
+        .def("__getitem__", [](const List &list, int64_t posIndex) {
+            auto size = static_cast<int64_t>(list.ids.size());
+            if (posIndex < 0) {
+                posIndex += size;
+            }
+            if (posIndex < 0 || posIndex >= size) {
+                throw pybind11::index_error();
+            }
+            return Handle<Id>{list.ids[static_cast<size_t>(posIndex)], list.access};
+        }, py::arg("index"))
+        .def("__getitem__", [](const List &list, py::slice slice) {
+            size_t start, stop, step, slicelength;
+            if (!slice.compute(list.ids.size(), &start, &stop, &step, &slicelength)) {
+                throw pybind11::error_already_set();
+            }
+            List sliced;
+            sliced.access = list.access;
+            sliced.ids.reserve(slicelength);
+            for (size_t i = 0; i < slicelength; i++, start += step) {
+                sliced.ids.push_back(list.ids[start]);
+            }
+            return sliced;
+        }, py::arg("slice"))
+        .def("columns", [](const List &list, const std::vector<std::string> &fieldNames) {
+            return handleColumns(list, fieldNames);
+        }, py::arg("fields"), "Return a dictionary mapping each of the given field names to a numpy array of that field for every handle in the list, read in one parallel pass")
+        .def("__getattr__", [](const List &list, const std::string &attr) -> py::object {
+            checkForwardedAttribute(attr);
+            try {
+                return handleColumns(list, {attr})[py::str(attr)];
+            } catch (const std::invalid_argument &) {}
+            // Attributes without a native column are read from each full object in turn
+            py::list values(list.ids.size());
+            for (size_t i = 0; i < list.ids.size(); i++) {
+                values[i] = py::getattr(py::cast(resolveHandle(list.ids[i], *list.access)), attr.c_str());
+            }
+            return values;
+        }, "Fields with a native column are returned as a numpy array for the whole list and other attributes as a list of that attribute of each full object")
+        ;
+        return cl;
+    }
+
+    template <typename Id>
+    void addToRange(py::class_<HandleList<Id>> &cl) {
+        using List = HandleList<Id>;
+        cl.def("to_range", [](const List &list) -> SizedRange<decltype(resolveHandle(std::declval<Id>(), std::declval<DataAccess &>()))> {
+            auto access = list.access;
+            return rangeFromRecords(std::vector<Id>(list.ids), [access](const Id &id) { return resolveHandle(id, *access); });
+        }, "Return a range of the full objects, which supports every range method");
+    }
+}
+
+void init_handles(py::module &m) {
+    auto txHandleCl = addHandleClass<uint32_t>(m, "TxHandle", "tx", "Handle to a transaction which stores only its index and reads the transaction when accessed");
+    txHandleCl
+    .def_property_readonly("index", [](const TxHandle &handle) { return handle.id; }, "The internal index of the transaction")
+    ;
+
+    auto inputHandleCl = addHandleClass<InputPointer>(m, "InputHandle", "input", "Handle to an input which stores only its pointer and reads the input when accessed");
+    inputHandleCl
+    .def_property_readonly("tx_index", [](const InputHandle &handle) { return handle.id.txNum; }, "The internal index of the transaction containing the input")
+    .def_property_readonly("index", [](const InputHandle &handle) { return handle.id.inoutNum; }, "The position of the input in its transaction")
+    ;
+
+    auto outputHandleCl = addHandleClass<OutputPointer>(m, "OutputHandle", "output", "Handle to an output which stores only its pointer and reads the output when accessed");
+    outputHandleCl
+    .def_property_readonly("tx_index", [](const OutputHandle &handle) { return handle.id.txNum; }, "The internal index of the transaction containing the output")
+    .def_property_readonly("index", [](const OutputHandle &handle) { return handle.id.inoutNum; }, "The position of the output in its transaction")
+    ;
+
+    auto addressHandleCl = addHandleClass<AddressId>(m, "AddressHandle", "address", "Handle to an address which stores only its number and type and reads the address when accessed");
+    addressHandleCl
+    .def_property_readonly("address_num", [](const AddressHandle &handle) { return handle.id.scriptNum; }, "The internal identifier of the address")
+    .def_property_readonly("type", [](const AddressHandle &handle) { return handle.id.type; }, "The type of address")
+    ;
+
+    auto txHandleListCl = addHandleListClass<uint32_t>(m, "TxHandleList", "Compact list of transaction handles. Attributes that are fields of Blockchain.tx_columns are read for the whole list as numpy arrays");
+    txHandleListCl
+    .def_property_readonly("index", [](const TxHandleList &list) { return columnToArray(list.ids); }, "Numpy array of the index of each transaction")
+    ;
+    addToRange(txHandleListCl);
+
+    auto inputHandleListCl = addHandleListClass<InputPointer>(m, "InputHandleList", "Compact list of input handles. Attributes that are fields of Blockchain.input_columns are read for the whole list as numpy arrays");
+    inputHandleListCl
+    .def_property_readonly("tx_index", [](const InputHandleList &list) { return identifierColumn(list, [](const InputPointer &pointer) { return pointer.txNum; }); }, "Numpy array of the index of the transaction containing each input")
+    .def_property_readonly("index", [](const InputHandleList &list) { return identifierColumn(list, [](const InputPointer &pointer) { return pointer.inoutNum; }); }, "Numpy array of the position of each input in its transaction")
+    ;
+    addToRange(inputHandleListCl);
+
+    auto outputHandleListCl = addHandleListClass<OutputPointer>(m, "OutputHandleList", "Compact list of output handles. Attributes that are fields of Blockchain.output_columns are read for the whole list as numpy arrays");
+    outputHandleListCl
+    .def_property_readonly("tx_index", [](const OutputHandleList &list) { return identifierColumn(list, [](const OutputPointer &pointer) { return pointer.txNum; }); }, "Numpy array of the index of the transaction containing each output")
+    .def_property_readonly("index", [](const OutputHandleList &list) { return identifierColumn(list, [](const OutputPointer &pointer) { return pointer.inoutNum; }); }, "Numpy array of the position of each output in its transaction")
+    ;
+    addToRange(outputHandleListCl);
+
+    auto addressHandleListCl = addHandleListClass<AddressId>(m, "AddressHandleList", "Compact list of address handles. The attributes first_tx_index and revealed_tx_index (-1 if never spent) are read for the whole list as numpy arrays");
+    addressHandleListCl
+    .def_property_readonly("address_num", [](const AddressHandleList &list) { return identifierColumn(list, [](const AddressId &id) { return id.scriptNum; }); }, "Numpy array of the address number of each address")
+    .def_property_readonly("type", [](const AddressHandleList &list) {
+        py::list types(list.ids.size());
+        for (size_t i = 0; i < list.ids.size(); i++) {
+            types[i] = py::cast(list.ids[i].type);
+        }
+        return types;
+    }, "List of the address type of each address, as the AddressType of the matching AddressHandle")
+    .def_property_readonly("type_code", [](const AddressHandleList &list) { return identifierColumn(list, [](const AddressId &id) { return static_cast<uint8_t>(id.type); }); }, "Numpy array of the address type of each address as the integer value of its AddressType")
+    ;
+}
@@ -0,0 +1,90 @@
+//
+//  handles_py.hpp
+//  blocksci
+//
+
+#ifndef handles_py_hpp
+#define handles_py_hpp
+
+#include <blocksci/chain/inout_pointer.hpp>
+#include <blocksci/chain/input.hpp>
+#include <blocksci/chain/output.hpp>
+#include <blocksci/chain/transaction.hpp>
+#include <blocksci/core/address_types.hpp>
+
+#include <pybind11/pybind11.h>
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Identifies an address without reading its script
+struct AddressId {
+    uint32_t scriptNum;
+    blocksci::AddressType::Enum type;
+
+    bool operator==(const AddressId &other) const {
+        return scriptNum == other.scriptNum && type == other.type;
+    }
+};
+
+/* Stand-in for a Tx, Input, Output or Address that holds only its identifier, where Id is a tx index, an InputPointer,
+ * an OutputPointer or an AddressId. Nothing is read from the chain until the handle is resolved to the full object */
+template <typename Id>
+struct Handle {
+    Id id;
+    blocksci::DataAccess *access;
+};
+
+// Identifiers stored back to back, so that a large result set costs a few bytes per entry until it is resolved
+template <typename Id>
+struct HandleList {
+    std::vector<Id> ids;
+    // Null for lists collected from empty ranges
+    blocksci::DataAccess *access = nullptr;
+};
+
+using TxHandle = Handle<uint32_t>;
+using InputHandle = Handle<blocksci::InputPointer>;
+using OutputHandle = Handle<blocksci::OutputPointer>;
+using AddressHandle = Handle<AddressId>;
+
+using TxHandleList = HandleList<uint32_t>;
+using InputHandleList = HandleList<blocksci::InputPointer>;
+using OutputHandleList = HandleList<blocksci::OutputPointer>;
+using AddressHandleList = HandleList<AddressId>;
+
+inline uint32_t handleId(const blocksci::Transaction &tx) {
+    return tx.txNum;
+}
+
+inline blocksci::InputPointer handleId(const blocksci::Input &input) {
+    return {input.txIndex(), static_cast<uint16_t>(input.inputIndex())};
+}
+
+inline blocksci::OutputPointer handleId(const blocksci::Output &output) {
+    return output.pointer;
+}
+
+// Collects the identifiers of the objects in a range without creating any Python objects
+template <typename Range>
+auto collectHandles(Range &range) {
+    using value_type = std::decay_t<decltype(*std::declval<Range &>().begin())>;
+    HandleList<decltype(handleId(std::declval<const value_type &>()))> list;
+    pybind11::gil_scoped_release release;
+    for (auto &&item : range) {
+        list.access = &item.getAccess();
+        list.ids.push_back(handleId(item));
+    }
+    return list;
+}
+
+template <typename Class>
+void addHandlesProperty(Class &cl) {
+    using Range = typename Class::type;
+    cl.def_property_readonly("handles", [](Range &range) { return collectHandles(range); },
+    "Returns a compact list of handles to the objects in the range, which store only their identifiers. Fields can be read for the whole list at once as numpy arrays, and handles only build their objects when accessed");
+}
+
+#endif /* handles_py_hpp */
@@ -8,6 +8,7 @@
 #include "input_range_py.hpp"
 #include "ranges_py.hpp"
 #include "caster_py.hpp"
+#include "chain/handles_py.hpp"
 
 #include <blocksci/chain/input.hpp>
 
@@ -16,4 +17,6 @@ using namespace blocksci;
 
 void addInputRangeMethods(RangeClasses<Input> &classes) {
     addRangeMethods(classes);
+    addHandlesProperty(classes.iterator);
+    addHandlesProperty(classes.range);
 }
\ No newline at end of file
@@ -0,0 +1,47 @@
+//
+//  miner_tagger_py.cpp
+//  blocksci
+//
+
+#include "caster_py.hpp"
+#include "column_conversion_py.hpp"
+
+#include <blocksci/address/address.hpp>
+#include <blocksci/chain/block.hpp>
+#include <blocksci/chain/miner_tagger.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace py = pybind11;
+
+using namespace blocksci;
+
+void init_miner_tagger(py::module &m) {
+    py::class_<MinerTagger>(m, "MinerTagger", "Labels blocks with their miners by matching coinbase tags with an Aho-Corasick automaton and looking up the addresses coinbase transactions pay")
+    .def(py::init<const MinerTagger::TagList &, const std::vector<std::pair<Address, std::string>> &, const MinerTagger::TagList &>(),
+        py::arg("coinbase_tags"), py::arg("payout_addresses"), py::arg("fallback_tags") = MinerTagger::TagList{},
+        "Create a tagger from lists of (tag, miner name) and (address, miner name) pairs. A block is labeled by the coinbase tag starting earliest in its coinbase, then by the first coinbase output paying a payout address, then by the first fallback tag its coinbase contains")
+    .def_property_readonly("labels", &MinerTagger::labels, "Miner names indexed by label, where label 0 is Unknown")
+    .def("label", [](const MinerTagger &tagger, const Block &block) {
+        return tagger.labels()[tagger.label(block)];
+    }, py::arg("block"), "Return the name of the miner of the block")
+    .def("label_blocks", [](const MinerTagger &tagger, Blockchain &chain, BlockHeight start, BlockHeight end) {
+        std::vector<uint32_t> blockLabels;
+        {
+            py::gil_scoped_release release;
+            blockLabels = tagger.labelBlocks(chain, resolveHeight(chain, start), resolveHeight(chain, end));
+        }
+        return columnToArray(std::move(blockLabels));
+    }, py::arg("chain"), py::arg("start") = 0, py::arg("end") = -1, "Return a numpy array of the label of every block in [start, end), computed in parallel")
+    .def("update_side_file", [](const MinerTagger &tagger, Blockchain &chain, const std::string &path) {
+        std::vector<uint32_t> blockLabels;
+        {
+            py::gil_scoped_release release;
+            blockLabels = tagger.updateSideFile(chain, path);
+        }
+        return columnToArray(std::move(blockLabels));
+    }, py::arg("chain"), py::arg("path"), "Return a numpy array of the label of every block in the chain, cached in the file at path. Only blocks added since the last update (or replaced by a reorg) are labeled")
+    ;
+}
@@ -8,10 +8,13 @@
 #include "output_range_py.hpp"
 #include "ranges_py.hpp"
 #include "caster_py.hpp"
+#include "chain/handles_py.hpp"
 
 namespace py = pybind11;
 using namespace blocksci;
 
 void addOutputRangeMethods(RangeClasses<Output> &classes) {
     addRangeMethods(classes);
+    addHandlesProperty(classes.iterator);
+    addHandlesProperty(classes.range);
 }
\ No newline at end of file
@@ -8,10 +8,16 @@
 #include "tx_range_py.hpp"
 #include "ranges_py.hpp"
 #include "caster_py.hpp"
+#include "chain/handles_py.hpp"
 
 namespace py = pybind11;
 using namespace blocksci;
 
 void addTxRangeMethods(RangeClasses<Transaction> &classes) {
     addRangeMethods(classes);
+    addHandlesProperty(classes.iterator);
+    addHandlesProperty(classes.range);
+    auto getHash = [](const Transaction &tx) { return tx.getHash(); };
+    addHashesMethod(classes.iterator, getHash);
+    addHashesMethod(classes.range, getHash);
 }
\ No newline at end of file
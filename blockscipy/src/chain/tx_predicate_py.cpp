@@ -0,0 +1,126 @@
+//
+//  tx_predicate_py.cpp
+//  blocksci
+//
+//
+
+#include "caster_py.hpp"
+
+#include <blocksci/chain/blockchain.hpp>
+#include <blocksci/chain/input.hpp>
+#include <blocksci/chain/output.hpp>
+#include <blocksci/chain/transaction.hpp>
+#include <blocksci/chain/tx_predicate.hpp>
+
+namespace py = pybind11;
+
+using namespace blocksci;
+
+namespace {
+    // Python side placeholders for a field, turned into predicates by comparing them against a value
+    struct TxFieldExpr {
+        TxField field;
+    };
+
+    struct InoutFieldExpr {
+        InoutField field;
+    };
+
+    struct InoutCountExpr {
+        InoutPredicate predicate;
+        bool inputs;
+
+        TxPredicate compare(Comparison comparison, int64_t value) const {
+            if (inputs) {
+                return TxPredicate::countInputs(predicate, comparison, value);
+            } else {
+                return TxPredicate::countOutputs(predicate, comparison, value);
+            }
+        }
+    };
+
+    template <typename Class, typename Func>
+    void addComparisons(Class &cl, Func func) {
+        cl
+        .def("__eq__", [=](const typename Class::type &expr, int64_t value) { return func(expr, Comparison::Equal, value); })
+        .def("__ne__", [=](const typename Class::type &expr, int64_t value) { return func(expr, Comparison::NotEqual, value); })
+        .def("__lt__", [=](const typename Class::type &expr, int64_t value) { return func(expr, Comparison::Less, value); })
+        .def("__le__", [=](const typename Class::type &expr, int64_t value) { return func(expr, Comparison::LessEqual, value); })
+        .def("__gt__", [=](const typename Class::type &expr, int64_t value) { return func(expr, Comparison::Greater, value); })
+        .def("__ge__", [=](const typename Class::type &expr, int64_t value) { return func(expr, Comparison::GreaterEqual, value); })
+        ;
+    }
+}
+
+void init_tx_predicate(py::module &m) {
+    auto s = m.def_submodule("predicate", "Predicates over transactions which are evaluated natively without compiling any code. Combine them with &, | and ~ and pass them to Blockchain.filter_txes");
+
+    py::class_<InoutPredicate>(s, "InoutPredicate", "A test applied to a single input or output")
+    .def("__and__", &InoutPredicate::operator&&, py::arg("other"), "Return a predicate matching inouts that match both predicates")
+    .def("__or__", &InoutPredicate::operator||, py::arg("other"), "Return a predicate matching inouts that match either predicate")
+    .def("__invert__", &InoutPredicate::operator!, "Return a predicate matching inouts that don't match this predicate")
+    .def("__call__", py::overload_cast<const Input &>(&InoutPredicate::operator(), py::const_), py::arg("input"), "Test the given input")
+    .def("__call__", py::overload_cast<const Output &>(&InoutPredicate::operator(), py::const_), py::arg("output"), "Test the given output")
+    .def("__repr__", &InoutPredicate::toString)
+    ;
+
+    py::class_<TxPredicate>(s, "TxPredicate", "A test applied to a transaction")
+    .def("__and__", &TxPredicate::operator&&, py::arg("other"), "Return a predicate matching transactions that match both predicates")
+    .def("__or__", &TxPredicate::operator||, py::arg("other"), "Return a predicate matching transactions that match either predicate")
+    .def("__invert__", &TxPredicate::operator!, "Return a predicate matching transactions that don't match this predicate")
+    .def("__call__", &TxPredicate::operator(), py::arg("tx"), "Test the given transaction")
+    .def("__repr__", &TxPredicate::toString)
+    ;
+
+    py::class_<TxFieldExpr> txFieldCl(s, "TxField", "A transaction field which produces a TxPredicate when compared with an integer");
+    addComparisons(txFieldCl, [](const TxFieldExpr &expr, Comparison comparison, int64_t value) {
+        return TxPredicate::compare(expr.field, comparison, value);
+    });
+
+    py::class_<InoutFieldExpr> inoutFieldCl(s, "InoutField", "An input or output field which produces an InoutPredicate when compared with an integer");
+    inoutFieldCl
+    .def("__eq__", [](const InoutFieldExpr &expr, AddressType::Enum type) {
+        return InoutPredicate::compare(expr.field, Comparison::Equal, static_cast<int64_t>(type));
+    })
+    .def("__ne__", [](const InoutFieldExpr &expr, AddressType::Enum type) {
+        return InoutPredicate::compare(expr.field, Comparison::NotEqual, static_cast<int64_t>(type));
+    })
+    ;
+    addComparisons(inoutFieldCl, [](const InoutFieldExpr &expr, Comparison comparison, int64_t value) {
+        return InoutPredicate::compare(expr.field, comparison, value);
+    });
+
+    py::class_<InoutCountExpr> countCl(s, "InoutCount", "The number of inputs or outputs matching a predicate, which produces a TxPredicate when compared with an integer");
+    addComparisons(countCl, [](const InoutCountExpr &expr, Comparison comparison, int64_t value) {
+        return expr.compare(comparison, value);
+    });
+
+    s.attr("index") = TxFieldExpr{TxField::Index};
+    s.attr("block_height") = TxFieldExpr{TxField::BlockHeight};
+    s.attr("input_count") = TxFieldExpr{TxField::InputCount};
+    s.attr("output_count") = TxFieldExpr{TxField::OutputCount};
+    s.attr("size_bytes") = TxFieldExpr{TxField::Size};
+    s.attr("total_size") = TxFieldExpr{TxField::TotalSize};
+    s.attr("base_size") = TxFieldExpr{TxField::BaseSize};
+    s.attr("weight") = TxFieldExpr{TxField::Weight};
+    s.attr("locktime") = TxFieldExpr{TxField::Locktime};
+    s.attr("input_value") = TxFieldExpr{TxField::InputValue};
+    s.attr("output_value") = TxFieldExpr{TxField::OutputValue};
+    s.attr("fee") = TxFieldExpr{TxField::Fee};
+
+    s.attr("value") = InoutFieldExpr{InoutField::Value};
+    s.attr("address_type") = InoutFieldExpr{InoutField::AddressType};
+    s.attr("address_num") = InoutFieldExpr{InoutField::AddressNum};
+    s.attr("linked_tx_index") = InoutFieldExpr{InoutField::LinkedTxIndex};
+    s.attr("age") = InoutFieldExpr{InoutField::Age};
+
+    s
+    .def("constant", &TxPredicate::constant, py::arg("value"), "Return a predicate which always returns value")
+    .def("any_input", &TxPredicate::anyInput, py::arg("predicate"), "Return a predicate matching transactions with at least one input matching the given predicate")
+    .def("all_inputs", &TxPredicate::allInputs, py::arg("predicate"), "Return a predicate matching transactions whose inputs all match the given predicate")
+    .def("any_output", &TxPredicate::anyOutput, py::arg("predicate"), "Return a predicate matching transactions with at least one output matching the given predicate")
+    .def("all_outputs", &TxPredicate::allOutputs, py::arg("predicate"), "Return a predicate matching transactions whose outputs all match the given predicate")
+    .def("count_inputs", [](const InoutPredicate &predicate) { return InoutCountExpr{predicate, true}; }, py::arg("predicate"), "Return the number of inputs matching the given predicate for use in a comparison")
+    .def("count_outputs", [](const InoutPredicate &predicate) { return InoutCountExpr{predicate, false}; }, py::arg("predicate"), "Return the number of outputs matching the given predicate for use in a comparison")
+    ;
+}
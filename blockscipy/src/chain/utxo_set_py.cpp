@@ -0,0 +1,43 @@
+//
+//  utxo_set_py.cpp
+//  blocksci
+//
+
+#include "caster_py.hpp"
+#include "column_conversion_py.hpp"
+
+#include <blocksci/chain/utxo_set.hpp>
+
+#include <cstdint>
+
+namespace py = pybind11;
+
+using namespace blocksci;
+
+void init_utxo_set(py::module &m) {
+    py::class_<UtxoSet>(m, "UtxoSet", "Columnar snapshot of the outputs that were unspent at a given height, ordered by output pointer")
+    .def_static("load", &UtxoSet::load, py::arg("path"), "Load a UTXO set saved with UtxoSet.save")
+    .def("save", &UtxoSet::save, py::arg("path"), py::arg("overwrite") = false, "Save the UTXO set to a columnar file")
+    .def("derive", [](const UtxoSet &set, Blockchain &chain, BlockHeight height) {
+        py::gil_scoped_release release;
+        return set.derive(chain, height);
+    }, py::arg("chain"), py::arg("height"), "Return the UTXO set at another height, computed by scanning only the blocks between the two heights")
+    .def("matches", &UtxoSet::matches, py::arg("chain"), "Whether the set is consistent with the given chain, ie. the chain hasn't reorganized below its height")
+    .def("__len__", &UtxoSet::size)
+    .def_property_readonly("height", &UtxoSet::height, "Number of blocks the set was computed over")
+    .def_property_readonly("total_value", &UtxoSet::totalValue, "Total value of the unspent outputs")
+    .def_property_readonly("tx_index", [](const UtxoSet &set) { return columnToArray(set.txNums); }, "Numpy array of the index of the transaction that created each output")
+    .def_property_readonly("output_index", [](const UtxoSet &set) { return columnToArray(set.outputNums); }, "Numpy array of the index of each output within its transaction")
+    .def_property_readonly("value", [](const UtxoSet &set) { return columnToArray(set.values); }, "Numpy array of the value of each output")
+    .def_property_readonly("address_num", [](const UtxoSet &set) { return columnToArray(set.addressNums); }, "Numpy array of the address number of each output")
+    .def_property_readonly("address_type", [](const UtxoSet &set) {
+        py::array_t<uint8_t> ret{set.types.size()};
+        auto data = ret.mutable_data();
+        for (size_t i = 0; i < set.types.size(); i++) {
+            data[i] = static_cast<uint8_t>(set.types[i]);
+        }
+        return ret;
+    }, "Numpy array of the address type of each output")
+    .def_property_readonly("block_height", [](const UtxoSet &set) { return columnToArray(set.heights); }, "Numpy array of the height of the block that created each output")
+    ;
+}
@@ -52,6 +52,10 @@ using namespace blocksci;
 void init_blockchain(py::module &m);
 void init_ranges(py::module &m);
 void init_heuristics(py::module &m);
+void init_tx_predicate(py::module &m);
+void init_utxo_set(py::module &m);
+void init_miner_tagger(py::module &m);
+void init_handles(py::module &m);
 
 PYBIND11_MODULE(_blocksci, m) {
     m.attr("__name__") = PYBIND11_STR_TYPE("blocksci");
@@ -101,7 +105,11 @@ PYBIND11_MODULE(_blocksci, m) {
 
     init_address_type(m);
     init_heuristics(m);
+    init_tx_predicate(m);
     init_data_access(m);
+    init_utxo_set(m);
+    init_miner_tagger(m);
+    init_handles(m);
     init_blockchain(blockchainCl);
     init_uint160(uint160Cl);
     init_uint256(uint256Cl);
@@ -61,6 +61,9 @@ struct ApplyMethodToRange<Range, Traits, F, std::index_sequence<Is...>> {
     using return_type = wrapped_range_method_t<Range, result_type>;
     F func;
 
+    // Conversion evaluates the method on every item after releasing the GIL unless its results are Python objects
+    static_assert(holdsPythonObjects<result_type>() || (!holdsPythonObjects<std::tuple_element_t<Is + 1, typename Traits::arg_tuple>>() && ...), "Range methods returning native values can't take Python objects as arguments");
+
     ApplyMethodToRange(F func_) : func(std::move(func_)) {}
 
     wrapped_range_method_t<Range, result_type> operator()(Range &t, const std::tuple_element_t<Is + 1, typename Traits::arg_tuple> &... args) const {
@@ -12,10 +12,13 @@
 #include <blocksci/address/equiv_address.hpp>
 #include <blocksci/scripts/script_variant.hpp>
 #include <blocksci/cluster/cluster.hpp>
+#include <blocksci/util/thread_pool.hpp>
 
 #include <pybind11/pybind11.h>
 
 #include <chrono>
+#include <cstring>
+#include <memory>
 
 using namespace blocksci;
 namespace py = pybind11;
@@ -56,9 +59,99 @@ typename NumpyConverter<blocksci::uint160>::type NumpyConverter<blocksci::uint16
     return ret;
 }
 
+namespace {
+    // Elements converted by each parallel task, enough to amortize copying the type erased iterator
+    constexpr size_t conversionChunkSize = 1 << 14;
+
+    template <size_t N>
+    struct NumpyBinaryHashConverter {
+        using type = std::array<char, N>;
+
+        template <typename Hash>
+        type operator()(const Hash &val) {
+            static_assert(sizeof(Hash) == N, "Hash size must match the numpy item size");
+            type ret;
+            std::memcpy(ret.data(), val.begin(), N);
+            return ret;
+        }
+    };
+
+    template <typename T>
+    struct IdentityConverter {
+        using type = T;
+
+        type operator()(const T &val) {
+            return val;
+        }
+    };
+
+    // Converts the elements of a random access range into out in parallel chunks without holding the GIL
+    template <typename T, typename Converter>
+    void convertRangeParallel(T && t, Converter converter, typename Converter::type *out) {
+        auto rangeSize = static_cast<size_t>(ranges::size(t));
+        pybind11::gil_scoped_release release;
+        auto first = ranges::begin(t);
+        ThreadPool::instance().parallelFor((rangeSize + conversionChunkSize - 1) / conversionChunkSize, [&](size_t chunk) {
+            auto convert = converter;
+            auto start = chunk * conversionChunkSize;
+            auto end = std::min(rangeSize, start + conversionChunkSize);
+            auto it = first + static_cast<ranges::range_difference_type_t<T>>(start);
+            for (auto i = start; i < end; ++i, ++it) {
+                out[i] = convert(*it);
+            }
+        });
+    }
+
+    // Converts the elements of any range into a vector without holding the GIL, preserving their order
+    template <typename T, typename Converter>
+    std::vector<typename Converter::type> collectRange(T && t, Converter converter) {
+        std::vector<typename Converter::type> values;
+        if constexpr (ranges::RandomAccessRange<T>() && ranges::SizedRange<T>()) {
+            values.resize(static_cast<size_t>(ranges::size(t)));
+            convertRangeParallel(std::forward<T>(t), converter, values.data());
+        } else {
+            pybind11::gil_scoped_release release;
+            RANGES_FOR(auto && a, t) {
+                values.push_back(converter(std::forward<decltype(a)>(a)));
+            }
+        }
+        return values;
+    }
+
+    /* Converts every element of the range into a new numpy array. Random access ranges are converted directly into
+     * the preallocated array, while other ranges are collected into a vector which the array then takes ownership of */
+    template <typename T, typename Converter>
+    pybind11::array_t<typename Converter::type> fillNumpyArray(T && t, Converter converter) {
+        using numpy_value_type = typename Converter::type;
+        if constexpr (ranges::RandomAccessRange<T>() && ranges::SizedRange<T>()) {
+            pybind11::array_t<numpy_value_type> ret{static_cast<size_t>(ranges::size(t))};
+            convertRangeParallel(std::forward<T>(t), converter, ret.mutable_data());
+            return ret;
+        } else {
+            auto values = std::make_unique<std::vector<numpy_value_type>>(collectRange(std::forward<T>(t), converter));
+            auto size = values->size();
+            auto data = values->data();
+            pybind11::capsule owner{values.get(), [](void *ptr) {
+                delete reinterpret_cast<std::vector<numpy_value_type> *>(ptr);
+            }};
+            values.release();
+            return pybind11::array_t<numpy_value_type>{size, data, owner};
+        }
+    }
+}
+
 template <typename T>
 pybind11::list convertRangeToPythonPy(T && t) {
-    if constexpr (ranges::SizedRange<T>()) {
+    using value_type = ranges::range_value_type_t<T>;
+    if constexpr (!holdsPythonObjects<value_type>()) {
+        // Only the creation of the Python objects needs the GIL, the range itself is evaluated natively
+        auto values = collectRange(std::forward<T>(t), IdentityConverter<value_type>{});
+        pybind11::list list{values.size()};
+        for (size_t i = 0; i < values.size(); i++) {
+            list[i] = pybind11::cast(std::move(values[i]));
+        }
+        return list;
+    } else if constexpr (ranges::SizedRange<T>()) {
         auto rangeSize = static_cast<size_t>(ranges::size(t));
         pybind11::list list{rangeSize};
         RANGES_FOR(auto && a, t) {
@@ -75,23 +168,25 @@ pybind11::list convertRangeToPythonPy(T && t) {
 }
 
 template <typename T>
-pybind11::array_t<typename NumpyConverter<ranges::range_value_type_t<T>>::type> convertRangeToPythonNumpy(T && t) {
-    using numpy_converter = NumpyConverter<ranges::range_value_type_t<T>>;
-    using numpy_value_type = typename numpy_converter::type;
-
-    auto numpy_converted = std::forward<T>(t) | ranges::view::transform(numpy_converter{});
-    if constexpr (ranges::SizedRange<T>()) {
-        auto rangeSize = static_cast<size_t>(ranges::size(numpy_converted));
-        pybind11::array_t<numpy_value_type> ret{rangeSize};
-        auto retPtr = ret.mutable_data();
-        ranges::copy(numpy_converted, retPtr);
-        return ret;
-    } else {
-        auto ret = numpy_converted | ranges::to_vector;
-        return pybind11::array_t<numpy_value_type>{ret.size(), ret.data()};
-    }
+converted_range_impl_t<T> convertRangeToPythonNumpy(T && t) {
+    using value_type = ranges::range_value_type_t<T>;
+    return fillNumpyArray(std::forward<T>(t), NumpyConverter<value_type>{});
+}
+
+template <typename T>
+pybind11::array convertAnyHashRangeToBinary(T && t) {
+    using value_type = ranges::range_value_type_t<T>;
+    auto hashes = fillNumpyArray(std::forward<T>(t), NumpyBinaryHashConverter<sizeof(value_type)>{});
+    // Viewed as void rather than bytes since numpy strips trailing zero bytes from the items of bytes arrays
+    auto voidType = pybind11::dtype("V" + std::to_string(sizeof(value_type)));
+    return pybind11::reinterpret_borrow<pybind11::array>(hashes.attr("view")(voidType));
 }
 
+template pybind11::array convertAnyHashRangeToBinary(ranges::any_view<uint256> &&);
+template pybind11::array convertAnyHashRangeToBinary(ranges::any_view<uint256, ranges::category::random_access | ranges::category::sized> &&);
+template pybind11::array convertAnyHashRangeToBinary(ranges::any_view<uint160> &&);
+template pybind11::array convertAnyHashRangeToBinary(ranges::any_view<uint160, ranges::category::random_access | ranges::category::sized> &&);
+
 template <typename T>
 converted_range_impl_t<T> convertRangeToPythonBlockSci(T && t) {
     return {std::forward<T>(t) | ranges::view::transform([](auto && x) { return BlockSciTypeConverter{}(std::forward<decltype(x)>(x)); })};
@@ -172,6 +172,29 @@ struct is_optional : std::false_type {};
 template <typename T>
 struct is_optional<ranges::optional<T>> : std::true_type {};
 
+template <typename T>
+struct is_pair : std::false_type {};
+
+template <typename A, typename B>
+struct is_pair<std::pair<A, B>> : std::true_type {};
+
+// Values which are or contain Python objects can only be created or used while holding the GIL
+template <typename T>
+constexpr bool holdsPythonObjects() {
+    using type = std::decay_t<T>;
+    if constexpr (std::is_base_of_v<pybind11::handle, type>) {
+        return true;
+    } else if constexpr (is_optional<type>::value) {
+        return holdsPythonObjects<typename type::value_type>();
+    } else if constexpr (is_pair<type>::value) {
+        return holdsPythonObjects<typename type::first_type>() || holdsPythonObjects<typename type::second_type>();
+    } else if constexpr (ranges::Range<type>()) {
+        return holdsPythonObjects<ranges::range_value_type_t<type>>();
+    } else {
+        return false;
+    }
+}
+
 // If type is already optional, do nothing. Otherwise make it optional
 template <typename T>
 struct make_optional { using type = ranges::optional<T>; };
@@ -334,4 +357,15 @@ converted_range_t<T> convertRangeToPython(T && t) {
     }
 }
 
+template <typename T>
+pybind11::array convertAnyHashRangeToBinary(T && t);
+
+/* Converts a range of hashes to a numpy array of their raw bytes in internal byte order instead of hex strings, which
+ * is much faster and can be passed back to the batched hash lookups. The hex string of a binary hash h is
+ * bytes(h)[::-1].hex() */
+template <typename T>
+pybind11::array convertHashRangeToBinary(T && t) {
+    return convertAnyHashRangeToBinary(convertToGeneric(std::forward<T>(t)));
+}
+
 #endif /* range_conversion_h */
@@ -65,7 +65,16 @@ struct ApplyRangeMethodToRange<Range, Traits, F, std::index_sequence<Is...>> {
     ApplyRangeMethodToRange(F func_) : func(std::move(func_)) {}
 
     return_type operator()(Range &t, const std::tuple_element_t<Is + 1, typename Traits::arg_tuple> &... args) const {
-        return converter{}(std::invoke(func, t, args...));
+        if constexpr (holdsPythonObjects<result_type>() || (holdsPythonObjects<std::tuple_element_t<Is + 1, typename Traits::arg_tuple>>() || ...)) {
+            return converter{}(std::invoke(func, t, args...));
+        } else {
+            // Native methods such as filters may do a lot of work up front, so they run without the GIL
+            decltype(auto) result = [&]() -> result_type {
+                pybind11::gil_scoped_release release;
+                return std::invoke(func, t, args...);
+            }();
+            return converter{}(std::forward<result_type>(result));
+        }
     }
 };
 
@@ -11,6 +11,7 @@
 #include "python_fwd.hpp"
 #include "range_conversion.hpp"
 #include "blocksci_range.hpp"
+#include "batch_iterator_py.hpp"
 
 #include <pybind11/functional.h>
 
@@ -45,8 +46,12 @@ auto addRangeMethods(Class &cl) {
 
     cl
     .def("__iter__", [](Range &range) { 
-        return pybind11::make_iterator(range.begin(), range.end()); 
+        return iterateBatched(range); 
     }, pybind11::keep_alive<0, 1>())
+    .def("batches", [](Range &range, size_t batchSize) {
+        return iterateBatches(range, batchSize);
+    }, pybind11::arg("batch_size") = defaultIterationBatchSize, pybind11::keep_alive<0, 1>(),
+    "Returns an iterator over lists of up to batch_size objects from the range, the next of which is read in the background")
     .def_property_readonly("all", [](Range & range) { 
         return pythonAllType(range);
     }, "Returns a list of all of the objects in the range")
@@ -130,6 +135,20 @@ auto addRangeMethods(Class &cl) {
     return cl;
 }
 
+// Properties can't take arguments, so the choice of hash representation is offered as a method next to the hash property
+template <typename Class, typename F>
+void addHashesMethod(Class &cl, F getHash) {
+    using Range = typename Class::type;
+    cl.def("hashes", [getHash](Range &range, bool binary) -> pybind11::array {
+        auto hashes = range | ranges::view::transform(getHash);
+        if (binary) {
+            return convertHashRangeToBinary(hashes);
+        }
+        return convertRangeToPython(hashes);
+    }, pybind11::arg("binary") = false,
+    "Return a numpy array of the hash of each item as a hex string, or as raw bytes in internal byte order if binary is set, which is much faster and can be passed back to the batched hash lookups. The hex string of a binary hash h is bytes(h)[::-1].hex()");
+}
+
 template <typename T>
 void addRangeMethods(RangeClasses<T> &cls) {
     addRangeMethods(cls.iterator);
@@ -0,0 +1,41 @@
+"""
+Smoke tests of gathering columns from Python, run against the data directory in BLOCKSCI_TEST_DATA
+"""
+
+import os
+import unittest
+
+import numpy as np
+
+import blocksci
+
+DATA_DIRECTORY = os.environ.get("BLOCKSCI_TEST_DATA")
+
+
+@unittest.skipIf(DATA_DIRECTORY is None, "BLOCKSCI_TEST_DATA is not set")
+class GatherTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.chain = blocksci.Blockchain(DATA_DIRECTORY)
+        cls.end = min(len(cls.chain), 2000)
+        cls.columns = cls.chain.tx_columns(["index", "fee", "output_count"], 0, cls.end)
+
+    def test_order_and_duplicates(self):
+        tx_count = len(self.columns["index"])
+        indexes = np.random.RandomState(1).randint(0, tx_count, 5000).astype(np.uint32)
+        indexes[-10:] = indexes[0]
+        gathered = self.chain.gather_tx_columns(indexes, ["index", "fee", "output_count"])
+        for name, column in gathered.items():
+            self.assertTrue(np.array_equal(column, self.columns[name][indexes]))
+
+    def test_out_of_range_raises_index_error(self):
+        indexes = np.arange(5000, dtype=np.uint32) % len(self.columns["index"])
+        indexes[-1] = np.iinfo(np.uint32).max
+        with self.assertRaises(IndexError):
+            self.chain.gather_tx_columns(indexes, ["fee"])
+        with self.assertRaises(IndexError):
+            self.chain.gather_output_columns(indexes[-1:], np.zeros(1, dtype=np.uint16), ["value"])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,61 @@
+"""
+Smoke tests of iterating over ranges from Python, run against the data directory in BLOCKSCI_TEST_DATA:
+
+    BLOCKSCI_TEST_DATA=/path/to/data python -m unittest discover blockscipy/tests
+"""
+
+import gc
+import os
+import unittest
+import weakref
+
+import blocksci
+
+DATA_DIRECTORY = os.environ.get("BLOCKSCI_TEST_DATA")
+
+
+@unittest.skipIf(DATA_DIRECTORY is None, "BLOCKSCI_TEST_DATA is not set")
+class IterationTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.chain = blocksci.Blockchain(DATA_DIRECTORY)
+        cls.end = min(len(cls.chain), 2000)
+
+    def test_iterators_are_weakly_referenceable(self):
+        for iterable in [self.chain, self.chain[:self.end], self.chain[self.end - 1].txes]:
+            it = iter(iterable)
+            ref = weakref.ref(it)
+            self.assertIs(iter(it), it)
+            next(it)
+            del it
+            gc.collect()
+            self.assertIsNone(ref())
+
+    def test_blocks_in_order(self):
+        heights = [block.height for block in self.chain[:self.end]]
+        self.assertEqual(heights, list(range(self.end)))
+        self.assertEqual(sum(1 for _ in self.chain), len(self.chain))
+
+    def test_iteration_matches_indexing(self):
+        block = self.chain[self.end - 1]
+        self.assertEqual([tx.index for tx in block.txes], [block.txes[i].index for i in range(len(block.txes))])
+        tx = block.txes[0]
+        self.assertEqual([out.value for out in tx.outs], [tx.outs[i].value for i in range(len(tx.outs))])
+
+    def test_iterator_outlives_range(self):
+        it = iter(self.chain[:self.end])
+        gc.collect()
+        self.assertEqual(sum(1 for _ in it), self.end)
+
+    def test_batches(self):
+        batches = list(self.chain[:self.end].batches(batch_size=100))
+        self.assertTrue(all(0 < len(batch) <= 100 for batch in batches))
+        self.assertEqual([block.height for batch in batches for block in batch], list(range(self.end)))
+
+    def test_empty_range(self):
+        self.assertEqual(list(self.chain[:0]), [])
+        self.assertEqual(list(self.chain[:0].batches()), [])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -20,6 +20,7 @@
 #include <range/v3/view/any_view.hpp>
 
 #include <functional>
+#include <utility>
 #include <vector>
 
 namespace blocksci {
@@ -65,10 +66,16 @@ namespace blocksci {
         
         ScriptBase getBaseScript() const;
         
+        // Served from the script hot columns when available, avoiding a read of the full script record
+        uint32_t getFirstTxIndex() const;
+        ranges::optional<uint32_t> getTxRevealedIndex() const;
+        
         EquivAddress getEquivAddresses(bool nestedEquivalent) const;
         
         ranges::any_view<OutputPointer> getOutputPointers() const;
         int64_t calculateBalance(BlockHeight height);
+        // Height and resulting balance of each block that changed the balance, for the blocks covered by the balance index
+        std::vector<std::pair<BlockHeight, int64_t>> getBalanceHistory() const;
         ranges::any_view<Output> getOutputs();
         std::vector<Input> getInputs();
         std::vector<Transaction> getTransactions();
@@ -10,13 +10,19 @@
 #define chain_h
 
 #include <blocksci/chain/algorithms.hpp>
+#include <blocksci/chain/arrow_export.hpp>
 #include <blocksci/chain/block.hpp>
+#include <blocksci/chain/block_time_index.hpp>
 #include <blocksci/chain/blockchain.hpp>
+#include <blocksci/chain/chain_columns.hpp>
 #include <blocksci/chain/inout_pointer.hpp>
 #include <blocksci/chain/input.hpp>
+#include <blocksci/chain/miner_tagger.hpp>
 #include <blocksci/chain/output.hpp>
 #include <blocksci/chain/transaction.hpp>
 #include <blocksci/chain/transaction_range.hpp>
 #include <blocksci/chain/transaction_summary.hpp>
+#include <blocksci/chain/tx_predicate.hpp>
+#include <blocksci/chain/utxo_set.hpp>
 
 #endif /* chain_h */
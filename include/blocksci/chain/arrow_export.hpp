@@ -0,0 +1,39 @@
+//
+//  arrow_export.hpp
+//  blocksci
+//
+
+#ifndef arrow_export_hpp
+#define arrow_export_hpp
+
+#include "chain_fwd.hpp"
+
+#include <blocksci/blocksci_export.h>
+#include <blocksci/typedefs.hpp>
+
+#include <string>
+
+namespace blocksci {
+
+    constexpr BlockHeight defaultArrowPartitionBlocks = 10000;
+
+    /* Exports the chain as Arrow IPC (Feather v2) files for Spark, DuckDB and pandas. Each partition of partitionBlocks
+     * blocks gets one file per table at <directory>/<table>/<start>-<end>.arrow, where the tables are
+     *
+     *  - blocks: one row per block, with total_size and base_size in bytes
+     *  - txes: one row per transaction, with the fields of txColumns and its hash
+     *  - inputs: one row per input, with the fields of inputColumns
+     *  - outputs: one row per output, with its value, address type and address number
+     *  - addresses: one row per script first seen in the partition, with its dedup type and number, first seen tx index,
+     *    the address types it has been seen as and its address string if it has one
+     *
+     * The export is incremental. manifest.txt records each exported partition with the hash of its last block, and
+     * a later call only exports blocks past the last complete partition, after dropping partitions that a reorg
+     * replaced. Exported partitions are never rewritten, so the tables leave out what later blocks change: when an
+     * output is spent, which outputColumns gives for the current chain, and when an address is first spent, which is
+     * its earliest row in the inputs. Exports written with an older set of columns are redone from scratch. Returns
+     * the number of blocks the export covers */
+    BlockHeight BLOCKSCI_EXPORT exportArrow(Blockchain &chain, const std::string &directory, BlockHeight partitionBlocks = defaultArrowPartitionBlocks);
+} // namespace blocksci
+
+#endif /* arrow_export_hpp */
@@ -0,0 +1,67 @@
+//
+//  block_time_index.hpp
+//  blocksci
+//
+
+#ifndef block_time_index_hpp
+#define block_time_index_hpp
+
+#include "chain_fwd.hpp"
+
+#include <blocksci/blocksci_export.h>
+#include <blocksci/typedefs.hpp>
+#include <blocksci/core/bitcoin_uint256.hpp>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace blocksci {
+
+    /* Translates between block times and heights in O(log n).
+     *
+     * Header timestamps are only loosely ordered, so they can't be binary searched directly. The index keeps the
+     * running maximum of the timestamps from the start of the chain and the running minimum from the end, which are
+     * both sorted: the first block with timestamp >= t is the first block whose prefix maximum is >= t, and the last
+     * block with timestamp <= t is the last block whose suffix minimum is <= t. It also stores each block's median
+     * time past (the median timestamp of it and its 10 predecessors), which consensus guarantees never decreases. */
+    class BLOCKSCI_EXPORT BlockTimeIndex {
+        std::vector<uint32_t> prefixMaxTimes;
+        std::vector<uint32_t> suffixMinTimes;
+        std::vector<uint32_t> medianTimes;
+        // Hash of the last indexed block, used to detect a reorg on update
+        uint256 lastHash;
+
+        void build(const ChainAccess &chain);
+
+    public:
+        static constexpr int medianTimeSpan = 11;
+
+        explicit BlockTimeIndex(const ChainAccess &chain);
+
+        // Indexes newly loaded blocks, or rebuilds from scratch if the indexed chain is no longer a prefix of it
+        void update(const ChainAccess &chain);
+
+        BlockHeight blockCount() const {
+            return static_cast<BlockHeight>(medianTimes.size());
+        }
+
+        // First block with timestamp >= time, or blockCount() if there is none
+        BlockHeight firstBlockAtOrAfter(uint32_t time) const;
+
+        // Last block with timestamp <= time, or -1 if there is none
+        BlockHeight lastBlockAtOrBefore(uint32_t time) const;
+
+        // First block whose median time past is >= time, or blockCount() if there is none
+        BlockHeight firstBlockWithMedianTimeAtOrAfter(uint32_t time) const;
+
+        // Heights [first, last) from the first block mined at or after startTime to the last mined at or before endTime
+        std::pair<BlockHeight, BlockHeight> heightRange(uint32_t startTime, uint32_t endTime) const;
+
+        uint32_t medianTimePast(BlockHeight height) const {
+            return medianTimes.at(static_cast<size_t>(height));
+        }
+    };
+} // namespace blocksci
+
+#endif /* block_time_index_hpp */
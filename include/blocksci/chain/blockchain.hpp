@@ -12,6 +12,7 @@
 #include "block.hpp"
 
 #include <blocksci/blocksci_export.h>
+#include <blocksci/core/inout_kernels.hpp>
 #include <blocksci/scripts/multisig_script.hpp>
 #include <blocksci/scripts/nonstandard_script.hpp>
 #include <blocksci/scripts/nulldata_script.hpp>
@@ -19,15 +20,17 @@
 #include <blocksci/scripts/multisig_pubkey_script.hpp>
 #include <blocksci/scripts/scripthash_script.hpp>
 #include <blocksci/util/data_access.hpp>
+#include <blocksci/util/thread_pool.hpp>
 
 #include <range/v3/view/any_view.hpp>
 #include <range/v3/range_for.hpp>
 
 #include <mpark/variant.hpp>
 
+#include <chrono>
 #include <map>
 #include <type_traits>
-#include <future>
+#include <utility>
 
 namespace blocksci {
     struct DataConfiguration;
@@ -54,26 +57,8 @@ namespace blocksci {
             static constexpr bool value = decltype(test<F>(nullptr))::value;
         };
         
-        template <typename ResultType, typename It, typename MapFunc, typename ReduceFunc>
-        ResultType mapReduceBlocksImp(It begin, It end, MapFunc mapFunc, ReduceFunc reduceFunc, int segmentBeginNum) {
-            auto segmentCount = static_cast<int>(std::distance(begin, end));
-            if(segmentCount == 1) {
-                ResultType res{};
-                auto ret = mapFunc(*begin, segmentBeginNum);
-                res = reduceFunc(res, ret);
-                return res;
-            } else {
-                auto mid = begin;
-                std::advance(mid, segmentCount / 2);
-                auto handle = std::async(std::launch::async, mapReduceBlocksImp<ResultType, It, MapFunc, ReduceFunc>, begin, mid, mapFunc, reduceFunc, segmentBeginNum);
-                ResultType res{};
-                auto ret2 = mapReduceBlocksImp<ResultType>(mid, end, mapFunc, reduceFunc, segmentBeginNum + segmentCount / 2);
-                auto ret1 = handle.get();
-                res = reduceFunc(res, ret1);
-                res = reduceFunc(res, ret2);
-                return res;
-            }
-        }
+        // Chunks handed to each pool thread, fine enough for work stealing to even out blocks of very different cost
+        static constexpr unsigned int chunksPerThread = 16;
     }
     
     std::vector<std::vector<Block>> BLOCKSCI_EXPORT segmentChain(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock, unsigned int segmentCount);
@@ -182,6 +167,15 @@ namespace blocksci {
             return static_cast<uint32_t>(lastBlockHeight);
         }
         
+        // First block whose header timestamp is at or after time, or size() if there is none
+        BlockHeight heightAtTime(std::chrono::system_clock::time_point time) const;
+        
+        // Heights [first, last) from the first block mined at or after start to the last block mined at or before end
+        std::pair<BlockHeight, BlockHeight> heightRange(std::chrono::system_clock::time_point start, std::chrono::system_clock::time_point end) const;
+        
+        // Median timestamp of the block at height and its 10 predecessors
+        std::chrono::system_clock::time_point medianTimePast(BlockHeight height) const;
+        
         uint32_t addressCount(AddressType::Enum type) const {
             return access.getScripts().scriptCount(dedupType(type));
         }
@@ -199,18 +193,24 @@ namespace blocksci {
             return table.at(index)(*this);
         }
         
+        /* The int passed along with each segment is the segment's index in [0, segment count), where there are at most
+         * threadCount() * chunksPerThread segments. It is not a thread index, so it can't be used to pick per-thread state */
         template <typename ResultType, typename MapFunc, typename ReduceFunc>
         std::enable_if_t<internal::is_callable<MapFunc, std::vector<Block>, int>::value, ResultType>
         mapReduce(BlockHeight start, BlockHeight stop, MapFunc mapFunc, ReduceFunc reduceFunc) {
-            auto segments = segmentChain(*this, start, stop, std::thread::hardware_concurrency());
-            return internal::mapReduceBlocksImp<ResultType>(segments.begin(), segments.end(), mapFunc, reduceFunc, 0);
+            auto segments = segmentChain(*this, start, stop, ThreadPool::instance().threadCount() * internal::chunksPerThread);
+            return parallelMapReduce<ResultType>(segments.size(), [&](size_t segmentNum) {
+                return mapFunc(segments[segmentNum], static_cast<int>(segmentNum));
+            }, reduceFunc);
         }
         
         template <typename ResultType, typename MapFunc, typename ReduceFunc>
         std::enable_if_t<internal::is_callable<MapFunc, std::vector<Block>>::value, ResultType>
         mapReduce(BlockHeight start, BlockHeight stop, MapFunc mapFunc, ReduceFunc reduceFunc) {
-            auto segments = segmentChain(*this, start, stop, std::thread::hardware_concurrency());
-            return internal::mapReduceBlocksImp<ResultType>(segments.begin(), segments.end(), [&](const std::vector<Block> &blocks, int) { return mapFunc(blocks); }, reduceFunc, 0);
+            auto segments = segmentChain(*this, start, stop, ThreadPool::instance().threadCount() * internal::chunksPerThread);
+            return parallelMapReduce<ResultType>(segments.size(), [&](size_t segmentNum) {
+                return mapFunc(segments[segmentNum]);
+            }, reduceFunc);
         }
 
         template <typename ResultType, typename MapFunc, typename ReduceFunc>
@@ -277,6 +277,14 @@ namespace blocksci {
     
     std::map<int64_t, Address> BLOCKSCI_EXPORT mostValuableAddresses(Blockchain &chain);
     
+    // Aggregates over blocks [startBlock, endBlock) computed in parallel with the vectorized kernels in core/inout_kernels.hpp
+    ValueSummary BLOCKSCI_EXPORT outputValueSummary(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock, uint32_t typeMask = kernels::allAddressTypes);
+    ValueSummary BLOCKSCI_EXPORT inputValueSummary(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock, uint32_t typeMask = kernels::allAddressTypes);
+    AddressTypeHistogram BLOCKSCI_EXPORT outputTypeHistogram(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock);
+    AddressTypeHistogram BLOCKSCI_EXPORT inputTypeHistogram(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock);
+    // Fees of the non-coinbase transactions
+    ValueSummary BLOCKSCI_EXPORT feeSummary(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock);
+    
     namespace internal {
         template<AddressType::Enum type>
         ScriptRangeVariant ScriptRangeFunctor<type>::f(Blockchain &chain) {
@@ -19,6 +19,7 @@
 #include <blocksci/typedefs.hpp>
 
 #include <algorithm>
+#include <limits>
 
 namespace blocksci {
     class BLOCKSCI_EXPORT ChainAccess {
@@ -27,15 +28,21 @@ namespace blocksci {
         
         IndexedFileMapper<AccessMode::readonly, RawTransaction> txFile;
         IndexedFileMapper<AccessMode::readonly, uint32_t> sequenceFile;
+        IndexedFileMapper<AccessMode::readonly, uint16_t> spendingInputFile;
         
         FixedSizeFileMapper<uint256> txHashesFile;
         
+        // Height of every 2^txHeightSampleShift-th transaction, written by the parser
+        FixedSizeFileMapper<uint32_t> txHeightFile;
+        
         uint256 lastBlockHash;
         const uint256 *lastBlockHashDisk = nullptr;
         BlockHeight maxHeight = 0;
         uint32_t _maxLoadedTx = 0;
         BlockHeight blocksIgnored = 0;
         bool errorOnReorg = false;
+        // Number of blocks the parser has published as complete
+        uint32_t committedBlockCount = std::numeric_limits<uint32_t>::max();
         
         void reorgCheck() const {
             if (errorOnReorg && lastBlockHash != *lastBlockHashDisk) {
@@ -45,7 +52,28 @@ namespace blocksci {
         
         void setup();
         
+        // Finds the block containing txIndex among the blocks [lowHeight, highHeight)
+        BlockHeight searchBlockHeight(uint32_t txIndex, BlockHeight lowHeight, BlockHeight highHeight) const {
+            auto blockBegin = blockFile[0];
+            auto first = blockBegin + static_cast<int>(lowHeight);
+            auto last = blockBegin + static_cast<int>(highHeight);
+            if (highHeight - lowHeight <= txHeightLinearScanLimit) {
+                while (first + 1 != last && (first + 1)->firstTxIndex <= txIndex) {
+                    ++first;
+                }
+                return static_cast<BlockHeight>(std::distance(blockBegin, first));
+            }
+            auto it = std::upper_bound(first, last, txIndex, [](uint32_t index, const RawBlock &b) {
+                return index < b.firstTxIndex;
+            });
+            it--;
+            return static_cast<BlockHeight>(std::distance(blockBegin, it));
+        }
+        
     public:
+        static constexpr uint32_t txHeightSampleShift = 8;
+        static constexpr BlockHeight txHeightLinearScanLimit = 16;
+        
         explicit ChainAccess(const std::string &baseDirectory, BlockHeight blocksIgnored, bool errorOnReorg);
         
         static std::string txFilePath(const std::string &baseDirectory);
@@ -53,6 +81,8 @@ namespace blocksci {
         static std::string blockFilePath(const std::string &baseDirectory);
         static std::string blockCoinbaseFilePath(const std::string &baseDirectory);
         static std::string sequenceFilePath(const std::string &baseDirectory);
+        static std::string txHeightFilePath(const std::string &baseDirectory);
+        static std::string spendingInputFilePath(const std::string &baseDirectory);
         
         uint32_t maxLoadedTx() const {
             return _maxLoadedTx;
@@ -63,13 +93,18 @@ namespace blocksci {
             if (errorOnReorg && txIndex >= _maxLoadedTx) {
                 throw std::out_of_range("Transaction index out of range");
             }
-            auto blockBegin = blockFile[0];
-            auto blockEnd = blockFile[static_cast<size_t>(static_cast<int>(maxHeight) - 1)] + 1;
-            auto it = std::upper_bound(blockBegin, blockEnd, txIndex, [](uint32_t index, const RawBlock &b) {
-                return index < b.firstTxIndex;
-            });
-            it--;
-            return static_cast<BlockHeight>(std::distance(blockBegin, it));
+            if (txIndex < _maxLoadedTx && txHeightFile.size() > 0) {
+                // Heights are monotonic in txIndex so the sample for txIndex and the one after it bound the search
+                auto lastHeight = maxHeight - 1;
+                auto sample = std::min(static_cast<size_t>(txIndex >> txHeightSampleShift), txHeightFile.size() - 1);
+                auto lowHeight = std::min(static_cast<BlockHeight>(*txHeightFile[sample]), lastHeight);
+                auto highHeight = lastHeight;
+                if (sample + 1 < txHeightFile.size()) {
+                    highHeight = std::min(static_cast<BlockHeight>(*txHeightFile[sample + 1]), lastHeight);
+                }
+                return searchBlockHeight(txIndex, lowHeight, highHeight + 1);
+            }
+            return searchBlockHeight(txIndex, 0, maxHeight);
         }
         
         const RawBlock *getBlock(BlockHeight blockHeight) const {
@@ -90,6 +125,16 @@ namespace blocksci {
             return sequenceFile.getData(index);
         }
         
+        // For each output of the transaction, one more than the index of the input spending it or 0 if that is unknown.
+        // Returns nullptr for transactions parsed before the spending input file existed or not yet published
+        const uint16_t *getSpendingInputNums(uint32_t index) const {
+            if (index < _maxLoadedTx && index < spendingInputFile.size()) {
+                return spendingInputFile.getData(index);
+            } else {
+                return nullptr;
+            }
+        }
+        
         size_t txCount() const {
             return _maxLoadedTx;
         }
@@ -98,6 +143,22 @@ namespace blocksci {
             return maxHeight;
         }
         
+        // Headers of the loaded blocks, indexed by height
+        MappedView blockView() const {
+            reorgCheck();
+            return blockFile.view(0, maxHeight);
+        }
+        
+        // Hashes of the loaded transactions in their internal byte order, indexed by tx index
+        MappedView txHashView() const {
+            reorgCheck();
+            return txHashesFile.view(0, _maxLoadedTx);
+        }
+        
+        /* Serialized transactions [firstTx, endTx), which are stored back to back. Each is a RawTransaction followed by
+         * its inputs and then its outputs, all of which are 16 byte records */
+        MappedView txDataView(uint32_t firstTx, uint32_t endTx) const;
+        
         std::vector<unsigned char> getCoinbase(uint64_t offset) const {
             auto pos = blockCoinbaseFile.getDataAtOffset(offset);
             uint32_t coinbaseLength;
@@ -108,12 +169,19 @@ namespace blocksci {
             return std::vector<unsigned char>(unsignedPos, unsignedPos + length);
         }
         
+        void setCommittedBlockCount(uint32_t blockCount) {
+            committedBlockCount = blockCount;
+            setup();
+        }
+        
         void reload() {
             blockFile.reload();
             blockCoinbaseFile.reload();
             txFile.reload();
             txHashesFile.reload();
             sequenceFile.reload();
+            spendingInputFile.reload();
+            txHeightFile.reload();
             setup();
         }
     };
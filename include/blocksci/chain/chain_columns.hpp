@@ -0,0 +1,54 @@
+//
+//  chain_columns.hpp
+//  blocksci
+//
+
+#ifndef chain_columns_hpp
+#define chain_columns_hpp
+
+#include "chain_fwd.hpp"
+#include "tx_predicate.hpp"
+
+#include <blocksci/blocksci_export.h>
+#include <blocksci/typedefs.hpp>
+#include <blocksci/core/bitcoin_uint256.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace blocksci {
+    class DataAccess;
+
+    // One row per transaction in chain order, with values[i] holding fields[i]
+    struct BLOCKSCI_EXPORT TxColumns {
+        std::vector<TxField> fields;
+        std::vector<std::vector<int64_t>> values;
+        // Only filled when requested
+        std::vector<uint256> hashes;
+    };
+
+    // One row per input or output in chain order, identified by its transaction, position in it and block height
+    struct BLOCKSCI_EXPORT InoutColumns {
+        std::vector<uint32_t> txIndexes;
+        std::vector<uint16_t> indexes;
+        std::vector<BlockHeight> heights;
+        std::vector<InoutField> fields;
+        std::vector<std::vector<int64_t>> values;
+    };
+
+    /* Materialize the requested fields of every transaction, input or output in the blocks [startBlock, endBlock) in a
+     * single parallel pass over the raw transaction data, writing directly into preallocated columns. Fields have the
+     * same definitions as in tx predicates. */
+    TxColumns BLOCKSCI_EXPORT txColumns(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock, const std::vector<TxField> &fields, bool includeHashes = false);
+    InoutColumns BLOCKSCI_EXPORT inputColumns(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock, const std::vector<InoutField> &fields);
+    InoutColumns BLOCKSCI_EXPORT outputColumns(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock, const std::vector<InoutField> &fields);
+
+    /* Gather the requested fields of the transactions, inputs or outputs with the given identifiers, with values[i][j]
+     * holding fields[i] of the j-th identifier. Identifiers are visited in sorted order by parallel workers so lookups
+     * walk the chain files forward, and may repeat. Throw std::out_of_range for identifiers not in the chain. */
+    std::vector<std::vector<int64_t>> BLOCKSCI_EXPORT gatherTxFields(DataAccess &access, const std::vector<uint32_t> &txNums, const std::vector<TxField> &fields);
+    std::vector<std::vector<int64_t>> BLOCKSCI_EXPORT gatherInputFields(DataAccess &access, const std::vector<InputPointer> &pointers, const std::vector<InoutField> &fields);
+    std::vector<std::vector<int64_t>> BLOCKSCI_EXPORT gatherOutputFields(DataAccess &access, const std::vector<OutputPointer> &pointers, const std::vector<InoutField> &fields);
+} // namespace blocksci
+
+#endif /* chain_columns_hpp */
@@ -0,0 +1,89 @@
+//
+//  miner_tagger.hpp
+//  blocksci
+//
+
+#ifndef miner_tagger_hpp
+#define miner_tagger_hpp
+
+#include "chain_fwd.hpp"
+
+#include <blocksci/blocksci_export.h>
+#include <blocksci/typedefs.hpp>
+#include <blocksci/address/address.hpp>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace blocksci {
+
+    /* Attributes blocks to miners by the tags in their coinbase and the addresses their coinbase transaction pays.
+     *
+     * A block is labeled, in order of preference, by the coinbase tag that starts earliest in its coinbase (ties going
+     * to the tag listed first), by the first coinbase output paying a known address, and by the first listed fallback
+     * tag its coinbase contains anywhere. Both kinds of tag are matched in one pass over the coinbase bytes by an
+     * Aho-Corasick automaton. Label 0 is reserved for blocks that match nothing. */
+    class BLOCKSCI_EXPORT MinerTagger {
+    public:
+        using TagList = std::vector<std::pair<std::string, std::string>>;
+
+        static constexpr uint32_t unknownLabel = 0;
+
+        MinerTagger(const TagList &coinbaseTags, const std::vector<std::pair<Address, std::string>> &payoutAddresses, const TagList &fallbackTags);
+
+        // Miner names indexed by label, starting with "Unknown"
+        const std::vector<std::string> &labels() const {
+            return labelNames;
+        }
+
+        // Labels of the best coinbase tag and the best fallback tag found in a coinbase, or unknownLabel where none is
+        struct CoinbaseMatch {
+            uint32_t tagLabel = unknownLabel;
+            uint32_t fallbackLabel = unknownLabel;
+        };
+
+        CoinbaseMatch matchCoinbase(const std::vector<unsigned char> &coinbase) const;
+
+        uint32_t label(const Block &block) const;
+
+        // Labels of the blocks [startBlock, endBlock), computed in parallel
+        std::vector<uint32_t> labelBlocks(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock) const;
+
+        /* Labels of every block in the chain, cached in a side file at path. Only blocks added since the last update are
+         * labeled, after dropping any that a reorg replaced. The file is rebuilt if it was written with different tags */
+        std::vector<uint32_t> updateSideFile(Blockchain &chain, const std::string &path) const;
+
+    private:
+        struct Node {
+            std::unordered_map<unsigned char, uint32_t> next;
+            uint32_t fail = 0;
+            // Closest node on the fail chain, this one included, that completes a pattern, or 0 if there is none
+            uint32_t output = 0;
+            uint32_t pattern = 0;
+        };
+
+        struct Pattern {
+            uint32_t length;
+            uint32_t priority;
+            uint32_t label;
+            bool fallback;
+        };
+
+        std::vector<Node> nodes;
+        std::vector<Pattern> patterns;
+        std::unordered_map<Address, uint32_t> addressLabels;
+        std::vector<std::string> labelNames;
+        // Identifies the configuration in side files so that they are only reused by an identical tagger
+        uint64_t fingerprint;
+
+        uint32_t labelId(const std::string &name);
+        void addPattern(const std::string &tag, uint32_t label, uint32_t priority, bool fallback);
+        void buildLinks();
+        uint32_t transition(uint32_t node, unsigned char c) const;
+    };
+} // namespace blocksci
+
+#endif /* miner_tagger_hpp */
@@ -111,6 +111,8 @@ namespace blocksci {
         }
         
         ranges::optional<Transaction> getSpendingTx() const;
+        ranges::optional<InputPointer> getSpendingInputPointer() const;
+        ranges::optional<Input> getSpendingInput() const;
     };
 
     inline std::ostream &operator<<(std::ostream &os, const Output &output) { 
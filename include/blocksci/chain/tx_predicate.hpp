@@ -0,0 +1,102 @@
+//
+//  tx_predicate.hpp
+//  blocksci
+//
+
+#ifndef tx_predicate_hpp
+#define tx_predicate_hpp
+
+#include "chain_fwd.hpp"
+
+#include <blocksci/blocksci_export.h>
+#include <blocksci/typedefs.hpp>
+#include <blocksci/core/address_types.hpp>
+#include <blocksci/core/core_fwd.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace blocksci {
+
+    enum class TxField {
+        Index, BlockHeight, InputCount, OutputCount, Size, TotalSize, BaseSize, Weight, Locktime, InputValue, OutputValue, Fee
+    };
+
+    /* LinkedTxIndex is the spent transaction for inputs and the spending transaction (0 if unspent) for outputs.
+     * Age is the number of blocks between an output being created and being spent, or -1 for unspent outputs. */
+    enum class InoutField {
+        Value, AddressType, AddressNum, LinkedTxIndex, Age
+    };
+
+    // Names of the fields as used in Python and in printed predicates
+    std::string BLOCKSCI_EXPORT fieldName(TxField field);
+    std::string BLOCKSCI_EXPORT fieldName(InoutField field);
+
+    // Throw std::invalid_argument for unknown names
+    TxField BLOCKSCI_EXPORT txFieldFromName(const std::string &name);
+    InoutField BLOCKSCI_EXPORT inoutFieldFromName(const std::string &name);
+
+    enum class Comparison {
+        Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual
+    };
+
+    namespace internal {
+        struct PredicateNode;
+    }
+
+    /* Predicates over transactions built from comparisons on transaction fields, quantifiers over the inputs and
+     * outputs and boolean combinators. Predicates are evaluated directly against the raw transaction data so a
+     * chain scan never constructs Transaction, Input or Output objects for transactions which don't match, and
+     * aggregate fields shared by several comparisons in one predicate are only computed once per transaction. */
+    class BLOCKSCI_EXPORT InoutPredicate {
+        std::shared_ptr<const internal::PredicateNode> node;
+
+        explicit InoutPredicate(std::shared_ptr<const internal::PredicateNode> node_) : node(std::move(node_)) {}
+        friend class TxPredicate;
+    public:
+        static InoutPredicate constant(bool value);
+        static InoutPredicate compare(InoutField field, Comparison comparison, int64_t value);
+
+        InoutPredicate operator&&(const InoutPredicate &other) const;
+        InoutPredicate operator||(const InoutPredicate &other) const;
+        InoutPredicate operator!() const;
+
+        bool operator()(const Input &input) const;
+        bool operator()(const Output &output) const;
+
+        std::string toString() const;
+    };
+
+    class BLOCKSCI_EXPORT TxPredicate {
+        std::shared_ptr<const internal::PredicateNode> node;
+
+        explicit TxPredicate(std::shared_ptr<const internal::PredicateNode> node_) : node(std::move(node_)) {}
+    public:
+        static TxPredicate constant(bool value);
+        static TxPredicate compare(TxField field, Comparison comparison, int64_t value);
+
+        static TxPredicate anyInput(const InoutPredicate &predicate);
+        static TxPredicate allInputs(const InoutPredicate &predicate);
+        static TxPredicate anyOutput(const InoutPredicate &predicate);
+        static TxPredicate allOutputs(const InoutPredicate &predicate);
+        // Compares the number of inputs or outputs matching predicate against value
+        static TxPredicate countInputs(const InoutPredicate &predicate, Comparison comparison, int64_t value);
+        static TxPredicate countOutputs(const InoutPredicate &predicate, Comparison comparison, int64_t value);
+
+        TxPredicate operator&&(const TxPredicate &other) const;
+        TxPredicate operator||(const TxPredicate &other) const;
+        TxPredicate operator!() const;
+
+        bool operator()(const Transaction &tx) const;
+        bool matches(const RawTransaction &tx, uint32_t txNum, BlockHeight height, const ChainAccess &chain) const;
+
+        std::string toString() const;
+    };
+
+    // Single parallel pass over blocks [startBlock, endBlock) returning the matching transactions in chain order
+    std::vector<Transaction> BLOCKSCI_EXPORT filter(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock, const TxPredicate &predicate);
+} // namespace blocksci
+
+#endif /* tx_predicate_hpp */
@@ -0,0 +1,106 @@
+//
+//  utxo_set.hpp
+//  blocksci
+//
+
+#ifndef utxo_set_hpp
+#define utxo_set_hpp
+
+#include "chain_fwd.hpp"
+#include "inout_pointer.hpp"
+
+#include <blocksci/blocksci_export.h>
+#include <blocksci/typedefs.hpp>
+#include <blocksci/core/address_types.hpp>
+#include <blocksci/core/bitcoin_uint256.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace blocksci {
+
+    /* The set of outputs that were unspent after the blocks [0, height), stored column-wise and ordered by output pointer.
+     *
+     * A set is computed with a parallel scan over every output in the chain, or derived from a set at another height by
+     * scanning only the blocks in between. Sets can be saved to and loaded from a single columnar file, and a
+     * UtxoSnapshotCache keeps a directory of them so that repeated historical queries start from the nearest snapshot. */
+    class BLOCKSCI_EXPORT UtxoSet {
+        BlockHeight setHeight = 0;
+        // Hash of block height - 1, used to check that a loaded set still matches the chain
+        uint256 lastBlockHash;
+
+        UtxoSet &merge(UtxoSet &other);
+
+        // Outputs created in the blocks [start, end) and not spent by a transaction before txCutoff
+        static UtxoSet scanOutputs(Blockchain &chain, BlockHeight start, BlockHeight end, uint32_t txCutoff);
+
+    public:
+        std::vector<uint32_t> txNums;
+        std::vector<uint16_t> outputNums;
+        std::vector<int64_t> values;
+        std::vector<AddressType::Enum> types;
+        std::vector<uint32_t> addressNums;
+        // Height of the block that created each output
+        std::vector<BlockHeight> heights;
+
+        UtxoSet() = default;
+
+        // Unspent outputs after the blocks [0, height)
+        static UtxoSet compute(Blockchain &chain, BlockHeight height);
+
+        static UtxoSet load(const std::string &path);
+
+        // Throws if the file exists and overwrite is false
+        void save(const std::string &path, bool overwrite = false) const;
+
+        // Set at another height, computed from this one by scanning the blocks between the two heights
+        UtxoSet derive(Blockchain &chain, BlockHeight height) const;
+
+        // Whether the set was computed from the chain currently loaded, ie. the chain hasn't reorged past its height
+        bool matches(Blockchain &chain) const;
+
+        BlockHeight height() const {
+            return setHeight;
+        }
+
+        size_t size() const {
+            return txNums.size();
+        }
+
+        bool empty() const {
+            return txNums.empty();
+        }
+
+        OutputPointer pointer(size_t i) const {
+            return {txNums[i], outputNums[i]};
+        }
+
+        int64_t totalValue() const;
+    };
+
+    /* Directory of saved UTXO sets named by height. A request for a height that isn't saved derives it from the nearest
+     * valid snapshot, or computes it from scratch if the genesis block is closer, and saves the result. Snapshots that
+     * were left behind by a reorg or can't be read are deleted. */
+    class BLOCKSCI_EXPORT UtxoSnapshotCache {
+        std::string directory;
+
+        std::string snapshotPath(BlockHeight height) const;
+
+    public:
+        explicit UtxoSnapshotCache(std::string directory);
+
+        const std::string &getDirectory() const {
+            return directory;
+        }
+
+        // Heights of the saved snapshots in increasing order
+        std::vector<BlockHeight> snapshotHeights() const;
+
+        UtxoSet get(Blockchain &chain, BlockHeight height, bool saveResult = true);
+
+        void remove(BlockHeight height);
+    };
+} // namespace blocksci
+
+#endif /* utxo_set_hpp */
@@ -64,13 +64,25 @@ namespace blocksci {
     
     using OffsetType = uint64_t;
     constexpr OffsetType InvalidFileIndex = std::numeric_limits<OffsetType>::max();
+    
+    /* Read only view of mapped file data. owner keeps the mapping alive, so the view stays valid after a reload remaps the
+     * file to make appended data visible. The mapping can't outlive the file's contents though: once a rollback or reorg
+     * truncates the file, the pages of the view past the new end are gone and reading them raises SIGBUS */
+    struct BLOCKSCI_EXPORT MappedView {
+        const char *data;
+        size_t size;
+        std::shared_ptr<const void> owner;
+    };
 
     struct BLOCKSCI_EXPORT SimpleFileMapperBase {
     private:
         void openFile(size_t size);
     protected:
-        std::unique_ptr<boost::iostreams::mapped_file> file;
+        // Shared with the views handed out by view(), reloads replace the mapping rather than closing it
+        std::shared_ptr<boost::iostreams::mapped_file> file;
         size_t fileEnd;
+        // Readonly files are mapped past their end so that data appended later becomes visible without remapping
+        size_t mappedSize;
         const char *const_data;
         char *dataPtr;
     public:
@@ -97,6 +109,11 @@ namespace blocksci {
             return fileEnd;
         }
         
+        MappedView view(OffsetType offset, size_t length) const {
+            assert(offset + length <= fileEnd);
+            return {length > 0 ? const_data + offset : nullptr, length, file};
+        }
+        
         size_t fileSize() const;
         
         void reload();
@@ -344,6 +361,11 @@ namespace blocksci {
             return dataFile.fileSize() / sizeof(T);
         }
         
+        // Covers the items [start, start + count), which must already be on disk
+        MappedView view(size_type start, size_type count) const {
+            return dataFile.SimpleFileMapperBase::view(getPos(start), getPos(count));
+        }
+        
         void truncate(size_type index) {
             dataFile.truncate(getPos(index));
         }
@@ -451,6 +473,10 @@ namespace blocksci {
             return indexFile.fileSize();
         }
         
+        MappedView dataView(OffsetType offset, size_t length) const {
+            return dataFile.SimpleFileMapperBase::view(offset, length);
+        }
+        
         void truncate(uint32_t index) {
             if (index < size()) {
                 auto offsets = getOffsets(index);
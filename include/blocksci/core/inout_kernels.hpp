@@ -0,0 +1,104 @@
+//
+//  inout_kernels.hpp
+//  blocksci
+//
+
+#ifndef inout_kernels_hpp
+#define inout_kernels_hpp
+
+#include "address_types.hpp"
+#include "raw_transaction.hpp"
+
+#include <blocksci/blocksci_export.h>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace blocksci {
+
+    struct BLOCKSCI_EXPORT ValueSummary {
+        int64_t total = 0;
+        int64_t min = std::numeric_limits<int64_t>::max();
+        int64_t max = std::numeric_limits<int64_t>::min();
+        uint64_t count = 0;
+
+        void add(int64_t value) {
+            total += value;
+            min = value < min ? value : min;
+            max = value > max ? value : max;
+            count++;
+        }
+
+        ValueSummary &merge(const ValueSummary &other) {
+            total += other.total;
+            min = other.min < min ? other.min : min;
+            max = other.max > max ? other.max : max;
+            count += other.count;
+            return *this;
+        }
+    };
+
+    struct BLOCKSCI_EXPORT AddressTypeHistogram {
+        std::array<int64_t, AddressType::size> values{};
+        std::array<uint64_t, AddressType::size> counts{};
+
+        AddressTypeHistogram &merge(const AddressTypeHistogram &other) {
+            for (size_t i = 0; i < AddressType::size; i++) {
+                values[i] += other.values[i];
+                counts[i] += other.counts[i];
+            }
+            return *this;
+        }
+    };
+
+    // Which inouts of each transaction the transaction span kernels read
+    enum class InoutSide {
+        Inputs, Outputs
+    };
+
+    /* Aggregation kernels that run directly over packed Inout arrays without constructing Input or Output objects.
+     * Each kernel is compiled for AVX-512, AVX2 and plain scalar code, and the widest version the CPU supports is
+     * selected the first time any of them is called. Type masks have bit (1 << type) set for every included
+     * AddressType::Enum. */
+    namespace kernels {
+        constexpr uint32_t allAddressTypes = (uint32_t{1} << AddressType::size) - 1;
+
+        // "avx512", "avx2" or "scalar"
+        std::string BLOCKSCI_EXPORT activeInstructionSet();
+
+        // Instruction sets this CPU can run, widest first. Always ends with "scalar"
+        std::vector<std::string> BLOCKSCI_EXPORT supportedInstructionSets();
+
+        // Switches every kernel to the given instruction set. Throws std::invalid_argument if it is unknown or unsupported
+        void BLOCKSCI_EXPORT setInstructionSet(const std::string &name);
+
+        int64_t BLOCKSCI_EXPORT sumValues(const Inout *begin, const Inout *end, uint32_t typeMask = allAddressTypes);
+
+        // Adds the total, min, max and count of the values of the selected inouts to summary
+        void BLOCKSCI_EXPORT summarizeValues(const Inout *begin, const Inout *end, uint32_t typeMask, ValueSummary &summary);
+
+        // Adds the value and count of the inouts of each address type to histogram
+        void BLOCKSCI_EXPORT accumulateTypeHistogram(const Inout *begin, const Inout *end, AddressTypeHistogram &histogram);
+
+        /* Span kernels run over serialized transactions as they are stored back to back in the tx file (see
+         * ChainAccess::txDataView), so a whole block range is reduced with one call whose vector accumulators carry
+         * across transaction boundaries */
+        void BLOCKSCI_EXPORT summarizeTxValues(const char *txData, size_t size, InoutSide side, uint32_t typeMask, ValueSummary &summary);
+        void BLOCKSCI_EXPORT accumulateTxTypeHistogram(const char *txData, size_t size, InoutSide side, AddressTypeHistogram &histogram);
+
+        // Adds the fee of every transaction in the span other than coinbase transactions to summary
+        void BLOCKSCI_EXPORT summarizeTxFees(const char *txData, size_t size, ValueSummary &summary);
+
+        inline int64_t fee(const RawTransaction &tx) {
+            if (tx.inputCount == 0) {
+                return 0;
+            }
+            return sumValues(tx.beginInputs(), tx.endInputs()) - sumValues(tx.beginOutputs(), tx.endOutputs());
+        }
+    } // namespace kernels
+} // namespace blocksci
+
+#endif /* inout_kernels_hpp */
@@ -36,6 +36,31 @@ namespace blocksci {
         }
     };
     
+    // Frequently scanned script fields, mirrored into a separate column per dedup type so scans don't pull in full records
+    struct BLOCKSCI_EXPORT ScriptHotData {
+        uint32_t txFirstSeen;
+        uint32_t txFirstSpent;
+        // Bitmask of the address types the script has appeared as in outputs, filled in by the parser when it backfills the column
+        uint32_t typesSeen;
+        
+        ScriptHotData(uint32_t txNum, AddressType::Enum type) : txFirstSeen(txNum), txFirstSpent(std::numeric_limits<uint32_t>::max()), typesSeen(typeMask(type)) {}
+        
+        explicit ScriptHotData(const ScriptDataBase &data) : txFirstSeen(data.txFirstSeen), txFirstSpent(data.txFirstSpent), typesSeen(0) {}
+        
+        static uint32_t typeMask(AddressType::Enum type) {
+            return uint32_t{1} << static_cast<uint32_t>(type);
+        }
+        
+        bool hasBeenSpent() const {
+            return txFirstSpent != std::numeric_limits<uint32_t>::max();
+        }
+        
+        // The parser records spends in place before publishing them, so readers ignore spends at or past maxLoadedTx
+        bool hasBeenSpentBefore(uint32_t maxLoadedTx) const {
+            return txFirstSpent < maxLoadedTx;
+        }
+    };
+    
     struct BLOCKSCI_EXPORT PubkeyData : public ScriptDataBase {
         CPubKey pubkey;
         uint160 address;
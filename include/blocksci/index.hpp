@@ -9,6 +9,9 @@
 #define blocksci_index_h
 
 #include <blocksci/index/address_index.hpp>
+#include <blocksci/index/address_prefix_index.hpp>
+#include <blocksci/index/address_ranking.hpp>
+#include <blocksci/index/balance_index.hpp>
 #include <blocksci/index/hash_index.hpp>
 
 #endif /* blocksci_index_h */
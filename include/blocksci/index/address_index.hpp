@@ -12,11 +12,13 @@
 #include <blocksci/blocksci_export.h>
 #include <blocksci/address/address_fwd.hpp>
 #include <blocksci/chain/chain_fwd.hpp>
+#include <blocksci/core/address_types.hpp>
 #include <blocksci/core/core_fwd.hpp>
 
 #include <range/v3/view/any_view.hpp>
 
 #include <cstring>
+#include <functional>
 #include <unordered_set>
 #include <string>
 #include <vector>
@@ -45,6 +47,13 @@ namespace blocksci {
         
         ranges::any_view<OutputPointer> getOutputPointers(const Address &address) const;
         
+        // The output entries of each address type are split by the first byte of their key into this many disjoint partitions
+        static constexpr int outputPartitionCount = 256;
+        
+        /* Calls func(addressNum, pointer) for every output entry of the given type in the partition. All outputs of
+         * an address fall in the same partition and are visited consecutively, so partitions can be scanned in parallel */
+        void visitOutputPartition(AddressType::Enum type, int partition, const std::function<void(uint32_t, const OutputPointer &)> &func) const;
+        
         std::vector<Address> getPossibleNestedEquivalent(const Address &address) const;
         ranges::any_view<Address> getIncludingMultisigs(const Address &searchAddress) const;
         
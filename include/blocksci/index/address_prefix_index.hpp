@@ -0,0 +1,111 @@
+//
+//  address_prefix_index.hpp
+//  blocksci
+//
+
+#ifndef address_prefix_index_hpp
+#define address_prefix_index_hpp
+
+#include <blocksci/blocksci_export.h>
+#include <blocksci/core/address_types.hpp>
+#include <blocksci/core/dedup_address_type.hpp>
+#include <blocksci/core/file_mapper.hpp>
+
+#include <array>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace blocksci {
+    class DataAccess;
+    struct DataConfiguration;
+    class ScriptAccess;
+
+    struct BLOCKSCI_EXPORT AddressPrefixSegmentInfo {
+        // Scripts of dedup type i with numbers in (startCounts[i], endCounts[i]] are covered
+        std::array<uint32_t, DedupAddressType::size> startCounts;
+        std::array<uint32_t, DedupAddressType::size> endCounts;
+        // Entries of address type i are [typeOffsets[i], typeOffsets[i + 1])
+        std::array<uint64_t, AddressType::size + 1> typeOffsets;
+    };
+
+    /* One immutable file set of the address prefix index.
+     *
+     * For each address type with a string encoding, the segment holds the numbers of the covered scripts sorted by
+     * their encoded address string. Only the numbers are stored: the strings are recomputed from the script data when
+     * searching, which keeps the index at four bytes per address. */
+    class BLOCKSCI_EXPORT AddressPrefixSegment {
+        FixedSizeFileMapper<AddressPrefixSegmentInfo> infoFile;
+        FixedSizeFileMapper<uint32_t> scriptsFile;
+
+    public:
+        explicit AddressPrefixSegment(const std::string &directory);
+
+        static std::string infoFilePath(const std::string &directory);
+        static std::string scriptsFilePath(const std::string &directory);
+
+        // False if any of the files is missing or truncated, eg. because the segment was removed by a merge
+        bool isComplete() const;
+
+        const AddressPrefixSegmentInfo &info() const {
+            return *infoFile[0];
+        }
+
+        uint64_t entryCount() const {
+            return scriptsFile.size();
+        }
+
+        std::pair<uint64_t, uint64_t> entries(AddressType::Enum type) const {
+            auto typeIndex = static_cast<size_t>(type);
+            return {info().typeOffsets[typeIndex], info().typeOffsets[typeIndex + 1]};
+        }
+
+        uint32_t scriptNum(uint64_t entry) const {
+            return *scriptsFile[entry];
+        }
+
+        // Entries of the type whose address string starts with prefix
+        std::pair<uint64_t, uint64_t> prefixRange(AddressType::Enum type, const std::string &prefix, DataAccess &access) const;
+    };
+
+    /* Sorted index of encoded address strings used to answer address prefix searches, maintained by the parser.
+     *
+     * Like the balance index, it is a list of segments which the parser appends as new scripts are seen and merges
+     * when adjacent segments reach a similar size. A prefix search is a pair of binary searches per segment, so it
+     * only encodes a logarithmic number of addresses instead of every script of the type. */
+    class BLOCKSCI_EXPORT AddressPrefixIndex {
+        std::string baseDirectory;
+        std::vector<std::unique_ptr<AddressPrefixSegment>> segments;
+
+        void setup(const ScriptAccess &scripts);
+
+    public:
+        AddressPrefixIndex(std::string baseDirectory, const ScriptAccess &scripts);
+        AddressPrefixIndex(const AddressPrefixIndex &) = delete;
+        AddressPrefixIndex &operator=(const AddressPrefixIndex &) = delete;
+        ~AddressPrefixIndex();
+
+        static std::string manifestFilePath(const std::string &baseDirectory);
+        static std::string segmentDirectory(const std::string &baseDirectory, const std::string &segmentName);
+        // Names of the segments listed in the manifest in script order
+        static std::vector<std::string> readManifest(const std::string &baseDirectory);
+
+        // Address types with a string encoding on the configured chain, in type order
+        static std::vector<AddressType::Enum> indexedTypes(const DataConfiguration &config);
+
+        // Encoded string of the script as an address of the given type, or an empty string if it has none
+        static std::string addressString(AddressType::Enum type, uint32_t scriptNum, DataAccess &access);
+
+        // The scripts [1, scriptCount(type)] of the dedup type are indexed
+        uint32_t scriptCount(DedupAddressType::Enum type) const;
+
+        // Numbers of the indexed addresses of the type whose string starts with prefix, in no particular order
+        std::vector<uint32_t> getAddressNumsWithPrefix(AddressType::Enum type, const std::string &prefix, DataAccess &access) const;
+
+        // Picks up segments written or merged by the parser since the index was opened
+        void reload(const ScriptAccess &scripts);
+    };
+} // namespace blocksci
+
+#endif /* address_prefix_index_hpp */
@@ -0,0 +1,39 @@
+//
+//  address_ranking.hpp
+//  blocksci
+//
+
+#ifndef address_ranking_hpp
+#define address_ranking_hpp
+
+#include <blocksci/blocksci_export.h>
+#include <blocksci/typedefs.hpp>
+#include <blocksci/address/address.hpp>
+#include <blocksci/chain/chain_fwd.hpp>
+
+#include <range/v3/utility/optional.hpp>
+
+#include <vector>
+
+namespace blocksci {
+    enum class AddressRankMetric {
+        // Value of the address's unspent outputs
+        Balance,
+        // Total value ever sent to the address
+        Received
+    };
+
+    struct BLOCKSCI_EXPORT RankedAddress {
+        Address address;
+        int64_t value;
+    };
+
+    /* Returns the k addresses with the highest metric, sorted from highest to lowest. If endHeight is given the
+     * metric is computed as of the state of the chain after the blocks [0, endHeight), otherwise at the tip.
+     *
+     * The address index is partitioned into independent key ranges which are scanned in parallel on the thread pool,
+     * each keeping a bounded heap of its best addresses, and the heaps are merged once all ranges are done. */
+    std::vector<RankedAddress> BLOCKSCI_EXPORT topAddresses(Blockchain &chain, size_t k, AddressRankMetric metric = AddressRankMetric::Balance, ranges::optional<BlockHeight> endHeight = ranges::nullopt);
+} // namespace blocksci
+
+#endif /* address_ranking_hpp */
@@ -0,0 +1,128 @@
+//
+//  balance_index.hpp
+//  blocksci
+//
+
+#ifndef balance_index_hpp
+#define balance_index_hpp
+
+#include <blocksci/blocksci_export.h>
+#include <blocksci/typedefs.hpp>
+#include <blocksci/core/address_types.hpp>
+#include <blocksci/core/bitcoin_uint256.hpp>
+#include <blocksci/core/file_mapper.hpp>
+
+#include <range/v3/utility/optional.hpp>
+
+#include <array>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace blocksci {
+    class ChainAccess;
+
+    struct BLOCKSCI_EXPORT BalanceSegmentInfo {
+        BlockHeight startHeight;
+        BlockHeight endHeight;
+        // Hash of block endHeight - 1, used to detect segments invalidated by a reorg
+        uint256 endBlockHash;
+        // Keys of address type i are [typeOffsets[i], typeOffsets[i + 1])
+        std::array<uint64_t, AddressType::size + 1> typeOffsets;
+    };
+
+    /* One immutable file set of the balance index, covering the blocks [startHeight, endHeight).
+     *
+     * For each address type the segment holds the sorted numbers of the addresses whose balance changed in those
+     * blocks. The entries of key k are [offsets[k], offsets[k + 1]) and give, in increasing height order, each height at
+     * which the balance changed and the balance of the address after that block. */
+    class BLOCKSCI_EXPORT BalanceIndexSegment {
+        FixedSizeFileMapper<BalanceSegmentInfo> infoFile;
+        FixedSizeFileMapper<uint32_t> keysFile;
+        FixedSizeFileMapper<uint64_t> offsetsFile;
+        FixedSizeFileMapper<BlockHeight> heightsFile;
+        FixedSizeFileMapper<int64_t> balancesFile;
+
+    public:
+        explicit BalanceIndexSegment(const std::string &directory);
+
+        static std::string infoFilePath(const std::string &directory);
+        static std::string keysFilePath(const std::string &directory);
+        static std::string offsetsFilePath(const std::string &directory);
+        static std::string heightsFilePath(const std::string &directory);
+        static std::string balancesFilePath(const std::string &directory);
+
+        // False if any of the files is missing or truncated, eg. because the segment was removed by a merge
+        bool isComplete() const;
+
+        const BalanceSegmentInfo &info() const {
+            return *infoFile[0];
+        }
+
+        uint64_t keyCount() const {
+            return keysFile.size();
+        }
+
+        uint64_t entryCount() const {
+            return heightsFile.size();
+        }
+
+        uint32_t key(uint64_t keyIndex) const {
+            return *keysFile[keyIndex];
+        }
+
+        // Entry range of the address, or an empty range if its balance didn't change in this segment
+        std::pair<uint64_t, uint64_t> entries(AddressType::Enum type, uint32_t addressNum) const;
+
+        std::pair<uint64_t, uint64_t> entriesOfKey(uint64_t keyIndex) const {
+            return {*offsetsFile[keyIndex], *offsetsFile[keyIndex + 1]};
+        }
+
+        BlockHeight height(uint64_t entry) const {
+            return *heightsFile[entry];
+        }
+
+        int64_t balance(uint64_t entry) const {
+            return *balancesFile[entry];
+        }
+    };
+
+    /* Running balance of every address after each block that changed it, maintained by the parser.
+     *
+     * The index is a list of segments covering consecutive block ranges. The parser appends a segment per update and
+     * merges adjacent segments of similar size, so the number of segments stays logarithmic in the number of updates.
+     * The balance at a height is found by a binary search in the newest segment at or below that height which
+     * touches the address. */
+    class BLOCKSCI_EXPORT BalanceIndex {
+        std::string baseDirectory;
+        std::vector<std::unique_ptr<BalanceIndexSegment>> segments;
+
+        void setup(const ChainAccess &chain);
+
+    public:
+        BalanceIndex(std::string baseDirectory, const ChainAccess &chain);
+        BalanceIndex(const BalanceIndex &) = delete;
+        BalanceIndex &operator=(const BalanceIndex &) = delete;
+        ~BalanceIndex();
+
+        static std::string manifestFilePath(const std::string &baseDirectory);
+        static std::string segmentDirectory(const std::string &baseDirectory, const std::string &segmentName);
+        // Names of the segments listed in the manifest in height order
+        static std::vector<std::string> readManifest(const std::string &baseDirectory);
+
+        // The blocks [0, blockCount()) are indexed
+        BlockHeight blockCount() const;
+
+        // Balance of the address after the block at height, or nullopt if that block isn't indexed
+        ranges::optional<int64_t> getBalance(AddressType::Enum type, uint32_t addressNum, BlockHeight height) const;
+
+        // Height and resulting balance of every indexed block that changed the balance of the address
+        std::vector<std::pair<BlockHeight, int64_t>> getBalanceHistory(AddressType::Enum type, uint32_t addressNum) const;
+
+        // Picks up segments written or merged by the parser since the index was opened
+        void reload(const ChainAccess &chain);
+    };
+} // namespace blocksci
+
+#endif /* balance_index_hpp */
@@ -29,6 +29,7 @@ namespace blocksci {
         std::unique_ptr<HashIndexPriv> impl;
         
         uint32_t lookupAddressImpl(AddressType::Enum type, const char *data, size_t size);
+        std::vector<uint32_t> lookupAddressesImpl(AddressType::Enum type, const char *data, size_t size, size_t count);
         
     public:
         
@@ -40,10 +41,18 @@ namespace blocksci {
             return lookupAddressImpl(type, reinterpret_cast<const char *>(&hash), sizeof(hash));
         }
         
+        // Batched equivalent of lookupAddress, with 0 for hashes that aren't indexed. Lookups are sorted and run in parallel
+        template<AddressType::Enum type>
+        std::vector<uint32_t> lookupAddresses(const typename AddressInfo<type>::IDType *hashes, size_t count) {
+            return lookupAddressesImpl(type, reinterpret_cast<const char *>(hashes), sizeof(*hashes), count);
+        }
+        
         uint32_t getPubkeyHashIndex(const uint160 &pubkeyhash);
         uint32_t getScriptHashIndex(const uint160 &scripthash);
         uint32_t getScriptHashIndex(const uint256 &scripthash);
         uint32_t getTxIndex(const uint256 &txHash);
+        // Batched equivalent of getTxIndex, with 0 for hashes that aren't indexed. Lookups are sorted and run in parallel
+        std::vector<uint32_t> getTxIndexes(const uint256 *txHashes, size_t count);
         
         uint32_t countColumn(AddressType::Enum type);
         uint32_t countTxes();
@@ -32,16 +32,11 @@ namespace blocksci {
         void visitPointers(const std::function<void(const Address &)> &) const {}
 
         uint32_t getFirstTxIndex() const {
-            return rawData->txFirstSeen;
+            return Address::getFirstTxIndex();
         }
         
         ranges::optional<uint32_t> getTxRevealedIndex() const {
-            auto txRevealedIndex = rawData->txFirstSpent;
-            if (txRevealedIndex != std::numeric_limits<uint32_t>::max()) {
-                return txRevealedIndex;
-            } else {
-                return ranges::nullopt;
-            }
+            return Address::getTxRevealedIndex();
         }
 
         bool hasBeenSpent() const {
@@ -16,6 +16,7 @@
 #include <blocksci/blocksci_export.h>
 #include <blocksci/meta.hpp>
 
+#include <algorithm>
 #include <memory>
 #include <tuple>
 
@@ -41,15 +42,35 @@ namespace blocksci {
     template<DedupAddressType::Enum type>
     using ScriptFile = ScriptFileType_t<typename ScriptInfo<type>::storage>;
     
+    template<DedupAddressType::Enum type>
+    struct ScriptHotFile : public FixedSizeFileMapper<ScriptHotData> {
+        using FixedSizeFileMapper<ScriptHotData>::FixedSizeFileMapper;
+    };
+    
+    template<DedupAddressType::Enum type>
+    struct ScriptHotViewFunctor {
+        static MappedView f(const ScriptAccess &access);
+    };
+    
     template<DedupAddressType::Enum type>
     struct ScriptDataBaseFunctor {
         static const ScriptDataBase * f(uint32_t scriptNum, const ScriptAccess &access);
     };
     
+    template<DedupAddressType::Enum type>
+    struct ScriptHotDataFunctor {
+        static ScriptHotData f(uint32_t scriptNum, const ScriptAccess &access);
+    };
+    
     class BLOCKSCI_EXPORT ScriptAccess {
     private:
         using ScriptFilesTuple = to_dedup_address_tuple_t<ScriptFile>;
         ScriptFilesTuple scriptFiles;
+        using ScriptHotFilesTuple = to_dedup_address_tuple_t<ScriptHotFile>;
+        // Optional, data directories written before the hot columns existed only have the full records
+        ScriptHotFilesTuple scriptHotFiles;
+        // Number of scripts of each type the parser has published as complete
+        std::array<uint32_t, DedupAddressType::size> committedCounts;
         
     public:
         explicit ScriptAccess(const std::string &baseDirectory);
@@ -69,6 +90,11 @@ namespace blocksci {
             return getFile<type>()[addressNum - 1];
         }
         
+        template <DedupAddressType::Enum type>
+        const ScriptHotFile<type> &getHotFile() const {
+            return std::get<ScriptHotFile<type>>(scriptHotFiles);
+        }
+        
         const ScriptDataBase *getScriptHeader(uint32_t addressNum, DedupAddressType::Enum type) const {
             static auto &scriptDataBaseTable = *[]() {
                 auto table = make_dynamic_table<DedupAddressType, ScriptDataBaseFunctor>();
@@ -78,14 +104,39 @@ namespace blocksci {
             return scriptDataBaseTable.at(index)(addressNum, *this);
         }
         
+        // Reads from the hot column when it covers the script and falls back to the full record otherwise
+        ScriptHotData getScriptHotData(uint32_t addressNum, DedupAddressType::Enum type) const {
+            static auto &scriptHotDataTable = *[]() {
+                auto table = make_dynamic_table<DedupAddressType, ScriptHotDataFunctor>();
+                return new decltype(table){table};
+            }();
+            auto index = static_cast<size_t>(type);
+            return scriptHotDataTable.at(index)(addressNum, *this);
+        }
+        
+        // Hot columns of the scripts of the type that have them, where the row of a script is its number minus one
+        MappedView scriptHotView(DedupAddressType::Enum type) const {
+            static auto &scriptHotViewTable = *[]() {
+                auto table = make_dynamic_table<DedupAddressType, ScriptHotViewFunctor>();
+                return new decltype(table){table};
+            }();
+            auto index = static_cast<size_t>(type);
+            return scriptHotViewTable.at(index)(*this);
+        }
+        
         std::array<uint32_t, DedupAddressType::size> scriptCounts() const;
         
         uint32_t scriptCount(DedupAddressType::Enum type) const;
         
         size_t totalAddressCount() const;
         
+        void setCommittedCounts(const std::array<uint32_t, DedupAddressType::size> &counts) {
+            committedCounts = counts;
+        }
+        
         void reload() {
             for_each(scriptFiles, [&](auto& file) -> decltype(auto) { file.reload(); });
+            for_each(scriptHotFiles, [&](auto& file) -> decltype(auto) { file.reload(); });
         }
     };
     
@@ -95,6 +146,21 @@ namespace blocksci {
         return file.getDataAtIndex(scriptNum - 1);
     }
     
+    template<DedupAddressType::Enum type>
+    MappedView ScriptHotViewFunctor<type>::f(const ScriptAccess &access) {
+        auto &hotFile = access.getHotFile<type>();
+        return hotFile.view(0, std::min<size_t>(hotFile.size(), access.scriptCount(type)));
+    }
+    
+    template<DedupAddressType::Enum type>
+    ScriptHotData ScriptHotDataFunctor<type>::f(uint32_t scriptNum, const ScriptAccess &access) {
+        auto &hotFile = access.getHotFile<type>();
+        if (scriptNum <= hotFile.size()) {
+            return *hotFile[scriptNum - 1];
+        }
+        return ScriptHotData{*access.getFile<type>().getDataAtIndex(scriptNum - 1)};
+    }
+    
 } // namespace blocksci
 
 #endif /* script_access_hpp */
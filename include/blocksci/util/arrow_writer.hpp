@@ -0,0 +1,117 @@
+//
+//  arrow_writer.hpp
+//  blocksci
+//
+
+#ifndef arrow_writer_hpp
+#define arrow_writer_hpp
+
+#include <blocksci/blocksci_export.h>
+
+#include <boost/filesystem/fstream.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace blocksci {
+
+    // Column types supported by ArrowFileWriter. Columns are never nullable
+    struct BLOCKSCI_EXPORT ArrowType {
+        enum class Kind {
+            Int, FixedSizeBinary, Binary, Utf8
+        };
+
+        Kind kind;
+        // Bits of integers or bytes of fixed size binary values
+        int32_t width;
+        bool isSigned;
+
+        template <typename T>
+        static ArrowType integer() {
+            static_assert(std::is_integral<T>::value, "Arrow integer columns must hold integers");
+            return {Kind::Int, static_cast<int32_t>(8 * sizeof(T)), std::is_signed<T>::value};
+        }
+
+        static ArrowType fixedSizeBinary(int32_t byteWidth) {
+            return {Kind::FixedSizeBinary, byteWidth, false};
+        }
+
+        static ArrowType binary() {
+            return {Kind::Binary, 0, false};
+        }
+
+        static ArrowType utf8() {
+            return {Kind::Utf8, 0, false};
+        }
+    };
+
+    struct BLOCKSCI_EXPORT ArrowField {
+        std::string name;
+        ArrowType type;
+    };
+
+    /* Values of one column of a record batch. Integer and fixed size binary values are stored back to back in values.
+     * Binary and utf8 values are concatenated in values, with offsets holding the start of each followed by the end of
+     * the last */
+    struct BLOCKSCI_EXPORT ArrowColumn {
+        std::vector<char> values;
+        std::vector<int32_t> offsets;
+
+        template <typename T, typename Source>
+        static ArrowColumn fromIntegers(const std::vector<Source> &source) {
+            ArrowColumn column;
+            column.values.resize(source.size() * sizeof(T));
+            for (size_t i = 0; i < source.size(); i++) {
+                auto value = static_cast<T>(source[i]);
+                std::memcpy(column.values.data() + i * sizeof(T), &value, sizeof(T));
+            }
+            return column;
+        }
+
+        void appendVariable(const void *data, size_t size) {
+            if (offsets.empty()) {
+                offsets.push_back(0);
+            }
+            auto bytes = reinterpret_cast<const char *>(data);
+            values.insert(values.end(), bytes, bytes + size);
+            offsets.push_back(static_cast<int32_t>(values.size()));
+        }
+    };
+
+    /* Writes record batches to an Arrow IPC file (Feather v2) readable by Arrow, pandas, Spark and DuckDB. The
+     * flatbuffer metadata is encoded here so that the library needs no Arrow dependency. The file is only valid once
+     * close has written its footer */
+    class BLOCKSCI_EXPORT ArrowFileWriter {
+    public:
+        ArrowFileWriter(const std::string &path, std::vector<ArrowField> fields);
+
+        // Columns in the order of the fields, each holding rowCount values
+        void writeBatch(int64_t rowCount, const std::vector<ArrowColumn> &columns);
+
+        void close();
+
+    private:
+        // Location of a message in the file, as listed in the footer
+        struct Block {
+            int64_t offset;
+            int32_t metadataLength;
+            int64_t bodyLength;
+        };
+
+        std::string path;
+        std::vector<ArrowField> fields;
+        boost::filesystem::ofstream file;
+        int64_t position = 0;
+        std::vector<Block> batches;
+
+        void write(const void *data, size_t size);
+        void pad(size_t alignment);
+        Block writeMessage(const std::vector<uint8_t> &metadata, const std::vector<std::pair<const char *, size_t>> &buffers);
+    };
+} // namespace blocksci
+
+#endif /* arrow_writer_hpp */
@@ -13,7 +13,9 @@
 
 #include <blocksci/blocksci_export.h>
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 
 namespace blocksci {
     class ChainAccess;
@@ -21,16 +23,60 @@ namespace blocksci {
     class AddressIndex;
     class HashIndex;
     class MempoolIndex;
+    class BlockTimeIndex;
+    class BalanceIndex;
+    class AddressPrefixIndex;
+    struct State;
+    
+    namespace internal {
+        // Owning pointer to a component that is opened on first use. Once opened, access is a single acquire load
+        template <typename T>
+        struct LazyComponent {
+            std::atomic<T *> loaded{nullptr};
+            std::unique_ptr<T> owner;
+            std::unique_ptr<std::mutex> loadMutex = std::make_unique<std::mutex>();
+            
+            LazyComponent() = default;
+            LazyComponent(LazyComponent &&other) noexcept : loaded(other.loaded.exchange(nullptr)), owner(std::move(other.owner)), loadMutex(std::move(other.loadMutex)) {}
+            LazyComponent &operator=(LazyComponent &&other) noexcept {
+                owner = std::move(other.owner);
+                loadMutex = std::move(other.loadMutex);
+                loaded = other.loaded.exchange(nullptr);
+                return *this;
+            }
+            
+            T *get() const {
+                return loaded.load(std::memory_order_acquire);
+            }
+        };
+    }
 
+    /* Components are opened lazily and thread-safely on first access, so constructing a DataAccess only
+     * touches the files that are actually used */
     class BLOCKSCI_EXPORT DataAccess {
+        mutable internal::LazyComponent<ChainAccess> chain;
+        mutable internal::LazyComponent<ScriptAccess> scripts;
+        mutable internal::LazyComponent<AddressIndex> addressIndex;
+        mutable internal::LazyComponent<HashIndex> hashIndex;
+        mutable internal::LazyComponent<MempoolIndex> mempoolIndex;
+        mutable internal::LazyComponent<BlockTimeIndex> blockTimeIndex;
+        mutable internal::LazyComponent<BalanceIndex> balanceIndex;
+        mutable internal::LazyComponent<AddressPrefixIndex> addressPrefixIndex;
+        // Read once on construction and on reload so that components opened at different times are clamped to the same
+        // published epoch. Null if the parser hasn't published one
+        std::unique_ptr<State> epoch;
+        
+        const ChainAccess &loadChain() const;
+        const ScriptAccess &loadScripts() const;
+        const MempoolIndex &loadMempoolIndex() const;
+        const BlockTimeIndex &loadBlockTimeIndex() const;
+        const BalanceIndex &loadBalanceIndex() const;
+        const AddressPrefixIndex &loadAddressPrefixIndex() const;
+        AddressIndex &loadAddressIndex();
+        HashIndex &loadHashIndex();
+        
     public:
         DataConfiguration config;
-
-        std::unique_ptr<ChainAccess> chain;
-        std::unique_ptr<ScriptAccess> scripts;
-        std::unique_ptr<AddressIndex> addressIndex;
-        std::unique_ptr<HashIndex> hashIndex;
-        std::unique_ptr<MempoolIndex> mempoolIndex;
         
         DataAccess();
         explicit DataAccess(DataConfiguration config_);
@@ -39,29 +85,73 @@ namespace blocksci {
         ~DataAccess();
 
         const ChainAccess &getChain() const {
-            return *chain;
+            if (auto loaded = chain.get()) {
+                return *loaded;
+            }
+            return loadChain();
         }
 
         const ScriptAccess &getScripts() const {
-            return *scripts;
+            if (auto loaded = scripts.get()) {
+                return *loaded;
+            }
+            return loadScripts();
         }
 
         const MempoolIndex &getMempoolIndex() const {
-            return *mempoolIndex;
+            if (auto loaded = mempoolIndex.get()) {
+                return *loaded;
+            }
+            return loadMempoolIndex();
+        }
+
+        // Built from the block headers on first use and extended as new blocks are loaded
+        const BlockTimeIndex &getBlockTimeIndex() const {
+            if (auto loaded = blockTimeIndex.get()) {
+                return *loaded;
+            }
+            return loadBlockTimeIndex();
+        }
+
+        // Written by the parser, covers no blocks if it hasn't been built
+        const BalanceIndex &getBalanceIndex() const {
+            if (auto loaded = balanceIndex.get()) {
+                return *loaded;
+            }
+            return loadBalanceIndex();
+        }
+
+        // Written by the parser, covers no scripts if it hasn't been built
+        const AddressPrefixIndex &getAddressPrefixIndex() const {
+            if (auto loaded = addressPrefixIndex.get()) {
+                return *loaded;
+            }
+            return loadAddressPrefixIndex();
         }
 
         AddressIndex &getAddressIndex() {
-            return *addressIndex;
+            if (auto loaded = addressIndex.get()) {
+                return *loaded;
+            }
+            return loadAddressIndex();
         }
 
         HashIndex &getHashIndex() {
-            return *hashIndex;
+            if (auto loaded = hashIndex.get()) {
+                return *loaded;
+            }
+            return loadHashIndex();
         }
         
         operator DataConfiguration() const { return config; }
         
+        // Picks up newly appended data in the opened components without remapping existing files, limited to the parser's last published epoch
         void reload();
     };
+    
+    /* Atomically replaces the epoch that readers clamp to. The parser publishes an epoch only once all the data it covers
+     * is written, and publishes the smaller epoch before truncating anything on a rollback */
+    void BLOCKSCI_EXPORT publishEpoch(const DataConfiguration &config, const State &state);
 }
 
 #endif /* data_access_hpp */
@@ -48,6 +48,11 @@ namespace blocksci {
         
         std::string addressDBFilePath() const;
         std::string hashIndexFilePath() const;
+        std::string balanceIndexDirectory() const;
+        std::string addressPrefixIndexDirectory() const;
+        
+        // State of the last completed parser update, replaced atomically by the parser
+        std::string epochFilePath() const;
         
         bool operator==(const DataConfiguration &other) const {
             return dataDirectory == other.dataDirectory;
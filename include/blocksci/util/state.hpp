@@ -12,6 +12,9 @@
 #include <blocksci/core/dedup_address_type.hpp>
 #include <blocksci/scripts/script_access.hpp>
 
+#include <array>
+#include <iostream>
+
 namespace blocksci {
     struct State {
         uint32_t blockCount;
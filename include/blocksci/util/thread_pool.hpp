@@ -0,0 +1,71 @@
+//
+//  thread_pool.hpp
+//  blocksci
+//
+
+#ifndef thread_pool_hpp
+#define thread_pool_hpp
+
+#include <blocksci/blocksci_export.h>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace blocksci {
+
+    /* Process-wide pool of persistent worker threads backing the parallel chain helpers.
+     *
+     * Each call to parallelFor hands every participant (the workers plus the calling thread) a contiguous range of
+     * task indexes. Participants run tasks from the front of their own range and steal the back half of another
+     * participant's range once theirs is exhausted, so uneven task costs don't leave threads idle at the tail.
+     * Calls made from inside a running task execute serially on the current thread. */
+    class BLOCKSCI_EXPORT ThreadPool {
+        struct Impl;
+        std::unique_ptr<Impl> impl;
+
+        void ensureWorkers();
+
+    public:
+        explicit ThreadPool(unsigned int threadCount);
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+        ~ThreadPool();
+
+        // Shared pool sized by BLOCKSCI_THREADS if set and by the hardware concurrency otherwise
+        static ThreadPool &instance();
+
+        // Number of threads taking part in a parallel call, including the calling thread
+        unsigned int threadCount() const;
+
+        // Waits for any running call to finish before replacing the workers. Throws std::logic_error if called from inside a task, which would wait on itself
+        void setThreadCount(unsigned int threadCount);
+
+        // Runs func(i) for every i in [0, taskCount) and returns once all have completed, rethrowing the first exception
+        void parallelFor(size_t taskCount, const std::function<void(size_t)> &func);
+    };
+
+    // Maps every task in parallel and folds the results in task order so reduceFunc does not need to be commutative
+    template <typename ResultType, typename MapFunc, typename ReduceFunc>
+    ResultType parallelMapReduce(size_t taskCount, MapFunc &&mapFunc, ReduceFunc &&reduceFunc) {
+        // Wrapped so that a bool result doesn't select the packed vector<bool>, which can't be written concurrently
+        struct TaskResult {
+            ResultType value{};
+        };
+        std::vector<TaskResult> results(taskCount);
+        ThreadPool::instance().parallelFor(taskCount, [&](size_t task) {
+            ResultType res{};
+            auto ret = mapFunc(task);
+            results[task].value = std::move(reduceFunc(res, ret));
+        });
+        ResultType res{};
+        for (auto &ret : results) {
+            res = reduceFunc(res, ret.value);
+        }
+        return res;
+    }
+} // namespace blocksci
+
+#endif /* thread_pool_hpp */
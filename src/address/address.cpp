@@ -11,11 +11,19 @@
 #include <blocksci/address/address.hpp>
 #include <blocksci/address/equiv_address.hpp>
 #include <blocksci/chain/algorithms.hpp>
+#include <blocksci/chain/chain_access.hpp>
 #include <blocksci/index/address_index.hpp>
+#include <blocksci/index/address_prefix_index.hpp>
+#include <blocksci/index/balance_index.hpp>
 #include <blocksci/index/hash_index.hpp>
 #include <scripts/bitcoin_base58.hpp>
 #include <scripts/bitcoin_segwit_addr.hpp>
 #include <blocksci/scripts/script_variant.hpp>
+#include <blocksci/scripts/script_access.hpp>
+#include <blocksci/core/address_info.hpp>
+#include <blocksci/util/data_access.hpp>
+
+#include <algorithm>
 
 namespace blocksci {
     
@@ -53,6 +61,19 @@ namespace blocksci {
         return ScriptBase(*this);
     }
     
+    uint32_t Address::getFirstTxIndex() const {
+        return access->getScripts().getScriptHotData(scriptNum, dedupType(type)).txFirstSeen;
+    }
+    
+    ranges::optional<uint32_t> Address::getTxRevealedIndex() const {
+        auto hotData = access->getScripts().getScriptHotData(scriptNum, dedupType(type));
+        if (hotData.hasBeenSpentBefore(access->getChain().maxLoadedTx())) {
+            return hotData.txFirstSpent;
+        } else {
+            return ranges::nullopt;
+        }
+    }
+    
     ranges::optional<Address> getAddressFromString(const std::string &addressString, DataAccess &access) {
         if (addressString.compare(0, access.config.segwitPrefix.size(), access.config.segwitPrefix) == 0) {
             std::pair<int, std::vector<uint8_t> > decoded = segwit_addr::decode(access.config.segwitPrefix, addressString);
@@ -92,29 +113,51 @@ namespace blocksci {
         return ranges::nullopt;
     }
     
-    template<AddressType::Enum type>
-    std::vector<Address> getAddressesWithPrefixImp(const std::string &prefix, DataAccess &access) {
+    std::vector<Address> getAddressesWithPrefix(const std::string &prefix, DataAccess &access) {
         std::vector<Address> addresses;
-        auto count = access.getScripts().scriptCount(dedupType(type));
-        for (uint32_t scriptNum = 1; scriptNum <= count; scriptNum++) {
-            ScriptAddress<type> script(scriptNum, access);
-            if (script.addressString().compare(0, prefix.length(), prefix) == 0) {
+        if (prefix.empty()) {
+            return addresses;
+        }
+        auto &index = access.getAddressPrefixIndex();
+        auto types = AddressPrefixIndex::indexedTypes(access.config);
+        bool indexBuilt = std::any_of(types.begin(), types.end(), [&](AddressType::Enum type) {
+            return index.scriptCount(dedupType(type)) > 0;
+        });
+        if (!indexBuilt) {
+            // Every script of a searched type is encoded, so only the type given by the leading character is searched
+            if (prefix.compare(0, 1, "1") == 0) {
+                types = {AddressType::PUBKEYHASH};
+            } else if (prefix.compare(0, 1, "3") == 0) {
+                types = {AddressType::SCRIPTHASH};
+            } else {
+                types.clear();
+            }
+        }
+        for (auto type : types) {
+            if (type == AddressType::WITNESS_PUBKEYHASH || type == AddressType::WITNESS_SCRIPTHASH) {
+                // Every bech32 address starts with the human readable part and separator
+                auto humanReadablePart = access.config.segwitPrefix + "1";
+                auto length = std::min(prefix.size(), humanReadablePart.size());
+                if (prefix.compare(0, length, humanReadablePart, 0, length) != 0) {
+                    continue;
+                }
+            }
+            auto scriptNums = index.getAddressNumsWithPrefix(type, prefix, access);
+            // Scripts added since the index was last updated are checked directly
+            auto scriptCount = access.getScripts().scriptCount(dedupType(type));
+            for (uint32_t scriptNum = index.scriptCount(dedupType(type)) + 1; scriptNum <= scriptCount; scriptNum++) {
+                if (AddressPrefixIndex::addressString(type, scriptNum, access).compare(0, prefix.length(), prefix) == 0) {
+                    scriptNums.push_back(scriptNum);
+                }
+            }
+            std::sort(scriptNums.begin(), scriptNums.end());
+            for (auto scriptNum : scriptNums) {
                 addresses.emplace_back(scriptNum, type, access);
             }
         }
         return addresses;
     }
     
-    std::vector<Address> getAddressesWithPrefix(const std::string &prefix, DataAccess &access) {
-        if (prefix.compare(0, 1, "1") == 0) {
-            return getAddressesWithPrefixImp<AddressType::Enum::PUBKEYHASH>(prefix, access);
-        } else if (prefix.compare(0, 1, "3") == 0) {
-            return getAddressesWithPrefixImp<AddressType::Enum::SCRIPTHASH>(prefix, access);
-        } else {
-            return {};
-        }
-    }
-    
     std::string fullTypeImp(const Address &address, DataAccess &access) {
         std::stringstream ss;
         ss << addressName(address.type);
@@ -157,9 +200,17 @@ namespace blocksci {
     }
     
     int64_t Address::calculateBalance(BlockHeight height) {
+        auto indexHeight = height == -1 ? access->getChain().blockCount() - 1 : height;
+        if (auto indexed = access->getBalanceIndex().getBalance(type, scriptNum, indexHeight)) {
+            return *indexed;
+        }
         return balance(height, outputs(getOutputPointers(), *access));
     }
     
+    std::vector<std::pair<BlockHeight, int64_t>> Address::getBalanceHistory() const {
+        return access->getBalanceIndex().getBalanceHistory(type, scriptNum);
+    }
+    
     ranges::any_view<Output> Address::getOutputs() {
         return outputs(getOutputPointers(), *access);
     }
@@ -61,7 +61,12 @@ namespace blocksci {
     }
     
     int64_t EquivAddress::calculateBalance(BlockHeight height) {
-        return balance(height, getOutputs());
+        // The member addresses have disjoint outputs, so their balances can be looked up individually
+        int64_t value = 0;
+        for (auto address : addresses) {
+            value += address.calculateBalance(height);
+        }
+        return value;
     }
     
     ranges::any_view<Output> EquivAddress::getOutputs() {
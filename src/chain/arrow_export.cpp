@@ -0,0 +1,395 @@
+//
+//  arrow_export.cpp
+//  blocksci
+//
+
+#include <blocksci/chain/arrow_export.hpp>
+#include <blocksci/chain/blockchain.hpp>
+#include <blocksci/chain/chain_access.hpp>
+#include <blocksci/chain/chain_columns.hpp>
+#include <blocksci/core/address_info.hpp>
+#include <blocksci/core/raw_block.hpp>
+#include <blocksci/core/script_data.hpp>
+#include <blocksci/index/address_prefix_index.hpp>
+#include <blocksci/scripts/script_access.hpp>
+#include <blocksci/util/arrow_writer.hpp>
+#include <blocksci/util/data_access.hpp>
+#include <blocksci/util/thread_pool.hpp>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace blocksci {
+    namespace {
+        const std::string manifestMagic = "blocksci-arrow-export";
+        constexpr int manifestVersion = 2;
+        const std::vector<std::string> tableNames = {"blocks", "txes", "inputs", "outputs", "addresses"};
+
+        struct ExportedPartition {
+            BlockHeight start;
+            BlockHeight end;
+            uint256 lastBlockHash;
+        };
+
+        boost::filesystem::path manifestPath(const boost::filesystem::path &directory) {
+            return directory/"manifest.txt";
+        }
+
+        std::string partitionFileName(BlockHeight start, BlockHeight end) {
+            char name[32];
+            std::snprintf(name, sizeof(name), "%09d-%09d.arrow", start, end);
+            return name;
+        }
+
+        std::vector<ExportedPartition> readManifest(const boost::filesystem::path &directory, BlockHeight partitionBlocks) {
+            std::vector<ExportedPartition> partitions;
+            auto path = manifestPath(directory);
+            if (!boost::filesystem::exists(path)) {
+                return partitions;
+            }
+            boost::filesystem::ifstream file(path);
+            std::string magic;
+            int version = 0;
+            BlockHeight exportedPartitionBlocks = 0;
+            file >> magic >> version >> exportedPartitionBlocks;
+            if (!file || magic != manifestMagic || version <= 0 || version > manifestVersion) {
+                throw std::runtime_error("Not a BlockSci Arrow export: " + directory.native());
+            }
+            // Exports with an older schema are redone from scratch so that every partition has the same columns
+            if (version != manifestVersion) {
+                return partitions;
+            }
+            if (exportedPartitionBlocks != partitionBlocks) {
+                throw std::invalid_argument("Export in " + directory.native() + " uses partitions of " + std::to_string(exportedPartitionBlocks) + " blocks");
+            }
+            ExportedPartition partition;
+            std::string hash;
+            while (file >> partition.start >> partition.end >> hash) {
+                partition.lastBlockHash.SetHex(hash);
+                partitions.push_back(partition);
+            }
+            return partitions;
+        }
+
+        // Written beside the destination and renamed into place so that readers never see a partial file
+        template <typename Func>
+        void replaceFile(const boost::filesystem::path &path, Func writeFunc) {
+            auto tempPath = path;
+            tempPath += boost::filesystem::unique_path(".%%%%-%%%%.tmp");
+            writeFunc(tempPath);
+            boost::filesystem::rename(tempPath, path);
+        }
+
+        void writeManifest(const boost::filesystem::path &directory, BlockHeight partitionBlocks, const std::vector<ExportedPartition> &partitions) {
+            replaceFile(manifestPath(directory), [&](const boost::filesystem::path &path) {
+                boost::filesystem::ofstream file(path);
+                file << manifestMagic << " " << manifestVersion << " " << partitionBlocks << "\n";
+                for (auto &partition : partitions) {
+                    file << partition.start << " " << partition.end << " " << partition.lastBlockHash.GetHex() << "\n";
+                }
+                if (!file) {
+                    throw std::runtime_error("Failed to write " + path.native());
+                }
+            });
+        }
+
+        // Removes table files the manifest doesn't list, left by partitions that were dropped or never finished
+        void removeUnlistedFiles(const boost::filesystem::path &directory, const std::vector<ExportedPartition> &partitions) {
+            std::set<std::string> listed;
+            for (auto &partition : partitions) {
+                listed.insert(partitionFileName(partition.start, partition.end));
+            }
+            for (auto &table : tableNames) {
+                auto tableDirectory = directory/table;
+                if (!boost::filesystem::exists(tableDirectory)) {
+                    continue;
+                }
+                std::vector<boost::filesystem::path> unlisted;
+                for (auto &entry : boost::filesystem::directory_iterator(tableDirectory)) {
+                    if (listed.find(entry.path().filename().native()) == listed.end()) {
+                        unlisted.push_back(entry.path());
+                    }
+                }
+                for (auto &path : unlisted) {
+                    boost::filesystem::remove(path);
+                }
+            }
+        }
+
+        struct Table {
+            std::vector<ArrowField> fields;
+            std::vector<ArrowColumn> columns;
+            int64_t rowCount = 0;
+        };
+
+        ArrowColumn integerColumn(const std::vector<int64_t> &values, const ArrowType &type) {
+            switch (type.width) {
+                case 8:
+                    return type.isSigned ? ArrowColumn::fromIntegers<int8_t>(values) : ArrowColumn::fromIntegers<uint8_t>(values);
+                case 16:
+                    return type.isSigned ? ArrowColumn::fromIntegers<int16_t>(values) : ArrowColumn::fromIntegers<uint16_t>(values);
+                case 32:
+                    return type.isSigned ? ArrowColumn::fromIntegers<int32_t>(values) : ArrowColumn::fromIntegers<uint32_t>(values);
+                default:
+                    return type.isSigned ? ArrowColumn::fromIntegers<int64_t>(values) : ArrowColumn::fromIntegers<uint64_t>(values);
+            }
+        }
+
+        // Narrows extracted int64 columns to their Arrow types, one column per task
+        void encodeIntegerColumns(Table &table, const std::vector<std::vector<int64_t>> &values, size_t firstColumn) {
+            table.columns.resize(firstColumn + values.size());
+            ThreadPool::instance().parallelFor(values.size(), [&](size_t i) {
+                table.columns[firstColumn + i] = integerColumn(values[i], table.fields[firstColumn + i].type);
+            });
+        }
+
+        ArrowType txFieldType(TxField field) {
+            switch (field) {
+                case TxField::Index:
+                case TxField::Size:
+                case TxField::TotalSize:
+                case TxField::BaseSize:
+                case TxField::Weight:
+                case TxField::Locktime:
+                    return ArrowType::integer<uint32_t>();
+                case TxField::BlockHeight:
+                    return ArrowType::integer<int32_t>();
+                case TxField::InputCount:
+                case TxField::OutputCount:
+                    return ArrowType::integer<uint16_t>();
+                case TxField::InputValue:
+                case TxField::OutputValue:
+                case TxField::Fee:
+                    return ArrowType::integer<int64_t>();
+            }
+            return ArrowType::integer<int64_t>();
+        }
+
+        ArrowType inoutFieldType(InoutField field) {
+            switch (field) {
+                case InoutField::Value:
+                    return ArrowType::integer<int64_t>();
+                case InoutField::AddressType:
+                    return ArrowType::integer<uint8_t>();
+                case InoutField::AddressNum:
+                case InoutField::LinkedTxIndex:
+                    return ArrowType::integer<uint32_t>();
+                case InoutField::Age:
+                    return ArrowType::integer<int32_t>();
+            }
+            return ArrowType::integer<int64_t>();
+        }
+
+        Table blockTable(Blockchain &chain, BlockHeight start, BlockHeight end) {
+            auto &chainAccess = chain.getAccess().getChain();
+            Table table;
+            table.fields = {
+                {"height", ArrowType::integer<int32_t>()},
+                {"version", ArrowType::integer<int32_t>()},
+                {"timestamp", ArrowType::integer<uint32_t>()},
+                {"bits", ArrowType::integer<uint32_t>()},
+                {"nonce", ArrowType::integer<uint32_t>()},
+                {"total_size", ArrowType::integer<uint32_t>()},
+                {"base_size", ArrowType::integer<uint32_t>()},
+                {"first_tx_index", ArrowType::integer<uint32_t>()},
+                {"tx_count", ArrowType::integer<uint32_t>()},
+                {"hash", ArrowType::fixedSizeBinary(32)},
+                {"coinbase", ArrowType::binary()}
+            };
+            table.rowCount = end - start;
+            std::vector<std::vector<int64_t>> values(9);
+            ArrowColumn hashes;
+            ArrowColumn coinbases;
+            for (auto height = start; height < end; height++) {
+                auto block = chainAccess.getBlock(height);
+                int64_t row[] = {height, block->version, block->timestamp, block->bits, block->nonce, block->realSize, block->baseSize, block->firstTxIndex, block->numTxes};
+                for (size_t i = 0; i < values.size(); i++) {
+                    values[i].push_back(row[i]);
+                }
+                hashes.values.insert(hashes.values.end(), block->hash.begin(), block->hash.end());
+                auto coinbase = chainAccess.getCoinbase(block->coinbaseOffset);
+                coinbases.appendVariable(coinbase.data(), coinbase.size());
+            }
+            encodeIntegerColumns(table, values, 0);
+            table.columns.push_back(std::move(hashes));
+            table.columns.push_back(std::move(coinbases));
+            return table;
+        }
+
+        Table txTable(Blockchain &chain, BlockHeight start, BlockHeight end) {
+            std::vector<TxField> fields = {TxField::Index, TxField::BlockHeight, TxField::InputCount, TxField::OutputCount, TxField::Size, TxField::TotalSize, TxField::BaseSize, TxField::Weight, TxField::Locktime, TxField::InputValue, TxField::OutputValue, TxField::Fee};
+            auto columns = txColumns(chain, start, end, fields, true);
+            Table table;
+            for (auto field : fields) {
+                table.fields.push_back({fieldName(field), txFieldType(field)});
+            }
+            table.fields.push_back({"hash", ArrowType::fixedSizeBinary(32)});
+            table.rowCount = static_cast<int64_t>(columns.hashes.size());
+            encodeIntegerColumns(table, columns.values, 0);
+            ArrowColumn hashes;
+            hashes.values.resize(columns.hashes.size() * sizeof(uint256));
+            if (!columns.hashes.empty()) {
+                std::memcpy(hashes.values.data(), columns.hashes.data(), hashes.values.size());
+            }
+            table.columns.push_back(std::move(hashes));
+            return table;
+        }
+
+        Table inoutTable(InoutColumns &&columns) {
+            Table table;
+            table.fields = {
+                {"tx_index", ArrowType::integer<uint32_t>()},
+                {"index", ArrowType::integer<uint16_t>()},
+                {"block_height", ArrowType::integer<int32_t>()}
+            };
+            for (auto field : columns.fields) {
+                table.fields.push_back({fieldName(field), inoutFieldType(field)});
+            }
+            table.rowCount = static_cast<int64_t>(columns.txIndexes.size());
+            encodeIntegerColumns(table, columns.values, 3);
+            table.columns[0] = ArrowColumn::fromIntegers<uint32_t>(columns.txIndexes);
+            table.columns[1] = ArrowColumn::fromIntegers<uint16_t>(columns.indexes);
+            table.columns[2] = ArrowColumn::fromIntegers<int32_t>(columns.heights);
+            return table;
+        }
+
+        // Encoding of the script as the first address type it has been seen as that has one
+        std::string addressString(DedupAddressType::Enum type, uint32_t scriptNum, uint32_t typesSeen, DataAccess &access) {
+            for (auto addressType : {AddressType::PUBKEYHASH, AddressType::WITNESS_PUBKEYHASH, AddressType::SCRIPTHASH, AddressType::WITNESS_SCRIPTHASH}) {
+                if (dedupType(addressType) == type && (typesSeen & ScriptHotData::typeMask(addressType)) != 0) {
+                    auto address = AddressPrefixIndex::addressString(addressType, scriptNum, access);
+                    if (!address.empty()) {
+                        return address;
+                    }
+                }
+            }
+            return "";
+        }
+
+        /* Scripts are numbered in the order they were first seen, so the scripts first seen in the partition's
+         * transactions are a contiguous range of each dedup type */
+        Table addressTable(Blockchain &chain, BlockHeight start, BlockHeight end) {
+            auto &access = chain.getAccess();
+            auto &scripts = access.getScripts();
+            uint32_t firstTx = 0;
+            uint32_t endTx = 0;
+            if (start < end) {
+                firstTx = chain[start].firstTxIndex();
+                endTx = chain[end - 1].endTxIndex();
+            }
+
+            std::vector<std::vector<int64_t>> values(4);
+            for (auto type : DedupAddressType::allArray()) {
+                auto firstSeenBefore = [&](uint32_t txNum) {
+                    uint32_t low = 1;
+                    uint32_t high = scripts.scriptCount(type) + 1;
+                    while (low < high) {
+                        auto mid = low + (high - low) / 2;
+                        if (scripts.getScriptHotData(mid, type).txFirstSeen < txNum) {
+                            low = mid + 1;
+                        } else {
+                            high = mid;
+                        }
+                    }
+                    return low;
+                };
+                auto endScript = firstSeenBefore(endTx);
+                for (auto scriptNum = firstSeenBefore(firstTx); scriptNum < endScript; scriptNum++) {
+                    auto data = scripts.getScriptHotData(scriptNum, type);
+                    values[0].push_back(static_cast<int64_t>(type));
+                    values[1].push_back(scriptNum);
+                    values[2].push_back(data.txFirstSeen);
+                    values[3].push_back(data.typesSeen);
+                }
+            }
+
+            Table table;
+            table.fields = {
+                {"dedup_type", ArrowType::integer<uint8_t>()},
+                {"address_num", ArrowType::integer<uint32_t>()},
+                {"first_tx_index", ArrowType::integer<uint32_t>()},
+                {"types_seen", ArrowType::integer<uint32_t>()},
+                {"address", ArrowType::utf8()}
+            };
+            table.rowCount = static_cast<int64_t>(values[0].size());
+            encodeIntegerColumns(table, values, 0);
+
+            constexpr size_t chunkSize = 4096;
+            auto rowCount = values[0].size();
+            std::vector<std::string> addresses(rowCount);
+            ThreadPool::instance().parallelFor((rowCount + chunkSize - 1) / chunkSize, [&](size_t chunk) {
+                auto chunkEnd = std::min(rowCount, (chunk + 1) * chunkSize);
+                for (size_t i = chunk * chunkSize; i < chunkEnd; i++) {
+                    auto type = static_cast<DedupAddressType::Enum>(values[0][i]);
+                    addresses[i] = addressString(type, static_cast<uint32_t>(values[1][i]), static_cast<uint32_t>(values[3][i]), access);
+                }
+            });
+            ArrowColumn addressColumn;
+            for (auto &address : addresses) {
+                addressColumn.appendVariable(address.data(), address.size());
+            }
+            table.columns.push_back(std::move(addressColumn));
+            return table;
+        }
+
+        void writeTable(const boost::filesystem::path &directory, const std::string &name, BlockHeight start, BlockHeight end, const Table &table) {
+            auto tableDirectory = directory/name;
+            boost::filesystem::create_directories(tableDirectory);
+            replaceFile(tableDirectory/partitionFileName(start, end), [&](const boost::filesystem::path &path) {
+                ArrowFileWriter writer{path.native(), table.fields};
+                writer.writeBatch(table.rowCount, table.columns);
+                writer.close();
+            });
+        }
+    }
+
+    BlockHeight exportArrow(Blockchain &chain, const std::string &directory, BlockHeight partitionBlocks) {
+        if (partitionBlocks <= 0) {
+            throw std::invalid_argument("Partitions must contain at least one block");
+        }
+        boost::filesystem::path exportDirectory{directory};
+        boost::filesystem::create_directories(exportDirectory);
+        auto partitions = readManifest(exportDirectory, partitionBlocks);
+
+        // Only complete partitions whose last block is still in the chain are kept
+        auto chainSize = static_cast<BlockHeight>(chain.size());
+        size_t kept = 0;
+        while (kept < partitions.size()) {
+            auto &partition = partitions[kept];
+            if (partition.end - partition.start != partitionBlocks || partition.end > chainSize || chain[partition.end - 1].getHash() != partition.lastBlockHash) {
+                break;
+            }
+            kept++;
+        }
+        if (kept != partitions.size()) {
+            partitions.resize(kept);
+            writeManifest(exportDirectory, partitionBlocks, partitions);
+        }
+        removeUnlistedFiles(exportDirectory, partitions);
+
+        auto start = partitions.empty() ? 0 : partitions.back().end;
+        while (start < chainSize) {
+            auto end = std::min(start + partitionBlocks, chainSize);
+            writeTable(exportDirectory, "blocks", start, end, blockTable(chain, start, end));
+            writeTable(exportDirectory, "txes", start, end, txTable(chain, start, end));
+            std::vector<InoutField> inputFields = {InoutField::Value, InoutField::AddressType, InoutField::AddressNum, InoutField::LinkedTxIndex, InoutField::Age};
+            // Whether and when an output is spent changes after its partition is exported, so only its creation is
+            std::vector<InoutField> outputFields = {InoutField::Value, InoutField::AddressType, InoutField::AddressNum};
+            writeTable(exportDirectory, "inputs", start, end, inoutTable(inputColumns(chain, start, end, inputFields)));
+            writeTable(exportDirectory, "outputs", start, end, inoutTable(outputColumns(chain, start, end, outputFields)));
+            writeTable(exportDirectory, "addresses", start, end, addressTable(chain, start, end));
+            partitions.push_back({start, end, chain[end - 1].getHash()});
+            writeManifest(exportDirectory, partitionBlocks, partitions);
+            start = end;
+        }
+        return start;
+    }
+} // namespace blocksci
@@ -0,0 +1,88 @@
+//
+//  block_time_index.cpp
+//  blocksci
+//
+
+#include <blocksci/chain/block_time_index.hpp>
+#include <blocksci/chain/chain_access.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace blocksci {
+    constexpr int BlockTimeIndex::medianTimeSpan;
+
+    BlockTimeIndex::BlockTimeIndex(const ChainAccess &chain) {
+        build(chain);
+    }
+
+    void BlockTimeIndex::build(const ChainAccess &chain) {
+        prefixMaxTimes.clear();
+        suffixMinTimes.clear();
+        medianTimes.clear();
+        lastHash.SetNull();
+        update(chain);
+    }
+
+    void BlockTimeIndex::update(const ChainAccess &chain) {
+        auto oldCount = blockCount();
+        auto newCount = chain.blockCount();
+        if (oldCount > 0 && (newCount < oldCount || chain.getBlock(oldCount - 1)->hash != lastHash)) {
+            build(chain);
+            return;
+        }
+        if (newCount == oldCount) {
+            return;
+        }
+
+        prefixMaxTimes.reserve(static_cast<size_t>(newCount));
+        suffixMinTimes.reserve(static_cast<size_t>(newCount));
+        medianTimes.reserve(static_cast<size_t>(newCount));
+        std::array<uint32_t, medianTimeSpan> window;
+        for (BlockHeight height = oldCount; height < newCount; height++) {
+            auto timestamp = chain.getBlock(height)->timestamp;
+            prefixMaxTimes.push_back(height == 0 ? timestamp : std::max(prefixMaxTimes.back(), timestamp));
+            suffixMinTimes.push_back(timestamp);
+
+            auto windowStart = std::max(height - medianTimeSpan + 1, BlockHeight{0});
+            auto windowEnd = window.begin();
+            for (auto windowHeight = windowStart; windowHeight <= height; windowHeight++) {
+                *windowEnd++ = chain.getBlock(windowHeight)->timestamp;
+            }
+            auto median = window.begin() + std::distance(window.begin(), windowEnd) / 2;
+            std::nth_element(window.begin(), median, windowEnd);
+            medianTimes.push_back(*median);
+        }
+
+        // New blocks can only lower the suffix minimum of earlier ones, and once a block's value is unchanged so are all before it
+        for (auto i = static_cast<size_t>(newCount) - 1; i-- > 0;) {
+            auto lowered = std::min(suffixMinTimes[i], suffixMinTimes[i + 1]);
+            if (i < static_cast<size_t>(oldCount) && lowered == suffixMinTimes[i]) {
+                break;
+            }
+            suffixMinTimes[i] = lowered;
+        }
+        lastHash = chain.getBlock(newCount - 1)->hash;
+    }
+
+    BlockHeight BlockTimeIndex::firstBlockAtOrAfter(uint32_t time) const {
+        auto it = std::lower_bound(prefixMaxTimes.begin(), prefixMaxTimes.end(), time);
+        return static_cast<BlockHeight>(std::distance(prefixMaxTimes.begin(), it));
+    }
+
+    BlockHeight BlockTimeIndex::lastBlockAtOrBefore(uint32_t time) const {
+        auto it = std::upper_bound(suffixMinTimes.begin(), suffixMinTimes.end(), time);
+        return static_cast<BlockHeight>(std::distance(suffixMinTimes.begin(), it)) - 1;
+    }
+
+    BlockHeight BlockTimeIndex::firstBlockWithMedianTimeAtOrAfter(uint32_t time) const {
+        auto it = std::lower_bound(medianTimes.begin(), medianTimes.end(), time);
+        return static_cast<BlockHeight>(std::distance(medianTimes.begin(), it));
+    }
+
+    std::pair<BlockHeight, BlockHeight> BlockTimeIndex::heightRange(uint32_t startTime, uint32_t endTime) const {
+        auto first = firstBlockAtOrAfter(startTime);
+        auto last = lastBlockAtOrBefore(endTime) + 1;
+        return {first, std::max(first, last)};
+    }
+} // namespace blocksci
@@ -7,6 +7,7 @@
 //
 
 #include <blocksci/chain/blockchain.hpp>
+#include <blocksci/chain/block_time_index.hpp>
 #include <blocksci/heuristics/tx_identification.hpp>
 #include <blocksci/index/address_output_range.hpp>
 
@@ -16,10 +17,41 @@
 #include <range/v3/view/filter.hpp>
 #include <range/v3/view/group_by.hpp>
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <limits>
 
 namespace blocksci {
+    namespace {
+        // Header timestamps are unsigned 32 bit so times outside that range clamp to either end
+        uint32_t toBlockTimestamp(std::chrono::system_clock::time_point time) {
+            auto seconds = std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+            if (seconds < 0) {
+                return 0;
+            }
+            return static_cast<uint32_t>(std::min<decltype(seconds)>(seconds, std::numeric_limits<uint32_t>::max()));
+        }
+        
+        // Reduces each segment's serialized transactions, which are contiguous in the tx file, with a single kernel call
+        template <typename ResultType, typename SpanFunc>
+        ResultType reduceTxData(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock, SpanFunc spanFunc) {
+            auto &chainAccess = chain.getAccess().getChain();
+            auto mapFunc = [&](const std::vector<Block> &segment) {
+                ResultType res;
+                if (!segment.empty()) {
+                    auto view = chainAccess.txDataView(segment.front().firstTxIndex(), segment.back().endTxIndex());
+                    spanFunc(view.data, view.size, res);
+                }
+                return res;
+            };
+            auto reduceFunc = [](ResultType &a, ResultType &b) -> ResultType & {
+                return a.merge(b);
+            };
+            return chain.mapReduce<ResultType>(startBlock, endBlock, mapFunc, reduceFunc);
+        }
+    }
+    
     // [start, end)
     std::vector<std::vector<Block>> segmentChain(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock, unsigned int segmentCount) {
         auto lastTx = chain[endBlock - BlockHeight{1}].endTxIndex();
@@ -81,6 +113,19 @@ namespace blocksci {
         return lastBlock.endTxIndex();
     }
     
+    BlockHeight Blockchain::heightAtTime(std::chrono::system_clock::time_point time) const {
+        return std::min(access.getBlockTimeIndex().firstBlockAtOrAfter(toBlockTimestamp(time)), lastBlockHeight);
+    }
+    
+    std::pair<BlockHeight, BlockHeight> Blockchain::heightRange(std::chrono::system_clock::time_point start, std::chrono::system_clock::time_point end) const {
+        auto range = access.getBlockTimeIndex().heightRange(toBlockTimestamp(start), toBlockTimestamp(end));
+        return {std::min(range.first, lastBlockHeight), std::min(range.second, lastBlockHeight)};
+    }
+    
+    std::chrono::system_clock::time_point Blockchain::medianTimePast(BlockHeight height) const {
+        return std::chrono::system_clock::from_time_t(static_cast<time_t>(access.getBlockTimeIndex().medianTimePast(height)));
+    }
+    
     std::vector<Block> filter(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock, std::function<bool(const Block &tx)> testFunc)  {
         auto mapFunc = [&testFunc](const std::vector<Block> &segment) -> std::vector<Block> {
             return segment | ranges::view::filter(testFunc) | ranges::to_vector;
@@ -138,4 +183,34 @@ namespace blocksci {
         }
         return topAddresses;
     }
+    
+    ValueSummary outputValueSummary(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock, uint32_t typeMask) {
+        return reduceTxData<ValueSummary>(chain, startBlock, endBlock, [typeMask](const char *txData, size_t size, ValueSummary &summary) {
+            kernels::summarizeTxValues(txData, size, InoutSide::Outputs, typeMask, summary);
+        });
+    }
+    
+    ValueSummary inputValueSummary(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock, uint32_t typeMask) {
+        return reduceTxData<ValueSummary>(chain, startBlock, endBlock, [typeMask](const char *txData, size_t size, ValueSummary &summary) {
+            kernels::summarizeTxValues(txData, size, InoutSide::Inputs, typeMask, summary);
+        });
+    }
+    
+    AddressTypeHistogram outputTypeHistogram(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock) {
+        return reduceTxData<AddressTypeHistogram>(chain, startBlock, endBlock, [](const char *txData, size_t size, AddressTypeHistogram &histogram) {
+            kernels::accumulateTxTypeHistogram(txData, size, InoutSide::Outputs, histogram);
+        });
+    }
+    
+    AddressTypeHistogram inputTypeHistogram(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock) {
+        return reduceTxData<AddressTypeHistogram>(chain, startBlock, endBlock, [](const char *txData, size_t size, AddressTypeHistogram &histogram) {
+            kernels::accumulateTxTypeHistogram(txData, size, InoutSide::Inputs, histogram);
+        });
+    }
+    
+    ValueSummary feeSummary(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock) {
+        return reduceTxData<ValueSummary>(chain, startBlock, endBlock, [](const char *txData, size_t size, ValueSummary &summary) {
+            kernels::summarizeTxFees(txData, size, summary);
+        });
+    }
 } // namespace blocksci
@@ -7,23 +7,30 @@
 
 #include <blocksci/chain/chain_access.hpp>
 #include <blocksci/core/raw_block.hpp>
+#include <blocksci/core/raw_transaction.hpp>
 
 #include <boost/filesystem/path.hpp>
 
 namespace blocksci {
+    constexpr uint32_t ChainAccess::txHeightSampleShift;
+    constexpr BlockHeight ChainAccess::txHeightLinearScanLimit;
+    
     ChainAccess::ChainAccess(const std::string &baseDirectory, BlockHeight blocksIgnored, bool errorOnReorg) :
         blockFile(blockFilePath(baseDirectory)),
         blockCoinbaseFile(blockCoinbaseFilePath(baseDirectory)),
         txFile(txFilePath(baseDirectory)),
         sequenceFile(sequenceFilePath(baseDirectory)),
+        spendingInputFile(spendingInputFilePath(baseDirectory)),
         txHashesFile(txHashesFilePath(baseDirectory)),
+        txHeightFile(txHeightFilePath(baseDirectory)),
         blocksIgnored(blocksIgnored),
         errorOnReorg(errorOnReorg) {
             setup();
     }
     
     void ChainAccess::setup() {
-        maxHeight = static_cast<BlockHeight>(blockFile.size()) - blocksIgnored;
+        auto blockCount = std::min(blockFile.size(), static_cast<size_t>(committedBlockCount));
+        maxHeight = static_cast<BlockHeight>(blockCount) - blocksIgnored;
         if (maxHeight > BlockHeight(0)) {
             const auto &blockFile_ = blockFile;
             auto maxLoadedBlock = blockFile_[static_cast<size_t>(static_cast<int>(maxHeight) - 1)];
@@ -37,6 +44,16 @@ namespace blocksci {
         }
     }
     
+    MappedView ChainAccess::txDataView(uint32_t firstTx, uint32_t endTx) const {
+        reorgCheck();
+        if (firstTx >= endTx) {
+            return {nullptr, 0, nullptr};
+        }
+        auto startOffset = txFile.getOffsets(firstTx)[0];
+        auto endOffset = txFile.getOffsets(endTx - 1)[0] + getTx(endTx - 1)->serializedSize();
+        return txFile.dataView(startOffset, endOffset - startOffset);
+    }
+    
     std::string ChainAccess::txFilePath(const std::string &baseDirectory) {
         return (boost::filesystem::path{baseDirectory}/"tx").native();
     }
@@ -56,4 +73,12 @@ namespace blocksci {
     std::string ChainAccess::sequenceFilePath(const std::string &baseDirectory) {
         return (boost::filesystem::path{baseDirectory}/"sequence").native();
     }
+    
+    std::string ChainAccess::spendingInputFilePath(const std::string &baseDirectory) {
+        return (boost::filesystem::path{baseDirectory}/"spending_input").native();
+    }
+    
+    std::string ChainAccess::txHeightFilePath(const std::string &baseDirectory) {
+        return (boost::filesystem::path{baseDirectory}/"tx_height").native();
+    }
 } // namespace blocksci
@@ -0,0 +1,210 @@
+//
+//  chain_columns.cpp
+//  blocksci
+//
+
+#include <blocksci/chain/chain_columns.hpp>
+
+#include "chain_fields.hpp"
+
+#include <blocksci/chain/block.hpp>
+#include <blocksci/chain/blockchain.hpp>
+#include <blocksci/chain/chain_access.hpp>
+#include <blocksci/chain/inout_pointer.hpp>
+#include <blocksci/core/raw_transaction.hpp>
+#include <blocksci/util/data_access.hpp>
+#include <blocksci/util/thread_pool.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace blocksci {
+    namespace {
+        std::vector<std::vector<Block>> columnSegments(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock) {
+            if (startBlock >= endBlock) {
+                return {};
+            }
+            return segmentChain(chain, startBlock, endBlock, ThreadPool::instance().threadCount() * internal::chunksPerThread);
+        }
+
+        InoutColumns inoutColumns(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock, const std::vector<InoutField> &fields, bool inputs) {
+            auto &chainAccess = chain.getAccess().getChain();
+            endBlock = std::min(endBlock, static_cast<BlockHeight>(chain.size()));
+            auto segments = columnSegments(chain, startBlock, endBlock);
+
+            // Inout counts are stored in the transaction headers, so sizing the columns doesn't touch the inouts
+            std::vector<uint64_t> segmentOffsets(segments.size() + 1, 0);
+            ThreadPool::instance().parallelFor(segments.size(), [&](size_t segmentNum) {
+                uint64_t count = 0;
+                for (auto &block : segments[segmentNum]) {
+                    for (auto txNum = block.firstTxIndex(); txNum < block.endTxIndex(); txNum++) {
+                        auto tx = chainAccess.getTx(txNum);
+                        count += inputs ? tx->inputCount : tx->outputCount;
+                    }
+                }
+                segmentOffsets[segmentNum + 1] = count;
+            });
+            std::partial_sum(segmentOffsets.begin(), segmentOffsets.end(), segmentOffsets.begin());
+            auto rowCount = segmentOffsets.back();
+
+            InoutColumns columns;
+            columns.fields = fields;
+            columns.txIndexes.resize(rowCount);
+            columns.indexes.resize(rowCount);
+            columns.heights.resize(rowCount);
+            columns.values.assign(fields.size(), std::vector<int64_t>(rowCount));
+            ThreadPool::instance().parallelFor(segments.size(), [&](size_t segmentNum) {
+                auto row = segmentOffsets[segmentNum];
+                for (auto &block : segments[segmentNum]) {
+                    auto height = block.height();
+                    for (auto txNum = block.firstTxIndex(); txNum < block.endTxIndex(); txNum++) {
+                        auto tx = chainAccess.getTx(txNum);
+                        auto begin = inputs ? tx->beginInputs() : tx->beginOutputs();
+                        auto end = inputs ? tx->endInputs() : tx->endOutputs();
+                        uint16_t index = 0;
+                        for (auto inout = begin; inout != end; ++inout, ++index, ++row) {
+                            columns.txIndexes[row] = txNum;
+                            columns.indexes[row] = index;
+                            columns.heights[row] = height;
+                            for (size_t i = 0; i < fields.size(); i++) {
+                                columns.values[i][row] = internal::inoutFieldValue(fields[i], *inout, inputs, height, chainAccess);
+                            }
+                        }
+                    }
+                }
+            });
+            return columns;
+        }
+
+        // Tracks the block of a stream of nondecreasing tx numbers so consecutive lookups in one block skip the search
+        class SortedHeightCursor {
+            const ChainAccess &chain;
+            BlockHeight currentHeight = 0;
+            uint32_t firstTx = 0;
+            uint32_t endTx = 0;
+
+        public:
+            explicit SortedHeightCursor(const ChainAccess &chain_) : chain(chain_) {}
+
+            BlockHeight height(uint32_t txNum) {
+                if (txNum < firstTx || txNum >= endTx) {
+                    currentHeight = chain.getBlockHeight(txNum);
+                    auto block = chain.getBlock(currentHeight);
+                    firstTx = block->firstTxIndex;
+                    endTx = block->firstTxIndex + block->numTxes;
+                }
+                return currentHeight;
+            }
+        };
+
+        /* Calls func(key, row, values, cursor) for every key in sorted order, split into contiguous chunks across the
+         * thread pool, where row is the key's position in the original order and so the row of values it fills */
+        template <typename Key, typename Func>
+        std::vector<std::vector<int64_t>> gatherRows(const ChainAccess &chain, const std::vector<Key> &keys, size_t fieldCount, Func func) {
+            std::vector<uint32_t> order(keys.size());
+            std::iota(order.begin(), order.end(), 0u);
+            std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                return keys[a] < keys[b];
+            });
+            std::vector<std::vector<int64_t>> values(fieldCount, std::vector<int64_t>(keys.size()));
+            auto chunkCount = std::min(keys.size(), ThreadPool::instance().threadCount() * internal::chunksPerThread);
+            ThreadPool::instance().parallelFor(chunkCount, [&](size_t chunk) {
+                SortedHeightCursor cursor{chain};
+                auto end = keys.size() * (chunk + 1) / chunkCount;
+                for (auto i = keys.size() * chunk / chunkCount; i < end; i++) {
+                    auto row = order[i];
+                    func(keys[row], row, values, cursor);
+                }
+            });
+            return values;
+        }
+
+        const RawTransaction &checkedTx(const ChainAccess &chain, uint32_t txNum) {
+            if (txNum >= chain.maxLoadedTx()) {
+                throw std::out_of_range("Transaction index " + std::to_string(txNum) + " out of range");
+            }
+            return *chain.getTx(txNum);
+        }
+
+        template <typename Pointer>
+        std::vector<std::vector<int64_t>> gatherInoutFields(DataAccess &access, const std::vector<Pointer> &pointers, const std::vector<InoutField> &fields, bool inputs) {
+            auto &chainAccess = access.getChain();
+            return gatherRows(chainAccess, pointers, fields.size(), [&](const Pointer &pointer, uint32_t row, std::vector<std::vector<int64_t>> &values, SortedHeightCursor &cursor) {
+                auto &tx = checkedTx(chainAccess, pointer.txNum);
+                auto count = inputs ? tx.inputCount : tx.outputCount;
+                if (pointer.inoutNum >= count) {
+                    throw std::out_of_range((inputs ? "Input " : "Output ") + std::to_string(pointer.inoutNum) + " of transaction " + std::to_string(pointer.txNum) + " out of range");
+                }
+                auto &inout = inputs ? tx.getInput(pointer.inoutNum) : tx.getOutput(pointer.inoutNum);
+                auto height = cursor.height(pointer.txNum);
+                for (size_t i = 0; i < fields.size(); i++) {
+                    values[i][row] = internal::inoutFieldValue(fields[i], inout, inputs, height, chainAccess);
+                }
+            });
+        }
+    }
+
+    TxColumns txColumns(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock, const std::vector<TxField> &fields, bool includeHashes) {
+        auto &chainAccess = chain.getAccess().getChain();
+        endBlock = std::min(endBlock, static_cast<BlockHeight>(chain.size()));
+        auto segments = columnSegments(chain, startBlock, endBlock);
+
+        uint32_t firstTx = 0;
+        uint32_t rowCount = 0;
+        if (!segments.empty()) {
+            firstTx = chain[startBlock].firstTxIndex();
+            rowCount = chain[endBlock - 1].endTxIndex() - firstTx;
+        }
+
+        TxColumns columns;
+        columns.fields = fields;
+        columns.values.assign(fields.size(), std::vector<int64_t>(rowCount));
+        if (includeHashes) {
+            columns.hashes.resize(rowCount);
+        }
+        ThreadPool::instance().parallelFor(segments.size(), [&](size_t segmentNum) {
+            for (auto &block : segments[segmentNum]) {
+                auto height = block.height();
+                for (auto txNum = block.firstTxIndex(); txNum < block.endTxIndex(); txNum++) {
+                    auto row = txNum - firstTx;
+                    internal::TxContext context{*chainAccess.getTx(txNum), txNum, height, chainAccess};
+                    for (size_t i = 0; i < fields.size(); i++) {
+                        columns.values[i][row] = context.fieldValue(fields[i]);
+                    }
+                    if (includeHashes) {
+                        columns.hashes[row] = *chainAccess.getTxHash(txNum);
+                    }
+                }
+            }
+        });
+        return columns;
+    }
+
+    InoutColumns inputColumns(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock, const std::vector<InoutField> &fields) {
+        return inoutColumns(chain, startBlock, endBlock, fields, true);
+    }
+
+    InoutColumns outputColumns(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock, const std::vector<InoutField> &fields) {
+        return inoutColumns(chain, startBlock, endBlock, fields, false);
+    }
+
+    std::vector<std::vector<int64_t>> gatherTxFields(DataAccess &access, const std::vector<uint32_t> &txNums, const std::vector<TxField> &fields) {
+        auto &chainAccess = access.getChain();
+        return gatherRows(chainAccess, txNums, fields.size(), [&](uint32_t txNum, uint32_t row, std::vector<std::vector<int64_t>> &values, SortedHeightCursor &cursor) {
+            internal::TxContext context{checkedTx(chainAccess, txNum), txNum, cursor.height(txNum), chainAccess};
+            for (size_t i = 0; i < fields.size(); i++) {
+                values[i][row] = context.fieldValue(fields[i]);
+            }
+        });
+    }
+
+    std::vector<std::vector<int64_t>> gatherInputFields(DataAccess &access, const std::vector<InputPointer> &pointers, const std::vector<InoutField> &fields) {
+        return gatherInoutFields(access, pointers, fields, true);
+    }
+
+    std::vector<std::vector<int64_t>> gatherOutputFields(DataAccess &access, const std::vector<OutputPointer> &pointers, const std::vector<InoutField> &fields) {
+        return gatherInoutFields(access, pointers, fields, false);
+    }
+} // namespace blocksci
@@ -0,0 +1,115 @@
+//
+//  chain_fields.hpp
+//  blocksci
+//
+
+#ifndef chain_fields_hpp
+#define chain_fields_hpp
+
+#include <blocksci/chain/chain_access.hpp>
+#include <blocksci/chain/tx_predicate.hpp>
+#include <blocksci/core/inout.hpp>
+#include <blocksci/core/inout_kernels.hpp>
+#include <blocksci/core/raw_transaction.hpp>
+
+#include <range/v3/utility/optional.hpp>
+
+namespace blocksci {
+    // Evaluation of the transaction and inout fields shared by tx predicates and column extraction
+    namespace internal {
+        // Per-transaction state so aggregate fields used by several comparisons are only computed once
+        class TxContext {
+            const RawTransaction &tx;
+            uint32_t txNum;
+            BlockHeight height;
+            const ChainAccess &chain;
+            mutable ranges::optional<int64_t> inputValue;
+            mutable ranges::optional<int64_t> outputValue;
+
+        public:
+            TxContext(const RawTransaction &tx_, uint32_t txNum_, BlockHeight height_, const ChainAccess &chain_) : tx(tx_), txNum(txNum_), height(height_), chain(chain_) {}
+
+            const RawTransaction &getTx() const {
+                return tx;
+            }
+
+            BlockHeight getHeight() const {
+                return height;
+            }
+
+            const ChainAccess &getChain() const {
+                return chain;
+            }
+
+            int64_t getInputValue() const {
+                if (!inputValue) {
+                    inputValue = kernels::sumValues(tx.beginInputs(), tx.endInputs());
+                }
+                return *inputValue;
+            }
+
+            int64_t getOutputValue() const {
+                if (!outputValue) {
+                    outputValue = kernels::sumValues(tx.beginOutputs(), tx.endOutputs());
+                }
+                return *outputValue;
+            }
+
+            int64_t fieldValue(TxField field) const {
+                switch (field) {
+                    case TxField::Index:
+                        return txNum;
+                    case TxField::BlockHeight:
+                        return height;
+                    case TxField::InputCount:
+                        return tx.inputCount;
+                    case TxField::OutputCount:
+                        return tx.outputCount;
+                    case TxField::Size:
+                        return (tx.realSize + 3 * int64_t{tx.baseSize} + 3) / 4;
+                    case TxField::TotalSize:
+                        return tx.realSize;
+                    case TxField::BaseSize:
+                        return tx.baseSize;
+                    case TxField::Weight:
+                        return tx.realSize + 3 * int64_t{tx.baseSize};
+                    case TxField::Locktime:
+                        return tx.locktime;
+                    case TxField::InputValue:
+                        return getInputValue();
+                    case TxField::OutputValue:
+                        return getOutputValue();
+                    case TxField::Fee:
+                        return tx.inputCount == 0 ? 0 : getInputValue() - getOutputValue();
+                }
+                return 0;
+            }
+        };
+
+        inline int64_t inoutFieldValue(InoutField field, const Inout &inout, bool isInput, BlockHeight height, const ChainAccess &chain) {
+            switch (field) {
+                case InoutField::Value:
+                    return inout.getValue();
+                case InoutField::AddressType:
+                    return static_cast<int64_t>(inout.getType());
+                case InoutField::AddressNum:
+                    return inout.getAddressNum();
+                case InoutField::LinkedTxIndex:
+                    if (isInput || inout.getLinkedTxNum() < chain.maxLoadedTx()) {
+                        return inout.getLinkedTxNum();
+                    }
+                    return 0;
+                case InoutField::Age:
+                    if (isInput) {
+                        return height - chain.getBlockHeight(inout.getLinkedTxNum());
+                    } else if (inout.getLinkedTxNum() > 0 && inout.getLinkedTxNum() < chain.maxLoadedTx()) {
+                        return chain.getBlockHeight(inout.getLinkedTxNum()) - height;
+                    }
+                    return -1;
+            }
+            return 0;
+        }
+    }
+} // namespace blocksci
+
+#endif /* chain_fields_hpp */
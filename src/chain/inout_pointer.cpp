@@ -31,12 +31,9 @@ namespace blocksci {
         std::unordered_set<InputPointer> allPointers;
         allPointers.reserve(pointers.size());
         for (auto &pointer : pointers) {
-            auto inputTx = Output(pointer, access).getSpendingTx();
-            if(inputTx) {
-                auto inputPointers = inputTx->getInputPointers(pointer);
-                for (auto &inputPointer : inputPointers) {
-                    allPointers.insert(inputPointer);
-                }
+            auto inputPointer = Output(pointer, access).getSpendingInputPointer();
+            if (inputPointer) {
+                allPointers.insert(*inputPointer);
             }
         }
         return allPointers
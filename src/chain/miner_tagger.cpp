@@ -0,0 +1,276 @@
+//
+//  miner_tagger.cpp
+//  blocksci
+//
+
+#include <blocksci/chain/miner_tagger.hpp>
+#include <blocksci/chain/block.hpp>
+#include <blocksci/chain/blockchain.hpp>
+#include <blocksci/util/thread_pool.hpp>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+
+namespace blocksci {
+    namespace {
+        constexpr uint64_t minerFileMagic = 0x31475452454e494d; // "MINERTG1"
+        constexpr uint32_t minerFileVersion = 1;
+
+        struct MinerFileHeader {
+            uint64_t magic;
+            uint32_t version;
+            uint32_t reserved;
+            uint64_t blockCount;
+            uint64_t fingerprint;
+        };
+
+        static_assert(sizeof(MinerFileHeader) == 32, "Miner label file header must be 32 bytes");
+
+        // The start of the block hash is kept beside each label so that blocks replaced by a reorg can be detected
+        struct MinerFileRecord {
+            uint32_t label;
+            uint32_t hashPrefix;
+        };
+
+        uint32_t hashPrefix(const Block &block) {
+            auto hash = block.getHash();
+            uint32_t prefix;
+            std::memcpy(&prefix, hash.begin(), sizeof(prefix));
+            return prefix;
+        }
+
+        // FNV-1a, which unlike std::hash is stable across platforms and runs
+        void hashBytes(uint64_t &hash, const void *data, size_t size) {
+            auto bytes = reinterpret_cast<const unsigned char *>(data);
+            for (size_t i = 0; i < size; i++) {
+                hash ^= bytes[i];
+                hash *= 0x100000001b3;
+            }
+        }
+
+        void hashString(uint64_t &hash, const std::string &str) {
+            uint64_t size = str.size();
+            hashBytes(hash, &size, sizeof(size));
+            hashBytes(hash, str.data(), str.size());
+        }
+
+        void hashTags(uint64_t &hash, const MinerTagger::TagList &tags) {
+            uint64_t count = tags.size();
+            hashBytes(hash, &count, sizeof(count));
+            for (auto &tag : tags) {
+                hashString(hash, tag.first);
+                hashString(hash, tag.second);
+            }
+        }
+    }
+
+    constexpr uint32_t MinerTagger::unknownLabel;
+
+    MinerTagger::MinerTagger(const TagList &coinbaseTags, const std::vector<std::pair<Address, std::string>> &payoutAddresses, const TagList &fallbackTags) : nodes(1), labelNames{"Unknown"}, fingerprint(0xcbf29ce484222325) {
+        for (size_t i = 0; i < coinbaseTags.size(); i++) {
+            addPattern(coinbaseTags[i].first, labelId(coinbaseTags[i].second), static_cast<uint32_t>(i), false);
+        }
+        for (size_t i = 0; i < fallbackTags.size(); i++) {
+            addPattern(fallbackTags[i].first, labelId(fallbackTags[i].second), static_cast<uint32_t>(i), true);
+        }
+        for (auto &payout : payoutAddresses) {
+            // The first listed name for an address wins, as it does for tags
+            addressLabels.emplace(payout.first, labelId(payout.second));
+        }
+        buildLinks();
+
+        hashTags(fingerprint, coinbaseTags);
+        hashTags(fingerprint, fallbackTags);
+        uint64_t addressCount = payoutAddresses.size();
+        hashBytes(fingerprint, &addressCount, sizeof(addressCount));
+        for (auto &payout : payoutAddresses) {
+            auto type = static_cast<uint32_t>(payout.first.type);
+            hashBytes(fingerprint, &payout.first.scriptNum, sizeof(payout.first.scriptNum));
+            hashBytes(fingerprint, &type, sizeof(type));
+            hashString(fingerprint, payout.second);
+        }
+    }
+
+    uint32_t MinerTagger::labelId(const std::string &name) {
+        auto it = std::find(labelNames.begin(), labelNames.end(), name);
+        if (it != labelNames.end()) {
+            return static_cast<uint32_t>(std::distance(labelNames.begin(), it));
+        }
+        labelNames.push_back(name);
+        return static_cast<uint32_t>(labelNames.size() - 1);
+    }
+
+    void MinerTagger::addPattern(const std::string &tag, uint32_t label, uint32_t priority, bool fallback) {
+        if (tag.empty()) {
+            throw std::invalid_argument("Coinbase tags must not be empty");
+        }
+        uint32_t node = 0;
+        for (auto c : tag) {
+            auto byte = static_cast<unsigned char>(c);
+            auto it = nodes[node].next.find(byte);
+            if (it == nodes[node].next.end()) {
+                nodes.emplace_back();
+                it = nodes[node].next.emplace(byte, static_cast<uint32_t>(nodes.size() - 1)).first;
+            }
+            node = it->second;
+        }
+        auto &existing = nodes[node].pattern;
+        // A repeated tag of the same kind is shadowed by its first occurrence, and coinbase tags shadow fallbacks
+        if (existing == 0 || (patterns[existing - 1].fallback && !fallback)) {
+            patterns.push_back({static_cast<uint32_t>(tag.size()), priority, label, fallback});
+            existing = static_cast<uint32_t>(patterns.size());
+        }
+    }
+
+    // Breadth first so that the fail links of shallower nodes are complete before deeper nodes use them
+    void MinerTagger::buildLinks() {
+        std::deque<uint32_t> queue;
+        // Children of the root fail back to it, which their default fail link already is
+        for (auto &child : nodes[0].next) {
+            queue.push_back(child.second);
+        }
+        while (!queue.empty()) {
+            auto node = queue.front();
+            queue.pop_front();
+            auto fail = nodes[node].fail;
+            nodes[node].output = nodes[node].pattern != 0 ? node : nodes[fail].output;
+            for (auto &child : nodes[node].next) {
+                nodes[child.second].fail = transition(fail, child.first);
+                queue.push_back(child.second);
+            }
+        }
+    }
+
+    uint32_t MinerTagger::transition(uint32_t node, unsigned char c) const {
+        while (true) {
+            auto it = nodes[node].next.find(c);
+            if (it != nodes[node].next.end()) {
+                return it->second;
+            }
+            if (node == 0) {
+                return 0;
+            }
+            node = nodes[node].fail;
+        }
+    }
+
+    MinerTagger::CoinbaseMatch MinerTagger::matchCoinbase(const std::vector<unsigned char> &coinbase) const {
+        // Coinbase tags are ranked by start position then priority, fallback tags by priority alone
+        auto best = std::make_tuple(std::numeric_limits<size_t>::max(), std::numeric_limits<uint32_t>::max(), unknownLabel);
+        auto bestFallback = std::make_pair(std::numeric_limits<uint32_t>::max(), unknownLabel);
+        uint32_t node = 0;
+        for (size_t i = 0; i < coinbase.size(); i++) {
+            node = transition(node, coinbase[i]);
+            for (auto match = nodes[node].output; match != 0; match = nodes[nodes[match].fail].output) {
+                auto &pattern = patterns[nodes[match].pattern - 1];
+                if (pattern.fallback) {
+                    bestFallback = std::min(bestFallback, std::make_pair(pattern.priority, pattern.label));
+                } else {
+                    best = std::min(best, std::make_tuple(i + 1 - pattern.length, pattern.priority, pattern.label));
+                }
+            }
+        }
+        CoinbaseMatch result;
+        result.tagLabel = std::get<2>(best);
+        result.fallbackLabel = bestFallback.second;
+        return result;
+    }
+
+    uint32_t MinerTagger::label(const Block &block) const {
+        auto match = matchCoinbase(block.getCoinbase());
+        if (match.tagLabel != unknownLabel) {
+            return match.tagLabel;
+        }
+        if (!addressLabels.empty()) {
+            auto coinbaseTx = block.coinbaseTx();
+            for (auto output : coinbaseTx.outputs()) {
+                auto it = addressLabels.find(output.getAddress());
+                if (it != addressLabels.end()) {
+                    return it->second;
+                }
+            }
+        }
+        return match.fallbackLabel;
+    }
+
+    std::vector<uint32_t> MinerTagger::labelBlocks(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock) const {
+        endBlock = std::min(endBlock, static_cast<BlockHeight>(chain.size()));
+        if (startBlock >= endBlock) {
+            return {};
+        }
+        constexpr size_t chunkSize = 1024;
+        std::vector<uint32_t> blockLabels(static_cast<size_t>(endBlock - startBlock));
+        ThreadPool::instance().parallelFor((blockLabels.size() + chunkSize - 1) / chunkSize, [&](size_t chunk) {
+            auto end = std::min(blockLabels.size(), (chunk + 1) * chunkSize);
+            for (size_t i = chunk * chunkSize; i < end; i++) {
+                blockLabels[i] = label(chain[startBlock + static_cast<BlockHeight>(i)]);
+            }
+        });
+        return blockLabels;
+    }
+
+    std::vector<uint32_t> MinerTagger::updateSideFile(Blockchain &chain, const std::string &path) const {
+        boost::filesystem::path filePath{path};
+        std::vector<MinerFileRecord> records;
+        if (boost::filesystem::exists(filePath)) {
+            boost::filesystem::ifstream file(filePath, std::ios::binary);
+            MinerFileHeader header;
+            file.read(reinterpret_cast<char *>(&header), sizeof(header));
+            if (!file || header.magic != minerFileMagic) {
+                throw std::runtime_error("Not a miner label file: " + path);
+            }
+            // Files from another version or tagger are rebuilt rather than rejected since they only cache labels
+            if (header.version == minerFileVersion && header.fingerprint == fingerprint) {
+                records.resize(static_cast<size_t>(header.blockCount));
+                file.read(reinterpret_cast<char *>(records.data()), static_cast<std::streamsize>(sizeof(MinerFileRecord) * records.size()));
+                if (!file) {
+                    records.clear();
+                }
+            }
+        }
+
+        auto chainSize = static_cast<BlockHeight>(chain.size());
+        auto kept = std::min(static_cast<BlockHeight>(records.size()), chainSize);
+        while (kept > 0 && records[static_cast<size_t>(kept - 1)].hashPrefix != hashPrefix(chain[kept - 1])) {
+            kept--;
+        }
+        bool changed = static_cast<size_t>(kept) != records.size() || kept < chainSize;
+        records.resize(static_cast<size_t>(kept));
+        auto newLabels = labelBlocks(chain, kept, chainSize);
+        for (size_t i = 0; i < newLabels.size(); i++) {
+            records.push_back({newLabels[i], hashPrefix(chain[kept + static_cast<BlockHeight>(i)])});
+        }
+
+        if (changed) {
+            if (filePath.has_parent_path()) {
+                boost::filesystem::create_directories(filePath.parent_path());
+            }
+            MinerFileHeader header{minerFileMagic, minerFileVersion, 0, records.size(), fingerprint};
+            // Written beside the destination and renamed into place so that readers never see a partial file
+            auto tempPath = filePath;
+            tempPath += boost::filesystem::unique_path(".%%%%-%%%%.tmp");
+            {
+                boost::filesystem::ofstream file(tempPath, std::ios::binary);
+                file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+                file.write(reinterpret_cast<const char *>(records.data()), static_cast<std::streamsize>(sizeof(MinerFileRecord) * records.size()));
+                if (!file) {
+                    throw std::runtime_error("Failed to write miner labels to " + path);
+                }
+            }
+            boost::filesystem::rename(tempPath, filePath);
+        }
+
+        std::vector<uint32_t> blockLabels(records.size());
+        std::transform(records.begin(), records.end(), blockLabels.begin(), [](const MinerFileRecord &record) {
+            return record.label;
+        });
+        return blockLabels;
+    }
+} // namespace blocksci
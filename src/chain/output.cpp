@@ -8,6 +8,7 @@
 
 #include <blocksci/chain/output.hpp>
 #include <blocksci/chain/block.hpp>
+#include <blocksci/chain/transaction.hpp>
 
 #include <sstream>
 
@@ -28,4 +29,28 @@ namespace blocksci {
             return ranges::nullopt;
         }
     }
+    
+    ranges::optional<InputPointer> Output::getSpendingInputPointer() const {
+        if (!isSpent()) {
+            return ranges::nullopt;
+        }
+        auto spendingInputNums = access->getChain().getSpendingInputNums(pointer.txNum);
+        if (spendingInputNums != nullptr && spendingInputNums[pointer.inoutNum] > 0) {
+            return InputPointer{spendingTxIndex, static_cast<uint16_t>(spendingInputNums[pointer.inoutNum] - 1)};
+        }
+        auto inputPointers = Transaction(spendingTxIndex, *access).getInputPointers(pointer);
+        if (inputPointers.empty()) {
+            return ranges::nullopt;
+        }
+        return inputPointers.front();
+    }
+    
+    ranges::optional<Input> Output::getSpendingInput() const {
+        auto inputPointer = getSpendingInputPointer();
+        if (inputPointer) {
+            return Input(*inputPointer, *access);
+        } else {
+            return ranges::nullopt;
+        }
+    }
 } // namespace blocksci
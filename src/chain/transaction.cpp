@@ -65,6 +65,13 @@ namespace blocksci {
     std::vector<InputPointer> Transaction::getInputPointers(const OutputPointer &pointer) const {
         std::vector<InputPointer> pointers;
         auto output = Output(pointer, *access);
+        auto spendingInputNums = access->getChain().getSpendingInputNums(pointer.txNum);
+        if (spendingInputNums != nullptr && spendingInputNums[pointer.inoutNum] > 0) {
+            if (output.isSpent() && *output.getSpendingTxIndex() == txNum) {
+                pointers.emplace_back(txNum, static_cast<uint16_t>(spendingInputNums[pointer.inoutNum] - 1));
+            }
+            return pointers;
+        }
         auto address = output.getAddress();
         auto search = Inout{pointer.txNum, address.scriptNum, address.type, output.getValue()};
         uint16_t i = 0;
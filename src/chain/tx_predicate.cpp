@@ -0,0 +1,470 @@
+//
+//  tx_predicate.cpp
+//  blocksci
+//
+
+#include <blocksci/chain/tx_predicate.hpp>
+
+#include "chain_fields.hpp"
+
+#include <blocksci/chain/blockchain.hpp>
+#include <blocksci/chain/chain_access.hpp>
+#include <blocksci/chain/input.hpp>
+#include <blocksci/chain/output.hpp>
+#include <blocksci/chain/transaction.hpp>
+#include <blocksci/core/inout_kernels.hpp>
+#include <blocksci/core/raw_transaction.hpp>
+
+#include <range/v3/utility/optional.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace blocksci {
+    namespace internal {
+        struct PredicateNode {
+            enum class Kind {
+                Constant, Compare, And, Or, Not, AnyInput, AllInputs, AnyOutput, AllOutputs, CountInputs, CountOutputs
+            };
+
+            Kind kind;
+            // TxField or InoutField depending on whether this is a transaction or inout node
+            int field = 0;
+            Comparison comparison = Comparison::Equal;
+            int64_t value = 0;
+            std::shared_ptr<const PredicateNode> left;
+            std::shared_ptr<const PredicateNode> right;
+            // Rough number of inouts touched per evaluation, used to run cheap tests first in And and Or
+            uint32_t cost = 1;
+
+            explicit PredicateNode(Kind kind_) : kind(kind_) {}
+        };
+    }
+
+    namespace {
+        using internal::PredicateNode;
+        using internal::TxContext;
+        using internal::inoutFieldValue;
+        using NodePtr = std::shared_ptr<const PredicateNode>;
+
+        bool compareValues(Comparison comparison, int64_t a, int64_t b) {
+            switch (comparison) {
+                case Comparison::Equal:
+                    return a == b;
+                case Comparison::NotEqual:
+                    return a != b;
+                case Comparison::Less:
+                    return a < b;
+                case Comparison::LessEqual:
+                    return a <= b;
+                case Comparison::Greater:
+                    return a > b;
+                case Comparison::GreaterEqual:
+                    return a >= b;
+            }
+            return false;
+        }
+
+        const char *comparisonString(Comparison comparison) {
+            switch (comparison) {
+                case Comparison::Equal:
+                    return "==";
+                case Comparison::NotEqual:
+                    return "!=";
+                case Comparison::Less:
+                    return "<";
+                case Comparison::LessEqual:
+                    return "<=";
+                case Comparison::Greater:
+                    return ">";
+                case Comparison::GreaterEqual:
+                    return ">=";
+            }
+            return "?";
+        }
+
+        const char *fieldString(TxField field) {
+            switch (field) {
+                case TxField::Index:
+                    return "index";
+                case TxField::BlockHeight:
+                    return "block_height";
+                case TxField::InputCount:
+                    return "input_count";
+                case TxField::OutputCount:
+                    return "output_count";
+                case TxField::Size:
+                    return "size_bytes";
+                case TxField::TotalSize:
+                    return "total_size";
+                case TxField::BaseSize:
+                    return "base_size";
+                case TxField::Weight:
+                    return "weight";
+                case TxField::Locktime:
+                    return "locktime";
+                case TxField::InputValue:
+                    return "input_value";
+                case TxField::OutputValue:
+                    return "output_value";
+                case TxField::Fee:
+                    return "fee";
+            }
+            return "?";
+        }
+
+        const char *fieldString(InoutField field) {
+            switch (field) {
+                case InoutField::Value:
+                    return "value";
+                case InoutField::AddressType:
+                    return "address_type";
+                case InoutField::AddressNum:
+                    return "address_num";
+                case InoutField::LinkedTxIndex:
+                    return "linked_tx_index";
+                case InoutField::Age:
+                    return "age";
+            }
+            return "?";
+        }
+
+        bool evalInout(const PredicateNode &node, const Inout &inout, bool isInput, BlockHeight height, const ChainAccess &chain) {
+            switch (node.kind) {
+                case PredicateNode::Kind::Constant:
+                    return node.value != 0;
+                case PredicateNode::Kind::Compare:
+                    return compareValues(node.comparison, inoutFieldValue(static_cast<InoutField>(node.field), inout, isInput, height, chain), node.value);
+                case PredicateNode::Kind::And:
+                    return evalInout(*node.left, inout, isInput, height, chain) && evalInout(*node.right, inout, isInput, height, chain);
+                case PredicateNode::Kind::Or:
+                    return evalInout(*node.left, inout, isInput, height, chain) || evalInout(*node.right, inout, isInput, height, chain);
+                case PredicateNode::Kind::Not:
+                    return !evalInout(*node.left, inout, isInput, height, chain);
+                default:
+                    return false;
+            }
+        }
+
+        int64_t countMatches(const PredicateNode &node, const Inout *begin, const Inout *end, bool isInput, const TxContext &context) {
+            int64_t count = 0;
+            for (auto it = begin; it != end; ++it) {
+                count += evalInout(node, *it, isInput, context.getHeight(), context.getChain());
+            }
+            return count;
+        }
+
+        bool evalTx(const PredicateNode &node, const TxContext &context) {
+            const auto &tx = context.getTx();
+            switch (node.kind) {
+                case PredicateNode::Kind::Constant:
+                    return node.value != 0;
+                case PredicateNode::Kind::Compare:
+                    return compareValues(node.comparison, context.fieldValue(static_cast<TxField>(node.field)), node.value);
+                case PredicateNode::Kind::And:
+                    return evalTx(*node.left, context) && evalTx(*node.right, context);
+                case PredicateNode::Kind::Or:
+                    return evalTx(*node.left, context) || evalTx(*node.right, context);
+                case PredicateNode::Kind::Not:
+                    return !evalTx(*node.left, context);
+                case PredicateNode::Kind::AnyInput:
+                    return std::any_of(tx.beginInputs(), tx.endInputs(), [&](const Inout &inout) {
+                        return evalInout(*node.left, inout, true, context.getHeight(), context.getChain());
+                    });
+                case PredicateNode::Kind::AllInputs:
+                    return std::all_of(tx.beginInputs(), tx.endInputs(), [&](const Inout &inout) {
+                        return evalInout(*node.left, inout, true, context.getHeight(), context.getChain());
+                    });
+                case PredicateNode::Kind::AnyOutput:
+                    return std::any_of(tx.beginOutputs(), tx.endOutputs(), [&](const Inout &inout) {
+                        return evalInout(*node.left, inout, false, context.getHeight(), context.getChain());
+                    });
+                case PredicateNode::Kind::AllOutputs:
+                    return std::all_of(tx.beginOutputs(), tx.endOutputs(), [&](const Inout &inout) {
+                        return evalInout(*node.left, inout, false, context.getHeight(), context.getChain());
+                    });
+                case PredicateNode::Kind::CountInputs:
+                    return compareValues(node.comparison, countMatches(*node.left, tx.beginInputs(), tx.endInputs(), true, context), node.value);
+                case PredicateNode::Kind::CountOutputs:
+                    return compareValues(node.comparison, countMatches(*node.left, tx.beginOutputs(), tx.endOutputs(), false, context), node.value);
+            }
+            return false;
+        }
+
+        void printNode(std::ostream &os, const PredicateNode &node, bool isTxNode) {
+            switch (node.kind) {
+                case PredicateNode::Kind::Constant:
+                    os << (node.value != 0 ? "True" : "False");
+                    break;
+                case PredicateNode::Kind::Compare:
+                    if (isTxNode) {
+                        os << fieldString(static_cast<TxField>(node.field));
+                    } else {
+                        os << fieldString(static_cast<InoutField>(node.field));
+                    }
+                    os << " " << comparisonString(node.comparison) << " " << node.value;
+                    break;
+                case PredicateNode::Kind::And:
+                case PredicateNode::Kind::Or:
+                    os << "(";
+                    printNode(os, *node.left, isTxNode);
+                    os << (node.kind == PredicateNode::Kind::And ? " & " : " | ");
+                    printNode(os, *node.right, isTxNode);
+                    os << ")";
+                    break;
+                case PredicateNode::Kind::Not:
+                    os << "~";
+                    printNode(os, *node.left, isTxNode);
+                    break;
+                case PredicateNode::Kind::AnyInput:
+                case PredicateNode::Kind::AllInputs:
+                case PredicateNode::Kind::AnyOutput:
+                case PredicateNode::Kind::AllOutputs: {
+                    const char *names[] = {"any_input", "all_inputs", "any_output", "all_outputs"};
+                    os << names[static_cast<int>(node.kind) - static_cast<int>(PredicateNode::Kind::AnyInput)] << "(";
+                    printNode(os, *node.left, false);
+                    os << ")";
+                    break;
+                }
+                case PredicateNode::Kind::CountInputs:
+                case PredicateNode::Kind::CountOutputs:
+                    os << (node.kind == PredicateNode::Kind::CountInputs ? "count_inputs(" : "count_outputs(");
+                    printNode(os, *node.left, false);
+                    os << ") " << comparisonString(node.comparison) << " " << node.value;
+                    break;
+            }
+        }
+
+        NodePtr makeConstant(bool value) {
+            auto node = std::make_shared<PredicateNode>(PredicateNode::Kind::Constant);
+            node->value = value;
+            return node;
+        }
+
+        NodePtr makeCompare(int field, Comparison comparison, int64_t value, uint32_t cost) {
+            auto node = std::make_shared<PredicateNode>(PredicateNode::Kind::Compare);
+            node->field = field;
+            node->comparison = comparison;
+            node->value = value;
+            node->cost = cost;
+            return node;
+        }
+
+        bool isConstant(const NodePtr &node, bool value) {
+            return node->kind == PredicateNode::Kind::Constant && (node->value != 0) == value;
+        }
+
+        // Constant operands are folded away and the cheaper operand is tested first so it can short circuit the other
+        NodePtr makeJunction(PredicateNode::Kind kind, NodePtr a, NodePtr b) {
+            bool identity = kind == PredicateNode::Kind::And;
+            if (isConstant(a, identity)) {
+                return b;
+            }
+            if (isConstant(b, identity)) {
+                return a;
+            }
+            if (isConstant(a, !identity) || isConstant(b, !identity)) {
+                return makeConstant(!identity);
+            }
+            if (b->cost < a->cost) {
+                std::swap(a, b);
+            }
+            auto node = std::make_shared<PredicateNode>(kind);
+            node->cost = a->cost + b->cost;
+            node->left = std::move(a);
+            node->right = std::move(b);
+            return node;
+        }
+
+        NodePtr makeNot(const NodePtr &a) {
+            if (a->kind == PredicateNode::Kind::Constant) {
+                return makeConstant(a->value == 0);
+            }
+            if (a->kind == PredicateNode::Kind::Not) {
+                return a->left;
+            }
+            auto node = std::make_shared<PredicateNode>(PredicateNode::Kind::Not);
+            node->cost = a->cost;
+            node->left = a;
+            return node;
+        }
+
+        std::shared_ptr<PredicateNode> makeQuantifier(PredicateNode::Kind kind, const NodePtr &inoutNode) {
+            auto node = std::make_shared<PredicateNode>(kind);
+            // Quantifiers touch every inout so they are always tested after plain transaction fields
+            node->cost = 16 * inoutNode->cost;
+            node->left = inoutNode;
+            return node;
+        }
+
+        uint32_t txFieldCost(TxField field) {
+            switch (field) {
+                case TxField::InputValue:
+                case TxField::OutputValue:
+                    return 8;
+                case TxField::Fee:
+                    return 16;
+                default:
+                    return 1;
+            }
+        }
+    }
+
+    InoutPredicate InoutPredicate::constant(bool value) {
+        return InoutPredicate{makeConstant(value)};
+    }
+
+    InoutPredicate InoutPredicate::compare(InoutField field, Comparison comparison, int64_t value) {
+        // Age needs a random lookup into the transaction height index
+        auto cost = field == InoutField::Age ? 4u : 1u;
+        return InoutPredicate{makeCompare(static_cast<int>(field), comparison, value, cost)};
+    }
+
+    InoutPredicate InoutPredicate::operator&&(const InoutPredicate &other) const {
+        return InoutPredicate{makeJunction(PredicateNode::Kind::And, node, other.node)};
+    }
+
+    InoutPredicate InoutPredicate::operator||(const InoutPredicate &other) const {
+        return InoutPredicate{makeJunction(PredicateNode::Kind::Or, node, other.node)};
+    }
+
+    InoutPredicate InoutPredicate::operator!() const {
+        return InoutPredicate{makeNot(node)};
+    }
+
+    bool InoutPredicate::operator()(const Input &input) const {
+        auto &chain = input.getAccess().getChain();
+        auto &inout = chain.getTx(input.txIndex())->getInput(static_cast<uint16_t>(input.inputIndex()));
+        return evalInout(*node, inout, true, input.blockHeight, chain);
+    }
+
+    bool InoutPredicate::operator()(const Output &output) const {
+        auto &chain = output.getAccess().getChain();
+        auto &inout = chain.getTx(output.txIndex())->getOutput(static_cast<uint16_t>(output.outputIndex()));
+        return evalInout(*node, inout, false, output.getBlockHeight(), chain);
+    }
+
+    std::string InoutPredicate::toString() const {
+        std::stringstream ss;
+        printNode(ss, *node, false);
+        return ss.str();
+    }
+
+    TxPredicate TxPredicate::constant(bool value) {
+        return TxPredicate{makeConstant(value)};
+    }
+
+    TxPredicate TxPredicate::compare(TxField field, Comparison comparison, int64_t value) {
+        return TxPredicate{makeCompare(static_cast<int>(field), comparison, value, txFieldCost(field))};
+    }
+
+    TxPredicate TxPredicate::anyInput(const InoutPredicate &predicate) {
+        return TxPredicate{makeQuantifier(PredicateNode::Kind::AnyInput, predicate.node)};
+    }
+
+    TxPredicate TxPredicate::allInputs(const InoutPredicate &predicate) {
+        return TxPredicate{makeQuantifier(PredicateNode::Kind::AllInputs, predicate.node)};
+    }
+
+    TxPredicate TxPredicate::anyOutput(const InoutPredicate &predicate) {
+        return TxPredicate{makeQuantifier(PredicateNode::Kind::AnyOutput, predicate.node)};
+    }
+
+    TxPredicate TxPredicate::allOutputs(const InoutPredicate &predicate) {
+        return TxPredicate{makeQuantifier(PredicateNode::Kind::AllOutputs, predicate.node)};
+    }
+
+    TxPredicate TxPredicate::countInputs(const InoutPredicate &predicate, Comparison comparison, int64_t value) {
+        auto node = makeQuantifier(PredicateNode::Kind::CountInputs, predicate.node);
+        node->comparison = comparison;
+        node->value = value;
+        return TxPredicate{node};
+    }
+
+    TxPredicate TxPredicate::countOutputs(const InoutPredicate &predicate, Comparison comparison, int64_t value) {
+        auto node = makeQuantifier(PredicateNode::Kind::CountOutputs, predicate.node);
+        node->comparison = comparison;
+        node->value = value;
+        return TxPredicate{node};
+    }
+
+    TxPredicate TxPredicate::operator&&(const TxPredicate &other) const {
+        return TxPredicate{makeJunction(PredicateNode::Kind::And, node, other.node)};
+    }
+
+    TxPredicate TxPredicate::operator||(const TxPredicate &other) const {
+        return TxPredicate{makeJunction(PredicateNode::Kind::Or, node, other.node)};
+    }
+
+    TxPredicate TxPredicate::operator!() const {
+        return TxPredicate{makeNot(node)};
+    }
+
+    bool TxPredicate::operator()(const Transaction &tx) const {
+        auto &chain = tx.getAccess().getChain();
+        return matches(*chain.getTx(tx.txNum), tx.txNum, tx.blockHeight, chain);
+    }
+
+    bool TxPredicate::matches(const RawTransaction &tx, uint32_t txNum, BlockHeight height, const ChainAccess &chain) const {
+        return evalTx(*node, TxContext{tx, txNum, height, chain});
+    }
+
+    std::string TxPredicate::toString() const {
+        std::stringstream ss;
+        printNode(ss, *node, true);
+        return ss.str();
+    }
+
+    std::string fieldName(TxField field) {
+        return fieldString(field);
+    }
+
+    std::string fieldName(InoutField field) {
+        return fieldString(field);
+    }
+
+    TxField txFieldFromName(const std::string &name) {
+        for (auto field : {TxField::Index, TxField::BlockHeight, TxField::InputCount, TxField::OutputCount, TxField::Size, TxField::TotalSize, TxField::BaseSize, TxField::Weight, TxField::Locktime, TxField::InputValue, TxField::OutputValue, TxField::Fee}) {
+            if (name == fieldString(field)) {
+                return field;
+            }
+        }
+        throw std::invalid_argument("Unknown transaction field " + name);
+    }
+
+    InoutField inoutFieldFromName(const std::string &name) {
+        for (auto field : {InoutField::Value, InoutField::AddressType, InoutField::AddressNum, InoutField::LinkedTxIndex, InoutField::Age}) {
+            if (name == fieldString(field)) {
+                return field;
+            }
+        }
+        throw std::invalid_argument("Unknown input or output field " + name);
+    }
+
+    std::vector<Transaction> filter(Blockchain &chain, BlockHeight startBlock, BlockHeight endBlock, const TxPredicate &predicate) {
+        auto &access = chain.getAccess();
+        auto &chainAccess = access.getChain();
+        auto mapFunc = [&](const std::vector<Block> &segment) {
+            std::vector<Transaction> txes;
+            for (auto &block : segment) {
+                auto height = block.height();
+                for (auto txNum = block.firstTxIndex(); txNum < block.endTxIndex(); txNum++) {
+                    auto tx = chainAccess.getTx(txNum);
+                    if (predicate.matches(*tx, txNum, height, chainAccess)) {
+                        txes.emplace_back(tx, txNum, height, access);
+                    }
+                }
+            }
+            return txes;
+        };
+
+        auto reduceFunc = [] (std::vector<Transaction> &vec1, std::vector<Transaction> &vec2) -> std::vector<Transaction> & {
+            vec1.reserve(vec1.size() + vec2.size());
+            vec1.insert(vec1.end(), std::make_move_iterator(vec2.begin()), std::make_move_iterator(vec2.end()));
+            return vec1;
+        };
+
+        return chain.mapReduce<std::vector<Transaction>>(startBlock, endBlock, mapFunc, reduceFunc);
+    }
+} // namespace blocksci
@@ -0,0 +1,415 @@
+//
+//  utxo_set.cpp
+//  blocksci
+//
+
+#include <blocksci/chain/utxo_set.hpp>
+#include <blocksci/chain/blockchain.hpp>
+#include <blocksci/chain/chain_access.hpp>
+#include <blocksci/core/raw_transaction.hpp>
+#include <blocksci/util/thread_pool.hpp>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+namespace blocksci {
+    namespace {
+        constexpr uint64_t utxoFileMagic = 0x315445534f585455; // "UTXOSET1"
+        constexpr uint32_t utxoFileVersion = 1;
+
+        struct UtxoFileHeader {
+            uint64_t magic;
+            uint32_t version;
+            int32_t height;
+            uint64_t count;
+            uint64_t reserved;
+            uint256 lastBlockHash;
+        };
+
+        static_assert(sizeof(UtxoFileHeader) == 64, "UTXO file header must be 64 bytes");
+
+        struct UtxoRow {
+            uint32_t txNum;
+            uint16_t outputNum;
+            int64_t value;
+            AddressType::Enum type;
+            uint32_t addressNum;
+            BlockHeight height;
+
+            bool operator<(const UtxoRow &other) const {
+                return std::tie(txNum, outputNum) < std::tie(other.txNum, other.outputNum);
+            }
+
+            bool operator==(const UtxoRow &other) const {
+                return txNum == other.txNum && outputNum == other.outputNum;
+            }
+        };
+
+        void pushRow(UtxoSet &set, const UtxoRow &row) {
+            set.txNums.push_back(row.txNum);
+            set.outputNums.push_back(row.outputNum);
+            set.values.push_back(row.value);
+            set.types.push_back(row.type);
+            set.addressNums.push_back(row.addressNum);
+            set.heights.push_back(row.height);
+        }
+
+        UtxoRow getRow(const UtxoSet &set, size_t i) {
+            return {set.txNums[i], set.outputNums[i], set.values[i], set.types[i], set.addressNums[i], set.heights[i]};
+        }
+
+        void reserveRows(UtxoSet &set, size_t count) {
+            set.txNums.reserve(count);
+            set.outputNums.reserve(count);
+            set.values.reserve(count);
+            set.types.reserve(count);
+            set.addressNums.reserve(count);
+            set.heights.reserve(count);
+        }
+
+        void checkHeight(Blockchain &chain, BlockHeight height) {
+            if (height < 0 || height > static_cast<BlockHeight>(chain.size())) {
+                throw std::out_of_range("UTXO set height out of range");
+            }
+        }
+
+        // Index of the first transaction in block height, so that transactions below it are those in the blocks [0, height)
+        uint32_t txCutoffAtHeight(Blockchain &chain, BlockHeight height) {
+            return height > 0 ? chain[height - 1].endTxIndex() : 0;
+        }
+
+        uint256 hashBeforeHeight(Blockchain &chain, BlockHeight height) {
+            return height > 0 ? chain[height - 1].getHash() : uint256{};
+        }
+
+        bool spentBefore(const Inout &output, uint32_t txCutoff, uint32_t maxLoadedTx) {
+            auto spendingTx = output.getLinkedTxNum();
+            return spendingTx > 0 && spendingTx < maxLoadedTx && spendingTx < txCutoff;
+        }
+
+        UtxoFileHeader readHeader(std::istream &file, const std::string &path) {
+            UtxoFileHeader header;
+            file.read(reinterpret_cast<char *>(&header), sizeof(header));
+            if (!file || header.magic != utxoFileMagic) {
+                throw std::runtime_error("Not a UTXO set file: " + path);
+            }
+            if (header.version != utxoFileVersion) {
+                throw std::runtime_error("Unsupported UTXO set file version: " + path);
+            }
+            return header;
+        }
+
+        template <typename T>
+        void writeColumn(std::ostream &file, const std::vector<T> &column) {
+            file.write(reinterpret_cast<const char *>(column.data()), static_cast<std::streamsize>(sizeof(T) * column.size()));
+        }
+
+        template <typename T>
+        void readColumn(std::istream &file, std::vector<T> &column, size_t count) {
+            column.resize(count);
+            file.read(reinterpret_cast<char *>(column.data()), static_cast<std::streamsize>(sizeof(T) * count));
+        }
+    }
+
+    UtxoSet &UtxoSet::merge(UtxoSet &other) {
+        txNums.insert(txNums.end(), other.txNums.begin(), other.txNums.end());
+        outputNums.insert(outputNums.end(), other.outputNums.begin(), other.outputNums.end());
+        values.insert(values.end(), other.values.begin(), other.values.end());
+        types.insert(types.end(), other.types.begin(), other.types.end());
+        addressNums.insert(addressNums.end(), other.addressNums.begin(), other.addressNums.end());
+        heights.insert(heights.end(), other.heights.begin(), other.heights.end());
+        return *this;
+    }
+
+    UtxoSet UtxoSet::scanOutputs(Blockchain &chain, BlockHeight start, BlockHeight end, uint32_t txCutoff) {
+        if (start >= end) {
+            return UtxoSet{};
+        }
+        auto &chainAccess = chain.getAccess().getChain();
+        auto maxLoadedTx = chainAccess.maxLoadedTx();
+        auto mapFunc = [&](const std::vector<Block> &segment) {
+            UtxoSet set;
+            for (auto &block : segment) {
+                for (auto txNum = block.firstTxIndex(); txNum < block.endTxIndex(); txNum++) {
+                    auto tx = chainAccess.getTx(txNum);
+                    for (uint16_t i = 0; i < tx->outputCount; i++) {
+                        auto &output = tx->getOutput(i);
+                        if (!spentBefore(output, txCutoff, maxLoadedTx)) {
+                            pushRow(set, {txNum, i, output.getValue(), output.getType(), output.getAddressNum(), block.height()});
+                        }
+                    }
+                }
+            }
+            return set;
+        };
+        // Segments are reduced in order so the result stays sorted by output pointer
+        auto reduceFunc = [](UtxoSet &a, UtxoSet &b) -> UtxoSet & {
+            return a.merge(b);
+        };
+        return chain.mapReduce<UtxoSet>(start, end, mapFunc, reduceFunc);
+    }
+
+    UtxoSet UtxoSet::compute(Blockchain &chain, BlockHeight height) {
+        checkHeight(chain, height);
+        auto set = scanOutputs(chain, 0, height, txCutoffAtHeight(chain, height));
+        set.setHeight = height;
+        set.lastBlockHash = hashBeforeHeight(chain, height);
+        return set;
+    }
+
+    UtxoSet UtxoSet::derive(Blockchain &chain, BlockHeight height) const {
+        checkHeight(chain, height);
+        if (!matches(chain)) {
+            throw std::runtime_error("UTXO set does not match the loaded chain");
+        }
+        if (height == setHeight) {
+            return *this;
+        }
+        auto &chainAccess = chain.getAccess().getChain();
+        auto maxLoadedTx = chainAccess.maxLoadedTx();
+        auto txCutoff = txCutoffAtHeight(chain, height);
+        auto reduceFunc = [](UtxoSet &a, UtxoSet &b) -> UtxoSet & {
+            return a.merge(b);
+        };
+
+        UtxoSet set;
+        if (height > setHeight) {
+            // Keep the outputs not spent by the new blocks, then add the new blocks' outputs which all sort after them
+            auto taskCount = ThreadPool::instance().threadCount() * internal::chunksPerThread;
+            auto chunkSize = (size() + taskCount - 1) / taskCount;
+            set = parallelMapReduce<UtxoSet>(taskCount, [&](size_t task) {
+                UtxoSet kept;
+                auto chunkEnd = std::min(size(), (task + 1) * chunkSize);
+                for (auto i = task * chunkSize; i < chunkEnd; i++) {
+                    if (!spentBefore(chainAccess.getTx(txNums[i])->getOutput(outputNums[i]), txCutoff, maxLoadedTx)) {
+                        pushRow(kept, getRow(*this, i));
+                    }
+                }
+                return kept;
+            }, reduceFunc);
+            auto added = scanOutputs(chain, setHeight, height, txCutoff);
+            set.merge(added);
+        } else {
+            // Drop the outputs created by the removed blocks and restore the older outputs that those blocks spent
+            auto mapFunc = [&](const std::vector<Block> &segment) {
+                std::vector<UtxoRow> restored;
+                if (segment.empty()) {
+                    return restored;
+                }
+                for (auto txNum = segment.front().firstTxIndex(); txNum < segment.back().endTxIndex(); txNum++) {
+                    auto tx = chainAccess.getTx(txNum);
+                    for (uint16_t i = 0; i < tx->inputCount; i++) {
+                        auto spentTxNum = tx->getInput(i).getLinkedTxNum();
+                        if (spentTxNum >= txCutoff) {
+                            continue;
+                        }
+                        // Inputs don't record the output they spend, so restore every output of the spent tx spent by this tx
+                        auto spentTx = chainAccess.getTx(spentTxNum);
+                        for (uint16_t j = 0; j < spentTx->outputCount; j++) {
+                            auto &output = spentTx->getOutput(j);
+                            if (output.getLinkedTxNum() == txNum) {
+                                restored.push_back({spentTxNum, j, output.getValue(), output.getType(), output.getAddressNum(), 0});
+                            }
+                        }
+                    }
+                }
+                return restored;
+            };
+            auto restoreReduce = [](std::vector<UtxoRow> &a, std::vector<UtxoRow> &b) -> std::vector<UtxoRow> & {
+                a.insert(a.end(), b.begin(), b.end());
+                return a;
+            };
+            auto restored = chain.mapReduce<std::vector<UtxoRow>>(height, setHeight, mapFunc, restoreReduce);
+            std::sort(restored.begin(), restored.end());
+            restored.erase(std::unique(restored.begin(), restored.end()), restored.end());
+            for (auto &row : restored) {
+                row.height = chainAccess.getBlockHeight(row.txNum);
+            }
+
+            auto keptEnd = static_cast<size_t>(std::distance(txNums.begin(), std::lower_bound(txNums.begin(), txNums.end(), txCutoff)));
+            reserveRows(set, keptEnd + restored.size());
+            size_t i = 0;
+            auto restoredIt = restored.begin();
+            while (i < keptEnd || restoredIt != restored.end()) {
+                if (restoredIt == restored.end() || (i < keptEnd && getRow(*this, i) < *restoredIt)) {
+                    pushRow(set, getRow(*this, i++));
+                } else {
+                    pushRow(set, *restoredIt++);
+                }
+            }
+        }
+        set.setHeight = height;
+        set.lastBlockHash = hashBeforeHeight(chain, height);
+        return set;
+    }
+
+    bool UtxoSet::matches(Blockchain &chain) const {
+        return setHeight <= static_cast<BlockHeight>(chain.size()) && hashBeforeHeight(chain, setHeight) == lastBlockHash;
+    }
+
+    int64_t UtxoSet::totalValue() const {
+        int64_t total = 0;
+        for (auto value : values) {
+            total += value;
+        }
+        return total;
+    }
+
+    void UtxoSet::save(const std::string &path, bool overwrite) const {
+        boost::filesystem::path filePath{path};
+        if (!overwrite && boost::filesystem::exists(filePath)) {
+            std::stringstream ss;
+            ss << "Overwrite is off, but " << filePath << " exists already";
+            throw std::runtime_error{ss.str()};
+        }
+        if (filePath.has_parent_path()) {
+            boost::filesystem::create_directories(filePath.parent_path());
+        }
+
+        UtxoFileHeader header;
+        header.magic = utxoFileMagic;
+        header.version = utxoFileVersion;
+        header.height = setHeight;
+        header.count = size();
+        header.reserved = 0;
+        header.lastBlockHash = lastBlockHash;
+
+        std::vector<uint8_t> rawTypes(types.size());
+        std::transform(types.begin(), types.end(), rawTypes.begin(), [](AddressType::Enum type) {
+            return static_cast<uint8_t>(type);
+        });
+
+        // Written beside the destination and renamed into place so that readers never see a partial file
+        auto tempPath = filePath;
+        tempPath += boost::filesystem::unique_path(".%%%%-%%%%.tmp");
+        {
+            boost::filesystem::ofstream file(tempPath, std::ios::binary);
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            // Columns are ordered by decreasing element size so that every column is naturally aligned when mapped
+            writeColumn(file, values);
+            writeColumn(file, txNums);
+            writeColumn(file, addressNums);
+            writeColumn(file, heights);
+            writeColumn(file, outputNums);
+            writeColumn(file, rawTypes);
+            if (!file) {
+                throw std::runtime_error("Failed to write UTXO set to " + path);
+            }
+        }
+        boost::filesystem::rename(tempPath, filePath);
+    }
+
+    UtxoSet UtxoSet::load(const std::string &path) {
+        boost::filesystem::ifstream file(boost::filesystem::path{path}, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("Could not open UTXO set file " + path);
+        }
+        auto header = readHeader(file, path);
+        auto count = static_cast<size_t>(header.count);
+
+        UtxoSet set;
+        set.setHeight = header.height;
+        set.lastBlockHash = header.lastBlockHash;
+        std::vector<uint8_t> rawTypes;
+        readColumn(file, set.values, count);
+        readColumn(file, set.txNums, count);
+        readColumn(file, set.addressNums, count);
+        readColumn(file, set.heights, count);
+        readColumn(file, set.outputNums, count);
+        readColumn(file, rawTypes, count);
+        if (!file) {
+            throw std::runtime_error("Truncated UTXO set file " + path);
+        }
+        set.types.resize(count);
+        std::transform(rawTypes.begin(), rawTypes.end(), set.types.begin(), [](uint8_t type) {
+            return static_cast<AddressType::Enum>(type);
+        });
+        return set;
+    }
+
+    UtxoSnapshotCache::UtxoSnapshotCache(std::string directory_) : directory(std::move(directory_)) {
+        boost::filesystem::create_directories(boost::filesystem::path{directory});
+    }
+
+    std::string UtxoSnapshotCache::snapshotPath(BlockHeight height) const {
+        std::stringstream ss;
+        ss << "utxo_" << height << ".dat";
+        return (boost::filesystem::path{directory} / ss.str()).native();
+    }
+
+    std::vector<BlockHeight> UtxoSnapshotCache::snapshotHeights() const {
+        std::vector<BlockHeight> heights;
+        const std::string prefix = "utxo_";
+        const std::string suffix = ".dat";
+        for (auto &entry : boost::filesystem::directory_iterator(boost::filesystem::path{directory})) {
+            auto name = entry.path().filename().string();
+            if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0 || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+                continue;
+            }
+            auto digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+            if (std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+                heights.push_back(static_cast<BlockHeight>(std::strtol(digits.c_str(), nullptr, 10)));
+            }
+        }
+        std::sort(heights.begin(), heights.end());
+        return heights;
+    }
+
+    UtxoSet UtxoSnapshotCache::get(Blockchain &chain, BlockHeight height, bool saveResult) {
+        checkHeight(chain, height);
+        auto heights = snapshotHeights();
+        std::sort(heights.begin(), heights.end(), [&](BlockHeight a, BlockHeight b) {
+            return std::abs(a - height) < std::abs(b - height);
+        });
+        for (auto snapshotHeight : heights) {
+            // Scanning from genesis is no more work than deriving from a snapshot this far away
+            if (std::abs(snapshotHeight - height) >= height) {
+                break;
+            }
+            if (snapshotHeight > static_cast<BlockHeight>(chain.size())) {
+                continue;
+            }
+            auto path = snapshotPath(snapshotHeight);
+            UtxoSet snapshot;
+            try {
+                boost::filesystem::ifstream file(boost::filesystem::path{path}, std::ios::binary);
+                auto header = readHeader(file, path);
+                if (header.lastBlockHash != hashBeforeHeight(chain, snapshotHeight)) {
+                    // Left behind by a reorg and can never become valid again
+                    file.close();
+                    remove(snapshotHeight);
+                    continue;
+                }
+                file.close();
+                snapshot = UtxoSet::load(path);
+            } catch (const std::runtime_error &) {
+                // A corrupt or truncated snapshot is discarded and replaced by the recomputed set
+                remove(snapshotHeight);
+                continue;
+            }
+            if (snapshotHeight == height) {
+                return snapshot;
+            }
+            auto set = snapshot.derive(chain, height);
+            if (saveResult) {
+                set.save(snapshotPath(height), true);
+            }
+            return set;
+        }
+        auto set = UtxoSet::compute(chain, height);
+        if (saveResult) {
+            set.save(snapshotPath(height), true);
+        }
+        return set;
+    }
+
+    void UtxoSnapshotCache::remove(BlockHeight height) {
+        boost::filesystem::remove(boost::filesystem::path{snapshotPath(height)});
+    }
+} // namespace blocksci
@@ -15,14 +15,17 @@
 #include <blocksci/heuristics/change_address.hpp>
 #include <blocksci/heuristics/tx_identification.hpp>
 #include <blocksci/util/progress_bar.hpp>
+#include <blocksci/util/thread_pool.hpp>
 
 #include <dset/dset.h>
 
 #include <boost/filesystem/fstream.hpp>
 #include <boost/filesystem/operations.hpp>
 
+#include <atomic>
 #include <future>
 #include <map>
+#include <mutex>
 
 namespace {
     template <typename Job>
@@ -37,39 +40,17 @@ namespace {
             return;
         }
         
-        auto segmentSize = total / segmentCount;
-        auto segmentsRemaining = total % segmentCount;
-        std::vector<std::pair<uint32_t, uint32_t>> segments;
-        uint32_t i = 0;
-        while(i < total) {
-            uint32_t startSegment = i;
-            i += segmentSize;
-            if (segmentsRemaining > 0) {
-                i += 1;
-                segmentsRemaining--;
+        blocksci::ThreadPool::instance().parallelFor(segmentCount, [&](size_t segmentNum) {
+            auto segmentStart = start + static_cast<uint32_t>(uint64_t{total} * segmentNum / segmentCount);
+            auto segmentEnd = start + static_cast<uint32_t>(uint64_t{total} * (segmentNum + 1) / segmentCount);
+            for (uint32_t i = segmentStart; i < segmentEnd; i++) {
+                job(i);
             }
-            uint32_t endSegment = i;
-            segments.emplace_back(startSegment + start, endSegment);
-        }
-        
-        std::vector<std::thread> threads;
-        for (uint32_t i = 0; i < segmentCount - 1; i++) {
-            auto segment = segments[i];
-            threads.emplace_back([segment, &job](){
-                for (uint32_t i = segment.first; i < segment.second; i++) {
-                    job(i);
-                }
-            });
-        }
-        
-        auto segment = segments.back();
-        for (uint32_t i = segment.first; i < segment.second; i++) {
-            job(i);
-        }
-        
-        for (auto &thread : threads) {
-            thread.join();
-        }
+        });
+    }
+    
+    uint32_t workSegmentCount() {
+        return blocksci::ThreadPool::instance().threadCount() * blocksci::internal::chunksPerThread;
     }
 }
 
@@ -114,7 +95,7 @@ namespace blocksci {
         }
         
         void resolveAll() {
-            segmentWork(0, disjoinSets.size(), 8, [&](uint32_t index) {
+            segmentWork(0, disjoinSets.size(), workSegmentCount(), [&](uint32_t index) {
                 disjoinSets.find(index);
             });
         }
@@ -133,7 +114,7 @@ namespace blocksci {
         auto scriptHashCount = chain.addressCount(AddressType::SCRIPTHASH);
         
         
-        segmentWork(1, scriptHashCount + 1, 8, [&ds, &access](uint32_t index) {
+        segmentWork(1, scriptHashCount + 1, workSegmentCount(), [&ds, &access](uint32_t index) {
             Address pointer(index, AddressType::SCRIPTHASH, access);
             script::ScriptHash scripthash{index, access};
             auto wrappedAddress = scripthash.getWrappedAddress();
@@ -143,33 +124,34 @@ namespace blocksci {
         });
         
         
-        auto extract = [&](const std::vector<Block> &blocks, int threadNum) {
-            uint32_t totalTxCount = 0;
-            auto progressThread = static_cast<int>(std::thread::hardware_concurrency()) - 1;
-            if (threadNum == progressThread) {
-                for (auto &block : blocks) {
-                    totalTxCount += block.size();
-                }
-            }
-            auto progressBar = makeProgressBar(totalTxCount, [=]() {});
-            if (threadNum != progressThread) {
-                progressBar.setSilent();
-            }
-            uint32_t txNum = 0;
+        // Chunks finish out of order, so progress is tracked across all of them and printed by whichever crosses a marker
+        // An empty chain has no last block and nothing to link
+        auto totalTxCount = chain.size() > 0 ? chain[static_cast<BlockHeight>(chain.size()) - 1].endTxIndex() : 0u;
+        auto progressBar = makeProgressBar(totalTxCount, [=]() {});
+        std::atomic<uint64_t> processedTxCount{0};
+        std::mutex progressMutex;
+        
+        auto extract = [&](const std::vector<Block> &blocks) {
             for (auto &block : blocks) {
                 RANGES_FOR(auto tx, block) {
                     auto pairs = processTransaction(tx, changeHeuristic);
                     for (auto &pair : pairs) {
                         ds.link_addresses(pair.first, pair.second);
                     }
-                    progressBar.update(txNum);
-                    txNum++;
+                }
+                auto previousCount = processedTxCount.fetch_add(block.size());
+                auto currentCount = previousCount + block.size();
+                if (currentCount / 10000 != previousCount / 10000) {
+                    std::lock_guard<std::mutex> lock(progressMutex);
+                    progressBar.update(currentCount - currentCount % 10000);
                 }
             }
             return 0;
         };
         
-        chain.mapReduce<int>(0, static_cast<int>(chain.size()), extract, [](int &a,int &) -> int & {return a;});
+        if (chain.size() > 0) {
+            chain.mapReduce<int>(0, static_cast<int>(chain.size()), extract, [](int &a,int &) -> int & {return a;});
+        }
         
         ds.resolveAll();
         
@@ -11,6 +11,8 @@
 #include <boost/filesystem/operations.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
 
+#include <algorithm>
+
 
 namespace {
     boost::iostreams::mapped_file::mapmode getMapMode(blocksci::AccessMode mode) {
@@ -23,11 +25,23 @@ namespace {
         assert(false);
         return boost::iostreams::mapped_file::mapmode::readonly;
     }
+    
+    size_t mappedSizeForFile(size_t size, blocksci::AccessMode mode) {
+        constexpr size_t minimumReserve = size_t{1} << 26;
+        switch (mode) {
+            case blocksci::AccessMode::readwrite:
+                return size;
+            case blocksci::AccessMode::readonly:
+                return size + std::max(size / 4, minimumReserve);
+        }
+        assert(false);
+        return size;
+    }
 }
 
 
 namespace blocksci {
-    SimpleFileMapperBase::SimpleFileMapperBase(const std::string &path_, AccessMode mode) : file(std::make_unique<boost::iostreams::mapped_file>()), fileEnd(0), path(path_ + ".dat"), fileMode(mode) {
+    SimpleFileMapperBase::SimpleFileMapperBase(const std::string &path_, AccessMode mode) : file(std::make_shared<boost::iostreams::mapped_file>()), fileEnd(0), mappedSize(0), path(path_ + ".dat"), fileMode(mode) {
         if (boost::filesystem::exists(path)) {
             openFile(fileSize());
         }
@@ -40,10 +54,15 @@ namespace blocksci {
     void SimpleFileMapperBase::openFile(size_t size) {
         fileEnd = size;
         if (fileEnd != 0) {
-            file->open(path, getMapMode(fileMode));
+            mappedSize = mappedSizeForFile(size, fileMode);
+            boost::iostreams::mapped_file_params params{path};
+            params.flags = getMapMode(fileMode);
+            params.length = mappedSize;
+            file->open(params);
             const_data = file->const_data();
             dataPtr = file->data();
         } else {
+            mappedSize = 0;
             const_data = nullptr;
             dataPtr = nullptr;
         }
@@ -57,16 +76,19 @@ namespace blocksci {
         if (boost::filesystem::exists(path)) {
             auto newSize = fileSize();
             if (newSize != fileEnd) {
-                if (file->is_open()) {
-                    file->close();
+                if (fileMode == AccessMode::readonly && file->is_open() && newSize <= mappedSize) {
+                    // The new tail is already covered by the existing mapping
+                    fileEnd = newSize;
+                    return;
                 }
+                // Views may still reference the old mapping, so it is released rather than closed
+                file = std::make_shared<boost::iostreams::mapped_file>();
                 openFile(newSize);
             }
         } else {
-            if (file->is_open()) {
-                file->close();
-            }
+            file = std::make_shared<boost::iostreams::mapped_file>();
             fileEnd = 0;
+            mappedSize = 0;
             const_data = nullptr;
             dataPtr = nullptr;
         }
@@ -116,6 +138,7 @@ namespace blocksci {
             }
             const_data = file->const_data();
             dataPtr = file->data();
+            mappedSize = fileEnd + buffer.size();
             memcpy(file->data() + fileEnd, buffer.data(), buffer.size());
             fileEnd += buffer.size();
             buffer.clear();
@@ -0,0 +1,552 @@
+//
+//  inout_kernels.cpp
+//  blocksci
+//
+
+#include <blocksci/core/inout_kernels.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BLOCKSCI_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace blocksci { namespace kernels {
+
+    namespace {
+        // The vector versions read the second 64 bit word of each Inout, which packs the value with the address type
+        static_assert(sizeof(Inout) == 16, "Vector kernels depend on the packed Inout layout");
+        static_assert(sizeof(RawTransaction) == sizeof(Inout), "Span kernels step over transactions in 16 byte records");
+
+        constexpr int64_t valueMask = (int64_t{1} << 60) - 1;
+
+        bool isSelected(const Inout &inout, uint32_t typeMask) {
+            return (typeMask >> static_cast<uint32_t>(inout.getType())) & 1;
+        }
+
+        /* Hands the inputs or outputs of every transaction serialized in [txData, txData + size) to acc. Always inlined
+         * so that the accumulator's vector code is inlined into the kernel compiled for its instruction set */
+        template <typename Accumulator>
+        inline __attribute__((always_inline)) void addTransactions(const char *txData, size_t size, InoutSide side, Accumulator &acc) {
+            auto end = txData + size;
+            while (txData < end) {
+                auto tx = reinterpret_cast<const RawTransaction *>(txData);
+                if (side == InoutSide::Inputs) {
+                    acc.add(tx->beginInputs(), tx->endInputs());
+                } else {
+                    acc.add(tx->beginOutputs(), tx->endOutputs());
+                }
+                txData += tx->serializedSize();
+            }
+        }
+
+        template <int64_t (*sumFunc)(const Inout *, const Inout *, uint32_t)>
+        void summarizeFees(const char *txData, size_t size, ValueSummary &summary) {
+            auto end = txData + size;
+            while (txData < end) {
+                auto tx = reinterpret_cast<const RawTransaction *>(txData);
+                if (tx->inputCount > 0) {
+                    summary.add(sumFunc(tx->beginInputs(), tx->endInputs(), allAddressTypes) - sumFunc(tx->beginOutputs(), tx->endOutputs(), allAddressTypes));
+                }
+                txData += tx->serializedSize();
+            }
+        }
+
+        struct SumScalar {
+            uint32_t typeMask;
+            int64_t total = 0;
+
+            explicit SumScalar(uint32_t typeMask_) : typeMask(typeMask_) {}
+
+            void add(const Inout *it, const Inout *end) {
+                for (; it != end; ++it) {
+                    if (isSelected(*it, typeMask)) {
+                        total += it->getValue();
+                    }
+                }
+            }
+        };
+
+        struct SummaryScalar {
+            uint32_t typeMask;
+            ValueSummary &summary;
+
+            SummaryScalar(uint32_t typeMask_, ValueSummary &summary_) : typeMask(typeMask_), summary(summary_) {}
+
+            void add(const Inout *it, const Inout *end) {
+                for (; it != end; ++it) {
+                    if (isSelected(*it, typeMask)) {
+                        summary.add(it->getValue());
+                    }
+                }
+            }
+        };
+
+        struct HistogramScalar {
+            AddressTypeHistogram &histogram;
+
+            explicit HistogramScalar(AddressTypeHistogram &histogram_) : histogram(histogram_) {}
+
+            void add(const Inout *it, const Inout *end) {
+                for (; it != end; ++it) {
+                    auto type = static_cast<size_t>(it->getType());
+                    if (type < AddressType::size) {
+                        histogram.values[type] += it->getValue();
+                        histogram.counts[type]++;
+                    }
+                }
+            }
+        };
+
+        int64_t sumValuesScalar(const Inout *begin, const Inout *end, uint32_t typeMask) {
+            SumScalar acc{typeMask};
+            acc.add(begin, end);
+            return acc.total;
+        }
+
+        void summarizeValuesScalar(const Inout *begin, const Inout *end, uint32_t typeMask, ValueSummary &summary) {
+            SummaryScalar{typeMask, summary}.add(begin, end);
+        }
+
+        void accumulateTypeHistogramScalar(const Inout *begin, const Inout *end, AddressTypeHistogram &histogram) {
+            HistogramScalar{histogram}.add(begin, end);
+        }
+
+        void summarizeTxValuesScalar(const char *txData, size_t size, InoutSide side, uint32_t typeMask, ValueSummary &summary) {
+            SummaryScalar acc{typeMask, summary};
+            addTransactions(txData, size, side, acc);
+        }
+
+        void accumulateTxTypeHistogramScalar(const char *txData, size_t size, InoutSide side, AddressTypeHistogram &histogram) {
+            HistogramScalar acc{histogram};
+            addTransactions(txData, size, side, acc);
+        }
+
+#ifdef BLOCKSCI_X86_KERNELS
+
+        /* The vector accumulators keep their lanes across calls to add, so a span of many short transactions is folded
+         * into a single horizontal reduction in finish. Each add handles its own scalar tail */
+
+        // Packed value and type words of four consecutive inouts
+        __attribute__((target("avx2"))) inline __m256i loadPackedAvx2(const Inout *inouts) {
+            auto first = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(inouts));
+            auto second = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(inouts + 2));
+            return _mm256_unpackhi_epi64(first, second);
+        }
+
+        // All ones in lanes whose address type is in the mask
+        __attribute__((target("avx2"))) inline __m256i selectedLanesAvx2(__m256i packed, __m256i typeMaskVec) {
+            auto one = _mm256_set1_epi64x(1);
+            auto bits = _mm256_and_si256(_mm256_srlv_epi64(typeMaskVec, _mm256_srli_epi64(packed, 60)), one);
+            return _mm256_cmpeq_epi64(bits, one);
+        }
+
+        __attribute__((target("avx2"))) inline int64_t horizontalSumAvx2(__m256i vec) {
+            alignas(32) int64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), vec);
+            return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        }
+
+        struct SumAvx2 {
+            uint32_t typeMask;
+            __m256i valueMaskVec;
+            __m256i typeMaskVec;
+            __m256i totals;
+            int64_t tail = 0;
+
+            __attribute__((target("avx2"))) explicit SumAvx2(uint32_t typeMask_) : typeMask(typeMask_), valueMaskVec(_mm256_set1_epi64x(valueMask)), typeMaskVec(_mm256_set1_epi64x(typeMask_)), totals(_mm256_setzero_si256()) {}
+
+            __attribute__((target("avx2"))) void add(const Inout *it, const Inout *end) {
+                for (; end - it >= 4; it += 4) {
+                    auto packed = loadPackedAvx2(it);
+                    auto values = _mm256_and_si256(packed, valueMaskVec);
+                    totals = _mm256_add_epi64(totals, _mm256_and_si256(values, selectedLanesAvx2(packed, typeMaskVec)));
+                }
+                tail += sumValuesScalar(it, end, typeMask);
+            }
+
+            __attribute__((target("avx2"))) int64_t finish() const {
+                return horizontalSumAvx2(totals) + tail;
+            }
+        };
+
+        struct SummaryAvx2 {
+            SummaryScalar tail;
+            __m256i valueMaskVec;
+            __m256i typeMaskVec;
+            __m256i minSentinel;
+            __m256i maxSentinel;
+            __m256i totals;
+            __m256i counts;
+            __m256i mins;
+            __m256i maxes;
+
+            __attribute__((target("avx2"))) SummaryAvx2(uint32_t typeMask, ValueSummary &summary) : tail(typeMask, summary), valueMaskVec(_mm256_set1_epi64x(valueMask)), typeMaskVec(_mm256_set1_epi64x(typeMask)), minSentinel(_mm256_set1_epi64x(std::numeric_limits<int64_t>::max())), maxSentinel(_mm256_set1_epi64x(std::numeric_limits<int64_t>::min())), totals(_mm256_setzero_si256()), counts(_mm256_setzero_si256()), mins(minSentinel), maxes(maxSentinel) {}
+
+            __attribute__((target("avx2"))) void add(const Inout *it, const Inout *end) {
+                for (; end - it >= 4; it += 4) {
+                    auto packed = loadPackedAvx2(it);
+                    auto values = _mm256_and_si256(packed, valueMaskVec);
+                    auto selected = selectedLanesAvx2(packed, typeMaskVec);
+                    totals = _mm256_add_epi64(totals, _mm256_and_si256(values, selected));
+                    counts = _mm256_sub_epi64(counts, selected);
+                    auto minCandidates = _mm256_blendv_epi8(minSentinel, values, selected);
+                    mins = _mm256_blendv_epi8(mins, minCandidates, _mm256_cmpgt_epi64(mins, minCandidates));
+                    auto maxCandidates = _mm256_blendv_epi8(maxSentinel, values, selected);
+                    maxes = _mm256_blendv_epi8(maxes, maxCandidates, _mm256_cmpgt_epi64(maxCandidates, maxes));
+                }
+                tail.add(it, end);
+            }
+
+            __attribute__((target("avx2"))) void finish() {
+                alignas(32) int64_t minLanes[4];
+                alignas(32) int64_t maxLanes[4];
+                _mm256_store_si256(reinterpret_cast<__m256i *>(minLanes), mins);
+                _mm256_store_si256(reinterpret_cast<__m256i *>(maxLanes), maxes);
+                ValueSummary vectorSummary;
+                vectorSummary.total = horizontalSumAvx2(totals);
+                vectorSummary.count = static_cast<uint64_t>(horizontalSumAvx2(counts));
+                for (int i = 0; i < 4; i++) {
+                    vectorSummary.min = std::min(vectorSummary.min, minLanes[i]);
+                    vectorSummary.max = std::max(vectorSummary.max, maxLanes[i]);
+                }
+                tail.summary.merge(vectorSummary);
+            }
+        };
+
+        struct HistogramAvx2 {
+            HistogramScalar tail;
+            __m256i valueMaskVec;
+            __m256i totals[AddressType::size];
+            __m256i counts[AddressType::size];
+
+            __attribute__((target("avx2"))) explicit HistogramAvx2(AddressTypeHistogram &histogram) : tail(histogram), valueMaskVec(_mm256_set1_epi64x(valueMask)) {
+                for (size_t i = 0; i < AddressType::size; i++) {
+                    totals[i] = _mm256_setzero_si256();
+                    counts[i] = _mm256_setzero_si256();
+                }
+            }
+
+            __attribute__((target("avx2"))) void add(const Inout *it, const Inout *end) {
+                for (; end - it >= 4; it += 4) {
+                    auto packed = loadPackedAvx2(it);
+                    auto values = _mm256_and_si256(packed, valueMaskVec);
+                    auto types = _mm256_srli_epi64(packed, 60);
+                    for (size_t i = 0; i < AddressType::size; i++) {
+                        auto matches = _mm256_cmpeq_epi64(types, _mm256_set1_epi64x(static_cast<int64_t>(i)));
+                        totals[i] = _mm256_add_epi64(totals[i], _mm256_and_si256(values, matches));
+                        counts[i] = _mm256_sub_epi64(counts[i], matches);
+                    }
+                }
+                tail.add(it, end);
+            }
+
+            __attribute__((target("avx2"))) void finish() {
+                for (size_t i = 0; i < AddressType::size; i++) {
+                    tail.histogram.values[i] += horizontalSumAvx2(totals[i]);
+                    tail.histogram.counts[i] += static_cast<uint64_t>(horizontalSumAvx2(counts[i]));
+                }
+            }
+        };
+
+        __attribute__((target("avx2"))) int64_t sumValuesAvx2(const Inout *begin, const Inout *end, uint32_t typeMask) {
+            SumAvx2 acc{typeMask};
+            acc.add(begin, end);
+            return acc.finish();
+        }
+
+        __attribute__((target("avx2"))) void summarizeValuesAvx2(const Inout *begin, const Inout *end, uint32_t typeMask, ValueSummary &summary) {
+            SummaryAvx2 acc{typeMask, summary};
+            acc.add(begin, end);
+            acc.finish();
+        }
+
+        __attribute__((target("avx2"))) void accumulateTypeHistogramAvx2(const Inout *begin, const Inout *end, AddressTypeHistogram &histogram) {
+            HistogramAvx2 acc{histogram};
+            acc.add(begin, end);
+            acc.finish();
+        }
+
+        __attribute__((target("avx2"))) void summarizeTxValuesAvx2(const char *txData, size_t size, InoutSide side, uint32_t typeMask, ValueSummary &summary) {
+            SummaryAvx2 acc{typeMask, summary};
+            addTransactions(txData, size, side, acc);
+            acc.finish();
+        }
+
+        __attribute__((target("avx2"))) void accumulateTxTypeHistogramAvx2(const char *txData, size_t size, InoutSide side, AddressTypeHistogram &histogram) {
+            HistogramAvx2 acc{histogram};
+            addTransactions(txData, size, side, acc);
+            acc.finish();
+        }
+
+        /* GCC 12 implements the unmasked AVX-512 intrinsics and the _mm512_reduce intrinsics on top of an undefined
+         * passthrough vector, which trips -Wmaybe-uninitialized wherever they are inlined. The kernels use the zero
+         * masked forms with every lane selected, which compile to the same instructions, and reduce through memory */
+        constexpr __mmask8 allLanes = 0xFF;
+
+        __attribute__((target("avx512f"))) inline __m512i typesAvx512(__m512i packed) {
+            return _mm512_maskz_srli_epi64(allLanes, packed, 60);
+        }
+
+        // Packed value and type words of eight consecutive inouts
+        __attribute__((target("avx512f"))) inline __m512i loadPackedAvx512(const Inout *inouts) {
+            auto first = _mm512_loadu_si512(reinterpret_cast<const void *>(inouts));
+            auto second = _mm512_loadu_si512(reinterpret_cast<const void *>(inouts + 4));
+            return _mm512_maskz_unpackhi_epi64(allLanes, first, second);
+        }
+
+        __attribute__((target("avx512f"))) inline __mmask8 selectedLanesAvx512(__m512i packed, __m512i typeMaskVec) {
+            auto shifted = _mm512_maskz_srlv_epi64(allLanes, typeMaskVec, typesAvx512(packed));
+            return _mm512_test_epi64_mask(shifted, _mm512_set1_epi64(1));
+        }
+
+        __attribute__((target("avx512f"))) inline void storeLanesAvx512(__m512i vec, int64_t (&lanes)[8]) {
+            _mm512_storeu_si512(reinterpret_cast<void *>(lanes), vec);
+        }
+
+        __attribute__((target("avx512f"))) inline int64_t horizontalSumAvx512(__m512i vec) {
+            int64_t lanes[8];
+            storeLanesAvx512(vec, lanes);
+            int64_t total = 0;
+            for (auto lane : lanes) {
+                total += lane;
+            }
+            return total;
+        }
+
+        struct SumAvx512 {
+            uint32_t typeMask;
+            __m512i valueMaskVec;
+            __m512i typeMaskVec;
+            __m512i totals;
+            int64_t tail = 0;
+
+            __attribute__((target("avx512f"))) explicit SumAvx512(uint32_t typeMask_) : typeMask(typeMask_), valueMaskVec(_mm512_set1_epi64(valueMask)), typeMaskVec(_mm512_set1_epi64(typeMask_)), totals(_mm512_setzero_si512()) {}
+
+            __attribute__((target("avx512f"))) void add(const Inout *it, const Inout *end) {
+                for (; end - it >= 8; it += 8) {
+                    auto packed = loadPackedAvx512(it);
+                    auto values = _mm512_and_si512(packed, valueMaskVec);
+                    totals = _mm512_mask_add_epi64(totals, selectedLanesAvx512(packed, typeMaskVec), totals, values);
+                }
+                tail += sumValuesScalar(it, end, typeMask);
+            }
+
+            __attribute__((target("avx512f"))) int64_t finish() const {
+                return horizontalSumAvx512(totals) + tail;
+            }
+        };
+
+        struct SummaryAvx512 {
+            SummaryScalar tail;
+            __m512i valueMaskVec;
+            __m512i typeMaskVec;
+            __m512i totals;
+            __m512i mins;
+            __m512i maxes;
+            uint64_t count = 0;
+
+            __attribute__((target("avx512f"))) SummaryAvx512(uint32_t typeMask, ValueSummary &summary) : tail(typeMask, summary), valueMaskVec(_mm512_set1_epi64(valueMask)), typeMaskVec(_mm512_set1_epi64(typeMask)), totals(_mm512_setzero_si512()), mins(_mm512_set1_epi64(std::numeric_limits<int64_t>::max())), maxes(_mm512_set1_epi64(std::numeric_limits<int64_t>::min())) {}
+
+            __attribute__((target("avx512f"))) void add(const Inout *it, const Inout *end) {
+                for (; end - it >= 8; it += 8) {
+                    auto packed = loadPackedAvx512(it);
+                    auto values = _mm512_and_si512(packed, valueMaskVec);
+                    auto selected = selectedLanesAvx512(packed, typeMaskVec);
+                    totals = _mm512_mask_add_epi64(totals, selected, totals, values);
+                    mins = _mm512_mask_min_epi64(mins, selected, mins, values);
+                    maxes = _mm512_mask_max_epi64(maxes, selected, maxes, values);
+                    count += static_cast<uint64_t>(__builtin_popcount(selected));
+                }
+                tail.add(it, end);
+            }
+
+            __attribute__((target("avx512f"))) void finish() {
+                int64_t minLanes[8];
+                int64_t maxLanes[8];
+                storeLanesAvx512(mins, minLanes);
+                storeLanesAvx512(maxes, maxLanes);
+                ValueSummary vectorSummary;
+                vectorSummary.total = horizontalSumAvx512(totals);
+                vectorSummary.count = count;
+                for (int i = 0; i < 8; i++) {
+                    vectorSummary.min = std::min(vectorSummary.min, minLanes[i]);
+                    vectorSummary.max = std::max(vectorSummary.max, maxLanes[i]);
+                }
+                tail.summary.merge(vectorSummary);
+            }
+        };
+
+        struct HistogramAvx512 {
+            HistogramScalar tail;
+            __m512i valueMaskVec;
+            __m512i totals[AddressType::size];
+            uint64_t counts[AddressType::size] = {};
+
+            __attribute__((target("avx512f"))) explicit HistogramAvx512(AddressTypeHistogram &histogram) : tail(histogram), valueMaskVec(_mm512_set1_epi64(valueMask)) {
+                for (size_t i = 0; i < AddressType::size; i++) {
+                    totals[i] = _mm512_setzero_si512();
+                }
+            }
+
+            __attribute__((target("avx512f"))) void add(const Inout *it, const Inout *end) {
+                for (; end - it >= 8; it += 8) {
+                    auto packed = loadPackedAvx512(it);
+                    auto values = _mm512_and_si512(packed, valueMaskVec);
+                    auto types = typesAvx512(packed);
+                    for (size_t i = 0; i < AddressType::size; i++) {
+                        auto matches = _mm512_cmpeq_epi64_mask(types, _mm512_set1_epi64(static_cast<int64_t>(i)));
+                        totals[i] = _mm512_mask_add_epi64(totals[i], matches, totals[i], values);
+                        counts[i] += static_cast<uint64_t>(__builtin_popcount(matches));
+                    }
+                }
+                tail.add(it, end);
+            }
+
+            __attribute__((target("avx512f"))) void finish() {
+                for (size_t i = 0; i < AddressType::size; i++) {
+                    tail.histogram.values[i] += horizontalSumAvx512(totals[i]);
+                    tail.histogram.counts[i] += counts[i];
+                }
+            }
+        };
+
+        __attribute__((target("avx512f"))) int64_t sumValuesAvx512(const Inout *begin, const Inout *end, uint32_t typeMask) {
+            SumAvx512 acc{typeMask};
+            acc.add(begin, end);
+            return acc.finish();
+        }
+
+        __attribute__((target("avx512f"))) void summarizeValuesAvx512(const Inout *begin, const Inout *end, uint32_t typeMask, ValueSummary &summary) {
+            SummaryAvx512 acc{typeMask, summary};
+            acc.add(begin, end);
+            acc.finish();
+        }
+
+        __attribute__((target("avx512f"))) void accumulateTypeHistogramAvx512(const Inout *begin, const Inout *end, AddressTypeHistogram &histogram) {
+            HistogramAvx512 acc{histogram};
+            acc.add(begin, end);
+            acc.finish();
+        }
+
+        __attribute__((target("avx512f"))) void summarizeTxValuesAvx512(const char *txData, size_t size, InoutSide side, uint32_t typeMask, ValueSummary &summary) {
+            SummaryAvx512 acc{typeMask, summary};
+            addTransactions(txData, size, side, acc);
+            acc.finish();
+        }
+
+        __attribute__((target("avx512f"))) void accumulateTxTypeHistogramAvx512(const char *txData, size_t size, InoutSide side, AddressTypeHistogram &histogram) {
+            HistogramAvx512 acc{histogram};
+            addTransactions(txData, size, side, acc);
+            acc.finish();
+        }
+
+#endif
+
+        struct KernelTable {
+            const char *name;
+            int64_t (*sumValues)(const Inout *, const Inout *, uint32_t);
+            void (*summarizeValues)(const Inout *, const Inout *, uint32_t, ValueSummary &);
+            void (*accumulateTypeHistogram)(const Inout *, const Inout *, AddressTypeHistogram &);
+            void (*summarizeTxValues)(const char *, size_t, InoutSide, uint32_t, ValueSummary &);
+            void (*accumulateTxTypeHistogram)(const char *, size_t, InoutSide, AddressTypeHistogram &);
+            void (*summarizeTxFees)(const char *, size_t, ValueSummary &);
+        };
+
+        // Widest first
+        const KernelTable kernelTables[] = {
+#ifdef BLOCKSCI_X86_KERNELS
+            {"avx512", sumValuesAvx512, summarizeValuesAvx512, accumulateTypeHistogramAvx512, summarizeTxValuesAvx512, accumulateTxTypeHistogramAvx512, summarizeFees<sumValuesAvx512>},
+            {"avx2", sumValuesAvx2, summarizeValuesAvx2, accumulateTypeHistogramAvx2, summarizeTxValuesAvx2, accumulateTxTypeHistogramAvx2, summarizeFees<sumValuesAvx2>},
+#endif
+            {"scalar", sumValuesScalar, summarizeValuesScalar, accumulateTypeHistogramScalar, summarizeTxValuesScalar, accumulateTxTypeHistogramScalar, summarizeFees<sumValuesScalar>}
+        };
+
+        bool isSupported(const KernelTable &table) {
+#ifdef BLOCKSCI_X86_KERNELS
+            __builtin_cpu_init();
+            if (std::string{table.name} == "avx512") {
+                return __builtin_cpu_supports("avx512f");
+            }
+            if (std::string{table.name} == "avx2") {
+                return __builtin_cpu_supports("avx2");
+            }
+#endif
+            return std::string{table.name} == "scalar";
+        }
+
+        const KernelTable *selectKernels() {
+            for (auto &table : kernelTables) {
+                if (isSupported(table)) {
+                    return &table;
+                }
+            }
+            return &kernelTables[std::size(kernelTables) - 1];
+        }
+
+        // Selected on first use and replaced by setInstructionSet
+        std::atomic<const KernelTable *> &activeTable() {
+            static std::atomic<const KernelTable *> table{selectKernels()};
+            return table;
+        }
+
+        const KernelTable &kernelTable() {
+            return *activeTable().load(std::memory_order_relaxed);
+        }
+    }
+
+    std::string activeInstructionSet() {
+        return kernelTable().name;
+    }
+
+    std::vector<std::string> supportedInstructionSets() {
+        std::vector<std::string> names;
+        for (auto &table : kernelTables) {
+            if (isSupported(table)) {
+                names.emplace_back(table.name);
+            }
+        }
+        return names;
+    }
+
+    void setInstructionSet(const std::string &name) {
+        for (auto &table : kernelTables) {
+            if (table.name == name) {
+                if (!isSupported(table)) {
+                    throw std::invalid_argument(name + " kernels are not supported on this CPU");
+                }
+                activeTable().store(&table, std::memory_order_relaxed);
+                return;
+            }
+        }
+        throw std::invalid_argument("Unknown kernel instruction set " + name);
+    }
+
+    int64_t sumValues(const Inout *begin, const Inout *end, uint32_t typeMask) {
+        return kernelTable().sumValues(begin, end, typeMask);
+    }
+
+    void summarizeValues(const Inout *begin, const Inout *end, uint32_t typeMask, ValueSummary &summary) {
+        kernelTable().summarizeValues(begin, end, typeMask, summary);
+    }
+
+    void accumulateTypeHistogram(const Inout *begin, const Inout *end, AddressTypeHistogram &histogram) {
+        kernelTable().accumulateTypeHistogram(begin, end, histogram);
+    }
+
+    void summarizeTxValues(const char *txData, size_t size, InoutSide side, uint32_t typeMask, ValueSummary &summary) {
+        kernelTable().summarizeTxValues(txData, size, side, typeMask, summary);
+    }
+
+    void accumulateTxTypeHistogram(const char *txData, size_t size, InoutSide side, AddressTypeHistogram &histogram) {
+        kernelTable().accumulateTxTypeHistogram(txData, size, side, histogram);
+    }
+
+    void summarizeTxFees(const char *txData, size_t size, ValueSummary &summary) {
+        kernelTable().summarizeTxFees(txData, size, summary);
+    }
+}} // namespace blocksci::kernels
@@ -42,6 +42,25 @@ namespace blocksci {
         });
     }
     
+    constexpr int AddressIndex::outputPartitionCount;
+    
+    void AddressIndex::visitOutputPartition(AddressType::Enum type, int partition, const std::function<void(uint32_t, const OutputPointer &)> &func) const {
+        auto firstByte = static_cast<char>(static_cast<uint8_t>(partition));
+        auto it = impl->getOutputIterator(type);
+        for (it->Seek(rocksdb::Slice(&firstByte, 1)); it->Valid(); it->Next()) {
+            auto key = it->key();
+            if (key[0] != firstByte) {
+                break;
+            }
+            uint32_t addressNum;
+            OutputPointer outPoint;
+            memcpy(&addressNum, key.data(), sizeof(addressNum));
+            key.remove_prefix(sizeof(addressNum));
+            memcpy(&outPoint, key.data(), sizeof(outPoint));
+            func(addressNum, outPoint);
+        }
+    }
+    
     ranges::any_view<Address> AddressIndex::getIncludingMultisigs(const Address &searchAddress) const {
         if (dedupType(searchAddress.type) != DedupAddressType::PUBKEY) {
             return {};
@@ -0,0 +1,153 @@
+//
+//  address_prefix_index.cpp
+//  blocksci
+//
+
+#include <blocksci/index/address_prefix_index.hpp>
+#include <blocksci/core/script_data.hpp>
+#include <blocksci/scripts/pubkey_script.hpp>
+#include <blocksci/scripts/script_access.hpp>
+#include <blocksci/scripts/scripthash_script.hpp>
+#include <blocksci/util/data_access.hpp>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+
+namespace blocksci {
+    AddressPrefixSegment::AddressPrefixSegment(const std::string &directory) :
+    infoFile(infoFilePath(directory)),
+    scriptsFile(scriptsFilePath(directory)) {}
+
+    std::string AddressPrefixSegment::infoFilePath(const std::string &directory) {
+        return (boost::filesystem::path{directory}/"info").native();
+    }
+
+    std::string AddressPrefixSegment::scriptsFilePath(const std::string &directory) {
+        return (boost::filesystem::path{directory}/"scripts").native();
+    }
+
+    bool AddressPrefixSegment::isComplete() const {
+        return infoFile.size() == 1 && info().typeOffsets.back() == entryCount();
+    }
+
+    std::pair<uint64_t, uint64_t> AddressPrefixSegment::prefixRange(AddressType::Enum type, const std::string &prefix, DataAccess &access) const {
+        auto range = entries(type);
+        // First entry in [first, last) for which pred is false, given that pred is true for a prefix of the range
+        auto partitionPoint = [&](uint64_t first, uint64_t last, auto &&pred) {
+            auto count = last - first;
+            while (count > 0) {
+                auto step = count / 2;
+                if (pred(AddressPrefixIndex::addressString(type, scriptNum(first + step), access))) {
+                    first += step + 1;
+                    count -= step + 1;
+                } else {
+                    count = step;
+                }
+            }
+            return first;
+        };
+        auto lower = partitionPoint(range.first, range.second, [&](const std::string &address) {
+            return address.compare(0, prefix.size(), prefix) < 0;
+        });
+        auto upper = partitionPoint(lower, range.second, [&](const std::string &address) {
+            return address.compare(0, prefix.size(), prefix) == 0;
+        });
+        return {lower, upper};
+    }
+
+    AddressPrefixIndex::AddressPrefixIndex(std::string baseDirectory_, const ScriptAccess &scripts) : baseDirectory(std::move(baseDirectory_)) {
+        setup(scripts);
+    }
+
+    AddressPrefixIndex::~AddressPrefixIndex() = default;
+
+    std::string AddressPrefixIndex::manifestFilePath(const std::string &baseDirectory) {
+        return (boost::filesystem::path{baseDirectory}/"segments.txt").native();
+    }
+
+    std::string AddressPrefixIndex::segmentDirectory(const std::string &baseDirectory, const std::string &segmentName) {
+        return (boost::filesystem::path{baseDirectory}/segmentName).native();
+    }
+
+    std::vector<std::string> AddressPrefixIndex::readManifest(const std::string &baseDirectory) {
+        std::vector<std::string> names;
+        boost::filesystem::ifstream manifest{boost::filesystem::path{manifestFilePath(baseDirectory)}};
+        std::string name;
+        while (manifest >> name) {
+            names.push_back(name);
+        }
+        return names;
+    }
+
+    std::vector<AddressType::Enum> AddressPrefixIndex::indexedTypes(const DataConfiguration &config) {
+        std::vector<AddressType::Enum> types{AddressType::PUBKEYHASH, AddressType::SCRIPTHASH};
+        if (config.segwitPrefix != "NONE") {
+            types.push_back(AddressType::WITNESS_PUBKEYHASH);
+            types.push_back(AddressType::WITNESS_SCRIPTHASH);
+        }
+        return types;
+    }
+
+    std::string AddressPrefixIndex::addressString(AddressType::Enum type, uint32_t scriptNum, DataAccess &access) {
+        switch (type) {
+            case AddressType::PUBKEYHASH:
+                return ScriptAddress<AddressType::PUBKEYHASH>(scriptNum, access).addressString();
+            case AddressType::SCRIPTHASH:
+                return ScriptAddress<AddressType::SCRIPTHASH>(scriptNum, access).addressString();
+            case AddressType::WITNESS_PUBKEYHASH:
+                return ScriptAddress<AddressType::WITNESS_PUBKEYHASH>(scriptNum, access).addressString();
+            case AddressType::WITNESS_SCRIPTHASH:
+                // Pay to script hash scripts only store a 160 bit hash, so they have no witness encoding
+                if (!access.getScripts().getScriptData<DedupAddressType::SCRIPTHASH>(scriptNum)->isSegwit) {
+                    return "";
+                }
+                return ScriptAddress<AddressType::WITNESS_SCRIPTHASH>(scriptNum, access).addressString();
+            default:
+                return "";
+        }
+    }
+
+    void AddressPrefixIndex::setup(const ScriptAccess &scripts) {
+        segments.clear();
+        std::array<uint32_t, DedupAddressType::size> coveredCounts;
+        coveredCounts.fill(0);
+        // Only the prefix of segments that is contiguous and refers to loaded scripts is used
+        for (auto &name : readManifest(baseDirectory)) {
+            auto segment = std::make_unique<AddressPrefixSegment>(segmentDirectory(baseDirectory, name));
+            if (!segment->isComplete() || segment->info().startCounts != coveredCounts) {
+                break;
+            }
+            auto &endCounts = segment->info().endCounts;
+            bool loaded = true;
+            for (size_t i = 0; i < DedupAddressType::size; i++) {
+                loaded &= endCounts[i] <= scripts.scriptCount(static_cast<DedupAddressType::Enum>(i));
+            }
+            if (!loaded) {
+                break;
+            }
+            coveredCounts = endCounts;
+            segments.push_back(std::move(segment));
+        }
+    }
+
+    void AddressPrefixIndex::reload(const ScriptAccess &scripts) {
+        setup(scripts);
+    }
+
+    uint32_t AddressPrefixIndex::scriptCount(DedupAddressType::Enum type) const {
+        return segments.empty() ? 0 : segments.back()->info().endCounts[static_cast<size_t>(type)];
+    }
+
+    std::vector<uint32_t> AddressPrefixIndex::getAddressNumsWithPrefix(AddressType::Enum type, const std::string &prefix, DataAccess &access) const {
+        std::vector<uint32_t> scriptNums;
+        for (auto &segment : segments) {
+            auto range = segment->prefixRange(type, prefix, access);
+            for (auto entry = range.first; entry < range.second; entry++) {
+                scriptNums.push_back(segment->scriptNum(entry));
+            }
+        }
+        return scriptNums;
+    }
+} // namespace blocksci
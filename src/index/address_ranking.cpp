@@ -0,0 +1,119 @@
+//
+//  address_ranking.cpp
+//  blocksci
+//
+
+#include <blocksci/index/address_ranking.hpp>
+#include <blocksci/index/address_index.hpp>
+
+#include <blocksci/chain/blockchain.hpp>
+#include <blocksci/chain/chain_access.hpp>
+#include <blocksci/chain/inout_pointer.hpp>
+#include <blocksci/core/raw_transaction.hpp>
+#include <blocksci/util/thread_pool.hpp>
+
+#include <algorithm>
+#include <tuple>
+
+namespace blocksci {
+    namespace {
+        struct RankEntry {
+            int64_t value;
+            AddressType::Enum type;
+            uint32_t addressNum;
+
+            // Ties are broken by address so that results don't depend on scheduling
+            bool operator>(const RankEntry &other) const {
+                return std::tie(value, type, addressNum) > std::tie(other.value, other.type, other.addressNum);
+            }
+        };
+
+        // Bounded min-heap of the best k entries seen so far
+        struct TopK {
+            size_t k = 0;
+            std::vector<RankEntry> heap;
+
+            void add(const RankEntry &entry) {
+                if (heap.size() < k) {
+                    heap.push_back(entry);
+                    std::push_heap(heap.begin(), heap.end(), std::greater<RankEntry>{});
+                } else if (k > 0 && entry > heap.front()) {
+                    std::pop_heap(heap.begin(), heap.end(), std::greater<RankEntry>{});
+                    heap.back() = entry;
+                    std::push_heap(heap.begin(), heap.end(), std::greater<RankEntry>{});
+                }
+            }
+
+            TopK &merge(const TopK &other) {
+                k = std::max(k, other.k);
+                for (auto &entry : other.heap) {
+                    add(entry);
+                }
+                return *this;
+            }
+        };
+    }
+
+    std::vector<RankedAddress> topAddresses(Blockchain &chain, size_t k, AddressRankMetric metric, ranges::optional<BlockHeight> endHeight) {
+        auto &access = chain.getAccess();
+        auto &chainAccess = access.getChain();
+        const auto &addressIndex = access.getAddressIndex();
+
+        // Outputs created and spends made by transactions before this index are the ones that count
+        auto height = std::min(endHeight.value_or(static_cast<BlockHeight>(chain.size())), static_cast<BlockHeight>(chain.size()));
+        uint32_t txCutoff = height > 0 ? chain[height - 1].endTxIndex() : 0;
+        auto maxLoadedTx = chainAccess.maxLoadedTx();
+
+        auto outputValue = [&](const OutputPointer &pointer) -> int64_t {
+            if (pointer.txNum >= txCutoff) {
+                return 0;
+            }
+            const auto &inout = chainAccess.getTx(pointer.txNum)->getOutput(pointer.inoutNum);
+            if (metric == AddressRankMetric::Balance) {
+                auto spendingTx = inout.getLinkedTxNum();
+                if (spendingTx > 0 && spendingTx < maxLoadedTx && spendingTx < txCutoff) {
+                    return 0;
+                }
+            }
+            return inout.getValue();
+        };
+
+        auto partitionCount = static_cast<size_t>(AddressIndex::outputPartitionCount);
+        auto taskCount = AddressType::size * partitionCount;
+        auto mapFunc = [&](size_t task) {
+            auto type = static_cast<AddressType::Enum>(task / partitionCount);
+            auto partition = static_cast<int>(task % partitionCount);
+            TopK best;
+            best.k = k;
+            RankEntry current{0, type, 0};
+            bool hasCurrent = false;
+            addressIndex.visitOutputPartition(type, partition, [&](uint32_t addressNum, const OutputPointer &pointer) {
+                if (!hasCurrent || addressNum != current.addressNum) {
+                    if (hasCurrent) {
+                        best.add(current);
+                    }
+                    current.addressNum = addressNum;
+                    current.value = 0;
+                    hasCurrent = true;
+                }
+                current.value += outputValue(pointer);
+            });
+            if (hasCurrent) {
+                best.add(current);
+            }
+            return best;
+        };
+        auto reduceFunc = [](TopK &a, TopK &b) -> TopK & {
+            return a.merge(b);
+        };
+        auto best = parallelMapReduce<TopK>(taskCount, mapFunc, reduceFunc);
+
+        std::sort(best.heap.begin(), best.heap.end(), std::greater<RankEntry>{});
+        std::vector<RankedAddress> ranked;
+        ranked.reserve(best.heap.size());
+        for (auto &entry : best.heap) {
+            ranked.push_back(RankedAddress{Address{entry.addressNum, entry.type, access}, entry.value});
+        }
+        return ranked;
+    }
+} // namespace blocksci
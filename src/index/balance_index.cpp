@@ -0,0 +1,154 @@
+//
+//  balance_index.cpp
+//  blocksci
+//
+
+#include <blocksci/index/balance_index.hpp>
+#include <blocksci/chain/chain_access.hpp>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+
+namespace blocksci {
+    BalanceIndexSegment::BalanceIndexSegment(const std::string &directory) :
+    infoFile(infoFilePath(directory)),
+    keysFile(keysFilePath(directory)),
+    offsetsFile(offsetsFilePath(directory)),
+    heightsFile(heightsFilePath(directory)),
+    balancesFile(balancesFilePath(directory)) {}
+
+    std::string BalanceIndexSegment::infoFilePath(const std::string &directory) {
+        return (boost::filesystem::path{directory}/"info").native();
+    }
+
+    std::string BalanceIndexSegment::keysFilePath(const std::string &directory) {
+        return (boost::filesystem::path{directory}/"keys").native();
+    }
+
+    std::string BalanceIndexSegment::offsetsFilePath(const std::string &directory) {
+        return (boost::filesystem::path{directory}/"offsets").native();
+    }
+
+    std::string BalanceIndexSegment::heightsFilePath(const std::string &directory) {
+        return (boost::filesystem::path{directory}/"heights").native();
+    }
+
+    std::string BalanceIndexSegment::balancesFilePath(const std::string &directory) {
+        return (boost::filesystem::path{directory}/"balances").native();
+    }
+
+    bool BalanceIndexSegment::isComplete() const {
+        return infoFile.size() == 1 && offsetsFile.size() == keysFile.size() + 1 && balancesFile.size() == heightsFile.size() && info().typeOffsets.back() == keyCount();
+    }
+
+    std::pair<uint64_t, uint64_t> BalanceIndexSegment::entries(AddressType::Enum type, uint32_t addressNum) const {
+        auto &typeOffsets = info().typeOffsets;
+        auto typeIndex = static_cast<size_t>(type);
+        auto first = typeOffsets[typeIndex];
+        auto last = typeOffsets[typeIndex + 1];
+        if (first == last) {
+            return {0, 0};
+        }
+        auto keys = keysFile[0];
+        auto it = std::lower_bound(keys + first, keys + last, addressNum);
+        if (it == keys + last || *it != addressNum) {
+            return {0, 0};
+        }
+        return entriesOfKey(static_cast<uint64_t>(std::distance(keys, it)));
+    }
+
+    BalanceIndex::BalanceIndex(std::string baseDirectory_, const ChainAccess &chain) : baseDirectory(std::move(baseDirectory_)) {
+        setup(chain);
+    }
+
+    BalanceIndex::~BalanceIndex() = default;
+
+    std::string BalanceIndex::manifestFilePath(const std::string &baseDirectory) {
+        return (boost::filesystem::path{baseDirectory}/"segments.txt").native();
+    }
+
+    std::string BalanceIndex::segmentDirectory(const std::string &baseDirectory, const std::string &segmentName) {
+        return (boost::filesystem::path{baseDirectory}/segmentName).native();
+    }
+
+    std::vector<std::string> BalanceIndex::readManifest(const std::string &baseDirectory) {
+        std::vector<std::string> names;
+        boost::filesystem::ifstream manifest{boost::filesystem::path{manifestFilePath(baseDirectory)}};
+        std::string name;
+        while (manifest >> name) {
+            names.push_back(name);
+        }
+        return names;
+    }
+
+    void BalanceIndex::setup(const ChainAccess &chain) {
+        segments.clear();
+        BlockHeight coveredHeight = 0;
+        // Only the prefix of segments that is contiguous and agrees with the loaded chain is used
+        for (auto &name : readManifest(baseDirectory)) {
+            auto segment = std::make_unique<BalanceIndexSegment>(segmentDirectory(baseDirectory, name));
+            if (!segment->isComplete()) {
+                break;
+            }
+            auto &info = segment->info();
+            if (info.startHeight != coveredHeight || info.endHeight > chain.blockCount() || chain.getBlock(info.endHeight - 1)->hash != info.endBlockHash) {
+                break;
+            }
+            coveredHeight = info.endHeight;
+            segments.push_back(std::move(segment));
+        }
+    }
+
+    void BalanceIndex::reload(const ChainAccess &chain) {
+        setup(chain);
+    }
+
+    BlockHeight BalanceIndex::blockCount() const {
+        return segments.empty() ? 0 : segments.back()->info().endHeight;
+    }
+
+    ranges::optional<int64_t> BalanceIndex::getBalance(AddressType::Enum type, uint32_t addressNum, BlockHeight height) const {
+        if (height < 0 || height >= blockCount()) {
+            return ranges::nullopt;
+        }
+        for (auto it = segments.rbegin(); it != segments.rend(); ++it) {
+            auto &segment = **it;
+            if (segment.info().startHeight > height) {
+                continue;
+            }
+            auto range = segment.entries(type, addressNum);
+            if (range.first == range.second) {
+                continue;
+            }
+            // Last change at or below height
+            auto first = range.first;
+            auto count = range.second - range.first;
+            while (count > 0) {
+                auto step = count / 2;
+                if (segment.height(first + step) <= height) {
+                    first += step + 1;
+                    count -= step + 1;
+                } else {
+                    count = step;
+                }
+            }
+            if (first != range.first) {
+                return segment.balance(first - 1);
+            }
+        }
+        return int64_t{0};
+    }
+
+    std::vector<std::pair<BlockHeight, int64_t>> BalanceIndex::getBalanceHistory(AddressType::Enum type, uint32_t addressNum) const {
+        std::vector<std::pair<BlockHeight, int64_t>> history;
+        for (auto &segment : segments) {
+            auto range = segment->entries(type, addressNum);
+            for (auto entry = range.first; entry < range.second; entry++) {
+                history.emplace_back(segment->height(entry), segment->balance(entry));
+            }
+        }
+        return history;
+    }
+} // namespace blocksci
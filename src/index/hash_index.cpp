@@ -89,6 +89,10 @@ namespace blocksci {
         return impl->getMatch(impl->getTxColumn().get(), txHash);
     }
     
+    std::vector<uint32_t> HashIndex::getTxIndexes(const uint256 *txHashes, size_t count) {
+        return impl->getMatches(impl->getTxColumn().get(), reinterpret_cast<const char *>(txHashes), sizeof(uint256), count);
+    }
+    
     void HashIndex::addAddressesImpl(AddressType::Enum type, std::vector<std::pair<MemoryView, MemoryView>> dataViews) {
         impl->addAddresses(type, dataViews);
     }
@@ -97,6 +101,10 @@ namespace blocksci {
         return impl->getAddressMatch(type, data, size);
     }
     
+    std::vector<uint32_t> HashIndex::lookupAddressesImpl(blocksci::AddressType::Enum type, const char *data, size_t size, size_t count) {
+        return impl->getMatches(impl->getColumn(type).get(), data, size, count);
+    }
+    
     void HashIndex::compactDB() {
         impl->compactDB();
     }
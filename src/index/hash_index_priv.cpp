@@ -8,6 +8,11 @@
 #include "hash_index_priv.hpp"
 
 #include <blocksci/meta.hpp>
+#include <blocksci/util/thread_pool.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
 
 namespace blocksci {
     
@@ -49,6 +54,38 @@ namespace blocksci {
         }
     }
     
+    std::vector<uint32_t> HashIndexPriv::getMatches(rocksdb::ColumnFamilyHandle *handle, const char *keys, size_t keySize, size_t count) {
+        constexpr size_t batchSize = 1024;
+        auto keyAt = [&](size_t i) {
+            return keys + i * keySize;
+        };
+        // Querying in key order makes each batch read neighbouring blocks of the sorted tables
+        std::vector<size_t> order(count);
+        std::iota(order.begin(), order.end(), size_t{0});
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return memcmp(keyAt(a), keyAt(b), keySize) < 0;
+        });
+        std::vector<uint32_t> results(count, 0);
+        ThreadPool::instance().parallelFor((count + batchSize - 1) / batchSize, [&](size_t batch) {
+            auto first = batch * batchSize;
+            auto last = std::min(count, first + batchSize);
+            std::vector<rocksdb::Slice> keySlices;
+            keySlices.reserve(last - first);
+            for (auto i = first; i < last; i++) {
+                keySlices.emplace_back(keyAt(order[i]), keySize);
+            }
+            std::vector<rocksdb::ColumnFamilyHandle *> handles(keySlices.size(), handle);
+            std::vector<std::string> values;
+            auto statuses = db->MultiGet(rocksdb::ReadOptions{}, handles, keySlices, &values);
+            for (size_t i = 0; i < statuses.size(); i++) {
+                if (statuses[i].ok()) {
+                    memcpy(&results[order[first + i]], values[i].data(), sizeof(uint32_t));
+                }
+            }
+        });
+        return results;
+    }
+    
     void HashIndexPriv::compactDB() {
         for (auto &column : columnHandles) {
             db->CompactRange(rocksdb::CompactRangeOptions{}, column.get(), nullptr, nullptr);
@@ -16,6 +16,7 @@
 #include <range/v3/view_facade.hpp>
 
 #include <memory>
+#include <vector>
 
 namespace blocksci {
     class HashIndexPriv {
@@ -52,6 +53,9 @@ namespace blocksci {
             }
         }
         
+        // Values of count keys of keySize bytes stored back to back, 0 for missing keys
+        std::vector<uint32_t> getMatches(rocksdb::ColumnFamilyHandle *handle, const char *keys, size_t keySize, size_t count);
+        
         void addAddresses(AddressType::Enum type, std::vector<std::pair<MemoryView, MemoryView>> dataViews) {
             rocksdb::WriteBatch batch;
             for (auto &pair : dataViews) {
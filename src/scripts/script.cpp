@@ -12,7 +12,7 @@
 
 namespace blocksci {
     
-    ScriptBase::ScriptBase(const Address &address) : ScriptBase(address.scriptNum, address.type, address.getAccess(), address.getAccess().scripts->getScriptHeader(address.scriptNum, dedupType(address.type))) {}
+    ScriptBase::ScriptBase(const Address &address) : ScriptBase(address.scriptNum, address.type, address.getAccess(), address.getAccess().getScripts().getScriptHeader(address.scriptNum, dedupType(address.type))) {}
     
     Transaction ScriptBase::getFirstTransaction() const {
         return Transaction(getFirstTxIndex(), getAccess());
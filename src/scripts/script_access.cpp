@@ -10,6 +10,10 @@
 
 #include <boost/filesystem/path.hpp>
 
+#include <algorithm>
+#include <sstream>
+#include <limits>
+
 namespace blocksci {
     
     namespace internal {
@@ -24,21 +28,34 @@ namespace blocksci {
     ScriptAccess::ScriptAccess(const std::string &baseDirectory) :
         scriptFiles(blocksci::apply(DedupAddressType::all(), [&] (auto tag) {
             return ScriptFile<tag.value>{(boost::filesystem::path{baseDirectory}/std::string{dedupAddressName(tag)}).native()};
-        })) {}
+        })),
+        scriptHotFiles(blocksci::apply(DedupAddressType::all(), [&] (auto tag) {
+            std::stringstream ss;
+            ss << dedupAddressName(tag) << "_hot";
+            return ScriptHotFile<tag.value>{(boost::filesystem::path{baseDirectory}/ss.str()).native()};
+        })) {
+        committedCounts.fill(std::numeric_limits<uint32_t>::max());
+    }
     
     std::array<uint32_t, DedupAddressType::size> ScriptAccess::scriptCounts() const {
-        return make_static_table<DedupAddressType, internal::ScriptCountFunctor>(*this);
+        auto counts = make_static_table<DedupAddressType, internal::ScriptCountFunctor>(*this);
+        for (size_t i = 0; i < counts.size(); i++) {
+            counts[i] = std::min(counts[i], committedCounts[i]);
+        }
+        return counts;
     }
     
     uint32_t ScriptAccess::scriptCount(DedupAddressType::Enum type) const {
         static constexpr auto table = make_dynamic_table<DedupAddressType, internal::ScriptCountFunctor>();
         auto index = static_cast<size_t>(type);
-        return table.at(index)(*this);
+        return std::min(table.at(index)(*this), committedCounts.at(index));
     }
     
     size_t ScriptAccess::totalAddressCount() const {
-        uint32_t count = 0;
-        for_each(scriptFiles, [&count](auto& obj) -> decltype(auto) {count += obj.size();});
+        size_t count = 0;
+        for (auto scriptCount : scriptCounts()) {
+            count += scriptCount;
+        }
         return count;
     }
 } // namespace blocksci
@@ -0,0 +1,362 @@
+//
+//  arrow_writer.cpp
+//  blocksci
+//
+
+#include <blocksci/util/arrow_writer.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace blocksci {
+    namespace {
+        constexpr char arrowMagic[] = "ARROW1";
+        constexpr uint32_t continuationMarker = 0xFFFFFFFF;
+        // Body buffers are aligned to 64 bytes as the Arrow format recommends
+        constexpr size_t bufferAlignment = 64;
+
+        // Values from the Arrow flatbuffer schemas (Schema.fbs, Message.fbs and File.fbs)
+        constexpr int16_t metadataVersionV5 = 4;
+        constexpr uint8_t messageHeaderSchema = 1;
+        constexpr uint8_t messageHeaderRecordBatch = 3;
+        constexpr uint8_t typeInt = 2;
+        constexpr uint8_t typeBinary = 4;
+        constexpr uint8_t typeUtf8 = 5;
+        constexpr uint8_t typeFixedSizeBinary = 15;
+
+        /* Minimal flatbuffer builder. As in the reference implementation the buffer is built back to front, so objects
+         * are referred to by their distance from the end of the buffer and must be created before the objects that
+         * refer to them. Only little endian hosts are supported, as elsewhere in BlockSci */
+        class FlatBufferBuilder {
+            // Stored reversed so that prepending is an append
+            std::vector<uint8_t> reversed;
+            std::vector<std::pair<uint16_t, uint32_t>> tableFields;
+            uint32_t tableStart = 0;
+
+            void prepend(const void *data, size_t size) {
+                auto bytes = reinterpret_cast<const uint8_t *>(data);
+                for (size_t i = size; i > 0; i--) {
+                    reversed.push_back(bytes[i - 1]);
+                }
+            }
+
+            template <typename T>
+            void prependScalar(T value) {
+                align(sizeof(T));
+                prepend(&value, sizeof(T));
+            }
+
+            void prependOffset(uint32_t ref) {
+                align(sizeof(uint32_t));
+                uint32_t offset = size() + static_cast<uint32_t>(sizeof(uint32_t)) - ref;
+                prepend(&offset, sizeof(offset));
+            }
+
+        public:
+            using Ref = uint32_t;
+
+            uint32_t size() const {
+                return static_cast<uint32_t>(reversed.size());
+            }
+
+            // Pads so that the end of the next additionalBytes bytes prepended is aligned
+            void align(size_t alignment, size_t additionalBytes = 0) {
+                while ((reversed.size() + additionalBytes) % alignment != 0) {
+                    reversed.push_back(0);
+                }
+            }
+
+            Ref createString(const std::string &str) {
+                align(sizeof(uint32_t), str.size() + 1);
+                reversed.push_back(0);
+                prepend(str.data(), str.size());
+                auto length = static_cast<uint32_t>(str.size());
+                prepend(&length, sizeof(length));
+                return size();
+            }
+
+            // Structs must be plain data with no padding that differs from the flatbuffer layout
+            template <typename T>
+            Ref createStructVector(const std::vector<T> &items) {
+                align(std::max(sizeof(uint32_t), alignof(T)), items.size() * sizeof(T));
+                prepend(items.data(), items.size() * sizeof(T));
+                auto length = static_cast<uint32_t>(items.size());
+                prepend(&length, sizeof(length));
+                return size();
+            }
+
+            Ref createOffsetVector(const std::vector<Ref> &refs) {
+                align(sizeof(uint32_t));
+                for (size_t i = refs.size(); i > 0; i--) {
+                    prependOffset(refs[i - 1]);
+                }
+                auto length = static_cast<uint32_t>(refs.size());
+                prepend(&length, sizeof(length));
+                return size();
+            }
+
+            void startTable() {
+                tableFields.clear();
+                tableStart = size();
+            }
+
+            template <typename T>
+            void addScalar(uint16_t slot, T value) {
+                prependScalar(value);
+                tableFields.emplace_back(slot, size());
+            }
+
+            void addOffset(uint16_t slot, Ref ref) {
+                prependOffset(ref);
+                tableFields.emplace_back(slot, size());
+            }
+
+            // Each table gets its own vtable, which precedes it in the buffer
+            Ref endTable() {
+                prependScalar(int32_t{0});
+                auto table = size();
+                uint16_t slotCount = 0;
+                for (auto &field : tableFields) {
+                    slotCount = std::max(slotCount, static_cast<uint16_t>(field.first + 1));
+                }
+                std::vector<uint16_t> vtable(2 + slotCount, 0);
+                vtable[0] = static_cast<uint16_t>(vtable.size() * sizeof(uint16_t));
+                vtable[1] = static_cast<uint16_t>(table - tableStart);
+                for (auto &field : tableFields) {
+                    vtable[2 + field.first] = static_cast<uint16_t>(table - field.second);
+                }
+                prepend(vtable.data(), vtable.size() * sizeof(uint16_t));
+                // Fill in the table's offset to its vtable, whose first byte is the last one stored
+                auto tableOffset = size() - table;
+                for (size_t i = 0; i < sizeof(tableOffset); i++) {
+                    reversed[table - 1 - i] = static_cast<uint8_t>(tableOffset >> (8 * i));
+                }
+                return table;
+            }
+
+            // The finished buffer's size is a multiple of 8 so that it can be embedded at an 8 byte aligned position
+            std::vector<uint8_t> finish(Ref root) {
+                align(8, sizeof(uint32_t));
+                prependOffset(root);
+                return std::vector<uint8_t>(reversed.rbegin(), reversed.rend());
+            }
+        };
+
+        struct FieldNode {
+            int64_t length;
+            int64_t nullCount;
+        };
+
+        struct BufferSpec {
+            int64_t offset;
+            int64_t length;
+        };
+
+        struct FileBlock {
+            int64_t offset;
+            int32_t metadataLength;
+            int32_t padding;
+            int64_t bodyLength;
+        };
+
+        static_assert(sizeof(FieldNode) == 16 && sizeof(BufferSpec) == 16 && sizeof(FileBlock) == 24, "Arrow structs must match the flatbuffer layout");
+
+        FlatBufferBuilder::Ref createType(FlatBufferBuilder &builder, const ArrowType &type) {
+            builder.startTable();
+            switch (type.kind) {
+                case ArrowType::Kind::Int:
+                    builder.addScalar<int32_t>(0, type.width);
+                    builder.addScalar<uint8_t>(1, type.isSigned ? 1 : 0);
+                    break;
+                case ArrowType::Kind::FixedSizeBinary:
+                    builder.addScalar<int32_t>(0, type.width);
+                    break;
+                case ArrowType::Kind::Binary:
+                case ArrowType::Kind::Utf8:
+                    break;
+            }
+            return builder.endTable();
+        }
+
+        uint8_t typeId(const ArrowType &type) {
+            switch (type.kind) {
+                case ArrowType::Kind::Int:
+                    return typeInt;
+                case ArrowType::Kind::FixedSizeBinary:
+                    return typeFixedSizeBinary;
+                case ArrowType::Kind::Binary:
+                    return typeBinary;
+                case ArrowType::Kind::Utf8:
+                    return typeUtf8;
+            }
+            return 0;
+        }
+
+        FlatBufferBuilder::Ref createSchema(FlatBufferBuilder &builder, const std::vector<ArrowField> &fields) {
+            std::vector<FlatBufferBuilder::Ref> fieldRefs;
+            for (auto &field : fields) {
+                auto name = builder.createString(field.name);
+                auto type = createType(builder, field.type);
+                auto children = builder.createOffsetVector({});
+                builder.startTable();
+                builder.addOffset(0, name);
+                builder.addScalar<uint8_t>(1, 0);
+                builder.addScalar<uint8_t>(2, typeId(field.type));
+                builder.addOffset(3, type);
+                builder.addOffset(5, children);
+                fieldRefs.push_back(builder.endTable());
+            }
+            auto fieldVector = builder.createOffsetVector(fieldRefs);
+            builder.startTable();
+            builder.addScalar<int16_t>(0, 0);
+            builder.addOffset(1, fieldVector);
+            return builder.endTable();
+        }
+
+        std::vector<uint8_t> createMessage(FlatBufferBuilder &builder, uint8_t headerType, FlatBufferBuilder::Ref header, int64_t bodyLength) {
+            builder.startTable();
+            builder.addScalar<int64_t>(3, bodyLength);
+            builder.addOffset(2, header);
+            builder.addScalar<int16_t>(0, metadataVersionV5);
+            builder.addScalar<uint8_t>(1, headerType);
+            return builder.finish(builder.endTable());
+        }
+
+        size_t paddedSize(size_t size, size_t alignment) {
+            return (size + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    ArrowFileWriter::ArrowFileWriter(const std::string &path_, std::vector<ArrowField> fields_) : path(path_), fields(std::move(fields_)), file(boost::filesystem::path{path_}, std::ios::binary | std::ios::trunc) {
+        if (!file) {
+            throw std::runtime_error("Failed to open " + path + " for writing");
+        }
+        write(arrowMagic, 6);
+        pad(8);
+        FlatBufferBuilder builder;
+        auto schema = createSchema(builder, fields);
+        writeMessage(createMessage(builder, messageHeaderSchema, schema, 0), {});
+    }
+
+    void ArrowFileWriter::write(const void *data, size_t size) {
+        file.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
+        position += static_cast<int64_t>(size);
+    }
+
+    void ArrowFileWriter::pad(size_t alignment) {
+        static const char zeros[bufferAlignment] = {};
+        write(zeros, paddedSize(static_cast<size_t>(position), alignment) - static_cast<size_t>(position));
+    }
+
+    ArrowFileWriter::Block ArrowFileWriter::writeMessage(const std::vector<uint8_t> &metadata, const std::vector<std::pair<const char *, size_t>> &buffers) {
+        // The body must start on a 64 byte boundary, so the metadata is padded up to one
+        Block block;
+        block.offset = position;
+        auto metadataSize = paddedSize(static_cast<size_t>(position) + 8 + metadata.size(), bufferAlignment) - static_cast<size_t>(position) - 8;
+        auto metadataLength = static_cast<int32_t>(metadataSize);
+        write(&continuationMarker, sizeof(continuationMarker));
+        write(&metadataLength, sizeof(metadataLength));
+        write(metadata.data(), metadata.size());
+        pad(bufferAlignment);
+        block.metadataLength = static_cast<int32_t>(position - block.offset);
+        auto bodyStart = position;
+        for (auto &buffer : buffers) {
+            write(buffer.first, buffer.second);
+            pad(bufferAlignment);
+        }
+        block.bodyLength = position - bodyStart;
+        return block;
+    }
+
+    void ArrowFileWriter::writeBatch(int64_t rowCount, const std::vector<ArrowColumn> &columns) {
+        if (columns.size() != fields.size()) {
+            throw std::invalid_argument("Record batch has " + std::to_string(columns.size()) + " columns but the schema has " + std::to_string(fields.size()));
+        }
+        std::vector<FieldNode> nodes;
+        std::vector<BufferSpec> specs;
+        std::vector<std::pair<const char *, size_t>> buffers;
+        int64_t bodyOffset = 0;
+        auto addBuffer = [&](const void *data, size_t size) {
+            specs.push_back({bodyOffset, static_cast<int64_t>(size)});
+            buffers.emplace_back(reinterpret_cast<const char *>(data), size);
+            bodyOffset += static_cast<int64_t>(paddedSize(size, bufferAlignment));
+        };
+        for (size_t i = 0; i < columns.size(); i++) {
+            auto &type = fields[i].type;
+            auto &column = columns[i];
+            auto rows = static_cast<size_t>(rowCount);
+            bool variable = type.kind == ArrowType::Kind::Binary || type.kind == ArrowType::Kind::Utf8;
+            bool valid = false;
+            switch (type.kind) {
+                case ArrowType::Kind::Int:
+                    valid = column.values.size() == rows * static_cast<size_t>(type.width / 8);
+                    break;
+                case ArrowType::Kind::FixedSizeBinary:
+                    valid = column.values.size() == rows * static_cast<size_t>(type.width);
+                    break;
+                case ArrowType::Kind::Binary:
+                case ArrowType::Kind::Utf8:
+                    valid = rows == 0 ? column.values.empty() : column.offsets.size() == rows + 1 && static_cast<size_t>(column.offsets.back()) == column.values.size();
+                    break;
+            }
+            if (!valid) {
+                throw std::invalid_argument("Column " + fields[i].name + " doesn't hold " + std::to_string(rowCount) + " values");
+            }
+            nodes.push_back({rowCount, 0});
+            // Columns have no nulls so their validity bitmaps are omitted
+            addBuffer(nullptr, 0);
+            if (variable) {
+                static const int32_t emptyOffsets[] = {0};
+                if (!column.offsets.empty()) {
+                    addBuffer(column.offsets.data(), column.offsets.size() * sizeof(int32_t));
+                } else {
+                    addBuffer(emptyOffsets, sizeof(emptyOffsets));
+                }
+            }
+            addBuffer(column.values.data(), column.values.size());
+        }
+
+        FlatBufferBuilder builder;
+        auto bufferVector = builder.createStructVector(specs);
+        auto nodeVector = builder.createStructVector(nodes);
+        builder.startTable();
+        builder.addScalar<int64_t>(0, rowCount);
+        builder.addOffset(1, nodeVector);
+        builder.addOffset(2, bufferVector);
+        auto recordBatch = builder.endTable();
+        batches.push_back(writeMessage(createMessage(builder, messageHeaderRecordBatch, recordBatch, bodyOffset), buffers));
+        if (!file) {
+            throw std::runtime_error("Failed to write to " + path);
+        }
+    }
+
+    void ArrowFileWriter::close() {
+        // End of stream marker, followed by the footer that indexes the messages for random access
+        uint32_t endOfStream[] = {continuationMarker, 0};
+        write(endOfStream, sizeof(endOfStream));
+
+        FlatBufferBuilder builder;
+        std::vector<FileBlock> blocks;
+        for (auto &batch : batches) {
+            blocks.push_back({batch.offset, batch.metadataLength, 0, batch.bodyLength});
+        }
+        auto recordBatches = builder.createStructVector(blocks);
+        auto dictionaries = builder.createStructVector(std::vector<FileBlock>{});
+        auto schema = createSchema(builder, fields);
+        builder.startTable();
+        builder.addOffset(1, schema);
+        builder.addOffset(2, dictionaries);
+        builder.addOffset(3, recordBatches);
+        builder.addScalar<int16_t>(0, metadataVersionV5);
+        auto footer = builder.finish(builder.endTable());
+        auto footerLength = static_cast<int32_t>(footer.size());
+        write(footer.data(), footer.size());
+        write(&footerLength, sizeof(footerLength));
+        write(arrowMagic, 6);
+        file.close();
+        if (!file) {
+            throw std::runtime_error("Failed to write to " + path);
+        }
+    }
+} // namespace blocksci
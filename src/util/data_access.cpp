@@ -8,31 +8,154 @@
 
 #include <blocksci/util/data_access.hpp>
 
+#include <blocksci/chain/block_time_index.hpp>
 #include <blocksci/chain/chain_access.hpp>
 #include <blocksci/scripts/script_access.hpp>
 #include <blocksci/index/address_index.hpp>
+#include <blocksci/index/address_prefix_index.hpp>
+#include <blocksci/index/balance_index.hpp>
 #include <blocksci/index/hash_index.hpp>
 #include <blocksci/index/mempool_index.hpp>
+#include <blocksci/util/state.hpp>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
 
 namespace blocksci {
     
+    namespace {
+        std::unique_ptr<State> readEpoch(const DataConfiguration &config) {
+            boost::filesystem::path epochPath{config.epochFilePath()};
+            if (config.dataDirectory.empty() || !boost::filesystem::exists(epochPath)) {
+                return nullptr;
+            }
+            auto epoch = std::make_unique<State>();
+            boost::filesystem::ifstream epochFile{epochPath};
+            epochFile >> *epoch;
+            if (epochFile.fail()) {
+                return nullptr;
+            }
+            return epoch;
+        }
+        
+        template <typename T, typename Func>
+        T &loadComponent(internal::LazyComponent<T> &component, Func &&openFunc) {
+            std::lock_guard<std::mutex> lock(*component.loadMutex);
+            auto loaded = component.loaded.load(std::memory_order_relaxed);
+            if (loaded == nullptr) {
+                component.owner = openFunc();
+                loaded = component.owner.get();
+                component.loaded.store(loaded, std::memory_order_release);
+            }
+            return *loaded;
+        }
+    }
+    
     DataAccess::DataAccess() = default;
 
-    DataAccess::DataAccess(DataConfiguration config_) :
-    config(std::move(config_)),
-    chain{std::make_unique<ChainAccess>(config.chainDirectory(), config.blocksIgnored, config.errorOnReorg)},
-    scripts{std::make_unique<ScriptAccess>(config.scriptsDirectory())},
-    addressIndex{std::make_unique<AddressIndex>(config.addressDBFilePath(), true)},
-    hashIndex{std::make_unique<HashIndex>(config.hashIndexFilePath(), true)},
-    mempoolIndex{std::make_unique<MempoolIndex>(config.mempoolDirectory())} {}
+    DataAccess::DataAccess(DataConfiguration config_) : epoch(readEpoch(config_)), config(std::move(config_)) {}
     
     DataAccess::DataAccess(DataAccess &&) = default;
     DataAccess &DataAccess::operator=(DataAccess &&) = default;
     DataAccess::~DataAccess() = default;
+    
+    const ChainAccess &DataAccess::loadChain() const {
+        return loadComponent(chain, [&]() {
+            auto access = std::make_unique<ChainAccess>(config.chainDirectory(), config.blocksIgnored, config.errorOnReorg);
+            if (epoch) {
+                access->setCommittedBlockCount(epoch->blockCount);
+            }
+            return access;
+        });
+    }
+    
+    const ScriptAccess &DataAccess::loadScripts() const {
+        return loadComponent(scripts, [&]() {
+            auto access = std::make_unique<ScriptAccess>(config.scriptsDirectory());
+            if (epoch) {
+                access->setCommittedCounts(epoch->scriptCounts);
+            }
+            return access;
+        });
+    }
+    
+    const MempoolIndex &DataAccess::loadMempoolIndex() const {
+        return loadComponent(mempoolIndex, [&]() {
+            return std::make_unique<MempoolIndex>(config.mempoolDirectory());
+        });
+    }
+    
+    const BlockTimeIndex &DataAccess::loadBlockTimeIndex() const {
+        return loadComponent(blockTimeIndex, [&]() {
+            return std::make_unique<BlockTimeIndex>(getChain());
+        });
+    }
+    
+    const BalanceIndex &DataAccess::loadBalanceIndex() const {
+        return loadComponent(balanceIndex, [&]() {
+            return std::make_unique<BalanceIndex>(config.balanceIndexDirectory(), getChain());
+        });
+    }
+    
+    const AddressPrefixIndex &DataAccess::loadAddressPrefixIndex() const {
+        return loadComponent(addressPrefixIndex, [&]() {
+            return std::make_unique<AddressPrefixIndex>(config.addressPrefixIndexDirectory(), getScripts());
+        });
+    }
+    
+    AddressIndex &DataAccess::loadAddressIndex() {
+        return loadComponent(addressIndex, [&]() {
+            return std::make_unique<AddressIndex>(config.addressDBFilePath(), true);
+        });
+    }
+    
+    HashIndex &DataAccess::loadHashIndex() {
+        return loadComponent(hashIndex, [&]() {
+            return std::make_unique<HashIndex>(config.hashIndexFilePath(), true);
+        });
+    }
+
+    void publishEpoch(const DataConfiguration &config, const State &state) {
+        boost::filesystem::path epochPath{config.epochFilePath()};
+        auto tempPath = boost::filesystem::path{epochPath}.concat(".tmp");
+        {
+            boost::filesystem::ofstream epochFile{tempPath};
+            epochFile << state;
+        }
+        // Renaming is atomic so readers never observe a partially written epoch
+        boost::filesystem::rename(tempPath, epochPath);
+    }
 
     void DataAccess::reload() {
-        chain->reload();
-        scripts->reload();
-        mempoolIndex->reload();
+        // Read before the files are remapped, since the parser only publishes an epoch after writing the data it covers
+        epoch = readEpoch(config);
+        auto loadedScripts = scripts.get();
+        auto loadedChain = chain.get();
+        if (loadedScripts != nullptr) {
+            loadedScripts->reload();
+        }
+        if (loadedChain != nullptr) {
+            loadedChain->reload();
+        }
+        if (epoch) {
+            if (loadedScripts != nullptr) {
+                loadedScripts->setCommittedCounts(epoch->scriptCounts);
+            }
+            if (loadedChain != nullptr) {
+                loadedChain->setCommittedBlockCount(epoch->blockCount);
+            }
+        }
+        if (auto loadedMempool = mempoolIndex.get()) {
+            loadedMempool->reload();
+        }
+        if (auto loadedTimeIndex = blockTimeIndex.get()) {
+            loadedTimeIndex->update(getChain());
+        }
+        if (auto loadedBalanceIndex = balanceIndex.get()) {
+            loadedBalanceIndex->reload(getChain());
+        }
+        if (auto loadedPrefixIndex = addressPrefixIndex.get()) {
+            loadedPrefixIndex->reload(getScripts());
+        }
     }
 }
@@ -115,4 +115,16 @@ namespace blocksci {
         return (boost::filesystem::path{dataDirectory}/"hashIndex").native();
     }
     
+    std::string DataConfiguration::balanceIndexDirectory() const {
+        return (boost::filesystem::path{dataDirectory}/"balanceIndex").native();
+    }
+    
+    std::string DataConfiguration::addressPrefixIndexDirectory() const {
+        return (boost::filesystem::path{dataDirectory}/"addressPrefixIndex").native();
+    }
+    
+    std::string DataConfiguration::epochFilePath() const {
+        return (boost::filesystem::path{dataDirectory}/"epoch.txt").native();
+    }
+    
 }
@@ -0,0 +1,266 @@
+//
+//  thread_pool.cpp
+//  blocksci
+//
+
+#include <blocksci/util/thread_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+namespace blocksci {
+
+    namespace {
+        // Set on pool workers and on a caller while it takes part in a parallel call so that nested calls run inline
+        thread_local bool insideParallelCall = false;
+
+        struct ParallelCallGuard {
+            bool previous;
+            ParallelCallGuard() : previous(insideParallelCall) {
+                insideParallelCall = true;
+            }
+            ~ParallelCallGuard() {
+                insideParallelCall = previous;
+            }
+        };
+
+        class TaskRange {
+            std::mutex mutex;
+            size_t begin = 0;
+            size_t end = 0;
+
+        public:
+            void assign(size_t begin_, size_t end_) {
+                std::lock_guard<std::mutex> lock(mutex);
+                begin = begin_;
+                end = end_;
+            }
+
+            bool takeFront(size_t &task) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (begin == end) {
+                    return false;
+                }
+                task = begin++;
+                return true;
+            }
+
+            bool stealBack(size_t &stolenBegin, size_t &stolenEnd) {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto remaining = end - begin;
+                if (remaining == 0) {
+                    return false;
+                }
+                stolenEnd = end;
+                stolenBegin = end - (remaining + 1) / 2;
+                end = stolenBegin;
+                return true;
+            }
+        };
+
+        struct Job {
+            const std::function<void(size_t)> &func;
+            std::vector<TaskRange> ranges;
+            std::atomic<bool> failed{false};
+            std::exception_ptr error;
+            std::mutex errorMutex;
+            size_t activeWorkers;
+
+            Job(const std::function<void(size_t)> &func_, size_t taskCount, size_t participantCount) : func(func_), ranges(participantCount), activeWorkers(participantCount - 1) {
+                for (size_t i = 0; i < participantCount; i++) {
+                    ranges[i].assign(taskCount * i / participantCount, taskCount * (i + 1) / participantCount);
+                }
+            }
+
+            void runTask(size_t task) {
+                try {
+                    func(task);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                    failed = true;
+                }
+            }
+
+            void participate(size_t slot) {
+                auto participantCount = ranges.size();
+                while (!failed) {
+                    size_t task;
+                    while (!failed && ranges[slot].takeFront(task)) {
+                        runTask(task);
+                    }
+                    bool stole = false;
+                    for (size_t offset = 1; offset < participantCount && !stole && !failed; offset++) {
+                        size_t stolenBegin, stolenEnd;
+                        if (ranges[(slot + offset) % participantCount].stealBack(stolenBegin, stolenEnd)) {
+                            ranges[slot].assign(stolenBegin, stolenEnd);
+                            stole = true;
+                        }
+                    }
+                    if (!stole) {
+                        return;
+                    }
+                }
+            }
+        };
+
+        unsigned int defaultThreadCount() {
+            if (auto threadsVar = std::getenv("BLOCKSCI_THREADS")) {
+                try {
+                    auto threads = std::stoi(threadsVar);
+                    if (threads > 0) {
+                        return static_cast<unsigned int>(threads);
+                    }
+                } catch (const std::exception &) {}
+            }
+            return std::max(std::thread::hardware_concurrency(), 1u);
+        }
+    }
+
+    struct ThreadPool::Impl {
+        unsigned int threadCount;
+        // Worker threads don't survive a fork, so a child process abandons the parent's pool and starts its own
+        pid_t ownerPid;
+        std::vector<std::thread> workers;
+
+        std::mutex callMutex;
+        std::mutex mutex;
+        std::condition_variable workAvailable;
+        std::condition_variable workFinished;
+        Job *currentJob = nullptr;
+        uint64_t generation = 0;
+        bool stopping = false;
+
+        explicit Impl(unsigned int threadCount_) : threadCount(std::max(threadCount_, 1u)), ownerPid(getpid()) {}
+
+        ~Impl() {
+            stopWorkers();
+        }
+
+        void startWorkers() {
+            for (unsigned int slot = 1; slot < threadCount; slot++) {
+                workers.emplace_back([this, slot, startGeneration = generation]() { workerLoop(slot, startGeneration); });
+            }
+        }
+
+        void stopWorkers() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            workAvailable.notify_all();
+            for (auto &worker : workers) {
+                worker.join();
+            }
+            workers.clear();
+            stopping = false;
+        }
+
+        void workerLoop(size_t slot, uint64_t seenGeneration) {
+            insideParallelCall = true;
+            while (true) {
+                Job *job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    workAvailable.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+                    if (stopping) {
+                        return;
+                    }
+                    seenGeneration = generation;
+                    job = currentJob;
+                }
+                job->participate(slot);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    job->activeWorkers--;
+                    if (job->activeWorkers == 0) {
+                        workFinished.notify_all();
+                    }
+                }
+            }
+        }
+
+        void run(size_t taskCount, const std::function<void(size_t)> &func) {
+            std::lock_guard<std::mutex> callLock(callMutex);
+            ParallelCallGuard guard;
+            if (workers.empty() && threadCount > 1) {
+                startWorkers();
+            }
+            Job job{func, taskCount, workers.size() + 1};
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                currentJob = &job;
+                generation++;
+            }
+            workAvailable.notify_all();
+            job.participate(0);
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                workFinished.wait(lock, [&]() { return job.activeWorkers == 0; });
+                currentJob = nullptr;
+            }
+            if (job.error) {
+                std::rethrow_exception(job.error);
+            }
+        }
+    };
+
+    ThreadPool::ThreadPool(unsigned int threadCount) : impl(std::make_unique<Impl>(threadCount)) {}
+
+    ThreadPool::~ThreadPool() {
+        if (impl->ownerPid != getpid()) {
+            static_cast<void>(impl.release());
+        }
+    }
+
+    ThreadPool &ThreadPool::instance() {
+        static ThreadPool pool{defaultThreadCount()};
+        return pool;
+    }
+
+    void ThreadPool::ensureWorkers() {
+        if (impl->ownerPid != getpid()) {
+            // Intentionally leaked, the parent's threads and locks are meaningless in this process
+            auto threadCount = impl->threadCount;
+            static_cast<void>(impl.release());
+            impl = std::make_unique<Impl>(threadCount);
+        }
+    }
+
+    unsigned int ThreadPool::threadCount() const {
+        return impl->threadCount;
+    }
+
+    void ThreadPool::setThreadCount(unsigned int threadCount) {
+        if (insideParallelCall) {
+            throw std::logic_error("Thread count can't be changed from inside a parallel call");
+        }
+        ensureWorkers();
+        std::lock_guard<std::mutex> callLock(impl->callMutex);
+        impl->stopWorkers();
+        impl->threadCount = std::max(threadCount, 1u);
+    }
+
+    void ThreadPool::parallelFor(size_t taskCount, const std::function<void(size_t)> &func) {
+        if (insideParallelCall || taskCount <= 1 || impl->threadCount == 1) {
+            ParallelCallGuard guard;
+            for (size_t task = 0; task < taskCount; task++) {
+                func(task);
+            }
+            return;
+        }
+        ensureWorkers();
+        impl->run(taskCount, func);
+    }
+} // namespace blocksci
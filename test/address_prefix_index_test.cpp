@@ -0,0 +1,194 @@
+//
+//  address_prefix_index_test.cpp
+//  blocksci
+//
+
+#include "test_chain.hpp"
+#include "test_util.hpp"
+
+#include "address_prefix_index_writer.hpp"
+#include "parser_configuration.hpp"
+
+#include <blocksci/address/address.hpp>
+#include <blocksci/core/address_info.hpp>
+#include <blocksci/index/address_prefix_index.hpp>
+
+#include <boost/filesystem/fstream.hpp>
+
+#include <algorithm>
+#include <set>
+#include <utility>
+
+using namespace blocksci;
+
+namespace {
+    using EntryRange = std::pair<uint64_t, uint64_t>;
+    using ScriptCounts = std::array<uint32_t, DedupAddressType::size>;
+
+    // Segment covering pubkey scripts (0, 40] and script hash scripts (5, 9] with three pubkey hash and two script hash entries
+    AddressPrefixSegmentInfo makeInfo() {
+        AddressPrefixSegmentInfo info;
+        info.startCounts.fill(0);
+        info.endCounts.fill(0);
+        info.startCounts[static_cast<size_t>(DedupAddressType::SCRIPTHASH)] = 5;
+        info.endCounts[static_cast<size_t>(DedupAddressType::PUBKEY)] = 40;
+        info.endCounts[static_cast<size_t>(DedupAddressType::SCRIPTHASH)] = 9;
+        info.typeOffsets.fill(0);
+        for (size_t i = 0; i < info.typeOffsets.size(); i++) {
+            if (i > static_cast<size_t>(AddressType::PUBKEYHASH)) {
+                info.typeOffsets[i] += 3;
+            }
+            if (i > static_cast<size_t>(AddressType::SCRIPTHASH)) {
+                info.typeOffsets[i] += 2;
+            }
+        }
+        return info;
+    }
+
+    // Numbers of the scripts up to scriptCount whose address of the type starts with prefix, found by encoding each one
+    std::vector<uint32_t> scanPrefix(AddressType::Enum type, const std::string &prefix, uint32_t scriptCount, DataAccess &access) {
+        std::vector<uint32_t> scriptNums;
+        for (uint32_t scriptNum = 1; scriptNum <= scriptCount; scriptNum++) {
+            auto address = AddressPrefixIndex::addressString(type, scriptNum, access);
+            if (!address.empty() && address.compare(0, prefix.size(), prefix) == 0) {
+                scriptNums.push_back(scriptNum);
+            }
+        }
+        return scriptNums;
+    }
+
+    /* Checks that the entries of every segment are sorted by address, and that searches for the prefixes of every
+     * address, and for prefixes matching none, return the same scripts as a scan */
+    void checkIndex(DataAccess &access, size_t segmentCount) {
+        auto &index = access.getAddressPrefixIndex();
+        auto directory = access.config.addressPrefixIndexDirectory();
+        auto names = AddressPrefixIndex::readManifest(directory);
+        BLOCKSCI_CHECK(names.size() == segmentCount);
+        for (auto type : AddressPrefixIndex::indexedTypes(access.config)) {
+            auto dedup = dedupType(type);
+            BLOCKSCI_CHECK(index.scriptCount(dedup) == access.getScripts().scriptCount(dedup));
+            for (auto &name : names) {
+                AddressPrefixSegment segment{AddressPrefixIndex::segmentDirectory(directory, name)};
+                std::vector<std::string> addresses;
+                auto range = segment.entries(type);
+                for (auto entry = range.first; entry < range.second; entry++) {
+                    addresses.push_back(AddressPrefixIndex::addressString(type, segment.scriptNum(entry), access));
+                    BLOCKSCI_CHECK(!addresses.back().empty());
+                }
+                BLOCKSCI_CHECK(std::is_sorted(addresses.begin(), addresses.end()));
+            }
+
+            auto scriptCount = index.scriptCount(dedup);
+            std::set<std::string> prefixes{"x", "1111111111", "bc1zzz"};
+            for (uint32_t scriptNum = 1; scriptNum <= scriptCount; scriptNum++) {
+                auto address = AddressPrefixIndex::addressString(type, scriptNum, access);
+                for (size_t length = 1; length <= std::min<size_t>(address.size(), 6); length++) {
+                    prefixes.insert(address.substr(0, length));
+                }
+                prefixes.insert(address);
+            }
+            for (auto &prefix : prefixes) {
+                auto found = index.getAddressNumsWithPrefix(type, prefix, access);
+                std::sort(found.begin(), found.end());
+                BLOCKSCI_CHECK(found == scanPrefix(type, prefix, scriptCount, access));
+            }
+        }
+    }
+
+    std::vector<Address> makeAddresses(const std::vector<uint32_t> &scriptNums, AddressType::Enum type, DataAccess &access) {
+        std::vector<Address> addresses;
+        for (auto scriptNum : scriptNums) {
+            addresses.emplace_back(scriptNum, type, access);
+        }
+        return addresses;
+    }
+}
+
+int main() {
+    TempDirectory dir;
+
+    auto directory = AddressPrefixIndex::segmentDirectory(dir.path().native(), "3");
+    boost::filesystem::create_directories(boost::filesystem::path{directory});
+    writeFixedSizeFile(AddressPrefixSegment::scriptsFilePath(directory), std::vector<uint32_t>{31, 2, 17, 9, 6});
+    writeFixedSizeFile(AddressPrefixSegment::infoFilePath(directory), std::vector<AddressPrefixSegmentInfo>{makeInfo()});
+    {
+        AddressPrefixSegment segment{directory};
+        BLOCKSCI_CHECK(segment.isComplete());
+        BLOCKSCI_CHECK(segment.entryCount() == 5);
+        BLOCKSCI_CHECK(segment.info().startCounts == makeInfo().startCounts);
+        BLOCKSCI_CHECK(segment.info().endCounts == makeInfo().endCounts);
+        BLOCKSCI_CHECK((segment.entries(AddressType::PUBKEYHASH) == EntryRange{0, 3}));
+        BLOCKSCI_CHECK((segment.entries(AddressType::SCRIPTHASH) == EntryRange{3, 5}));
+        BLOCKSCI_CHECK((segment.entries(AddressType::WITNESS_PUBKEYHASH) == EntryRange{5, 5}));
+        BLOCKSCI_CHECK(segment.scriptNum(1) == 2);
+        BLOCKSCI_CHECK(segment.scriptNum(4) == 6);
+    }
+
+    // A segment whose scripts don't add up to its offsets, or which has no info, is reported as incomplete
+    boost::filesystem::resize_file(boost::filesystem::path{AddressPrefixSegment::scriptsFilePath(directory) + ".dat"}, 4 * sizeof(uint32_t));
+    BLOCKSCI_CHECK(!AddressPrefixSegment{directory}.isComplete());
+    boost::filesystem::remove(boost::filesystem::path{AddressPrefixSegment::infoFilePath(directory) + ".dat"});
+    BLOCKSCI_CHECK(!AddressPrefixSegment{directory}.isComplete());
+
+    BLOCKSCI_CHECK(AddressPrefixIndex::readManifest(dir.path().native()).empty());
+    {
+        boost::filesystem::ofstream manifest{boost::filesystem::path{AddressPrefixIndex::manifestFilePath(dir.path().native())}};
+        manifest << "0\n3\n";
+    }
+    BLOCKSCI_CHECK((AddressPrefixIndex::readManifest(dir.path().native()) == std::vector<std::string>{"0", "3"}));
+
+    TestChain chain{dir.path() / "data"};
+    chain.addPubkeyScripts(60);
+    chain.addScriptHashScripts(30);
+    chain.publish();
+    {
+        // Without an index, searches encode every script of the type given by the leading character, like they always did
+        DataAccess access{chain.config()};
+        auto pubkeyHashNums = scanPrefix(AddressType::PUBKEYHASH, "1", 60, access);
+        auto scriptHashNums = scanPrefix(AddressType::SCRIPTHASH, "3", 30, access);
+        BLOCKSCI_CHECK(pubkeyHashNums.size() == 60);
+        BLOCKSCI_CHECK(scriptHashNums.size() == 30);
+        BLOCKSCI_CHECK(getAddressesWithPrefix("1", access) == makeAddresses(pubkeyHashNums, AddressType::PUBKEYHASH, access));
+        BLOCKSCI_CHECK(getAddressesWithPrefix("3", access) == makeAddresses(scriptHashNums, AddressType::SCRIPTHASH, access));
+        BLOCKSCI_CHECK(getAddressesWithPrefix("bc1", access).empty());
+        BLOCKSCI_CHECK(getAddressesWithPrefix("", access).empty());
+    }
+
+    // A directory that only shares the generated names' prefix doesn't stop the writer from naming new segments
+    ParserConfigurationBase config{chain.directory()};
+    boost::filesystem::create_directories(boost::filesystem::path{config.dataConfig.addressPrefixIndexDirectory()} / "segment_old");
+    AddressPrefixIndexWriter writer{config};
+    auto update = [&](size_t segmentCount) {
+        chain.publish();
+        DataAccess access{chain.config()};
+        writer.update(access);
+        access.reload();
+        checkIndex(access, segmentCount);
+    };
+    update(1);
+
+    // A small update is kept as its own segment and a second one of similar size is merged into it, so searches span
+    // two segments whose entries were merged in address order
+    chain.addPubkeyScripts(12);
+    chain.addScriptHashScripts(6);
+    update(2);
+    chain.addPubkeyScripts(10);
+    chain.addScriptHashScripts(6);
+    update(2);
+    {
+        DataAccess access{chain.config()};
+        auto names = AddressPrefixIndex::readManifest(access.config.addressPrefixIndexDirectory());
+        AddressPrefixSegment newest{AddressPrefixIndex::segmentDirectory(access.config.addressPrefixIndexDirectory(), names.back())};
+        BLOCKSCI_CHECK(newest.info().startCounts[static_cast<size_t>(DedupAddressType::PUBKEY)] == 60);
+        BLOCKSCI_CHECK(newest.info().endCounts[static_cast<size_t>(DedupAddressType::PUBKEY)] == 82);
+
+        // Searches through the index also cover the witness encodings, of every pubkey but only of segwit script hashes
+        auto expected = makeAddresses(scanPrefix(AddressType::WITNESS_PUBKEYHASH, "bc1", 82, access), AddressType::WITNESS_PUBKEYHASH, access);
+        BLOCKSCI_CHECK(expected.size() == 82);
+        auto witnessScriptHashes = makeAddresses(scanPrefix(AddressType::WITNESS_SCRIPTHASH, "bc1", 42, access), AddressType::WITNESS_SCRIPTHASH, access);
+        BLOCKSCI_CHECK(witnessScriptHashes.size() == 21);
+        expected.insert(expected.end(), witnessScriptHashes.begin(), witnessScriptHashes.end());
+        BLOCKSCI_CHECK(getAddressesWithPrefix("bc1", access) == expected);
+    }
+    return 0;
+}
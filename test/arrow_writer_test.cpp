@@ -0,0 +1,265 @@
+//
+//  arrow_writer_test.cpp
+//  blocksci
+//
+
+#include "test_util.hpp"
+
+#include <blocksci/util/arrow_writer.hpp>
+
+#include <boost/filesystem/fstream.hpp>
+
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+using namespace blocksci;
+
+namespace {
+    /* Reads back the parts of an Arrow IPC file that ArrowFileWriter produces, following the flatbuffer layout from
+     * the Arrow schemas independently of the writer's builder */
+    class ArrowFileReader {
+        std::vector<char> data;
+
+        template <typename T>
+        T read(size_t pos) const {
+            BLOCKSCI_CHECK(pos + sizeof(T) <= data.size());
+            T value;
+            std::memcpy(&value, data.data() + pos, sizeof(T));
+            return value;
+        }
+
+        // Position of a table's field, or 0 if the field is absent
+        size_t field(size_t table, uint16_t slot) const {
+            auto vtable = table - static_cast<size_t>(read<int32_t>(table));
+            auto vtableSize = read<uint16_t>(vtable);
+            auto entry = vtable + 4 + 2 * size_t{slot};
+            if (entry + 2 > vtable + vtableSize) {
+                return 0;
+            }
+            auto offset = read<uint16_t>(entry);
+            return offset == 0 ? 0 : table + offset;
+        }
+
+        template <typename T>
+        T scalar(size_t table, uint16_t slot, T defaultValue = T{}) const {
+            auto pos = field(table, slot);
+            return pos == 0 ? defaultValue : read<T>(pos);
+        }
+
+        size_t offsetField(size_t table, uint16_t slot) const {
+            auto pos = field(table, slot);
+            BLOCKSCI_CHECK(pos != 0);
+            return pos + read<uint32_t>(pos);
+        }
+
+        std::string string(size_t table, uint16_t slot) const {
+            auto pos = offsetField(table, slot);
+            return std::string(data.data() + pos + 4, read<uint32_t>(pos));
+        }
+
+        // Positions of the tables in a vector of tables
+        std::vector<size_t> tables(size_t table, uint16_t slot) const {
+            auto pos = offsetField(table, slot);
+            std::vector<size_t> result;
+            for (uint32_t i = 0; i < read<uint32_t>(pos); i++) {
+                auto element = pos + 4 + 4 * i;
+                result.push_back(element + read<uint32_t>(element));
+            }
+            return result;
+        }
+
+        template <typename T>
+        std::vector<T> structs(size_t table, uint16_t slot) const {
+            auto pos = offsetField(table, slot);
+            std::vector<T> result(read<uint32_t>(pos));
+            for (size_t i = 0; i < result.size(); i++) {
+                result[i] = read<T>(pos + 4 + i * sizeof(T));
+            }
+            return result;
+        }
+
+        size_t root(size_t start) const {
+            return start + read<uint32_t>(start);
+        }
+
+    public:
+        struct Field {
+            std::string name;
+            uint8_t typeId;
+            int32_t width;
+            bool isSigned;
+        };
+
+        struct Batch {
+            int64_t rowCount;
+            // Buffers of each column in schema order, without the omitted validity bitmaps
+            std::vector<std::vector<std::string>> columns;
+        };
+
+        std::vector<Field> fields;
+        std::vector<Batch> batches;
+
+        explicit ArrowFileReader(const std::string &path) {
+            boost::filesystem::ifstream file(boost::filesystem::path{path}, std::ios::binary);
+            data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            BLOCKSCI_CHECK(data.size() > 16);
+            BLOCKSCI_CHECK(std::string(data.data(), 6) == "ARROW1");
+            BLOCKSCI_CHECK(std::string(data.data() + data.size() - 6, 6) == "ARROW1");
+
+            auto footerLength = static_cast<size_t>(read<int32_t>(data.size() - 10));
+            auto footerStart = data.size() - 10 - footerLength;
+            BLOCKSCI_CHECK(footerStart % 8 == 0);
+            auto footer = root(footerStart);
+
+            auto schema = offsetField(footer, 1);
+            for (auto fieldTable : tables(schema, 1)) {
+                Field f;
+                f.name = string(fieldTable, 0);
+                BLOCKSCI_CHECK(scalar<uint8_t>(fieldTable, 1) == 0);
+                f.typeId = scalar<uint8_t>(fieldTable, 2);
+                auto type = offsetField(fieldTable, 3);
+                f.width = scalar<int32_t>(type, 0);
+                f.isSigned = scalar<uint8_t>(type, 1) != 0;
+                fields.push_back(f);
+            }
+
+            struct Block {
+                int64_t offset;
+                int32_t metadataLength;
+                int32_t padding;
+                int64_t bodyLength;
+            };
+            struct Node {
+                int64_t length;
+                int64_t nullCount;
+            };
+            struct Buffer {
+                int64_t offset;
+                int64_t length;
+            };
+            for (auto &block : structs<Block>(footer, 3)) {
+                auto offset = static_cast<size_t>(block.offset);
+                BLOCKSCI_CHECK(offset % 8 == 0);
+                BLOCKSCI_CHECK(read<uint32_t>(offset) == 0xFFFFFFFF);
+                BLOCKSCI_CHECK(static_cast<size_t>(read<int32_t>(offset + 4)) + 8 == static_cast<size_t>(block.metadataLength));
+                auto bodyStart = offset + static_cast<size_t>(block.metadataLength);
+                BLOCKSCI_CHECK(bodyStart % 64 == 0);
+
+                auto message = root(offset + 8);
+                BLOCKSCI_CHECK(scalar<int16_t>(message, 0) == 4);
+                BLOCKSCI_CHECK(scalar<uint8_t>(message, 1) == 3);
+                BLOCKSCI_CHECK(scalar<int64_t>(message, 3) == block.bodyLength);
+                auto recordBatch = offsetField(message, 2);
+
+                Batch batch;
+                batch.rowCount = scalar<int64_t>(recordBatch, 0);
+                auto nodes = structs<Node>(recordBatch, 1);
+                auto buffers = structs<Buffer>(recordBatch, 2);
+                BLOCKSCI_CHECK(nodes.size() == fields.size());
+                size_t nextBuffer = 0;
+                for (size_t i = 0; i < fields.size(); i++) {
+                    BLOCKSCI_CHECK(nodes[i].length == batch.rowCount);
+                    BLOCKSCI_CHECK(nodes[i].nullCount == 0);
+                    bool variable = fields[i].typeId == 4 || fields[i].typeId == 5;
+                    auto bufferCount = variable ? size_t{3} : size_t{2};
+                    BLOCKSCI_CHECK(nextBuffer + bufferCount <= buffers.size());
+                    // Validity bitmaps are omitted since no column has nulls
+                    BLOCKSCI_CHECK(buffers[nextBuffer].length == 0);
+                    std::vector<std::string> columnBuffers;
+                    for (size_t j = nextBuffer + 1; j < nextBuffer + bufferCount; j++) {
+                        BLOCKSCI_CHECK(buffers[j].offset % 64 == 0);
+                        BLOCKSCI_CHECK(buffers[j].offset + buffers[j].length <= block.bodyLength);
+                        columnBuffers.emplace_back(data.data() + bodyStart + buffers[j].offset, static_cast<size_t>(buffers[j].length));
+                    }
+                    nextBuffer += bufferCount;
+                    batch.columns.push_back(columnBuffers);
+                }
+                BLOCKSCI_CHECK(nextBuffer == buffers.size());
+                batches.push_back(batch);
+            }
+        }
+    };
+
+    std::string bytes(const std::vector<char> &values) {
+        return std::string(values.data(), values.size());
+    }
+
+    std::string bytes(const std::vector<int32_t> &offsets) {
+        return std::string(reinterpret_cast<const char *>(offsets.data()), offsets.size() * sizeof(int32_t));
+    }
+}
+
+int main() {
+    TempDirectory dir;
+
+    std::vector<ArrowField> fields{
+        {"height", ArrowType::integer<int32_t>()},
+        {"value", ArrowType::integer<uint64_t>()},
+        {"hash", ArrowType::fixedSizeBinary(32)},
+        {"address", ArrowType::utf8()},
+        {"script", ArrowType::binary()}
+    };
+
+    std::vector<ArrowColumn> columns;
+    columns.push_back(ArrowColumn::fromIntegers<int32_t>(std::vector<int>{0, 1, -1}));
+    columns.push_back(ArrowColumn::fromIntegers<uint64_t>(std::vector<uint64_t>{5000000000, 0, 21000000ull * 100000000ull}));
+    ArrowColumn hashes;
+    hashes.values.resize(3 * 32);
+    for (size_t i = 0; i < hashes.values.size(); i++) {
+        hashes.values[i] = static_cast<char>(i);
+    }
+    columns.push_back(hashes);
+    ArrowColumn addresses;
+    for (std::string address : {"1A1zP1eP5QGefi2DMPTfTL5SLmv7DivfNa", "", "bc1qar0srrr7xfkvy5l643lydnw9re59gtzzwf5mdq"}) {
+        addresses.appendVariable(address.data(), address.size());
+    }
+    columns.push_back(addresses);
+    ArrowColumn scripts;
+    for (std::string script : {std::string("\x76\xa9\x14", 3), std::string("\x00\x01", 2), std::string()}) {
+        scripts.appendVariable(script.data(), script.size());
+    }
+    columns.push_back(scripts);
+
+    auto path = dir.file("chain.arrow");
+    {
+        ArrowFileWriter writer{path, fields};
+        writer.writeBatch(3, columns);
+        // Empty batches need no offsets for their variable length columns
+        writer.writeBatch(0, std::vector<ArrowColumn>(fields.size()));
+        BLOCKSCI_CHECK(throwsException<std::invalid_argument>([&] { writer.writeBatch(3, std::vector<ArrowColumn>(2)); }));
+        BLOCKSCI_CHECK(throwsException<std::invalid_argument>([&] { writer.writeBatch(2, columns); }));
+        writer.close();
+    }
+
+    ArrowFileReader reader{path};
+    BLOCKSCI_CHECK(reader.fields.size() == fields.size());
+    for (size_t i = 0; i < fields.size(); i++) {
+        BLOCKSCI_CHECK(reader.fields[i].name == fields[i].name);
+    }
+    BLOCKSCI_CHECK(reader.fields[0].typeId == 2 && reader.fields[0].width == 32 && reader.fields[0].isSigned);
+    BLOCKSCI_CHECK(reader.fields[1].typeId == 2 && reader.fields[1].width == 64 && !reader.fields[1].isSigned);
+    BLOCKSCI_CHECK(reader.fields[2].typeId == 15 && reader.fields[2].width == 32);
+    BLOCKSCI_CHECK(reader.fields[3].typeId == 5);
+    BLOCKSCI_CHECK(reader.fields[4].typeId == 4);
+
+    BLOCKSCI_CHECK(reader.batches.size() == 2);
+    auto &batch = reader.batches[0];
+    BLOCKSCI_CHECK(batch.rowCount == 3);
+    for (size_t i = 0; i < 3; i++) {
+        BLOCKSCI_CHECK(batch.columns[i].size() == 1);
+        BLOCKSCI_CHECK(batch.columns[i][0] == bytes(columns[i].values));
+    }
+    for (size_t i = 3; i < 5; i++) {
+        BLOCKSCI_CHECK(batch.columns[i].size() == 2);
+        BLOCKSCI_CHECK(batch.columns[i][0] == bytes(columns[i].offsets));
+        BLOCKSCI_CHECK(batch.columns[i][1] == bytes(columns[i].values));
+    }
+
+    auto &empty = reader.batches[1];
+    BLOCKSCI_CHECK(empty.rowCount == 0);
+    BLOCKSCI_CHECK(empty.columns[0][0].empty());
+    BLOCKSCI_CHECK(empty.columns[3][0] == bytes(std::vector<int32_t>{0}));
+    BLOCKSCI_CHECK(empty.columns[3][1].empty());
+    return 0;
+}
@@ -0,0 +1,251 @@
+//
+//  balance_index_test.cpp
+//  blocksci
+//
+
+#include "test_chain.hpp"
+#include "test_util.hpp"
+
+#include "balance_index_writer.hpp"
+#include "parser_configuration.hpp"
+
+#include <blocksci/index/balance_index.hpp>
+
+#include <boost/filesystem/fstream.hpp>
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <utility>
+
+using namespace blocksci;
+
+namespace {
+    using EntryRange = std::pair<uint64_t, uint64_t>;
+
+    /* Segment for the blocks [10, 20) in which pubkey addresses 3 and 9 and script hash address 3 changed balance.
+     * Keys are sorted within each type and share the type's entry order. */
+    void writeSegment(const std::string &directory) {
+        boost::filesystem::create_directories(boost::filesystem::path{directory});
+        BalanceSegmentInfo info;
+        info.startHeight = 10;
+        info.endHeight = 20;
+        info.endBlockHash.SetHex("00000000000000000000000000000000000000000000000000000000deadbeef");
+        info.typeOffsets.fill(0);
+        for (size_t i = 0; i < info.typeOffsets.size(); i++) {
+            if (i > static_cast<size_t>(AddressType::PUBKEY)) {
+                info.typeOffsets[i] += 2;
+            }
+            if (i > static_cast<size_t>(AddressType::SCRIPTHASH)) {
+                info.typeOffsets[i] += 1;
+            }
+        }
+        writeFixedSizeFile(BalanceIndexSegment::keysFilePath(directory), std::vector<uint32_t>{3, 9, 3});
+        writeFixedSizeFile(BalanceIndexSegment::offsetsFilePath(directory), std::vector<uint64_t>{0, 2, 3, 6});
+        writeFixedSizeFile(BalanceIndexSegment::heightsFilePath(directory), std::vector<BlockHeight>{10, 15, 19, 11, 12, 13});
+        writeFixedSizeFile(BalanceIndexSegment::balancesFilePath(directory), std::vector<int64_t>{50, 0, 7, 1, 2, 3});
+        writeFixedSizeFile(BalanceIndexSegment::infoFilePath(directory), std::vector<BalanceSegmentInfo>{info});
+    }
+
+    using AddressKey = std::pair<AddressType::Enum, uint32_t>;
+
+    // Writes blocks that each pay a coinbase output and spend the oldest unspent output, cycling over a few addresses
+    struct ChainBuilder {
+        TestChain chain;
+        std::deque<std::pair<std::pair<uint32_t, uint16_t>, int64_t>> unspent;
+
+        explicit ChainBuilder(const boost::filesystem::path &directory) : chain(directory) {}
+
+        void addBlocks(uint32_t count) {
+            for (uint32_t i = 0; i < count; i++) {
+                auto height = chain.state().blockCount;
+                auto txNum = chain.txCount();
+                std::vector<TestTx> txes{TestTx{{}, {{50, AddressType::PUBKEYHASH, 1 + height % 8}}}};
+                unspent.push_back({{txNum, 0}, 50});
+                if (unspent.size() > 1) {
+                    auto spent = unspent.front();
+                    unspent.pop_front();
+                    auto half = spent.second / 2;
+                    txes.push_back(TestTx{{spent.first}, {{half, AddressType::SCRIPTHASH, 1 + height % 3}, {spent.second - half, AddressType::PUBKEYHASH, 1 + height * 3 % 8}}});
+                    unspent.push_back({{txNum + 1, 0}, half});
+                    unspent.push_back({{txNum + 1, 1}, spent.second - half});
+                }
+                chain.addBlock(txes, 1000 + height * 10);
+            }
+        }
+
+        ChainAccess access() const {
+            return ChainAccess{(boost::filesystem::path{chain.directory()} / "chain").native(), 0, false};
+        }
+    };
+
+    // Balance of every address after each block, computed by scanning the whole chain
+    std::map<AddressKey, std::vector<int64_t>> scanBalances(const ChainAccess &chain) {
+        std::map<AddressKey, std::vector<int64_t>> balances;
+        auto blockCount = static_cast<size_t>(chain.blockCount());
+        auto addDelta = [&](const Inout &inout, size_t height, int64_t delta) {
+            auto &history = balances[{inout.getType(), inout.getAddressNum()}];
+            history.resize(blockCount, 0);
+            for (auto i = height; i < blockCount; i++) {
+                history[i] += delta;
+            }
+        };
+        for (BlockHeight height = 0; height < chain.blockCount(); height++) {
+            auto block = chain.getBlock(height);
+            for (auto txNum = block->firstTxIndex; txNum < block->firstTxIndex + block->numTxes; txNum++) {
+                auto tx = chain.getTx(txNum);
+                for (uint16_t i = 0; i < tx->inputCount; i++) {
+                    addDelta(tx->getInput(i), static_cast<size_t>(height), -tx->getInput(i).getValue());
+                }
+                for (uint16_t i = 0; i < tx->outputCount; i++) {
+                    addDelta(tx->getOutput(i), static_cast<size_t>(height), tx->getOutput(i).getValue());
+                }
+            }
+        }
+        return balances;
+    }
+
+    // Checks every query of an index covering the blocks [0, blockCount) against a scan of the chain
+    void checkIndex(const ChainAccess &chain, const std::string &directory, BlockHeight blockCount) {
+        BalanceIndex index{directory, chain};
+        BLOCKSCI_CHECK(index.blockCount() == blockCount);
+        for (auto &entry : scanBalances(chain)) {
+            auto type = entry.first.first;
+            auto addressNum = entry.first.second;
+            std::vector<std::pair<BlockHeight, int64_t>> expectedHistory;
+            int64_t previous = 0;
+            for (BlockHeight height = 0; height < blockCount; height++) {
+                auto balance = entry.second[static_cast<size_t>(height)];
+                BLOCKSCI_CHECK(index.getBalance(type, addressNum, height) == balance);
+                if (balance != previous) {
+                    expectedHistory.emplace_back(height, balance);
+                    previous = balance;
+                }
+            }
+            BLOCKSCI_CHECK(!index.getBalance(type, addressNum, blockCount));
+            BLOCKSCI_CHECK(!index.getBalance(type, addressNum, -1));
+            BLOCKSCI_CHECK(index.getBalanceHistory(type, addressNum) == expectedHistory);
+        }
+        if (blockCount > 0) {
+            BLOCKSCI_CHECK(index.getBalance(AddressType::PUBKEYHASH, 1000, blockCount - 1) == int64_t{0});
+        }
+    }
+
+    std::vector<std::unique_ptr<BalanceIndexSegment>> readSegments(const std::string &directory) {
+        std::vector<std::unique_ptr<BalanceIndexSegment>> segments;
+        for (auto &name : BalanceIndex::readManifest(directory)) {
+            segments.push_back(std::make_unique<BalanceIndexSegment>(BalanceIndex::segmentDirectory(directory, name)));
+        }
+        return segments;
+    }
+}
+
+int main() {
+    TempDirectory dir;
+
+    auto directory = BalanceIndex::segmentDirectory(dir.path().native(), "0");
+    writeSegment(directory);
+    {
+        BalanceIndexSegment segment{directory};
+        BLOCKSCI_CHECK(segment.isComplete());
+        BLOCKSCI_CHECK(segment.info().startHeight == 10);
+        BLOCKSCI_CHECK(segment.info().endHeight == 20);
+        BLOCKSCI_CHECK(segment.info().endBlockHash.GetHex() == "00000000000000000000000000000000000000000000000000000000deadbeef");
+        BLOCKSCI_CHECK(segment.keyCount() == 3);
+        BLOCKSCI_CHECK(segment.entryCount() == 6);
+
+        auto pubkey9 = segment.entries(AddressType::PUBKEY, 9);
+        BLOCKSCI_CHECK((pubkey9 == EntryRange{2, 3}));
+        BLOCKSCI_CHECK(segment.height(pubkey9.first) == 19);
+        BLOCKSCI_CHECK(segment.balance(pubkey9.first) == 7);
+
+        auto scripthash3 = segment.entries(AddressType::SCRIPTHASH, 3);
+        BLOCKSCI_CHECK((scripthash3 == EntryRange{3, 6}));
+        BLOCKSCI_CHECK(segment.balance(scripthash3.second - 1) == 3);
+
+        // Same address number under another type, a number between keys and a type with no keys
+        BLOCKSCI_CHECK(segment.entries(AddressType::PUBKEYHASH, 3).first == segment.entries(AddressType::PUBKEYHASH, 3).second);
+        BLOCKSCI_CHECK(segment.entries(AddressType::PUBKEY, 5).first == segment.entries(AddressType::PUBKEY, 5).second);
+        BLOCKSCI_CHECK(segment.entries(AddressType::PUBKEY, 10).first == segment.entries(AddressType::PUBKEY, 10).second);
+        BLOCKSCI_CHECK(segment.entries(AddressType::WITNESS_SCRIPTHASH, 3).first == segment.entries(AddressType::WITNESS_SCRIPTHASH, 3).second);
+    }
+
+    // A segment cut short by an interrupted write or a concurrent merge is reported as incomplete
+    boost::filesystem::resize_file(boost::filesystem::path{BalanceIndexSegment::balancesFilePath(directory) + ".dat"}, 5 * sizeof(int64_t));
+    BLOCKSCI_CHECK(!BalanceIndexSegment{directory}.isComplete());
+    boost::filesystem::remove_all(boost::filesystem::path{directory});
+    BLOCKSCI_CHECK(!BalanceIndexSegment{directory}.isComplete());
+
+    // Manifest names are read back in order, and a missing manifest is an empty index
+    BLOCKSCI_CHECK(BalanceIndex::readManifest(dir.path().native()).empty());
+    {
+        boost::filesystem::ofstream manifest{boost::filesystem::path{BalanceIndex::manifestFilePath(dir.path().native())}};
+        manifest << "4\n12\n5\n";
+    }
+    BLOCKSCI_CHECK((BalanceIndex::readManifest(dir.path().native()) == std::vector<std::string>{"4", "12", "5"}));
+
+    // The parser's updates, merges and rollbacks, checked against a scan of the chain
+    ChainBuilder builder{dir.path() / "data"};
+    ParserConfigurationBase config{builder.chain.directory()};
+    auto indexDirectory = config.dataConfig.balanceIndexDirectory();
+    BalanceIndexWriter writer{config};
+
+    builder.addBlocks(30);
+    writer.update(builder.access());
+    BLOCKSCI_CHECK(readSegments(indexDirectory).size() == 1);
+    checkIndex(builder.access(), indexDirectory, 30);
+
+    // A small update is kept as its own segment, and a second one of similar size is merged into it, so queries span
+    // two segments
+    builder.addBlocks(3);
+    writer.update(builder.access());
+    BLOCKSCI_CHECK(readSegments(indexDirectory).size() == 2);
+    checkIndex(builder.access(), indexDirectory, 33);
+    builder.addBlocks(3);
+    writer.update(builder.access());
+    {
+        auto segments = readSegments(indexDirectory);
+        BLOCKSCI_CHECK(segments.size() == 2);
+        BLOCKSCI_CHECK(segments[1]->info().startHeight == 30);
+        BLOCKSCI_CHECK(segments[1]->info().endHeight == 36);
+        BLOCKSCI_CHECK(segments[0]->entryCount() >= 2 * segments[1]->entryCount());
+    }
+    checkIndex(builder.access(), indexDirectory, 36);
+
+    // Rolling back into the middle of the newest segment rewrites it with only the entries below the cut, and the
+    // next update indexes the blocks above it again
+    writer.rollback(32, TestChain::blockHash(31));
+    {
+        auto segments = readSegments(indexDirectory);
+        BLOCKSCI_CHECK(segments.size() == 2);
+        BLOCKSCI_CHECK(segments[1]->info().startHeight == 30);
+        BLOCKSCI_CHECK(segments[1]->info().endHeight == 32);
+    }
+    checkIndex(builder.access(), indexDirectory, 32);
+    writer.update(builder.access());
+    {
+        auto segments = readSegments(indexDirectory);
+        BLOCKSCI_CHECK(segments.size() == 2);
+        BLOCKSCI_CHECK(segments[1]->info().startHeight == 30);
+        BLOCKSCI_CHECK(segments[1]->info().endHeight == 36);
+    }
+    checkIndex(builder.access(), indexDirectory, 36);
+
+    // A reorg that replaces the last block invalidates the segment ending in it, which the next update drops and
+    // rebuilds from the new block
+    {
+        auto chainDirectory = (boost::filesystem::path{builder.chain.directory()} / "chain").native();
+        FixedSizeFileMapper<RawBlock, AccessMode::readwrite> blockFile{ChainAccess::blockFilePath(chainDirectory)};
+        auto block = blockFile[35];
+        block->hash = TestChain::blockHash(1000);
+        IndexedFileMapper<AccessMode::readwrite, blocksci::RawTransaction> txFile{ChainAccess::txFilePath(chainDirectory)};
+        txFile.getDataAtIndex(block->firstTxIndex)->getOutput(0).setValue(20);
+    }
+    checkIndex(builder.access(), indexDirectory, 30);
+    writer.update(builder.access());
+    for (auto &segment : readSegments(indexDirectory)) {
+        BLOCKSCI_CHECK(segment->isComplete());
+    }
+    checkIndex(builder.access(), indexDirectory, 36);
+    return 0;
+}
@@ -0,0 +1,154 @@
+//
+//  block_time_index_test.cpp
+//  blocksci
+//
+
+#include "test_chain.hpp"
+#include "test_util.hpp"
+
+#include <blocksci/chain/block_time_index.hpp>
+#include <blocksci/chain/chain_access.hpp>
+#include <blocksci/util/data_access.hpp>
+
+#include <algorithm>
+#include <random>
+
+using namespace blocksci;
+
+namespace {
+    // Checks every query against a linear scan of the timestamps
+    void checkIndex(const BlockTimeIndex &index, const std::vector<uint32_t> &timestamps) {
+        auto count = static_cast<int>(timestamps.size());
+        BLOCKSCI_CHECK(index.blockCount() == BlockHeight{count});
+
+        std::vector<uint32_t> medianTimes;
+        for (int height = 0; height < count; height++) {
+            auto windowStart = std::max(height - BlockTimeIndex::medianTimeSpan + 1, 0);
+            std::vector<uint32_t> window(timestamps.begin() + windowStart, timestamps.begin() + height + 1);
+            std::sort(window.begin(), window.end());
+            medianTimes.push_back(window[window.size() / 2]);
+            BLOCKSCI_CHECK(index.medianTimePast(height) == medianTimes.back());
+        }
+        // Consensus keeps the median time past from decreasing, which the test chains respect
+        BLOCKSCI_CHECK(std::is_sorted(medianTimes.begin(), medianTimes.end()));
+
+        uint32_t lowest = timestamps.empty() ? 0 : *std::min_element(timestamps.begin(), timestamps.end());
+        uint32_t highest = timestamps.empty() ? 0 : *std::max_element(timestamps.begin(), timestamps.end());
+        for (auto time = lowest > 0 ? lowest - 1 : 0; time <= highest + 1; time++) {
+            int first = 0;
+            while (first < count && timestamps[static_cast<size_t>(first)] < time) {
+                first++;
+            }
+            int last = count - 1;
+            while (last >= 0 && timestamps[static_cast<size_t>(last)] > time) {
+                last--;
+            }
+            int firstMedian = 0;
+            while (firstMedian < count && medianTimes[static_cast<size_t>(firstMedian)] < time) {
+                firstMedian++;
+            }
+            BLOCKSCI_CHECK(index.firstBlockAtOrAfter(time) == BlockHeight{first});
+            BLOCKSCI_CHECK(index.lastBlockAtOrBefore(time) == BlockHeight{last});
+            BLOCKSCI_CHECK(index.firstBlockWithMedianTimeAtOrAfter(time) == BlockHeight{firstMedian});
+
+            auto range = index.heightRange(time, time + 5);
+            auto rangeEnd = std::max(first, static_cast<int>(index.lastBlockAtOrBefore(time + 5)) + 1);
+            BLOCKSCI_CHECK(range.first == BlockHeight{first});
+            BLOCKSCI_CHECK(range.second == BlockHeight{rangeEnd});
+        }
+    }
+
+    uint32_t medianOfLast(const std::vector<uint32_t> &timestamps) {
+        auto windowStart = timestamps.size() > BlockTimeIndex::medianTimeSpan ? timestamps.size() - BlockTimeIndex::medianTimeSpan : 0;
+        std::vector<uint32_t> window(timestamps.begin() + static_cast<std::ptrdiff_t>(windowStart), timestamps.end());
+        std::sort(window.begin(), window.end());
+        return window[window.size() / 2];
+    }
+
+    /* Roughly ten time units apart but out of order, as miners' clocks disagree. Like consensus requires, each is
+     * after the median time past of the blocks before it */
+    std::vector<uint32_t> extendTimestamps(std::vector<uint32_t> &timestamps, size_t count, std::mt19937 &rng) {
+        std::uniform_int_distribution<int> jitter(-25, 25);
+        std::vector<uint32_t> added;
+        for (size_t i = 0; i < count; i++) {
+            auto expected = timestamps.empty() ? 1000 : static_cast<int>(timestamps.size()) * 10 + 1000;
+            auto timestamp = static_cast<uint32_t>(expected + jitter(rng));
+            if (!timestamps.empty()) {
+                timestamp = std::max(timestamp, medianOfLast(timestamps) + 1);
+            }
+            timestamps.push_back(timestamp);
+            added.push_back(timestamp);
+        }
+        return added;
+    }
+
+    void addBlocks(TestChain &chain, const std::vector<uint32_t> &timestamps) {
+        for (auto timestamp : timestamps) {
+            chain.addBlock({TestTx{{}, {{50, AddressType::PUBKEYHASH, 1}}}}, timestamp);
+        }
+    }
+}
+
+int main() {
+    TempDirectory dir;
+    TestChain chain{dir.path()};
+    std::mt19937 rng{7};
+
+    // An empty chain answers every query with an empty range
+    chain.publish();
+    DataAccess access{chain.config()};
+    checkIndex(access.getBlockTimeIndex(), {});
+    BLOCKSCI_CHECK(access.getBlockTimeIndex().lastBlockAtOrBefore(100) == BlockHeight{-1});
+
+    // Fewer blocks than the median window, then a longer chain built in one go
+    std::vector<uint32_t> timestamps;
+    addBlocks(chain, extendTimestamps(timestamps, 5, rng));
+    chain.publish();
+    access.reload();
+    checkIndex(access.getBlockTimeIndex(), timestamps);
+
+    // Blocks appended after the index is built update it incrementally, which lowers the suffix minimum of blocks
+    // indexed earlier whenever a new block's timestamp is below theirs
+    auto &index = access.getBlockTimeIndex();
+    std::vector<size_t> batches{1, 3, 20};
+    batches.resize(40, 1);
+    for (auto batch : batches) {
+        addBlocks(chain, extendTimestamps(timestamps, batch, rng));
+        chain.publish();
+        access.reload();
+        BLOCKSCI_CHECK(&access.getBlockTimeIndex() == &index);
+        checkIndex(index, timestamps);
+
+        BlockTimeIndex rebuilt{access.getChain()};
+        checkIndex(rebuilt, timestamps);
+    }
+    BLOCKSCI_CHECK(!std::is_sorted(timestamps.begin(), timestamps.end()));
+
+    // Blocks written but not yet published aren't indexed
+    auto unpublished = timestamps;
+    addBlocks(chain, extendTimestamps(unpublished, 4, rng));
+    access.reload();
+    checkIndex(index, timestamps);
+
+    // Rolling back to a shorter chain rebuilds the index from scratch
+    auto rolledBack = chain.state();
+    rolledBack.blockCount = 10;
+    rolledBack.txCount = 10;
+    publishEpoch(chain.config(), rolledBack);
+    access.reload();
+    timestamps.resize(10);
+    checkIndex(index, timestamps);
+
+    // As does a reorg that replaces the last indexed block with one of the same height
+    {
+        FixedSizeFileMapper<RawBlock, AccessMode::readwrite> blockFile{ChainAccess::blockFilePath((dir.path() / "chain").native())};
+        auto block = blockFile[9];
+        block->hash = TestChain::blockHash(1000);
+        timestamps.pop_back();
+        block->timestamp = medianOfLast(timestamps) + 1;
+        timestamps.push_back(block->timestamp);
+    }
+    access.reload();
+    checkIndex(index, timestamps);
+    return 0;
+}
@@ -0,0 +1,177 @@
+//
+//  chain_columns_test.cpp
+//  blocksci
+//
+
+#include "test_chain.hpp"
+#include "test_util.hpp"
+
+#include <blocksci/chain/block.hpp>
+#include <blocksci/chain/blockchain.hpp>
+#include <blocksci/chain/chain_columns.hpp>
+#include <blocksci/chain/inout_pointer.hpp>
+#include <blocksci/chain/input.hpp>
+#include <blocksci/chain/output.hpp>
+#include <blocksci/chain/transaction.hpp>
+#include <blocksci/util/thread_pool.hpp>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace blocksci;
+
+namespace {
+    constexpr int64_t coin = 100000000;
+
+    const std::vector<TxField> allTxFields{TxField::Index, TxField::BlockHeight, TxField::InputCount, TxField::OutputCount, TxField::Size, TxField::TotalSize, TxField::BaseSize, TxField::Weight, TxField::Locktime, TxField::InputValue, TxField::OutputValue, TxField::Fee};
+    const std::vector<InoutField> allInoutFields{InoutField::Value, InoutField::AddressType, InoutField::AddressNum, InoutField::LinkedTxIndex, InoutField::Age};
+
+    std::vector<int64_t> row(const std::vector<std::vector<int64_t>> &values, size_t rowNum) {
+        std::vector<int64_t> ret;
+        for (auto &column : values) {
+            ret.push_back(column.at(rowNum));
+        }
+        return ret;
+    }
+
+    // Compares every column of the blocks [start, end) with the values read through the transaction, input and output objects
+    void checkColumns(Blockchain &chain, BlockHeight start, BlockHeight end) {
+        auto txes = txColumns(chain, start, end, allTxFields, true);
+        auto inputs = inputColumns(chain, start, end, allInoutFields);
+        auto outputs = outputColumns(chain, start, end, allInoutFields);
+
+        size_t txRow = 0;
+        size_t inputRow = 0;
+        size_t outputRow = 0;
+        for (BlockHeight height = start; height < std::min(end, static_cast<BlockHeight>(chain.size())); height++) {
+            RANGES_FOR(auto tx, chain[height]) {
+                int64_t inputValue = 0;
+                int64_t outputValue = 0;
+                RANGES_FOR(auto input, tx.inputs()) {
+                    std::vector<int64_t> expected{input.getValue(), static_cast<int64_t>(input.getType()), input.getAddress().scriptNum, input.spentTxIndex(), input.age()};
+                    BLOCKSCI_CHECK(row(inputs.values, inputRow) == expected);
+                    BLOCKSCI_CHECK(inputs.txIndexes[inputRow] == tx.txNum);
+                    BLOCKSCI_CHECK(inputs.indexes[inputRow] == input.inputIndex());
+                    BLOCKSCI_CHECK(inputs.heights[inputRow] == height);
+                    inputValue += input.getValue();
+                    inputRow++;
+                }
+                RANGES_FOR(auto output, tx.outputs()) {
+                    auto spendingTx = output.getSpendingTx();
+                    int64_t age = spendingTx ? spendingTx->blockHeight - output.getBlockHeight() : -1;
+                    std::vector<int64_t> expected{output.getValue(), static_cast<int64_t>(output.getType()), output.getAddress().scriptNum, output.isSpent() ? *output.getSpendingTxIndex() : 0, age};
+                    BLOCKSCI_CHECK(row(outputs.values, outputRow) == expected);
+                    BLOCKSCI_CHECK(outputs.txIndexes[outputRow] == tx.txNum);
+                    BLOCKSCI_CHECK(outputs.indexes[outputRow] == output.outputIndex());
+                    BLOCKSCI_CHECK(outputs.heights[outputRow] == height);
+                    outputValue += output.getValue();
+                    outputRow++;
+                }
+                std::vector<int64_t> expected{tx.txNum, tx.blockHeight, tx.inputCount(), tx.outputCount(), tx.virtualSize(), tx.totalSize(), tx.baseSize(), tx.weight(), tx.locktime(), inputValue, outputValue, tx.fee()};
+                BLOCKSCI_CHECK(row(txes.values, txRow) == expected);
+                BLOCKSCI_CHECK(txes.hashes.at(txRow) == tx.getHash());
+                txRow++;
+            }
+        }
+        BLOCKSCI_CHECK(txes.hashes.size() == txRow);
+        BLOCKSCI_CHECK(std::all_of(txes.values.begin(), txes.values.end(), [&](auto &column) { return column.size() == txRow; }));
+        BLOCKSCI_CHECK(inputs.txIndexes.size() == inputRow);
+        BLOCKSCI_CHECK(std::all_of(inputs.values.begin(), inputs.values.end(), [&](auto &column) { return column.size() == inputRow; }));
+        BLOCKSCI_CHECK(outputs.txIndexes.size() == outputRow);
+        BLOCKSCI_CHECK(std::all_of(outputs.values.begin(), outputs.values.end(), [&](auto &column) { return column.size() == outputRow; }));
+    }
+
+    // Random rows of the columns, repeating some, in an order unrelated to the chain's
+    std::vector<size_t> shuffledRows(size_t rowCount, std::mt19937 &rng) {
+        std::vector<size_t> rows;
+        for (size_t i = 0; i < rowCount * 3; i++) {
+            rows.push_back(rng() % rowCount);
+        }
+        rows.push_back(rows.front());
+        rows.push_back(rows.front());
+        std::shuffle(rows.begin(), rows.end(), rng);
+        return rows;
+    }
+
+    template <typename Pointer, typename Gather>
+    void checkGatheredInouts(const InoutColumns &columns, std::mt19937 &rng, Gather gather) {
+        auto rows = shuffledRows(columns.txIndexes.size(), rng);
+        std::vector<Pointer> pointers;
+        for (auto rowNum : rows) {
+            pointers.emplace_back(columns.txIndexes[rowNum], columns.indexes[rowNum]);
+        }
+        auto gathered = gather(pointers, allInoutFields);
+        for (size_t i = 0; i < rows.size(); i++) {
+            BLOCKSCI_CHECK(row(gathered, i) == row(columns.values, rows[i]));
+        }
+    }
+}
+
+int main() {
+    TempDirectory dir;
+    TestChain testChain{dir.path()};
+    // Each block's coinbase pays two outputs, the first spent by the next block and the second by the block after it
+    std::vector<uint32_t> coinbaseTxes;
+    for (uint32_t height = 0; height < 40; height++) {
+        std::vector<TestTx> txes{TestTx{{}, {{50 * coin, AddressType::PUBKEYHASH, height + 1}, {coin, AddressType::SCRIPTHASH, height + 1}}}};
+        if (height >= 2) {
+            txes.push_back(TestTx{{{coinbaseTxes[height - 1], 0}, {coinbaseTxes[height - 2], 1}}, {{50 * coin, AddressType::WITNESS_PUBKEYHASH, height}}, 300, 200, height});
+        }
+        coinbaseTxes.push_back(testChain.txCount());
+        testChain.addBlock(txes, 1000 + height * 10);
+    }
+    testChain.publish();
+    // Spends in a block that isn't published yet leave the outputs they spend unspent in the columns
+    testChain.addBlock({TestTx{{}, {{50 * coin, AddressType::PUBKEYHASH, 41}}}, TestTx{{{coinbaseTxes[39], 0}}, {{49 * coin, AddressType::PUBKEYHASH, 42}}}}, 2000);
+
+    Blockchain chain{testChain.config()};
+    BLOCKSCI_CHECK(chain.size() == 40);
+    checkColumns(chain, 0, 40);
+    checkColumns(chain, 1, 3);
+    checkColumns(chain, 17, 31);
+    checkColumns(chain, 39, 40);
+
+    // The end is clamped to the chain and empty ranges have no rows
+    checkColumns(chain, 35, 100);
+    BLOCKSCI_CHECK(txColumns(chain, 20, 20, allTxFields).values.front().empty());
+    BLOCKSCI_CHECK(inputColumns(chain, 30, 10, allInoutFields).txIndexes.empty());
+    BLOCKSCI_CHECK(outputColumns(chain, 40, 41, allInoutFields).txIndexes.empty());
+
+    // Gathered rows follow the order of the identifiers, which may repeat, rather than the sorted order workers visit
+    ThreadPool::instance().setThreadCount(4);
+    auto &access = chain.getAccess();
+    std::mt19937 rng{5};
+    auto allTxes = txColumns(chain, 0, 40, allTxFields);
+    auto txRows = shuffledRows(testChain.txCount() - 2, rng);
+    std::vector<uint32_t> txNums(txRows.begin(), txRows.end());
+    auto gatheredTxes = gatherTxFields(access, txNums, allTxFields);
+    for (size_t i = 0; i < txRows.size(); i++) {
+        BLOCKSCI_CHECK(row(gatheredTxes, i) == row(allTxes.values, txRows[i]));
+    }
+    checkGatheredInouts<InputPointer>(inputColumns(chain, 0, 40, allInoutFields), rng, [&](auto &pointers, auto &fields) {
+        return gatherInputFields(access, pointers, fields);
+    });
+    checkGatheredInouts<OutputPointer>(outputColumns(chain, 0, 40, allInoutFields), rng, [&](auto &pointers, auto &fields) {
+        return gatherOutputFields(access, pointers, fields);
+    });
+    BLOCKSCI_CHECK(gatherTxFields(access, {}, allTxFields) == std::vector<std::vector<int64_t>>(allTxFields.size()));
+
+    /* Identifiers outside the loaded chain sort last, so a worker thread rather than the calling thread reaches them,
+     * and the exception must still reach the caller. The unpublished block's transactions aren't loaded */
+    auto unpublishedTx = testChain.txCount() - 1;
+    auto withUnpublished = txNums;
+    withUnpublished.push_back(unpublishedTx);
+    BLOCKSCI_CHECK(throwsException<std::out_of_range>([&] { gatherTxFields(access, withUnpublished, allTxFields); }));
+    std::vector<OutputPointer> outputPointers;
+    for (auto txNum : txNums) {
+        outputPointers.emplace_back(txNum, 0);
+    }
+    // The last loaded transaction has a single output
+    outputPointers.emplace_back(unpublishedTx - 2, 1);
+    BLOCKSCI_CHECK(throwsException<std::out_of_range>([&] { gatherOutputFields(access, outputPointers, allInoutFields); }));
+    // Coinbase transactions have no inputs
+    BLOCKSCI_CHECK(throwsException<std::out_of_range>([&] { gatherInputFields(access, {InputPointer{coinbaseTxes[39], 0}}, allInoutFields); }));
+    return 0;
+}
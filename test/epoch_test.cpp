@@ -0,0 +1,132 @@
+//
+//  epoch_test.cpp
+//  blocksci
+//
+
+#include "test_chain.hpp"
+#include "test_util.hpp"
+
+#include <blocksci/chain/chain_access.hpp>
+#include <blocksci/util/data_access.hpp>
+#include <blocksci/util/state.hpp>
+
+#include <boost/filesystem/fstream.hpp>
+
+#include <sstream>
+
+using namespace blocksci;
+
+namespace {
+    State makeState() {
+        State state;
+        state.blockCount = 550000;
+        state.txCount = 4000000000u;
+        for (size_t i = 0; i < state.scriptCounts.size(); i++) {
+            state.scriptCounts[i] = static_cast<uint32_t>(i * 1000003 + 15);
+        }
+        return state;
+    }
+
+    bool sameState(const State &a, const State &b) {
+        return a.blockCount == b.blockCount && a.txCount == b.txCount && a.scriptCounts == b.scriptCounts;
+    }
+}
+
+int main() {
+    TempDirectory dir;
+
+    // The epoch file the parser publishes is read back field for field
+    auto state = makeState();
+    boost::filesystem::path epochPath{dir.file("epoch.txt")};
+    {
+        boost::filesystem::ofstream epochFile{epochPath};
+        epochFile << state;
+    }
+    State loaded;
+    {
+        boost::filesystem::ifstream epochFile{epochPath};
+        epochFile >> loaded;
+        BLOCKSCI_CHECK(!epochFile.fail());
+    }
+    BLOCKSCI_CHECK(sameState(state, loaded));
+
+    // Counts are written in hex, but the stream is left in decimal for whatever follows
+    std::stringstream ss;
+    ss << state << 10;
+    BLOCKSCI_CHECK(ss.str().substr(ss.str().size() - 3) == " 10");
+    State fromStream;
+    int trailing = 0;
+    ss >> fromStream >> trailing;
+    BLOCKSCI_CHECK(sameState(state, fromStream));
+    BLOCKSCI_CHECK(trailing == 10);
+
+    // A cut off epoch fails to parse, so readers fall back to the full files instead of clamping to garbage
+    auto text = [&] {
+        std::stringstream full;
+        full << state;
+        return full.str();
+    }();
+    std::stringstream truncated{text.substr(0, text.size() / 2)};
+    State partial;
+    truncated >> partial;
+    BLOCKSCI_CHECK(truncated.fail());
+
+    TempDirectory chainDir;
+    TestChain chain{chainDir.path()};
+    TestOutput reward{5000000000, AddressType::PUBKEYHASH, 1};
+    chain.addBlock({TestTx{{}, {reward, reward}}}, 1000);
+    chain.publish();
+    // Publishing goes through a temporary file that is renamed over the epoch
+    BLOCKSCI_CHECK(!boost::filesystem::exists(boost::filesystem::path{chain.config().epochFilePath()}.concat(".tmp")));
+
+    DataAccess access{chain.config()};
+    auto &chainAccess = access.getChain();
+    BLOCKSCI_CHECK(chainAccess.blockCount() == 1);
+    BLOCKSCI_CHECK(chainAccess.maxLoadedTx() == 1);
+    auto blocks = chainAccess.blockView();
+    BLOCKSCI_CHECK(blocks.size == sizeof(RawBlock));
+
+    // A block the parser has written but not published is invisible, and its spend of an earlier output reads as
+    // unspent since the spending tx is past maxLoadedTx
+    chain.addBlock({TestTx{{}, {reward}}, TestTx{{{0, 1}}, {reward}}}, 2000);
+    access.reload();
+    BLOCKSCI_CHECK(&access.getChain() == &chainAccess);
+    BLOCKSCI_CHECK(chainAccess.blockCount() == 1);
+    BLOCKSCI_CHECK(chainAccess.txCount() == 1);
+    auto spentOutput = chainAccess.getTx(0)->getOutput(1);
+    BLOCKSCI_CHECK(spentOutput.getLinkedTxNum() == 2);
+    BLOCKSCI_CHECK(spentOutput.getLinkedTxNum() >= chainAccess.maxLoadedTx());
+    BLOCKSCI_CHECK(chainAccess.getSpendingInputNums(0) != nullptr);
+    BLOCKSCI_CHECK(chainAccess.getSpendingInputNums(1) == nullptr);
+    // Appends that fit in the reserved space past the end of the file don't remap it
+    BLOCKSCI_CHECK(chainAccess.blockView().data == blocks.data);
+
+    // Once published the block is loaded in the same mapping and the spend becomes visible
+    chain.publish();
+    access.reload();
+    BLOCKSCI_CHECK(chainAccess.blockCount() == 2);
+    BLOCKSCI_CHECK(chainAccess.txCount() == 3);
+    BLOCKSCI_CHECK(chainAccess.blockView().data == blocks.data);
+    BLOCKSCI_CHECK(chainAccess.getBlock(1)->timestamp == 2000);
+    BLOCKSCI_CHECK(chainAccess.getTx(0)->getOutput(1).getLinkedTxNum() < chainAccess.maxLoadedTx());
+    BLOCKSCI_CHECK(chainAccess.getSpendingInputNums(0)[1] == 1);
+    BLOCKSCI_CHECK(*chainAccess.getTxHash(2) == TestChain::txHash(2));
+
+    // On a rollback the parser publishes the smaller epoch before truncating, so a reload in between already clamps
+    auto rolledBack = chain.state();
+    rolledBack.blockCount = 1;
+    rolledBack.txCount = 1;
+    publishEpoch(chain.config(), rolledBack);
+    access.reload();
+    BLOCKSCI_CHECK(chainAccess.blockCount() == 1);
+    BLOCKSCI_CHECK(chainAccess.txCount() == 1);
+    BLOCKSCI_CHECK(chainAccess.getSpendingInputNums(1) == nullptr);
+    State reread;
+    {
+        boost::filesystem::ifstream epochFile{boost::filesystem::path{chain.config().epochFilePath()}};
+        epochFile >> reread;
+        BLOCKSCI_CHECK(!epochFile.fail());
+    }
+    BLOCKSCI_CHECK(sameState(rolledBack, reread));
+    return 0;
+}
@@ -0,0 +1,76 @@
+//
+//  file_mapper_test.cpp
+//  blocksci
+//
+
+#include "test_util.hpp"
+
+#include <blocksci/core/file_mapper.hpp>
+
+#include <boost/filesystem/fstream.hpp>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace blocksci;
+
+namespace {
+    std::vector<uint64_t> sequence(uint64_t start, uint64_t count) {
+        std::vector<uint64_t> values;
+        for (uint64_t i = start; i < start + count; i++) {
+            values.push_back(i * 7);
+        }
+        return values;
+    }
+
+    void append(const std::string &path, const std::vector<uint64_t> &values) {
+        boost::filesystem::ofstream file{path + ".dat", std::ios::binary | std::ios::app};
+        file.write(reinterpret_cast<const char *>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(uint64_t)));
+    }
+
+    bool viewHolds(const MappedView &view, uint64_t count) {
+        if (view.size != count * sizeof(uint64_t)) {
+            return false;
+        }
+        auto expected = sequence(0, count);
+        return std::memcmp(view.data, expected.data(), view.size) == 0;
+    }
+}
+
+int main() {
+    TempDirectory dir;
+    auto path = dir.file("values");
+    writeFixedSizeFile(path, sequence(0, 1000));
+
+    auto file = std::make_unique<FixedSizeFileMapper<uint64_t>>(path);
+    auto first = file->view(0, 1000);
+    BLOCKSCI_CHECK(viewHolds(first, 1000));
+    BLOCKSCI_CHECK(file->view(0, 0).data == nullptr);
+
+    // Appended values within the space reserved past the end of the file are visible without remapping
+    append(path, sequence(1000, 10));
+    file->reload();
+    BLOCKSCI_CHECK(file->size() == 1010);
+    auto second = file->view(0, 1010);
+    BLOCKSCI_CHECK(second.owner == first.owner);
+    BLOCKSCI_CHECK(viewHolds(first, 1000));
+    BLOCKSCI_CHECK(viewHolds(second, 1010));
+
+    // Growing past the reserved space remaps the file, while the earlier views keep the old mapping alive
+    uint64_t grownCount = 1010 + (uint64_t{1} << 26) / sizeof(uint64_t);
+    append(path, sequence(1010, grownCount - 1010));
+    file->reload();
+    BLOCKSCI_CHECK(file->size() == grownCount);
+    auto grown = file->view(0, grownCount);
+    BLOCKSCI_CHECK(grown.owner != first.owner);
+    BLOCKSCI_CHECK(viewHolds(first, 1000));
+    BLOCKSCI_CHECK(viewHolds(second, 1010));
+    BLOCKSCI_CHECK(viewHolds(grown, grownCount));
+
+    // As they do after the mapper itself is gone
+    file.reset();
+    BLOCKSCI_CHECK(viewHolds(first, 1000));
+    BLOCKSCI_CHECK(viewHolds(grown, grownCount));
+    return 0;
+}
@@ -0,0 +1,75 @@
+//
+//  hash_index_test.cpp
+//  blocksci
+//
+
+#include "test_chain.hpp"
+#include "test_util.hpp"
+
+#include <blocksci/index/hash_index.hpp>
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace blocksci;
+
+namespace {
+    uint160 addressHash(uint32_t addressNum) {
+        uint160 hash;
+        hash.SetNull();
+        auto mixed = addressNum * 2654435761u;
+        std::memcpy(hash.begin(), &mixed, sizeof(mixed));
+        return hash;
+    }
+}
+
+int main() {
+    TempDirectory dir;
+    HashIndex index{dir.file("hash_index"), false};
+
+    // Indexed numbers start at 1 since 0 marks a missing key
+    constexpr uint32_t indexedCount = 3000;
+    std::vector<std::pair<uint256, uint32_t>> txRows;
+    std::vector<std::pair<uint160, uint32_t>> addressRows;
+    for (uint32_t i = 1; i <= indexedCount; i++) {
+        txRows.emplace_back(TestChain::txHash(i), i);
+        addressRows.emplace_back(addressHash(i), i);
+    }
+    index.addTxes(txRows);
+    index.addAddresses<AddressType::PUBKEYHASH>(addressRows);
+
+    // Several batches of keys in random order, with missing keys and duplicates spread among them
+    std::mt19937 rng{3};
+    std::vector<uint32_t> queried;
+    for (uint32_t i = 1; i <= 4500; i++) {
+        queried.push_back(i);
+    }
+    for (uint32_t i = 0; i < 500; i++) {
+        queried.push_back(queried[rng() % queried.size()]);
+    }
+    std::shuffle(queried.begin(), queried.end(), rng);
+
+    std::vector<uint256> txHashes;
+    std::vector<uint160> addressHashes;
+    for (auto num : queried) {
+        txHashes.push_back(TestChain::txHash(num));
+        addressHashes.push_back(addressHash(num));
+    }
+    auto txNums = index.getTxIndexes(txHashes.data(), txHashes.size());
+    auto addressNums = index.lookupAddresses<AddressType::PUBKEYHASH>(addressHashes.data(), addressHashes.size());
+    BLOCKSCI_CHECK(txNums.size() == queried.size());
+    BLOCKSCI_CHECK(addressNums.size() == queried.size());
+    for (size_t i = 0; i < queried.size(); i++) {
+        auto expected = queried[i] <= indexedCount ? queried[i] : 0;
+        BLOCKSCI_CHECK(txNums[i] == expected);
+        BLOCKSCI_CHECK(addressNums[i] == expected);
+        BLOCKSCI_CHECK(index.getTxIndex(txHashes[i]) == expected);
+    }
+
+    // Keys of another column aren't matched, and an empty batch has no results
+    BLOCKSCI_CHECK(index.lookupAddresses<AddressType::SCRIPTHASH>(addressHashes.data(), addressHashes.size()) == std::vector<uint32_t>(queried.size(), 0));
+    BLOCKSCI_CHECK(index.getTxIndexes(txHashes.data(), 0).empty());
+    return 0;
+}
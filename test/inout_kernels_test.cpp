@@ -0,0 +1,153 @@
+//
+//  inout_kernels_test.cpp
+//  blocksci
+//
+
+#include "test_util.hpp"
+
+#include <blocksci/core/inout.hpp>
+#include <blocksci/core/inout_kernels.hpp>
+
+#include <algorithm>
+#include <new>
+#include <random>
+#include <stdexcept>
+
+using namespace blocksci;
+
+namespace {
+    std::vector<Inout> makeInouts(size_t count, std::mt19937_64 &rng) {
+        std::uniform_int_distribution<int> typeDist(0, static_cast<int>(AddressType::size) - 1);
+        std::uniform_int_distribution<int64_t> valueDist(0, int64_t{21000000} * 100000000);
+        std::vector<Inout> inouts;
+        for (size_t i = 0; i < count; i++) {
+            inouts.emplace_back(0, static_cast<uint32_t>(i), static_cast<AddressType::Enum>(typeDist(rng)), valueDist(rng));
+        }
+        return inouts;
+    }
+
+    bool selected(const Inout &inout, uint32_t typeMask) {
+        return (typeMask >> static_cast<uint32_t>(inout.getType())) & 1;
+    }
+
+    // Compares every kernel with a plain loop over the same inouts
+    void checkKernels(const std::vector<Inout> &inouts, uint32_t typeMask) {
+        auto begin = inouts.data();
+        auto end = inouts.data() + inouts.size();
+
+        ValueSummary expected;
+        AddressTypeHistogram expectedHistogram;
+        for (auto &inout : inouts) {
+            if (selected(inout, typeMask)) {
+                expected.add(inout.getValue());
+            }
+            expectedHistogram.values[static_cast<size_t>(inout.getType())] += inout.getValue();
+            expectedHistogram.counts[static_cast<size_t>(inout.getType())]++;
+        }
+
+        BLOCKSCI_CHECK(kernels::sumValues(begin, end, typeMask) == expected.total);
+
+        ValueSummary summary;
+        kernels::summarizeValues(begin, end, typeMask, summary);
+        BLOCKSCI_CHECK(summary.total == expected.total);
+        BLOCKSCI_CHECK(summary.count == expected.count);
+        BLOCKSCI_CHECK(summary.min == expected.min);
+        BLOCKSCI_CHECK(summary.max == expected.max);
+
+        AddressTypeHistogram histogram;
+        kernels::accumulateTypeHistogram(begin, end, histogram);
+        BLOCKSCI_CHECK(histogram.values == expectedHistogram.values);
+        BLOCKSCI_CHECK(histogram.counts == expectedHistogram.counts);
+    }
+
+    bool sameSummary(const ValueSummary &a, const ValueSummary &b) {
+        return a.total == b.total && a.count == b.count && a.min == b.min && a.max == b.max;
+    }
+
+    // Transactions serialized back to back as in the tx file, with input and output counts around the vector widths
+    std::vector<Inout> makeTxData(size_t txCount, std::mt19937_64 &rng) {
+        std::uniform_int_distribution<uint16_t> countDist(0, 19);
+        std::vector<Inout> records;
+        for (size_t i = 0; i < txCount; i++) {
+            auto inputCount = i % 5 == 0 ? uint16_t{0} : countDist(rng);
+            auto outputCount = countDist(rng);
+            auto inouts = makeInouts(size_t{inputCount} + outputCount, rng);
+            records.emplace_back();
+            new (&records.back()) RawTransaction{250, 250, 0, inputCount, outputCount};
+            records.insert(records.end(), inouts.begin(), inouts.end());
+        }
+        return records;
+    }
+
+    // Compares the span kernels with the per transaction kernels, which are checked against plain loops above
+    void checkSpanKernels(const std::vector<Inout> &records, uint32_t typeMask) {
+        auto txData = reinterpret_cast<const char *>(records.data());
+        auto size = records.size() * sizeof(Inout);
+
+        ValueSummary expectedInputs, expectedOutputs, expectedFees;
+        AddressTypeHistogram expectedInputHistogram, expectedOutputHistogram;
+        for (size_t record = 0; record < records.size();) {
+            auto &tx = *reinterpret_cast<const RawTransaction *>(&records[record]);
+            kernels::summarizeValues(tx.beginInputs(), tx.endInputs(), typeMask, expectedInputs);
+            kernels::summarizeValues(tx.beginOutputs(), tx.endOutputs(), typeMask, expectedOutputs);
+            kernels::accumulateTypeHistogram(tx.beginInputs(), tx.endInputs(), expectedInputHistogram);
+            kernels::accumulateTypeHistogram(tx.beginOutputs(), tx.endOutputs(), expectedOutputHistogram);
+            if (tx.inputCount > 0) {
+                expectedFees.add(kernels::fee(tx));
+            }
+            record += 1 + tx.inputCount + tx.outputCount;
+        }
+
+        ValueSummary inputs, outputs, fees;
+        kernels::summarizeTxValues(txData, size, InoutSide::Inputs, typeMask, inputs);
+        kernels::summarizeTxValues(txData, size, InoutSide::Outputs, typeMask, outputs);
+        kernels::summarizeTxFees(txData, size, fees);
+        BLOCKSCI_CHECK(sameSummary(inputs, expectedInputs));
+        BLOCKSCI_CHECK(sameSummary(outputs, expectedOutputs));
+        BLOCKSCI_CHECK(sameSummary(fees, expectedFees));
+
+        AddressTypeHistogram inputHistogram, outputHistogram;
+        kernels::accumulateTxTypeHistogram(txData, size, InoutSide::Inputs, inputHistogram);
+        kernels::accumulateTxTypeHistogram(txData, size, InoutSide::Outputs, outputHistogram);
+        BLOCKSCI_CHECK(inputHistogram.values == expectedInputHistogram.values && inputHistogram.counts == expectedInputHistogram.counts);
+        BLOCKSCI_CHECK(outputHistogram.values == expectedOutputHistogram.values && outputHistogram.counts == expectedOutputHistogram.counts);
+    }
+}
+
+int main() {
+    auto supported = kernels::supportedInstructionSets();
+    BLOCKSCI_CHECK(!supported.empty() && supported.back() == "scalar");
+    BLOCKSCI_CHECK(kernels::activeInstructionSet() == supported.front());
+    BLOCKSCI_CHECK(throwsException<std::invalid_argument>([] { kernels::setInstructionSet("sse9"); }));
+    for (std::string name : {"avx512", "avx2"}) {
+        if (std::find(supported.begin(), supported.end(), name) == supported.end()) {
+            BLOCKSCI_CHECK(throwsException<std::invalid_argument>([&] { kernels::setInstructionSet(name); }));
+            std::cerr << "Skipping " << name << " kernels, which this CPU does not support" << std::endl;
+        }
+    }
+
+    // Every version the CPU can run is checked, not just the one picked by default
+    for (auto &name : supported) {
+        kernels::setInstructionSet(name);
+        BLOCKSCI_CHECK(kernels::activeInstructionSet() == name);
+
+        // Lengths around the vector widths exercise the main loops and their scalar tails
+        std::mt19937_64 rng{42};
+        for (size_t count : {0, 1, 3, 4, 7, 8, 9, 15, 16, 17, 31, 32, 33, 100, 1000}) {
+            auto inouts = makeInouts(count, rng);
+            checkKernels(inouts, kernels::allAddressTypes);
+            checkKernels(inouts, 0);
+            checkKernels(inouts, uint32_t{1} << AddressType::PUBKEYHASH);
+            checkKernels(inouts, (uint32_t{1} << AddressType::SCRIPTHASH) | (uint32_t{1} << AddressType::WITNESS_SCRIPTHASH));
+        }
+
+        for (size_t txCount : {0, 1, 2, 50, 500}) {
+            auto records = makeTxData(txCount, rng);
+            checkSpanKernels(records, kernels::allAddressTypes);
+            checkSpanKernels(records, uint32_t{1} << AddressType::PUBKEYHASH);
+        }
+    }
+    kernels::setInstructionSet(supported.front());
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+//
+//  miner_tagger_test.cpp
+//  blocksci
+//
+
+#include "test_chain.hpp"
+#include "test_util.hpp"
+
+#include <blocksci/chain/block.hpp>
+#include <blocksci/chain/blockchain.hpp>
+#include <blocksci/chain/miner_tagger.hpp>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+using namespace blocksci;
+
+namespace {
+    std::vector<unsigned char> bytes(const std::string &str) {
+        return {str.begin(), str.end()};
+    }
+
+    uint32_t labelOf(const MinerTagger &tagger, const std::string &name) {
+        auto &labels = tagger.labels();
+        auto it = std::find(labels.begin(), labels.end(), name);
+        BLOCKSCI_CHECK(it != labels.end());
+        return static_cast<uint32_t>(std::distance(labels.begin(), it));
+    }
+
+    MinerTagger::CoinbaseMatch match(const MinerTagger &tagger, const std::string &coinbase) {
+        return tagger.matchCoinbase(bytes(coinbase));
+    }
+
+    /* The tag the Python implementation picked: the first match of a regex alternating the tags in list order, which is
+     * the leftmost match, going to the first listed tag among those starting there */
+    uint32_t regexOrderLabel(const MinerTagger &tagger, const MinerTagger::TagList &tags, const std::string &coinbase) {
+        for (size_t start = 0; start < coinbase.size(); start++) {
+            for (auto &tag : tags) {
+                if (coinbase.compare(start, tag.first.size(), tag.first) == 0) {
+                    return labelOf(tagger, tag.second);
+                }
+            }
+        }
+        return MinerTagger::unknownLabel;
+    }
+
+    // The first listed fallback tag contained anywhere in the coinbase
+    uint32_t fallbackOrderLabel(const MinerTagger &tagger, const MinerTagger::TagList &tags, const std::string &coinbase) {
+        for (auto &tag : tags) {
+            if (coinbase.find(tag.first) != std::string::npos) {
+                return labelOf(tagger, tag.second);
+            }
+        }
+        return MinerTagger::unknownLabel;
+    }
+
+    std::string randomString(std::mt19937 &rng, size_t minLength, size_t maxLength) {
+        std::uniform_int_distribution<size_t> length(minLength, maxLength);
+        std::uniform_int_distribution<int> letter('a', 'c');
+        std::string str(length(rng), 'a');
+        for (auto &c : str) {
+            c = static_cast<char>(letter(rng));
+        }
+        return str;
+    }
+}
+
+int main() {
+    const std::vector<std::pair<Address, std::string>> noAddresses;
+
+    // The tag starting earliest wins regardless of the order of the tags
+    {
+        MinerTagger tagger{{{"BB", "Beta"}, {"AAB", "Alpha"}}, noAddresses, {}};
+        BLOCKSCI_CHECK(match(tagger, "xAABB").tagLabel == labelOf(tagger, "Alpha"));
+        BLOCKSCI_CHECK(match(tagger, "xBBAAB").tagLabel == labelOf(tagger, "Beta"));
+        BLOCKSCI_CHECK(match(tagger, "xAAxBx").tagLabel == MinerTagger::unknownLabel);
+        BLOCKSCI_CHECK(match(tagger, "").tagLabel == MinerTagger::unknownLabel);
+    }
+
+    // Among tags starting at the same position the first listed wins, not the longest
+    {
+        MinerTagger tagger{{{"AB", "Short"}, {"ABC", "Long"}}, noAddresses, {}};
+        BLOCKSCI_CHECK(match(tagger, "xABCD").tagLabel == labelOf(tagger, "Short"));
+        MinerTagger reversed{{{"ABC", "Long"}, {"AB", "Short"}}, noAddresses, {}};
+        BLOCKSCI_CHECK(match(reversed, "xABCD").tagLabel == labelOf(reversed, "Long"));
+        BLOCKSCI_CHECK(match(reversed, "xABD").tagLabel == labelOf(reversed, "Short"));
+    }
+
+    // Tags overlapping each other or ending inside each other are all found
+    {
+        MinerTagger tagger{{{"CD", "Third"}, {"BCD", "Second"}, {"ABCDE", "First"}, {"D", "Fourth"}}, noAddresses, {}};
+        BLOCKSCI_CHECK(match(tagger, "ABCDE").tagLabel == labelOf(tagger, "First"));
+        BLOCKSCI_CHECK(match(tagger, "ABCDx").tagLabel == labelOf(tagger, "Second"));
+        BLOCKSCI_CHECK(match(tagger, "xxCDE").tagLabel == labelOf(tagger, "Third"));
+        BLOCKSCI_CHECK(match(tagger, "xxxDE").tagLabel == labelOf(tagger, "Fourth"));
+    }
+
+    // Coinbase tags shadow fallback tags, and the first occurrence of a repeated tag shadows the later ones
+    {
+        MinerTagger tagger{{{"pool", "Tagged"}, {"pool", "Repeated"}}, noAddresses, {{"xpoolx", "Outer"}, {"pool", "Fallback"}, {"solo", "Solo"}, {"solo", "Repeated"}}};
+        auto shadowed = match(tagger, "/pool/");
+        BLOCKSCI_CHECK(shadowed.tagLabel == labelOf(tagger, "Tagged"));
+        BLOCKSCI_CHECK(shadowed.fallbackLabel == MinerTagger::unknownLabel);
+        auto both = match(tagger, "xpoolx");
+        BLOCKSCI_CHECK(both.tagLabel == labelOf(tagger, "Tagged"));
+        BLOCKSCI_CHECK(both.fallbackLabel == labelOf(tagger, "Outer"));
+        auto fallback = match(tagger, "/solo/");
+        BLOCKSCI_CHECK(fallback.tagLabel == MinerTagger::unknownLabel);
+        BLOCKSCI_CHECK(fallback.fallbackLabel == labelOf(tagger, "Solo"));
+    }
+
+    // Fallback tags go by list order alone, wherever they appear
+    {
+        MinerTagger tagger{{}, noAddresses, {{"late", "Late"}, {"early", "Early"}}};
+        BLOCKSCI_CHECK(match(tagger, "early late").fallbackLabel == labelOf(tagger, "Late"));
+        BLOCKSCI_CHECK(match(tagger, "early").fallbackLabel == labelOf(tagger, "Early"));
+    }
+
+    // Tags are matched on the raw bytes, so multibyte tags match their UTF-8 encoding
+    {
+        MinerTagger tagger{{}, noAddresses, {{"七彩神仙鱼", "F2Pool"}}};
+        BLOCKSCI_CHECK(match(tagger, "\x03\xff七彩神仙鱼\x01").fallbackLabel == labelOf(tagger, "F2Pool"));
+        BLOCKSCI_CHECK(match(tagger, "七彩神仙").fallbackLabel == MinerTagger::unknownLabel);
+    }
+
+    BLOCKSCI_CHECK(throwsException<std::invalid_argument>([&] { MinerTagger({{"", "Empty"}}, noAddresses, {}); }));
+
+    // Random tags over a small alphabet overlap constantly, and still match the order of the Python implementation
+    std::mt19937 rng{11};
+    for (int round = 0; round < 50; round++) {
+        MinerTagger::TagList coinbaseTags;
+        MinerTagger::TagList fallbackTags;
+        for (int i = 0; i < 8; i++) {
+            coinbaseTags.emplace_back(randomString(rng, 2, 5), "Miner" + std::to_string(rng() % 6));
+            fallbackTags.emplace_back(randomString(rng, 1, 4), "Fallback" + std::to_string(rng() % 6));
+        }
+        MinerTagger tagger{coinbaseTags, noAddresses, fallbackTags};
+        for (int i = 0; i < 200; i++) {
+            auto coinbase = randomString(rng, 0, 24);
+            auto result = match(tagger, coinbase);
+            BLOCKSCI_CHECK(result.tagLabel == regexOrderLabel(tagger, coinbaseTags, coinbase));
+            // Fallbacks are only used when no coinbase tag matched, when none of them can be shadowed
+            if (result.tagLabel == MinerTagger::unknownLabel) {
+                BLOCKSCI_CHECK(result.fallbackLabel == fallbackOrderLabel(tagger, fallbackTags, coinbase));
+            }
+        }
+    }
+
+    // Blocks are labeled by coinbase tag, then by payout address, then by fallback tag
+    TempDirectory dir;
+    TestChain testChain{dir.path()};
+    auto coinbaseTx = [](uint32_t addressNum) {
+        return std::vector<TestTx>{TestTx{{}, {{1, AddressType::PUBKEYHASH, 1}, {50, AddressType::PUBKEYHASH, addressNum}}}};
+    };
+    testChain.addBlock(coinbaseTx(7), 1000, "/pool/solo/");
+    testChain.addBlock(coinbaseTx(7), 1010, "/solo/");
+    testChain.addBlock(coinbaseTx(8), 1020, "/solo/");
+    testChain.addBlock(coinbaseTx(8), 1030, "nothing");
+    testChain.publish();
+
+    Blockchain chain{testChain.config()};
+    MinerTagger tagger{{{"/pool/", "Pool"}}, {{Address{7, AddressType::PUBKEYHASH, chain.getAccess()}, "Payout"}}, {{"/solo/", "Solo"}}};
+    std::vector<uint32_t> expected{labelOf(tagger, "Pool"), labelOf(tagger, "Payout"), labelOf(tagger, "Solo"), MinerTagger::unknownLabel};
+    for (BlockHeight height = 0; height < 4; height++) {
+        BLOCKSCI_CHECK(tagger.label(chain[height]) == expected[static_cast<size_t>(height)]);
+    }
+    BLOCKSCI_CHECK(tagger.labelBlocks(chain, 0, 4) == expected);
+    BLOCKSCI_CHECK(tagger.labelBlocks(chain, 1, 100) == std::vector<uint32_t>(expected.begin() + 1, expected.end()));
+    return 0;
+}
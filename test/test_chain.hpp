@@ -0,0 +1,234 @@
+//
+//  test_chain.hpp
+//  blocksci
+//
+
+#ifndef blocksci_test_chain_hpp
+#define blocksci_test_chain_hpp
+
+#include <blocksci/chain/chain_access.hpp>
+#include <blocksci/core/file_mapper.hpp>
+#include <blocksci/core/dedup_address_info.hpp>
+#include <blocksci/core/raw_block.hpp>
+#include <blocksci/core/raw_transaction.hpp>
+#include <blocksci/core/script_data.hpp>
+#include <blocksci/util/data_access.hpp>
+#include <blocksci/util/data_configuration.hpp>
+#include <blocksci/util/state.hpp>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <array>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct TestOutput {
+    int64_t value;
+    blocksci::AddressType::Enum type;
+    uint32_t addressNum;
+};
+
+struct TestTx {
+    // Tx index and output index of the output spent by each input
+    std::vector<std::pair<uint32_t, uint16_t>> spends;
+    std::vector<TestOutput> outputs;
+    uint32_t realSize = 250;
+    uint32_t baseSize = 250;
+    uint32_t locktime = 0;
+};
+
+/* Writes a data directory the way the parser does, a block at a time. Like the parser, spends are recorded in the spent
+ * outputs and the spending input file as soon as the spending block is written, before any epoch covers it */
+class TestChain {
+    std::string dataDirectory;
+    std::vector<std::vector<TestOutput>> txOutputs;
+    std::vector<uint64_t> txOffsets;
+    std::vector<uint64_t> spendingInputOffsets;
+    uint32_t blockCount = 0;
+    uint64_t txDataSize = 0;
+    uint64_t spendingInputDataSize = 0;
+    uint64_t sequenceDataSize = 0;
+    uint64_t coinbaseSize = 0;
+    std::array<uint32_t, blocksci::DedupAddressType::size> scriptCounts{};
+
+    std::string chainDirectory() const {
+        return (boost::filesystem::path{dataDirectory} / "chain").native();
+    }
+
+    std::string scriptFilePath(blocksci::DedupAddressType::Enum type) const {
+        return (boost::filesystem::path{dataDirectory} / "scripts" / blocksci::dedupAddressName(type)).native();
+    }
+
+    // Spread over the whole range of the leading bytes, so that encoded addresses differ from their first characters
+    template <typename Hash>
+    static Hash scriptHash(uint32_t scriptNum) {
+        Hash hash;
+        hash.SetNull();
+        auto mixed = scriptNum * 2654435761u;
+        std::memcpy(hash.begin(), &mixed, sizeof(mixed));
+        hash.begin()[hash.size() - 1] = 0x55;
+        return hash;
+    }
+
+    template <typename T>
+    static void appendIndexed(const std::string &prefix, const std::vector<T> &values, uint64_t &dataSize) {
+        blocksci::FixedSizeFileMapper<blocksci::FileIndex<1>, blocksci::AccessMode::readwrite> indexFile{prefix + "_index"};
+        indexFile.write(blocksci::FileIndex<1>{{dataSize}});
+        blocksci::SimpleFileMapper<blocksci::AccessMode::readwrite> dataFile{prefix + "_data"};
+        for (auto &value : values) {
+            dataFile.write(value);
+        }
+        dataSize += values.size() * sizeof(T);
+    }
+
+public:
+    explicit TestChain(const boost::filesystem::path &directory) : dataDirectory(directory.native()) {
+        boost::filesystem::create_directories(directory / "chain");
+        boost::filesystem::create_directories(directory / "scripts");
+        boost::filesystem::create_directories(directory / "mempool");
+        boost::filesystem::ofstream configFile{directory / "config.ini"};
+        configFile << "version=" << blocksci::dataVersion << "\n";
+    }
+
+    static blocksci::uint256 blockHash(uint32_t height) {
+        blocksci::uint256 hash;
+        hash.SetNull();
+        std::memcpy(hash.begin(), &height, sizeof(height));
+        hash.begin()[31] = 0xbb;
+        return hash;
+    }
+
+    static blocksci::uint256 txHash(uint32_t txNum) {
+        blocksci::uint256 hash;
+        hash.SetNull();
+        std::memcpy(hash.begin(), &txNum, sizeof(txNum));
+        hash.begin()[31] = 0x77;
+        return hash;
+    }
+
+    // Returns the height of the new block, whose first transaction should be the coinbase transaction with no inputs
+    blocksci::BlockHeight addBlock(const std::vector<TestTx> &txes, uint32_t timestamp, const std::string &coinbase = "") {
+        auto chainDir = chainDirectory();
+        auto firstTxNum = static_cast<uint32_t>(txOutputs.size());
+        uint32_t blockSize = 80;
+        uint32_t blockBaseSize = 80;
+        {
+            blocksci::FixedSizeFileMapper<blocksci::uint256, blocksci::AccessMode::readwrite> hashFile{blocksci::ChainAccess::txHashesFilePath(chainDir)};
+            blocksci::SimpleFileMapper<blocksci::AccessMode::readwrite> txData{blocksci::ChainAccess::txFilePath(chainDir) + "_data"};
+            blocksci::FixedSizeFileMapper<blocksci::FileIndex<1>, blocksci::AccessMode::readwrite> txIndex{blocksci::ChainAccess::txFilePath(chainDir) + "_index"};
+            for (auto &tx : txes) {
+                auto txNum = static_cast<uint32_t>(txOutputs.size());
+                std::vector<char> record(sizeof(blocksci::RawTransaction) + sizeof(blocksci::Inout) * (tx.spends.size() + tx.outputs.size()));
+                auto rawTx = new (record.data()) blocksci::RawTransaction{tx.realSize, tx.baseSize, tx.locktime, static_cast<uint16_t>(tx.spends.size()), static_cast<uint16_t>(tx.outputs.size())};
+                for (uint16_t i = 0; i < tx.spends.size(); i++) {
+                    auto &spent = txOutputs.at(tx.spends[i].first).at(tx.spends[i].second);
+                    rawTx->getInput(i) = blocksci::Inout{tx.spends[i].first, spent.addressNum, spent.type, spent.value};
+                }
+                for (uint16_t i = 0; i < tx.outputs.size(); i++) {
+                    auto &output = tx.outputs[i];
+                    rawTx->getOutput(i) = blocksci::Inout{0, output.addressNum, output.type, output.value};
+                }
+                txIndex.write(blocksci::FileIndex<1>{{txDataSize}});
+                txData.write(record.data(), record.size());
+                txOffsets.push_back(txDataSize);
+                txDataSize += record.size();
+                hashFile.write(txHash(txNum));
+                txOutputs.push_back(tx.outputs);
+                blockSize += tx.realSize;
+                blockBaseSize += tx.baseSize;
+
+                std::vector<uint32_t> sequenceNums(tx.spends.size(), std::numeric_limits<uint32_t>::max());
+                appendIndexed(blocksci::ChainAccess::sequenceFilePath(chainDir), sequenceNums, sequenceDataSize);
+                spendingInputOffsets.push_back(spendingInputDataSize);
+                appendIndexed(blocksci::ChainAccess::spendingInputFilePath(chainDir), std::vector<uint16_t>(tx.outputs.size(), 0), spendingInputDataSize);
+            }
+        }
+
+        // Spends are recorded in place in the earlier transactions, as the parser does when it processes a block
+        {
+            blocksci::SimpleFileMapper<blocksci::AccessMode::readwrite> txData{blocksci::ChainAccess::txFilePath(chainDir) + "_data"};
+            blocksci::SimpleFileMapper<blocksci::AccessMode::readwrite> spendingData{blocksci::ChainAccess::spendingInputFilePath(chainDir) + "_data"};
+            for (uint32_t i = 0; i < txes.size(); i++) {
+                auto txNum = firstTxNum + i;
+                for (uint16_t j = 0; j < txes[i].spends.size(); j++) {
+                    auto spent = txes[i].spends[j];
+                    auto spentTx = reinterpret_cast<blocksci::RawTransaction *>(txData.getDataAtOffset(txOffsets.at(spent.first)));
+                    spentTx->getOutput(spent.second).setLinkedTxNum(txNum);
+                    auto spendingInputNums = reinterpret_cast<uint16_t *>(spendingData.getDataAtOffset(spendingInputOffsets.at(spent.first)));
+                    spendingInputNums[spent.second] = static_cast<uint16_t>(j + 1);
+                }
+            }
+        }
+
+        auto coinbaseOffset = coinbaseSize;
+        {
+            blocksci::SimpleFileMapper<blocksci::AccessMode::readwrite> coinbaseFile{blocksci::ChainAccess::blockCoinbaseFilePath(chainDir)};
+            coinbaseFile.write(static_cast<uint32_t>(coinbase.size()));
+            coinbaseFile.write(coinbase.data(), coinbase.size());
+            coinbaseSize += sizeof(uint32_t) + coinbase.size();
+        }
+
+        auto height = blockCount;
+        {
+            blocksci::FixedSizeFileMapper<blocksci::RawBlock, blocksci::AccessMode::readwrite> blockFile{blocksci::ChainAccess::blockFilePath(chainDir)};
+            blockFile.write(blocksci::RawBlock{firstTxNum, static_cast<uint32_t>(txes.size()), height, blockHash(height), 1, timestamp, 0x1d00ffff, height, blockSize, blockBaseSize, coinbaseOffset});
+        }
+        blockCount++;
+        return static_cast<blocksci::BlockHeight>(height);
+    }
+
+    // Appends pubkey scripts, which have pay to pubkey hash addresses
+    void addPubkeyScripts(uint32_t count) {
+        blocksci::FixedSizeFileMapper<blocksci::PubkeyData, blocksci::AccessMode::readwrite> file{scriptFilePath(blocksci::DedupAddressType::PUBKEY)};
+        auto &scriptCount = scriptCounts[static_cast<size_t>(blocksci::DedupAddressType::PUBKEY)];
+        for (uint32_t i = 0; i < count; i++) {
+            file.write(blocksci::PubkeyData{0, blocksci::CPubKey{}, scriptHash<blocksci::uint160>(++scriptCount)});
+        }
+    }
+
+    // Appends script hash scripts, alternating between pay to script hash and pay to witness script hash
+    void addScriptHashScripts(uint32_t count) {
+        blocksci::FixedSizeFileMapper<blocksci::ScriptHashData, blocksci::AccessMode::readwrite> file{scriptFilePath(blocksci::DedupAddressType::SCRIPTHASH)};
+        auto &scriptCount = scriptCounts[static_cast<size_t>(blocksci::DedupAddressType::SCRIPTHASH)];
+        blocksci::RawAddress noWrappedAddress{0, blocksci::AddressType::NONSTANDARD};
+        for (uint32_t i = 0; i < count; i++) {
+            if (++scriptCount % 2 == 0) {
+                file.write(blocksci::ScriptHashData{0, scriptHash<blocksci::uint256>(scriptCount), noWrappedAddress});
+            } else {
+                file.write(blocksci::ScriptHashData{0, scriptHash<blocksci::uint160>(scriptCount), noWrappedAddress});
+            }
+        }
+    }
+
+    uint32_t txCount() const {
+        return static_cast<uint32_t>(txOutputs.size());
+    }
+
+    // State covering everything written so far
+    blocksci::State state() const {
+        blocksci::State state;
+        state.blockCount = blockCount;
+        state.txCount = txCount();
+        state.scriptCounts = scriptCounts;
+        return state;
+    }
+
+    void publish() const {
+        blocksci::publishEpoch(config(), state());
+    }
+
+    blocksci::DataConfiguration config() const {
+        return blocksci::DataConfiguration{dataDirectory, false, blocksci::BlockHeight{0}};
+    }
+
+    const std::string &directory() const {
+        return dataDirectory;
+    }
+};
+
+#endif /* blocksci_test_chain_hpp */
@@ -0,0 +1,72 @@
+//
+//  test_util.hpp
+//  blocksci
+//
+
+#ifndef blocksci_test_util_hpp
+#define blocksci_test_util_hpp
+
+#include <blocksci/core/file_mapper.hpp>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Tests are plain executables registered with ctest, which fail by exiting with a nonzero status
+#define BLOCKSCI_CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition << std::endl; \
+            std::exit(EXIT_FAILURE); \
+        } \
+    } while (false)
+
+template <typename Exception, typename Func>
+bool throwsException(Func &&func) {
+    try {
+        func();
+    } catch (const Exception &) {
+        return true;
+    }
+    return false;
+}
+
+// Writes values to the file that a FixedSizeFileMapper<T> opened with the same path reads
+template <typename T>
+void writeFixedSizeFile(const std::string &path, const std::vector<T> &values) {
+    blocksci::FixedSizeFileMapper<T, blocksci::AccessMode::readwrite> file{path};
+    for (auto &value : values) {
+        file.write(value);
+    }
+}
+
+// Fresh directory under the system temp directory that is removed with everything in it on destruction
+class TempDirectory {
+    boost::filesystem::path directory;
+
+public:
+    TempDirectory() : directory(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("blocksci-test-%%%%-%%%%-%%%%")) {
+        boost::filesystem::create_directories(directory);
+    }
+
+    TempDirectory(const TempDirectory &) = delete;
+    TempDirectory &operator=(const TempDirectory &) = delete;
+
+    ~TempDirectory() {
+        boost::system::error_code ec;
+        boost::filesystem::remove_all(directory, ec);
+    }
+
+    const boost::filesystem::path &path() const {
+        return directory;
+    }
+
+    std::string file(const std::string &name) const {
+        return (directory / name).native();
+    }
+};
+
+#endif /* blocksci_test_util_hpp */
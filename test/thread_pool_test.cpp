@@ -0,0 +1,75 @@
+//
+//  thread_pool_test.cpp
+//  blocksci
+//
+
+#include "test_util.hpp"
+
+#include <blocksci/util/thread_pool.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+using namespace blocksci;
+
+int main() {
+    // Every task runs exactly once, including on a pool larger than the task count
+    for (unsigned int threads : {1u, 2u, 8u}) {
+        ThreadPool pool{threads};
+        BLOCKSCI_CHECK(pool.threadCount() == threads);
+        for (size_t taskCount : {0, 1, 5, 1000}) {
+            std::vector<std::atomic<int>> runs(taskCount);
+            pool.parallelFor(taskCount, [&](size_t task) {
+                runs[task]++;
+            });
+            for (auto &count : runs) {
+                BLOCKSCI_CHECK(count == 1);
+            }
+        }
+
+        // Calls from inside a task run serially instead of deadlocking
+        std::atomic<size_t> nestedRuns{0};
+        pool.parallelFor(4, [&](size_t) {
+            pool.parallelFor(10, [&](size_t) {
+                nestedRuns++;
+            });
+        });
+        BLOCKSCI_CHECK(nestedRuns == 40);
+
+        BLOCKSCI_CHECK(throwsException<std::runtime_error>([&] {
+            pool.parallelFor(100, [](size_t task) {
+                if (task == 37) {
+                    throw std::runtime_error("task failed");
+                }
+            });
+        }));
+        // The pool stays usable after a task throws
+        std::atomic<size_t> total{0};
+        pool.parallelFor(100, [&](size_t task) {
+            total += task;
+        });
+        BLOCKSCI_CHECK(total == 4950);
+
+        // Resizing the pool from inside a task would wait on the call it is part of
+        std::atomic<size_t> resizeFailures{0};
+        pool.parallelFor(4, [&](size_t) {
+            if (throwsException<std::logic_error>([&] { pool.setThreadCount(2); })) {
+                resizeFailures++;
+            }
+        });
+        BLOCKSCI_CHECK(resizeFailures == 4);
+        BLOCKSCI_CHECK(pool.threadCount() == threads);
+    }
+
+    // Results are folded in task order, so a non commutative reduction is deterministic
+    ThreadPool::instance().setThreadCount(4);
+    auto concatenated = parallelMapReduce<std::string>(26, [](size_t task) {
+        return std::string(1, static_cast<char>('a' + task));
+    }, [](std::string &a, std::string &b) -> std::string & {
+        a += b;
+        return a;
+    });
+    BLOCKSCI_CHECK(concatenated == "abcdefghijklmnopqrstuvwxyz");
+    return 0;
+}
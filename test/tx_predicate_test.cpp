@@ -0,0 +1,149 @@
+//
+//  tx_predicate_test.cpp
+//  blocksci
+//
+
+#include "test_chain.hpp"
+#include "test_util.hpp"
+
+#include <blocksci/chain/chain_access.hpp>
+#include <blocksci/chain/tx_predicate.hpp>
+#include <blocksci/util/data_access.hpp>
+
+#include <stdexcept>
+
+using namespace blocksci;
+
+namespace {
+    constexpr int64_t coin = 100000000;
+
+    bool matches(const TxPredicate &predicate, const ChainAccess &chain, uint32_t txNum) {
+        return predicate.matches(*chain.getTx(txNum), txNum, chain.getBlockHeight(txNum), chain);
+    }
+
+    TxPredicate txCompare(TxField field, Comparison comparison, int64_t value) {
+        return TxPredicate::compare(field, comparison, value);
+    }
+
+    InoutPredicate inoutCompare(InoutField field, Comparison comparison, int64_t value) {
+        return InoutPredicate::compare(field, comparison, value);
+    }
+}
+
+int main() {
+    TempDirectory dir;
+    TestChain chain{dir.path()};
+    // Block 0: tx 0 pays 50 coins to a pubkeyhash and 10 to a scripthash
+    chain.addBlock({TestTx{{}, {{50 * coin, AddressType::PUBKEYHASH, 1}, {10 * coin, AddressType::SCRIPTHASH, 2}}}}, 1000);
+    // Block 1: tx 2 spends tx 0's first output with a 1 coin fee
+    chain.addBlock({
+        TestTx{{}, {{50 * coin, AddressType::PUBKEYHASH, 1}}},
+        TestTx{{{0, 0}}, {{30 * coin, AddressType::PUBKEYHASH, 3}, {19 * coin, AddressType::WITNESS_PUBKEYHASH, 4}}, 300, 200, 500}
+    }, 2000);
+    // Block 2: tx 4 spends tx 0's second output and tx 2's first with a 1 coin fee, leaving tx 2's second unspent
+    chain.addBlock({
+        TestTx{{}, {{50 * coin, AddressType::PUBKEYHASH, 1}}},
+        TestTx{{{0, 1}, {2, 0}}, {{39 * coin, AddressType::SCRIPTHASH, 5}}}
+    }, 3000);
+    chain.publish();
+
+    DataAccess access{chain.config()};
+    auto &chainAccess = access.getChain();
+    BLOCKSCI_CHECK(chainAccess.txCount() == 5);
+
+    // Transaction fields
+    BLOCKSCI_CHECK(matches(txCompare(TxField::Index, Comparison::Equal, 2), chainAccess, 2));
+    BLOCKSCI_CHECK(!matches(txCompare(TxField::Index, Comparison::Equal, 2), chainAccess, 3));
+    BLOCKSCI_CHECK(matches(txCompare(TxField::BlockHeight, Comparison::Equal, 1), chainAccess, 2));
+    BLOCKSCI_CHECK(matches(txCompare(TxField::InputCount, Comparison::Equal, 2), chainAccess, 4));
+    BLOCKSCI_CHECK(matches(txCompare(TxField::OutputCount, Comparison::Equal, 2), chainAccess, 0));
+    BLOCKSCI_CHECK(matches(txCompare(TxField::TotalSize, Comparison::Equal, 300), chainAccess, 2));
+    BLOCKSCI_CHECK(matches(txCompare(TxField::BaseSize, Comparison::Equal, 200), chainAccess, 2));
+    BLOCKSCI_CHECK(matches(txCompare(TxField::Weight, Comparison::Equal, 900), chainAccess, 2));
+    BLOCKSCI_CHECK(matches(txCompare(TxField::Size, Comparison::Equal, 225), chainAccess, 2));
+    BLOCKSCI_CHECK(matches(txCompare(TxField::Locktime, Comparison::Equal, 500), chainAccess, 2));
+    BLOCKSCI_CHECK(matches(txCompare(TxField::InputValue, Comparison::Equal, 40 * coin), chainAccess, 4));
+    BLOCKSCI_CHECK(matches(txCompare(TxField::OutputValue, Comparison::Equal, 39 * coin), chainAccess, 4));
+    BLOCKSCI_CHECK(matches(txCompare(TxField::Fee, Comparison::Equal, coin), chainAccess, 2));
+    BLOCKSCI_CHECK(matches(txCompare(TxField::Fee, Comparison::Equal, coin), chainAccess, 4));
+    // Coinbase transactions have no fee rather than a negative one
+    BLOCKSCI_CHECK(matches(txCompare(TxField::Fee, Comparison::Equal, 0), chainAccess, 0));
+
+    // Every comparison operator on both sides of the boundary
+    auto fee = [&](Comparison comparison, int64_t value) {
+        return matches(txCompare(TxField::Fee, comparison, value), chainAccess, 2);
+    };
+    BLOCKSCI_CHECK(fee(Comparison::NotEqual, 0) && !fee(Comparison::NotEqual, coin));
+    BLOCKSCI_CHECK(fee(Comparison::Less, coin + 1) && !fee(Comparison::Less, coin));
+    BLOCKSCI_CHECK(fee(Comparison::LessEqual, coin) && !fee(Comparison::LessEqual, coin - 1));
+    BLOCKSCI_CHECK(fee(Comparison::Greater, coin - 1) && !fee(Comparison::Greater, coin));
+    BLOCKSCI_CHECK(fee(Comparison::GreaterEqual, coin) && !fee(Comparison::GreaterEqual, coin + 1));
+
+    // Boolean combinators
+    auto isCoinbase = txCompare(TxField::InputCount, Comparison::Equal, 0);
+    auto inBlock1 = txCompare(TxField::BlockHeight, Comparison::Equal, 1);
+    BLOCKSCI_CHECK(matches(isCoinbase && inBlock1, chainAccess, 1));
+    BLOCKSCI_CHECK(!matches(isCoinbase && inBlock1, chainAccess, 2));
+    BLOCKSCI_CHECK(matches(isCoinbase || inBlock1, chainAccess, 2));
+    BLOCKSCI_CHECK(!matches(isCoinbase || inBlock1, chainAccess, 4));
+    BLOCKSCI_CHECK(matches(!isCoinbase, chainAccess, 4));
+    BLOCKSCI_CHECK(matches(TxPredicate::constant(true), chainAccess, 0));
+    BLOCKSCI_CHECK(!matches(TxPredicate::constant(false), chainAccess, 0));
+
+    // Quantifiers over inputs and outputs
+    auto toScriptHash = inoutCompare(InoutField::AddressType, Comparison::Equal, AddressType::SCRIPTHASH);
+    BLOCKSCI_CHECK(matches(TxPredicate::anyOutput(toScriptHash), chainAccess, 0));
+    BLOCKSCI_CHECK(!matches(TxPredicate::allOutputs(toScriptHash), chainAccess, 0));
+    BLOCKSCI_CHECK(matches(TxPredicate::allOutputs(toScriptHash), chainAccess, 4));
+    BLOCKSCI_CHECK(matches(TxPredicate::anyInput(toScriptHash), chainAccess, 4));
+    BLOCKSCI_CHECK(!matches(TxPredicate::allInputs(toScriptHash), chainAccess, 4));
+    // Vacuously true and false over a coinbase transaction's missing inputs
+    BLOCKSCI_CHECK(matches(TxPredicate::allInputs(InoutPredicate::constant(false)), chainAccess, 0));
+    BLOCKSCI_CHECK(!matches(TxPredicate::anyInput(InoutPredicate::constant(true)), chainAccess, 0));
+    auto large = inoutCompare(InoutField::Value, Comparison::GreaterEqual, 20 * coin);
+    BLOCKSCI_CHECK(matches(TxPredicate::countInputs(large, Comparison::Equal, 1), chainAccess, 4));
+    BLOCKSCI_CHECK(matches(TxPredicate::countOutputs(large || toScriptHash, Comparison::Equal, 2), chainAccess, 0));
+    BLOCKSCI_CHECK(matches(TxPredicate::countOutputs(large && !toScriptHash, Comparison::Equal, 1), chainAccess, 2));
+    BLOCKSCI_CHECK(matches(TxPredicate::anyOutput(inoutCompare(InoutField::AddressNum, Comparison::Equal, 4)), chainAccess, 2));
+
+    // Linked transactions and ages, with -1 and 0 for unspent outputs
+    BLOCKSCI_CHECK(matches(TxPredicate::allInputs(inoutCompare(InoutField::LinkedTxIndex, Comparison::Equal, 0)), chainAccess, 2));
+    BLOCKSCI_CHECK(matches(TxPredicate::anyInput(inoutCompare(InoutField::Age, Comparison::Equal, 2)), chainAccess, 4));
+    BLOCKSCI_CHECK(matches(TxPredicate::anyInput(inoutCompare(InoutField::Age, Comparison::Equal, 1)), chainAccess, 4));
+    BLOCKSCI_CHECK(matches(TxPredicate::countOutputs(inoutCompare(InoutField::Age, Comparison::Equal, 1), Comparison::Equal, 1), chainAccess, 0));
+    BLOCKSCI_CHECK(matches(TxPredicate::countOutputs(inoutCompare(InoutField::Age, Comparison::Equal, -1), Comparison::Equal, 1), chainAccess, 2));
+    BLOCKSCI_CHECK(matches(TxPredicate::anyOutput(inoutCompare(InoutField::LinkedTxIndex, Comparison::Equal, 4)), chainAccess, 2));
+    auto unspentLink = TxPredicate::anyOutput(inoutCompare(InoutField::LinkedTxIndex, Comparison::Equal, 0) && inoutCompare(InoutField::AddressNum, Comparison::Equal, 4));
+    BLOCKSCI_CHECK(matches(unspentLink, chainAccess, 2));
+
+    // A spend the parser has written but not published still reads as unspent
+    chain.addBlock({TestTx{{}, {{50 * coin, AddressType::PUBKEYHASH, 1}}}, TestTx{{{2, 1}}, {{18 * coin, AddressType::PUBKEYHASH, 6}}}}, 4000);
+    access.reload();
+    BLOCKSCI_CHECK(chainAccess.txCount() == 5);
+    BLOCKSCI_CHECK(matches(unspentLink, chainAccess, 2));
+    BLOCKSCI_CHECK(matches(TxPredicate::countOutputs(inoutCompare(InoutField::Age, Comparison::Equal, -1), Comparison::Equal, 1), chainAccess, 2));
+    chain.publish();
+    access.reload();
+    BLOCKSCI_CHECK(!matches(unspentLink, chainAccess, 2));
+    BLOCKSCI_CHECK(matches(TxPredicate::anyOutput(inoutCompare(InoutField::Age, Comparison::Equal, 2) && inoutCompare(InoutField::LinkedTxIndex, Comparison::Equal, 6)), chainAccess, 2));
+
+    // Constants fold away, double negation cancels and cheap fields are tested before quantifiers
+    BLOCKSCI_CHECK((isCoinbase && TxPredicate::constant(true)).toString() == "input_count == 0");
+    BLOCKSCI_CHECK((isCoinbase && TxPredicate::constant(false)).toString() == "False");
+    BLOCKSCI_CHECK((isCoinbase || TxPredicate::constant(true)).toString() == "True");
+    BLOCKSCI_CHECK((!!isCoinbase).toString() == "input_count == 0");
+    BLOCKSCI_CHECK((TxPredicate::anyOutput(toScriptHash) && isCoinbase).toString() == "(input_count == 0 & any_output(address_type == " + std::to_string(AddressType::SCRIPTHASH) + "))");
+    BLOCKSCI_CHECK((txCompare(TxField::Fee, Comparison::Greater, 0) || inBlock1).toString() == "(block_height == 1 | fee > 0)");
+    BLOCKSCI_CHECK(TxPredicate::countInputs(!large, Comparison::Less, 3).toString() == "count_inputs(~value >= " + std::to_string(20 * coin) + ") < 3");
+
+    // Field names round trip and unknown names are rejected
+    for (auto field : {TxField::Index, TxField::BlockHeight, TxField::InputCount, TxField::OutputCount, TxField::Size, TxField::TotalSize, TxField::BaseSize, TxField::Weight, TxField::Locktime, TxField::InputValue, TxField::OutputValue, TxField::Fee}) {
+        BLOCKSCI_CHECK(txFieldFromName(fieldName(field)) == field);
+    }
+    for (auto field : {InoutField::Value, InoutField::AddressType, InoutField::AddressNum, InoutField::LinkedTxIndex, InoutField::Age}) {
+        BLOCKSCI_CHECK(inoutFieldFromName(fieldName(field)) == field);
+    }
+    BLOCKSCI_CHECK(throwsException<std::invalid_argument>([] { txFieldFromName("height"); }));
+    BLOCKSCI_CHECK(throwsException<std::invalid_argument>([] { inoutFieldFromName("fee"); }));
+    return 0;
+}
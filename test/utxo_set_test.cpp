@@ -0,0 +1,108 @@
+//
+//  utxo_set_test.cpp
+//  blocksci
+//
+
+#include "test_chain.hpp"
+#include "test_util.hpp"
+
+#include <blocksci/chain/blockchain.hpp>
+#include <blocksci/chain/utxo_set.hpp>
+
+#include <boost/filesystem/fstream.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+using namespace blocksci;
+
+namespace {
+    UtxoSet makeSet() {
+        UtxoSet set;
+        set.txNums = {1, 1, 7, 4000000000u};
+        set.outputNums = {0, 3, 65535, 1};
+        set.values = {5000000000, 1, 0, -1};
+        set.types = {AddressType::PUBKEY, AddressType::PUBKEYHASH, AddressType::NULL_DATA, AddressType::WITNESS_SCRIPTHASH};
+        set.addressNums = {1, 2, 0, 123456789};
+        set.heights = {0, 0, 2, 700000};
+        return set;
+    }
+
+    void checkEqual(const UtxoSet &a, const UtxoSet &b) {
+        BLOCKSCI_CHECK(a.height() == b.height());
+        BLOCKSCI_CHECK(a.txNums == b.txNums);
+        BLOCKSCI_CHECK(a.outputNums == b.outputNums);
+        BLOCKSCI_CHECK(a.values == b.values);
+        BLOCKSCI_CHECK(a.types == b.types);
+        BLOCKSCI_CHECK(a.addressNums == b.addressNums);
+        BLOCKSCI_CHECK(a.heights == b.heights);
+    }
+}
+
+int main() {
+    TempDirectory dir;
+
+    auto set = makeSet();
+    auto path = dir.file("utxo.dat");
+    set.save(path);
+    auto loaded = UtxoSet::load(path);
+    checkEqual(set, loaded);
+    BLOCKSCI_CHECK(loaded.totalValue() == set.totalValue());
+    BLOCKSCI_CHECK(loaded.pointer(2) == set.pointer(2));
+
+    // Saving must not clobber an existing file unless asked to
+    BLOCKSCI_CHECK(throwsException<std::runtime_error>([&] { UtxoSet{}.save(path); }));
+    UtxoSet{}.save(path, true);
+    BLOCKSCI_CHECK(UtxoSet::load(path).empty());
+
+    // Nested directories are created on save
+    auto nestedPath = (dir.path() / "a" / "b" / "utxo.dat").native();
+    set.save(nestedPath);
+    checkEqual(set, UtxoSet::load(nestedPath));
+
+    // Files that aren't UTXO sets or that were cut short are rejected
+    auto badPath = dir.file("bad.dat");
+    {
+        boost::filesystem::ofstream file(boost::filesystem::path{badPath}, std::ios::binary);
+        file << "not a UTXO set";
+    }
+    BLOCKSCI_CHECK(throwsException<std::runtime_error>([&] { UtxoSet::load(badPath); }));
+    boost::filesystem::resize_file(boost::filesystem::path{nestedPath}, boost::filesystem::file_size(nestedPath) - 1);
+    BLOCKSCI_CHECK(throwsException<std::runtime_error>([&] { UtxoSet::load(nestedPath); }));
+    BLOCKSCI_CHECK(throwsException<std::runtime_error>([&] { UtxoSet::load(dir.file("missing.dat")); }));
+
+    // The snapshot cache only lists files it named itself
+    UtxoSnapshotCache cache{(dir.path() / "cache").native()};
+    set.save(dir.file("cache/utxo_10.dat"));
+    set.save(dir.file("cache/utxo_2.dat"));
+    set.save(dir.file("cache/utxo_x.dat"));
+    set.save(dir.file("cache/other_3.dat"));
+    BLOCKSCI_CHECK((cache.snapshotHeights() == std::vector<BlockHeight>{2, 10}));
+    cache.remove(10);
+    BLOCKSCI_CHECK((cache.snapshotHeights() == std::vector<BlockHeight>{2}));
+
+    // Snapshots that can't be read are deleted and the set recomputed rather than failing the request
+    TestChain testChain{dir.path() / "data"};
+    testChain.addBlock({TestTx{{}, {{50, AddressType::PUBKEYHASH, 1}, {25, AddressType::SCRIPTHASH, 1}}}}, 1000);
+    for (uint32_t i = 1; i < 6; i++) {
+        testChain.addBlock({TestTx{{}, {{50, AddressType::PUBKEYHASH, i + 1}}}, TestTx{{{i - 1, 0}}, {{40, AddressType::PUBKEYHASH, i + 10}}}}, 1000 + i * 10);
+    }
+    testChain.publish();
+    Blockchain chain{testChain.config()};
+    auto expected = UtxoSet::compute(chain, 5);
+    BLOCKSCI_CHECK(!expected.empty());
+
+    UtxoSnapshotCache chainCache{(dir.path() / "chain_cache").native()};
+    auto truncatedPath = dir.file("chain_cache/utxo_5.dat");
+    expected.save(truncatedPath);
+    boost::filesystem::resize_file(boost::filesystem::path{truncatedPath}, boost::filesystem::file_size(truncatedPath) - 1);
+    {
+        boost::filesystem::ofstream file(boost::filesystem::path{dir.file("chain_cache/utxo_4.dat")}, std::ios::binary);
+        file << "not a UTXO set";
+    }
+    BLOCKSCI_CHECK((chainCache.snapshotHeights() == std::vector<BlockHeight>{4, 5}));
+    checkEqual(chainCache.get(chain, 5), expected);
+    BLOCKSCI_CHECK((chainCache.snapshotHeights() == std::vector<BlockHeight>{5}));
+    checkEqual(UtxoSet::load(truncatedPath), expected);
+    return 0;
+}
@@ -0,0 +1,289 @@
+//
+//  address_prefix_index_writer.cpp
+//  blocksci
+//
+
+#include "address_prefix_index_writer.hpp"
+#include "file_writer.hpp"
+
+#include <blocksci/core/address_info.hpp>
+#include <blocksci/index/address_prefix_index.hpp>
+#include <blocksci/scripts/script_access.hpp>
+#include <blocksci/util/data_access.hpp>
+#include <blocksci/util/thread_pool.hpp>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <tuple>
+
+namespace {
+    using blocksci::AddressPrefixIndex;
+    using blocksci::AddressPrefixSegment;
+    using blocksci::AddressPrefixSegmentInfo;
+    using blocksci::AddressType;
+    using blocksci::DataAccess;
+    using blocksci::DedupAddressType;
+    using blocksci::FixedSizeFileWriter;
+    using ScriptCounts = std::array<uint32_t, DedupAddressType::size>;
+
+    const std::string &createDirectory(const std::string &directory) {
+        boost::filesystem::create_directories(boost::filesystem::path{directory});
+        return directory;
+    }
+
+    // Streams a segment to disk. Entries must be added in type order and in string order within a type
+    class SegmentBuilder {
+        std::string directory;
+        AddressPrefixSegmentInfo info;
+        size_t nextType = 0;
+        uint64_t entryCount = 0;
+        FixedSizeFileWriter<uint32_t> scriptsFile;
+
+    public:
+        SegmentBuilder(const std::string &directory_, const ScriptCounts &startCounts, const ScriptCounts &endCounts) :
+        directory(createDirectory(directory_)),
+        scriptsFile(AddressPrefixSegment::scriptsFilePath(directory)) {
+            info.startCounts = startCounts;
+            info.endCounts = endCounts;
+        }
+
+        void add(AddressType::Enum type, uint32_t scriptNum) {
+            while (nextType <= static_cast<size_t>(type)) {
+                info.typeOffsets[nextType++] = entryCount;
+            }
+            scriptsFile.write(scriptNum);
+            entryCount++;
+        }
+
+        // The info file is written last since readers treat a segment without it as incomplete
+        void finish() {
+            while (nextType <= AddressType::size) {
+                info.typeOffsets[nextType++] = entryCount;
+            }
+            scriptsFile.flush();
+            FixedSizeFileWriter<AddressPrefixSegmentInfo> infoFile(AddressPrefixSegment::infoFilePath(directory));
+            infoFile.write(info);
+        }
+    };
+
+    std::vector<std::string> encodeAddresses(AddressType::Enum type, const std::vector<uint32_t> &scriptNums, DataAccess &access) {
+        constexpr size_t chunkSize = 4096;
+        std::vector<std::string> addresses(scriptNums.size());
+        blocksci::ThreadPool::instance().parallelFor((scriptNums.size() + chunkSize - 1) / chunkSize, [&](size_t chunk) {
+            auto end = std::min(scriptNums.size(), (chunk + 1) * chunkSize);
+            for (size_t i = chunk * chunkSize; i < end; i++) {
+                addresses[i] = AddressPrefixIndex::addressString(type, scriptNums[i], access);
+            }
+        });
+        return addresses;
+    }
+
+    // Walks the entries of one type of a segment in order, encoding their addresses ahead in batches
+    class EncodedCursor {
+        static constexpr uint64_t batchSize = 1 << 16;
+
+        const AddressPrefixSegment &segment;
+        AddressType::Enum type;
+        DataAccess &access;
+        uint64_t nextEntry;
+        uint64_t endEntry;
+        std::vector<uint32_t> scriptNums;
+        std::vector<std::string> addresses;
+        size_t position = 0;
+
+        void fill() {
+            scriptNums.clear();
+            for (; nextEntry < endEntry && scriptNums.size() < batchSize; nextEntry++) {
+                scriptNums.push_back(segment.scriptNum(nextEntry));
+            }
+            addresses = encodeAddresses(type, scriptNums, access);
+            position = 0;
+        }
+
+    public:
+        EncodedCursor(const AddressPrefixSegment &segment_, AddressType::Enum type_, DataAccess &access_) : segment(segment_), type(type_), access(access_) {
+            std::tie(nextEntry, endEntry) = segment.entries(type);
+            fill();
+        }
+
+        bool done() const {
+            return position == scriptNums.size();
+        }
+
+        const std::string &address() const {
+            return addresses[position];
+        }
+
+        uint32_t scriptNum() const {
+            return scriptNums[position];
+        }
+
+        void advance() {
+            position++;
+            if (position == scriptNums.size() && nextEntry < endEntry) {
+                fill();
+            }
+        }
+    };
+}
+
+constexpr uint32_t AddressPrefixIndexWriter::segmentScriptCount;
+
+AddressPrefixIndexWriter::AddressPrefixIndexWriter(const ParserConfigurationBase &config) : manifest(config.dataConfig.addressPrefixIndexDirectory(), AddressPrefixIndex::manifestFilePath(config.dataConfig.addressPrefixIndexDirectory()), AddressPrefixIndex::readManifest(config.dataConfig.addressPrefixIndexDirectory())) {}
+
+void AddressPrefixIndexWriter::mergeNewestSegments(DataAccess &access) {
+    auto &segmentNames = manifest.names;
+    while (segmentNames.size() >= 2) {
+        auto olderName = segmentNames[segmentNames.size() - 2];
+        auto newerName = segmentNames.back();
+        AddressPrefixSegment older{manifest.segmentDirectory(olderName)};
+        AddressPrefixSegment newer{manifest.segmentDirectory(newerName)};
+        if (older.entryCount() >= 2 * newer.entryCount()) {
+            break;
+        }
+
+        auto mergedName = manifest.nextSegmentName();
+        SegmentBuilder builder{manifest.segmentDirectory(mergedName), older.info().startCounts, newer.info().endCounts};
+        for (auto type : AddressPrefixIndex::indexedTypes(access.config)) {
+            EncodedCursor olderCursor{older, type, access};
+            EncodedCursor newerCursor{newer, type, access};
+            while (!olderCursor.done() || !newerCursor.done()) {
+                bool takeOlder = newerCursor.done() || (!olderCursor.done() && olderCursor.address() <= newerCursor.address());
+                auto &cursor = takeOlder ? olderCursor : newerCursor;
+                builder.add(type, cursor.scriptNum());
+                cursor.advance();
+            }
+        }
+        builder.finish();
+
+        segmentNames.pop_back();
+        segmentNames.back() = mergedName;
+        manifest.write();
+        manifest.removeSegment(olderName);
+        manifest.removeSegment(newerName);
+    }
+}
+
+void AddressPrefixIndexWriter::update(DataAccess &access) {
+    auto &scripts = access.getScripts();
+    // Drop segments that are incomplete or refer to scripts that no longer exist, which are rebuilt below
+    {
+        AddressPrefixIndex index{manifest.directory(), scripts};
+        size_t validCount = 0;
+        while (validCount < manifest.names.size()) {
+            AddressPrefixSegment segment{manifest.segmentDirectory(manifest.names[validCount])};
+            if (!segment.isComplete()) {
+                break;
+            }
+            bool covered = true;
+            for (size_t i = 0; i < DedupAddressType::size; i++) {
+                covered &= segment.info().endCounts[i] <= index.scriptCount(static_cast<DedupAddressType::Enum>(i));
+            }
+            if (!covered) {
+                break;
+            }
+            validCount++;
+        }
+        manifest.truncate(validCount);
+    }
+
+    ScriptCounts startCounts;
+    {
+        AddressPrefixIndex index{manifest.directory(), scripts};
+        for (size_t i = 0; i < DedupAddressType::size; i++) {
+            startCounts[i] = index.scriptCount(static_cast<DedupAddressType::Enum>(i));
+        }
+    }
+    auto totalCounts = scripts.scriptCounts();
+    if (startCounts != totalCounts) {
+        std::cout << "Updating address prefix index\n";
+    }
+    auto types = AddressPrefixIndex::indexedTypes(access.config);
+    while (startCounts != totalCounts) {
+        ScriptCounts endCounts;
+        for (size_t i = 0; i < DedupAddressType::size; i++) {
+            endCounts[i] = startCounts[i] + std::min(segmentScriptCount, totalCounts[i] - startCounts[i]);
+        }
+
+        auto segmentName = manifest.nextSegmentName();
+        SegmentBuilder builder{manifest.segmentDirectory(segmentName), startCounts, endCounts};
+        for (auto type : types) {
+            auto dedupIndex = static_cast<size_t>(dedupType(type));
+            std::vector<uint32_t> scriptNums(endCounts[dedupIndex] - startCounts[dedupIndex]);
+            std::iota(scriptNums.begin(), scriptNums.end(), startCounts[dedupIndex] + 1);
+            auto addresses = encodeAddresses(type, scriptNums, access);
+            std::vector<uint32_t> order(scriptNums.size());
+            std::iota(order.begin(), order.end(), 0u);
+            std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                return addresses[a] < addresses[b];
+            });
+            for (auto i : order) {
+                // Scripts without an encoding of this type, eg. non-segwit script hashes, aren't indexed under it
+                if (!addresses[i].empty()) {
+                    builder.add(type, scriptNums[i]);
+                }
+            }
+        }
+        builder.finish();
+
+        manifest.names.push_back(segmentName);
+        manifest.write();
+        mergeNewestSegments(access);
+        startCounts = endCounts;
+    }
+}
+
+void AddressPrefixIndexWriter::rollback(const ScriptCounts &scriptKeepCounts) {
+    auto &segmentNames = manifest.names;
+    std::vector<std::string> removed;
+    while (!segmentNames.empty()) {
+        AddressPrefixSegment segment{manifest.segmentDirectory(segmentNames.back())};
+        bool complete = segment.isComplete();
+        bool kept = complete;
+        bool straddles = complete;
+        for (size_t i = 0; complete && i < DedupAddressType::size; i++) {
+            kept &= segment.info().endCounts[i] <= scriptKeepCounts[i];
+            straddles &= segment.info().startCounts[i] <= scriptKeepCounts[i];
+        }
+        if (kept) {
+            break;
+        }
+        removed.push_back(segmentNames.back());
+        segmentNames.pop_back();
+        if (!straddles) {
+            continue;
+        }
+
+        // The segment covers scripts on both sides of the kept counts, so rewrite it with only the kept ones
+        auto endCounts = segment.info().endCounts;
+        for (size_t i = 0; i < DedupAddressType::size; i++) {
+            endCounts[i] = std::min(endCounts[i], scriptKeepCounts[i]);
+        }
+        if (endCounts != segment.info().startCounts) {
+            auto truncatedName = manifest.nextSegmentName();
+            SegmentBuilder builder{manifest.segmentDirectory(truncatedName), segment.info().startCounts, endCounts};
+            for (size_t typeIndex = 0; typeIndex < AddressType::size; typeIndex++) {
+                auto type = static_cast<AddressType::Enum>(typeIndex);
+                auto keepCount = scriptKeepCounts[static_cast<size_t>(dedupType(type))];
+                auto range = segment.entries(type);
+                for (auto entry = range.first; entry < range.second; entry++) {
+                    if (segment.scriptNum(entry) <= keepCount) {
+                        builder.add(type, segment.scriptNum(entry));
+                    }
+                }
+            }
+            builder.finish();
+            segmentNames.push_back(truncatedName);
+        }
+        break;
+    }
+    if (!removed.empty()) {
+        manifest.write();
+        for (auto &name : removed) {
+            manifest.removeSegment(name);
+        }
+    }
+}
@@ -0,0 +1,43 @@
+//
+//  address_prefix_index_writer.hpp
+//  blocksci
+//
+
+#ifndef address_prefix_index_writer_hpp
+#define address_prefix_index_writer_hpp
+
+#include "parser_configuration.hpp"
+#include "segment_manifest.hpp"
+
+#include <blocksci/core/dedup_address_type.hpp>
+
+#include <array>
+
+namespace blocksci {
+    class DataAccess;
+}
+
+/* Maintains the segments of the address prefix index (see blocksci::AddressPrefixIndex).
+ *
+ * Each update sorts the scripts added since the last one into segments of at most segmentScriptCount scripts per
+ * type, then merges the newest segment into its predecessor while the predecessor is less than twice its size.
+ * Merges stream both segments, encoding their addresses in parallel batches, so memory use is independent of the
+ * size of the index. */
+class AddressPrefixIndexWriter {
+    SegmentManifest manifest;
+
+    void mergeNewestSegments(blocksci::DataAccess &access);
+
+public:
+    static constexpr uint32_t segmentScriptCount = 5000000;
+
+    explicit AddressPrefixIndexWriter(const ParserConfigurationBase &config);
+
+    // Indexes the scripts visible through access, which must see the parser's latest published epoch
+    void update(blocksci::DataAccess &access);
+
+    // Drops the entries of scripts beyond the kept count of their type
+    void rollback(const std::array<uint32_t, blocksci::DedupAddressType::size> &scriptKeepCounts);
+};
+
+#endif /* address_prefix_index_writer_hpp */
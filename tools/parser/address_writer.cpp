@@ -9,13 +9,69 @@
 
 #include "address_writer.hpp"
 
+#include <blocksci/chain/chain_access.hpp>
+#include <blocksci/core/raw_address.hpp>
+#include <blocksci/core/raw_transaction.hpp>
+#include <blocksci/scripts/script_access.hpp>
+
+#include <array>
+#include <iostream>
+#include <sstream>
+
 using blocksci::AddressType;
 using blocksci::DedupAddressType;
 
 AddressWriter::AddressWriter(const ParserConfigurationBase &config) :
 scriptFiles(blocksci::apply(blocksci::DedupAddressType::all(), [&] (auto tag) {
     return ScriptFile<tag>((boost::filesystem::path{config.dataConfig.scriptsDirectory()}/std::string{dedupAddressName(tag)}).native());
+})),
+scriptHotFiles(blocksci::apply(blocksci::DedupAddressType::all(), [&] (auto tag) {
+    std::stringstream ss;
+    ss << dedupAddressName(tag) << "_hot";
+    return ScriptHotFile<tag>((boost::filesystem::path{config.dataConfig.scriptsDirectory()}/ss.str()).native());
 })) {
+    // Data directories created before the hot columns existed are backfilled from the full records
+    bool backfilled = false;
+    blocksci::for_each(blocksci::DedupAddressType::all(), [&](auto tag) {
+        auto &file = std::get<ScriptFile<tag()>>(scriptFiles);
+        auto &hotFile = std::get<ScriptHotFile<tag()>>(scriptHotFiles);
+        if (hotFile.size() > file.size()) {
+            hotFile.truncate(file.size());
+        }
+        for (auto i = hotFile.size(); i < file.size(); i++) {
+            hotFile.write(blocksci::ScriptHotData{*file.getDataAtIndex(static_cast<uint32_t>(i))});
+            backfilled = true;
+        }
+    });
+    if (backfilled) {
+        backfillTypesSeen(config);
+    }
+}
+
+// The records don't store the types a script has been seen as, so they are recovered by visiting every output and the
+// scripts it wraps, as serialize does when parsing
+void AddressWriter::backfillTypesSeen(const ParserConfigurationBase &config) {
+    std::array<blocksci::FixedSizeFileMapper<blocksci::ScriptHotData, blocksci::AccessMode::readwrite> *, DedupAddressType::size> hotFiles;
+    blocksci::for_each(blocksci::DedupAddressType::all(), [&](auto tag) {
+        hotFiles[static_cast<size_t>(tag())] = &std::get<ScriptHotFile<tag()>>(scriptHotFiles);
+    });
+    auto markSeen = [&](const blocksci::RawAddress &address) {
+        auto &hotFile = *hotFiles[static_cast<size_t>(dedupType(address.type))];
+        if (address.scriptNum > 0 && address.scriptNum <= hotFile.size()) {
+            hotFile[address.scriptNum - 1]->typesSeen |= blocksci::ScriptHotData::typeMask(address.type);
+        }
+        return true;
+    };
+    
+    blocksci::ScriptAccess scripts{config.dataConfig.scriptsDirectory()};
+    blocksci::IndexedFileMapper<blocksci::AccessMode::readonly, blocksci::RawTransaction> txFile(blocksci::ChainAccess::txFilePath(config.dataConfig.chainDirectory()));
+    std::cout << "Backfilling the types seen of scripts from " << txFile.size() << " txes" << std::endl;
+    for (uint32_t txNum = 0; txNum < txFile.size(); txNum++) {
+        auto tx = txFile.getData(txNum);
+        for (auto output = tx->beginOutputs(); output != tx->endOutputs(); ++output) {
+            blocksci::visit(blocksci::RawAddress{output->getAddressNum(), output->getType()}, markSeen, scripts);
+        }
+    }
 }
 
 size_t AddressWriter::serialize(const AnyScriptOutput &output, uint32_t txNum) {
@@ -78,5 +134,6 @@ void AddressWriter::rollback(const blocksci::State &state) {
     blocksci::for_each(blocksci::DedupAddressType::all(), [&](auto tag) {
         auto &file = std::get<ScriptFile<tag()>>(scriptFiles);
         file.truncate(state.scriptCounts[static_cast<size_t>(tag)]);
+        std::get<ScriptHotFile<tag()>>(scriptHotFiles).truncate(state.scriptCounts[static_cast<size_t>(tag)]);
     });
 }
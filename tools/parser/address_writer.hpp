@@ -33,11 +33,18 @@ struct ScriptFile : public ScriptFileType_t<type> {
     using ScriptFileType_t<type>::ScriptFileType_t;
 };
 
+template<blocksci::DedupAddressType::Enum type>
+struct ScriptHotFile : public blocksci::FixedSizeFileMapper<blocksci::ScriptHotData, blocksci::AccessMode::readwrite> {
+    using blocksci::FixedSizeFileMapper<blocksci::ScriptHotData, blocksci::AccessMode::readwrite>::FixedSizeFileMapper;
+};
 
 class AddressWriter {
     using ScriptFilesTuple = blocksci::to_dedup_address_tuple_t<ScriptFile>;
+    using ScriptHotFilesTuple = blocksci::to_dedup_address_tuple_t<ScriptHotFile>;
     
     ScriptFilesTuple scriptFiles;
+    // Mirrors the first seen, first spent and seen types of every script, kept in lockstep with scriptFiles
+    ScriptHotFilesTuple scriptHotFiles;
     
     template<blocksci::AddressType::Enum type>
     void serializeImp(const ScriptInput<type> &, ScriptFile<dedupType(type)> &) {}
@@ -74,15 +81,18 @@ public:
     
     template<blocksci::AddressType::Enum type>
     size_t serialize(const ScriptOutput<type> &output, uint32_t txNum) {
+        auto &hotFile = std::get<ScriptHotFile<dedupType(type)>>(scriptHotFiles);
         if (output.isNew) {
             auto &file = std::get<ScriptFile<dedupType(type)>>(scriptFiles);
             auto data = output.data.getData(txNum);
             file.write(data);
+            hotFile.write(blocksci::ScriptHotData{txNum, type});
             output.data.visitWrapped([&](auto &output) { this->serialize(output, txNum); });
             return file.size();
         } else {
             auto &file = std::get<ScriptFile<dedupType(type)>>(scriptFiles);
             serializeImp(output, file);
+            hotFile[output.scriptNum - 1]->typesSeen |= blocksci::ScriptHotData::typeMask(type);
         }
         return 0;
     }
@@ -91,14 +101,17 @@ public:
     void serialize(const ScriptInput<type> &input, uint32_t txNum, uint32_t outputTxNum) {
         auto &file = std::get<ScriptFile<dedupType(type)>>(scriptFiles);
         auto data = file.getDataAtIndex(input.scriptNum - 1);
+        auto hotData = std::get<ScriptHotFile<dedupType(type)>>(scriptHotFiles)[input.scriptNum - 1];
         bool isFirstSpend = data->txFirstSpent == std::numeric_limits<uint32_t>::max();
         bool isNewerFirstSeen = outputTxNum < data->txFirstSeen;
         
         if (isNewerFirstSeen) {
             data->txFirstSeen = outputTxNum;
+            hotData->txFirstSeen = outputTxNum;
         }
         if (isFirstSpend) {
             data->txFirstSpent = txNum;
+            hotData->txFirstSpent = txNum;
             serializeImp(input, file);
         }
         
@@ -107,6 +120,9 @@ public:
     
     void rollback(const blocksci::State &state);
     
+    // Fills in typesSeen for hot columns backfilled from the full records
+    void backfillTypesSeen(const ParserConfigurationBase &config);
+    
     size_t serialize(const AnyScriptOutput &output, uint32_t txNum);
     void serialize(const AnyScriptInput &input, uint32_t txNum, uint32_t outputTxNum);
     
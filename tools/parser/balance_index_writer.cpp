@@ -0,0 +1,280 @@
+//
+//  balance_index_writer.cpp
+//  blocksci
+//
+
+#include "balance_index_writer.hpp"
+#include "file_writer.hpp"
+
+#include <blocksci/chain/chain_access.hpp>
+#include <blocksci/core/raw_block.hpp>
+#include <blocksci/core/raw_transaction.hpp>
+#include <blocksci/index/balance_index.hpp>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <tuple>
+
+namespace {
+    using blocksci::AddressType;
+    using blocksci::BalanceIndex;
+    using blocksci::BalanceIndexSegment;
+    using blocksci::BalanceSegmentInfo;
+    using blocksci::BlockHeight;
+    using blocksci::FixedSizeFileWriter;
+
+    struct BalanceRecord {
+        uint8_t type;
+        uint32_t addressNum;
+        BlockHeight height;
+        int64_t delta;
+
+        bool operator<(const BalanceRecord &other) const {
+            return std::tie(type, addressNum, height) < std::tie(other.type, other.addressNum, other.height);
+        }
+    };
+
+    const std::string &createDirectory(const std::string &directory) {
+        boost::filesystem::create_directories(boost::filesystem::path{directory});
+        return directory;
+    }
+
+    // Streams a segment to disk. Keys must be added in (type, address) order, each followed by its entries
+    class SegmentBuilder {
+        std::string directory;
+        BalanceSegmentInfo info;
+        size_t nextType = 0;
+        uint64_t keyCount = 0;
+        uint64_t entryCount = 0;
+        FixedSizeFileWriter<uint32_t> keysFile;
+        FixedSizeFileWriter<uint64_t> offsetsFile;
+        FixedSizeFileWriter<BlockHeight> heightsFile;
+        FixedSizeFileWriter<int64_t> balancesFile;
+
+    public:
+        SegmentBuilder(const std::string &directory_, BlockHeight startHeight, BlockHeight endHeight, const blocksci::uint256 &endBlockHash) :
+        directory(createDirectory(directory_)),
+        keysFile(BalanceIndexSegment::keysFilePath(directory)),
+        offsetsFile(BalanceIndexSegment::offsetsFilePath(directory)),
+        heightsFile(BalanceIndexSegment::heightsFilePath(directory)),
+        balancesFile(BalanceIndexSegment::balancesFilePath(directory)) {
+            info.startHeight = startHeight;
+            info.endHeight = endHeight;
+            info.endBlockHash = endBlockHash;
+            offsetsFile.write(0);
+        }
+
+        void addKey(AddressType::Enum type, uint32_t addressNum) {
+            while (nextType <= static_cast<size_t>(type)) {
+                info.typeOffsets[nextType++] = keyCount;
+            }
+            keysFile.write(addressNum);
+            keyCount++;
+        }
+
+        void addEntry(BlockHeight height, int64_t balance) {
+            heightsFile.write(height);
+            balancesFile.write(balance);
+            entryCount++;
+        }
+
+        void endKey() {
+            offsetsFile.write(entryCount);
+        }
+
+        // The info file is written last since readers treat a segment without it as incomplete
+        void finish() {
+            while (nextType <= AddressType::size) {
+                info.typeOffsets[nextType++] = keyCount;
+            }
+            keysFile.flush();
+            offsetsFile.flush();
+            heightsFile.flush();
+            balancesFile.flush();
+            FixedSizeFileWriter<BalanceSegmentInfo> infoFile(BalanceIndexSegment::infoFilePath(directory));
+            infoFile.write(info);
+        }
+    };
+}
+
+constexpr uint32_t BalanceIndexWriter::segmentTxCount;
+
+BalanceIndexWriter::BalanceIndexWriter(const ParserConfigurationBase &config) : manifest(config.dataConfig.balanceIndexDirectory(), BalanceIndex::manifestFilePath(config.dataConfig.balanceIndexDirectory()), BalanceIndex::readManifest(config.dataConfig.balanceIndexDirectory())) {}
+
+void BalanceIndexWriter::mergeNewestSegments() {
+    auto &segmentNames = manifest.names;
+    while (segmentNames.size() >= 2) {
+        auto olderName = segmentNames[segmentNames.size() - 2];
+        auto newerName = segmentNames.back();
+        BalanceIndexSegment older{manifest.segmentDirectory(olderName)};
+        BalanceIndexSegment newer{manifest.segmentDirectory(newerName)};
+        if (older.entryCount() >= 2 * newer.entryCount()) {
+            break;
+        }
+
+        auto mergedName = manifest.nextSegmentName();
+        SegmentBuilder builder{manifest.segmentDirectory(mergedName), older.info().startHeight, newer.info().endHeight, newer.info().endBlockHash};
+        auto copyKey = [&](const BalanceIndexSegment &segment, uint64_t keyIndex) {
+            auto range = segment.entriesOfKey(keyIndex);
+            for (auto entry = range.first; entry < range.second; entry++) {
+                builder.addEntry(segment.height(entry), segment.balance(entry));
+            }
+        };
+        for (size_t typeIndex = 0; typeIndex < AddressType::size; typeIndex++) {
+            auto type = static_cast<AddressType::Enum>(typeIndex);
+            auto i = older.info().typeOffsets[typeIndex];
+            auto iEnd = older.info().typeOffsets[typeIndex + 1];
+            auto j = newer.info().typeOffsets[typeIndex];
+            auto jEnd = newer.info().typeOffsets[typeIndex + 1];
+            while (i < iEnd || j < jEnd) {
+                bool takeOlder = j == jEnd || (i < iEnd && older.key(i) <= newer.key(j));
+                bool takeNewer = i == iEnd || (j < jEnd && newer.key(j) <= older.key(i));
+                builder.addKey(type, takeOlder ? older.key(i) : newer.key(j));
+                // The older segment's entries are all at lower heights, so concatenating keeps them sorted
+                if (takeOlder) {
+                    copyKey(older, i++);
+                }
+                if (takeNewer) {
+                    copyKey(newer, j++);
+                }
+                builder.endKey();
+            }
+        }
+        builder.finish();
+
+        segmentNames.pop_back();
+        segmentNames.back() = mergedName;
+        manifest.write();
+        manifest.removeSegment(olderName);
+        manifest.removeSegment(newerName);
+    }
+}
+
+void BalanceIndexWriter::update(const blocksci::ChainAccess &chain) {
+    // Drop segments that are incomplete or no longer match the chain, which are rebuilt below
+    auto &baseDirectory = manifest.directory();
+    {
+        BalanceIndex index{baseDirectory, chain};
+        size_t validCount = 0;
+        while (validCount < manifest.names.size()) {
+            BalanceIndexSegment segment{manifest.segmentDirectory(manifest.names[validCount])};
+            if (!segment.isComplete() || segment.info().endHeight > index.blockCount()) {
+                break;
+            }
+            validCount++;
+        }
+        manifest.truncate(validCount);
+    }
+
+    auto blockCount = chain.blockCount();
+    auto startHeight = BalanceIndex{baseDirectory, chain}.blockCount();
+    if (startHeight < blockCount) {
+        std::cout << "Updating balance index with " << blockCount - startHeight << " blocks\n";
+    }
+    while (startHeight < blockCount) {
+        auto endHeight = startHeight;
+        uint32_t txCount = 0;
+        while (endHeight < blockCount && (txCount == 0 || txCount + chain.getBlock(endHeight)->numTxes <= segmentTxCount)) {
+            txCount += chain.getBlock(endHeight)->numTxes;
+            endHeight++;
+        }
+
+        std::vector<BalanceRecord> records;
+        for (auto height = startHeight; height < endHeight; height++) {
+            auto block = chain.getBlock(height);
+            for (auto txNum = block->firstTxIndex; txNum < block->firstTxIndex + block->numTxes; txNum++) {
+                auto tx = chain.getTx(txNum);
+                for (uint16_t i = 0; i < tx->inputCount; i++) {
+                    auto &input = tx->getInput(i);
+                    records.push_back({static_cast<uint8_t>(input.getType()), input.getAddressNum(), height, -input.getValue()});
+                }
+                for (uint16_t i = 0; i < tx->outputCount; i++) {
+                    auto &output = tx->getOutput(i);
+                    records.push_back({static_cast<uint8_t>(output.getType()), output.getAddressNum(), height, output.getValue()});
+                }
+            }
+        }
+        std::sort(records.begin(), records.end());
+
+        BalanceIndex index{baseDirectory, chain};
+        auto segmentName = manifest.nextSegmentName();
+        SegmentBuilder builder{manifest.segmentDirectory(segmentName), startHeight, endHeight, chain.getBlock(endHeight - 1)->hash};
+        std::vector<std::pair<BlockHeight, int64_t>> keyEntries;
+        auto it = records.begin();
+        while (it != records.end()) {
+            auto type = static_cast<AddressType::Enum>(it->type);
+            auto addressNum = it->addressNum;
+            auto balance = startHeight > 0 ? index.getBalance(type, addressNum, startHeight - 1).value_or(0) : 0;
+            keyEntries.clear();
+            while (it != records.end() && it->type == static_cast<uint8_t>(type) && it->addressNum == addressNum) {
+                auto height = it->height;
+                int64_t delta = 0;
+                for (; it != records.end() && it->type == static_cast<uint8_t>(type) && it->addressNum == addressNum && it->height == height; ++it) {
+                    delta += it->delta;
+                }
+                // Blocks which spent and received the same amount leave the balance unchanged and need no entry
+                if (delta != 0) {
+                    balance += delta;
+                    keyEntries.emplace_back(height, balance);
+                }
+            }
+            if (!keyEntries.empty()) {
+                builder.addKey(type, addressNum);
+                for (auto &entry : keyEntries) {
+                    builder.addEntry(entry.first, entry.second);
+                }
+                builder.endKey();
+            }
+        }
+        builder.finish();
+
+        manifest.names.push_back(segmentName);
+        manifest.write();
+        mergeNewestSegments();
+        startHeight = endHeight;
+    }
+}
+
+void BalanceIndexWriter::rollback(BlockHeight blockKeepCount, const blocksci::uint256 &lastKeptHash) {
+    auto &segmentNames = manifest.names;
+    std::vector<std::string> removed;
+    while (!segmentNames.empty()) {
+        BalanceIndexSegment segment{manifest.segmentDirectory(segmentNames.back())};
+        if (segment.isComplete() && segment.info().endHeight <= blockKeepCount) {
+            break;
+        }
+        removed.push_back(segmentNames.back());
+        segmentNames.pop_back();
+        if (!segment.isComplete() || segment.info().startHeight >= blockKeepCount) {
+            continue;
+        }
+
+        // The segment straddles the kept height, so rewrite it with only the entries below it
+        auto truncatedName = manifest.nextSegmentName();
+        SegmentBuilder builder{manifest.segmentDirectory(truncatedName), segment.info().startHeight, blockKeepCount, lastKeptHash};
+        for (size_t typeIndex = 0; typeIndex < AddressType::size; typeIndex++) {
+            for (auto key = segment.info().typeOffsets[typeIndex]; key < segment.info().typeOffsets[typeIndex + 1]; key++) {
+                auto range = segment.entriesOfKey(key);
+                if (range.first == range.second || segment.height(range.first) >= blockKeepCount) {
+                    continue;
+                }
+                builder.addKey(static_cast<AddressType::Enum>(typeIndex), segment.key(key));
+                for (auto entry = range.first; entry < range.second && segment.height(entry) < blockKeepCount; entry++) {
+                    builder.addEntry(segment.height(entry), segment.balance(entry));
+                }
+                builder.endKey();
+            }
+        }
+        builder.finish();
+        segmentNames.push_back(truncatedName);
+        break;
+    }
+    if (!removed.empty()) {
+        manifest.write();
+        for (auto &name : removed) {
+            manifest.removeSegment(name);
+        }
+    }
+}
@@ -0,0 +1,42 @@
+//
+//  balance_index_writer.hpp
+//  blocksci
+//
+
+#ifndef balance_index_writer_hpp
+#define balance_index_writer_hpp
+
+#include "parser_configuration.hpp"
+#include "segment_manifest.hpp"
+
+#include <blocksci/typedefs.hpp>
+#include <blocksci/core/bitcoin_uint256.hpp>
+
+#include <string>
+#include <vector>
+
+namespace blocksci {
+    class ChainAccess;
+}
+
+/* Maintains the segments of the balance index (see blocksci::BalanceIndex).
+ *
+ * Each update indexes the new blocks into segments of at most segmentTxCount transactions, then merges the newest
+ * segment into its predecessor while the predecessor is less than twice its size. */
+class BalanceIndexWriter {
+    SegmentManifest manifest;
+
+    void mergeNewestSegments();
+
+public:
+    static constexpr uint32_t segmentTxCount = 5000000;
+
+    explicit BalanceIndexWriter(const ParserConfigurationBase &config);
+
+    void update(const blocksci::ChainAccess &chain);
+
+    // Drops the entries of blocks at or above blockKeepCount. lastKeptHash is the hash of block blockKeepCount - 1
+    void rollback(blocksci::BlockHeight blockKeepCount, const blocksci::uint256 &lastKeptHash);
+};
+
+#endif /* balance_index_writer_hpp */
@@ -264,6 +264,12 @@ blocksci::RawBlock readNewBlock(uint32_t firstTxNum, const BlockInfoBase &block,
             files.sequenceFile.write(input.sequenceNum);
         }
         
+        // Filled in with the spending input of each output by backUpdateTxes
+        files.spendingInputFile.writeIndexGroup();
+        for (size_t i = 0; i < tx->outputs.size(); i++) {
+            files.spendingInputFile.write(uint16_t{0});
+        }
+        
         if (tx->inputs.size() == 1 && tx->inputs[0].rawOutputPointer.hash == nullHash) {
             auto scriptView = tx->inputs[0].getScriptView();
             coinbase.assign(scriptView.begin(), scriptView.end());
@@ -363,7 +369,7 @@ void serializeTransaction(RawTransaction &tx, IndexedFileWriter<1> &txFile, Fixe
     for (size_t i = 0; i < tx.inputs.size(); i++) {
         auto &input = tx.inputs[i];
         auto &scriptInput = tx.scriptInputs[i];
-        linkDataFile.write({input.getOutputPointer(), tx.txNum});
+        linkDataFile.write({input.getOutputPointer(), tx.txNum, static_cast<uint16_t>(i)});
         auto address = scriptInput.address();
         blocksci::Inout blocksciInput{input.utxo.txNum, address.scriptNum, address.type, input.utxo.value};
         txFile.write(blocksciInput);
@@ -394,6 +400,7 @@ void backUpdateTxes(const ParserConfigurationBase &config) {
     {
         
         blocksci::IndexedFileMapper<blocksci::AccessMode::readwrite, blocksci::RawTransaction> txFile(blocksci::ChainAccess::txFilePath(config.dataConfig.chainDirectory()));
+        blocksci::IndexedFileMapper<blocksci::AccessMode::readwrite, uint16_t> spendingInputFile(blocksci::ChainAccess::spendingInputFilePath(config.dataConfig.chainDirectory()));
         
         blocksci::FixedSizeFileMapper<OutputLinkData> linkDataFile_(config.txUpdatesFilePath());
         const auto &linkDataFile = linkDataFile_;
@@ -418,6 +425,9 @@ void backUpdateTxes(const ParserConfigurationBase &config) {
             auto tx = txFile.getData(update.pointer.txNum);
             auto &output = tx->getOutput(update.pointer.inoutNum);
             output.setLinkedTxNum(update.txNum);
+            if (update.pointer.txNum < spendingInputFile.size()) {
+                spendingInputFile.getData(update.pointer.txNum)[update.pointer.inoutNum] = static_cast<uint16_t>(update.inputNum + 1);
+            }
             count++;
             progressBar.update(count);
         }
@@ -426,6 +436,25 @@ void backUpdateTxes(const ParserConfigurationBase &config) {
     boost::filesystem::remove(config.txUpdatesFilePath() + ".dat");
 }
 
+void padSpendingInputFile(const ParserConfigurationBase &config, uint32_t txCount) {
+    IndexedFileWriter<1> spendingInputFile(blocksci::ChainAccess::spendingInputFilePath(config.dataConfig.chainDirectory()));
+    auto firstTxNum = static_cast<uint32_t>(spendingInputFile.size());
+    if (firstTxNum >= txCount) {
+        return;
+    }
+    
+    // Transactions parsed before the spending input file existed are marked as unknown and resolved by scanning at read time
+    blocksci::IndexedFileMapper<blocksci::AccessMode::readonly, blocksci::RawTransaction> txFile(blocksci::ChainAccess::txFilePath(config.dataConfig.chainDirectory()));
+    std::cout << "Adding spending input placeholders for " << txCount - firstTxNum << " txes" << std::endl;
+    for (uint32_t txNum = firstTxNum; txNum < txCount; txNum++) {
+        auto tx = txFile.getData(txNum);
+        spendingInputFile.writeIndexGroup();
+        for (uint16_t i = 0; i < tx->outputCount; i++) {
+            spendingInputFile.write(uint16_t{0});
+        }
+    }
+}
+
 struct CompletionGuard {
     explicit CompletionGuard(std::atomic<bool> &isDone_) : isDone(isDone_) {}
     CompletionGuard(const CompletionGuard &) = delete;
@@ -511,7 +540,8 @@ ProcessStep<ProcessFunc, AdvanceFunc> makeProcessStep(std::atomic<bool> &prevDon
 
 NewBlocksFiles::NewBlocksFiles(const ParserConfigurationBase &config) :
     blockCoinbaseFile(blocksci::ChainAccess::blockCoinbaseFilePath(config.dataConfig.chainDirectory())),
-    sequenceFile(blocksci::ChainAccess::sequenceFilePath(config.dataConfig.chainDirectory())) {}
+    sequenceFile(blocksci::ChainAccess::sequenceFilePath(config.dataConfig.chainDirectory())),
+    spendingInputFile(blocksci::ChainAccess::spendingInputFilePath(config.dataConfig.chainDirectory())) {}
 
 
 template <typename ParseTag>
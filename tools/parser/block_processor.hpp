@@ -30,6 +30,7 @@ public:
 struct NewBlocksFiles {
     blocksci::ArbitraryFileWriter blockCoinbaseFile;
     blocksci::IndexedFileWriter<1> sequenceFile;
+    blocksci::IndexedFileWriter<1> spendingInputFile;
     
     NewBlocksFiles(const ParserConfigurationBase &config);
 };
@@ -37,6 +38,7 @@ struct NewBlocksFiles {
 struct OutputLinkData {
     blocksci::OutputPointer pointer;
     uint32_t txNum;
+    uint16_t inputNum;
 };
 
 blocksci::RawBlock readNewBlock(uint32_t firstTxNum, const BlockInfoBase &block, BlockFileReaderBase &fileReader, NewBlocksFiles &files, const std::function<bool(RawTransaction *&tx)> &loadFunc, const std::function<void(RawTransaction *tx)> &outFunc);
@@ -49,6 +51,7 @@ void processAddresses(RawTransaction &tx, AddressState &addressState);
 void recordAddresses(RawTransaction &tx, UTXOScriptState &state);
 void serializeAddressess(RawTransaction &tx, AddressWriter &addressWriter);
 void backUpdateTxes(const ParserConfigurationBase &config);
+void padSpendingInputFile(const ParserConfigurationBase &config, uint32_t txCount);
 
 
 class BlockProcessor {
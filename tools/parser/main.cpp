@@ -16,6 +16,8 @@
 #include "preproccessed_block.hpp"
 #include "block_processor.hpp"
 #include "address_db.hpp"
+#include "address_prefix_index_writer.hpp"
+#include "balance_index_writer.hpp"
 #include "parser_index_creator.hpp"
 #include "hash_index_creator.hpp"
 #include "block_replayer.hpp"
@@ -23,6 +25,7 @@
 #include "utxo_address_state.hpp"
 
 #include <blocksci/scripts/script_variant.hpp>
+#include <blocksci/util/data_access.hpp>
 
 #ifdef BLOCKSCI_RPC_PARSER
 #include <bitcoinapi/bitcoinapi.h>
@@ -52,6 +55,7 @@ blocksci::State rollbackState(const ParserConfigurationBase &config, blocksci::B
     
     blocksci::IndexedFileMapper<blocksci::AccessMode::readwrite, blocksci::RawTransaction> txFile{blocksci::ChainAccess::txFilePath(config.dataConfig.chainDirectory())};
     blocksci::FixedSizeFileMapper<blocksci::uint256, blocksci::AccessMode::readwrite> txHashesFile{blocksci::ChainAccess::txHashesFilePath(config.dataConfig.chainDirectory())};
+    blocksci::IndexedFileMapper<blocksci::AccessMode::readwrite, uint16_t> spendingInputFile{blocksci::ChainAccess::spendingInputFilePath(config.dataConfig.chainDirectory())};
     blocksci::DataAccess access(config.dataConfig);
     
     UTXOState utxoState;
@@ -92,6 +96,9 @@ blocksci::State rollbackState(const ParserConfigurationBase &config, blocksci::B
                 auto &output = spentTx->getOutput(j);
                 if (output.getLinkedTxNum() == txNum) {
                     output.setLinkedTxNum(0);
+                    if (spentTxNum < spendingInputFile.size()) {
+                        spendingInputFile.getData(spentTxNum)[j] = 0;
+                    }
                     UTXO utxo(output.getValue(), spentTxNum, output.getType());
                     utxoState.add({*spentHash, j}, utxo);
                     blocksci::AnyScript script(output.getAddressNum(), output.getType(), access);
@@ -111,6 +118,12 @@ blocksci::State rollbackState(const ParserConfigurationBase &config, blocksci::B
     return state;
 }
 
+void publishEpoch(const ParserConfigurationBase &config) {
+    blocksci::ChainAccess chain{config.dataConfig.chainDirectory(), 0, false};
+    blocksci::ScriptAccess scripts{config.dataConfig.scriptsDirectory()};
+    blocksci::publishEpoch(config.dataConfig, blocksci::State{chain, scripts});
+}
+
 void rollbackTransactions(blocksci::BlockHeight blockKeepCount, HashIndexCreator &hashDb, const ParserConfigurationBase &config) {
     using blocksci::AccessMode;
     using blocksci::RawBlock;
@@ -128,14 +141,25 @@ void rollbackTransactions(blocksci::BlockHeight blockKeepCount, HashIndexCreator
         auto firstDeletedTxNum = firstDeletedBlock->firstTxIndex;
         
         auto blocksciState = rollbackState(config, blockKeepCount, firstDeletedTxNum);
-        
+        blocksci::publishEpoch(config.dataConfig, blocksciState);
         
         IndexedFileMapper<readwrite, blocksci::RawTransaction>(blocksci::ChainAccess::txFilePath(config.dataConfig.chainDirectory())).truncate(firstDeletedTxNum);
         FixedSizeFileMapper<blocksci::uint256, readwrite>(blocksci::ChainAccess::txHashesFilePath(config.dataConfig.chainDirectory())).truncate(firstDeletedTxNum);
         IndexedFileMapper<readwrite, uint32_t>(blocksci::ChainAccess::sequenceFilePath(config.dataConfig.chainDirectory())).truncate(firstDeletedTxNum);
+        IndexedFileMapper<readwrite, uint16_t>(blocksci::ChainAccess::spendingInputFilePath(config.dataConfig.chainDirectory())).truncate(firstDeletedTxNum);
         SimpleFileMapper<readwrite>(blocksci::ChainAccess::blockCoinbaseFilePath(config.dataConfig.chainDirectory())).truncate(firstDeletedBlock->coinbaseOffset);
+        {
+            FixedSizeFileMapper<uint32_t, readwrite> txHeightFile(blocksci::ChainAccess::txHeightFilePath(config.dataConfig.chainDirectory()));
+            uint32_t sampleSize = uint32_t{1} << blocksci::ChainAccess::txHeightSampleShift;
+            size_t samplesKept = (firstDeletedTxNum + sampleSize - 1) / sampleSize;
+            if (samplesKept < txHeightFile.size()) {
+                txHeightFile.truncate(samplesKept);
+            }
+        }
         blockFile.truncate(blockKeepSize);
         AddressWriter(config).rollback(blocksciState);
+        AddressPrefixIndexWriter(config).rollback(blocksciState.scriptCounts);
+        BalanceIndexWriter(config).rollback(blockKeepCount, blockKeepSize > 0 ? blockFile[blockKeepSize - 1]->hash : blocksci::uint256{});
         
         AddressState addressState{config.addressPath(), hashDb};
         hashDb.db.rollback(blocksciState);
@@ -215,6 +239,7 @@ std::vector<blocksci::RawBlock> updateChain(const ParserConfiguration<ParserTag>
     }
     
     uint32_t startingTxCount = getStartingTxCount(config.dataConfig);
+    padSpendingInputFile(config, startingTxCount);
     auto maxBlockHeight = blocksToAdd.back().height;
     
     uint32_t totalTxCount = 0;
@@ -261,6 +286,22 @@ std::vector<blocksci::RawBlock> updateChain(const ParserConfiguration<ParserTag>
     return newBlocks;
 }
 
+void updateTxHeightIndex(const ParserConfigurationBase &config) {
+    blocksci::FixedSizeFileMapper<blocksci::RawBlock> blockFile{blocksci::ChainAccess::blockFilePath(config.dataConfig.chainDirectory())};
+    blocksci::FixedSizeFileWriter<uint32_t> txHeightFile{blocksci::ChainAccess::txHeightFilePath(config.dataConfig.chainDirectory())};
+    
+    auto sample = static_cast<uint64_t>(txHeightFile.size());
+    uint32_t height = sample > 0 ? txHeightFile.read(static_cast<uint32_t>(sample - 1)) : 0;
+    for (; height < blockFile.size(); height++) {
+        auto block = blockFile[height];
+        uint64_t blockEnd = static_cast<uint64_t>(block->firstTxIndex) + block->numTxes;
+        while ((sample << blocksci::ChainAccess::txHeightSampleShift) < blockEnd) {
+            txHeightFile.write(height);
+            sample++;
+        }
+    }
+}
+
 void updateHashDB(const ParserConfigurationBase &config, HashIndexCreator &db) {
     blocksci::ChainAccess chain{config.dataConfig.chainDirectory(), config.dataConfig.blocksIgnored, config.dataConfig.errorOnReorg};
     blocksci::ScriptAccess scripts{config.dataConfig.scriptsDirectory()};
@@ -283,6 +324,16 @@ void updateAddressDB(const ParserConfigurationBase &config) {
     db.runUpdate(updateState);
 }
 
+void updateBalanceIndex(const ParserConfigurationBase &config) {
+    blocksci::ChainAccess chain{config.dataConfig.chainDirectory(), config.dataConfig.blocksIgnored, config.dataConfig.errorOnReorg};
+    BalanceIndexWriter(config).update(chain);
+}
+
+void updateAddressPrefixIndex(const ParserConfigurationBase &config) {
+    blocksci::DataAccess access(config.dataConfig);
+    AddressPrefixIndexWriter(config).update(access);
+}
+
 void updateConfig(boost::filesystem::path &dataDirectory) {
     auto configFile = dataDirectory/"config.ini";
     
@@ -295,7 +346,7 @@ void updateConfig(boost::filesystem::path &dataDirectory) {
 
 int main(int argc, char * argv[]) {
     
-    enum class mode {update, updateCore, updateIndexes, updateHashIndex, updateAddressIndex, compactIndexes, help};
+    enum class mode {update, updateCore, updateIndexes, updateHashIndex, updateAddressIndex, updateBalanceIndex, updateAddressPrefixIndex, compactIndexes, help};
     mode selected = mode::help;
 
 
@@ -331,6 +382,8 @@ int main(int argc, char * argv[]) {
     auto indexUpdateCommand = clipp::command("index-update").set(selected,mode::updateIndexes) % "Update indexes to latest chain state";
     auto addressIndexUpdateCommand = clipp::command("address-index-update").set(selected,mode::updateAddressIndex) % "Update address index to latest state";
     auto hashIndexUpdateCommand = clipp::command("hash-index-update").set(selected,mode::updateHashIndex) % "Update hash index to latest state";
+    auto balanceIndexUpdateCommand = clipp::command("balance-index-update").set(selected,mode::updateBalanceIndex) % "Update balance history index to latest state";
+    auto addressPrefixIndexUpdateCommand = clipp::command("address-prefix-index-update").set(selected,mode::updateAddressPrefixIndex) % "Update address prefix index to latest state";
     auto compactIndexesCommand = clipp::command("compact-indexes").set(selected, mode::compactIndexes) % "Compact indexes to speed up blockchain construction";
     
     int maxBlockNum = 0;
@@ -338,7 +391,7 @@ int main(int argc, char * argv[]) {
     
     auto coreUpdateOptions = (maxBlockOpt, (fileOptions | rpcOptions));
     
-    auto commands = ((updateCommand | updateCoreCommand), coreUpdateOptions) | indexUpdateCommand | addressIndexUpdateCommand | hashIndexUpdateCommand | compactIndexesCommand;
+    auto commands = ((updateCommand | updateCoreCommand), coreUpdateOptions) | indexUpdateCommand | addressIndexUpdateCommand | hashIndexUpdateCommand | balanceIndexUpdateCommand | addressPrefixIndexUpdateCommand | compactIndexesCommand;
     
     auto cli = (outputDirOpt, commands);
     
@@ -391,10 +444,17 @@ int main(int argc, char * argv[]) {
                     blockFile.write(block);
                 }
             }
+            updateTxHeightIndex(config);
 
             if (selected == mode::update) {
                 updateHashDB(config, hashDb);
                 updateAddressDB(config);
+                updateBalanceIndex(config);
+            }
+            publishEpoch(config);
+            // Reads the scripts through DataAccess, which only sees those covered by the published epoch
+            if (selected == mode::update) {
+                updateAddressPrefixIndex(config);
             }
             
             break;
@@ -407,6 +467,8 @@ int main(int argc, char * argv[]) {
                 HashIndexCreator db(config, config.dataConfig.hashIndexFilePath());
                 updateHashDB(config, db);
             }
+            updateBalanceIndex(config);
+            updateAddressPrefixIndex(config);
             break;
         }
 
@@ -422,6 +484,18 @@ int main(int argc, char * argv[]) {
             updateAddressDB(config);
             break;
         }
+        
+        case mode::updateBalanceIndex: {
+            ParserConfigurationBase config{dataDirectory.native()};
+            updateBalanceIndex(config);
+            break;
+        }
+        
+        case mode::updateAddressPrefixIndex: {
+            ParserConfigurationBase config{dataDirectory.native()};
+            updateAddressPrefixIndex(config);
+            break;
+        }
             
         case mode::compactIndexes: {
             ParserConfigurationBase config{dataDirectory.native()};
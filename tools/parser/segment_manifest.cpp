@@ -0,0 +1,65 @@
+//
+//  segment_manifest.cpp
+//  blocksci
+//
+
+#include "segment_manifest.hpp"
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+
+SegmentManifest::SegmentManifest(std::string baseDirectory_, std::string manifestPath_, std::vector<std::string> names_) : baseDirectory(std::move(baseDirectory_)), manifestPath(std::move(manifestPath_)), names(std::move(names_)) {
+    boost::filesystem::create_directories(boost::filesystem::path{baseDirectory});
+}
+
+std::string SegmentManifest::segmentDirectory(const std::string &name) const {
+    return (boost::filesystem::path{baseDirectory}/name).native();
+}
+
+std::string SegmentManifest::nextSegmentName() const {
+    uint64_t next = 0;
+    const std::string prefix = "segment_";
+    for (auto &entry : boost::filesystem::directory_iterator(boost::filesystem::path{baseDirectory})) {
+        auto name = entry.path().filename().string();
+        if (name.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        auto suffix = name.substr(prefix.size());
+        // Other names sharing the prefix, eg. copies made by hand, can't collide with generated ones and are skipped
+        if (suffix.empty() || !std::all_of(suffix.begin(), suffix.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            continue;
+        }
+        next = std::max(next, static_cast<uint64_t>(std::stoull(suffix)) + 1);
+    }
+    return prefix + std::to_string(next);
+}
+
+void SegmentManifest::write() const {
+    boost::filesystem::path path{manifestPath};
+    auto tempPath = boost::filesystem::path{path}.concat(".tmp");
+    {
+        boost::filesystem::ofstream manifest{tempPath};
+        for (auto &name : names) {
+            manifest << name << "\n";
+        }
+    }
+    boost::filesystem::rename(tempPath, path);
+}
+
+void SegmentManifest::removeSegment(const std::string &name) const {
+    boost::filesystem::remove_all(boost::filesystem::path{segmentDirectory(name)});
+}
+
+void SegmentManifest::truncate(size_t keepCount) {
+    if (keepCount >= names.size()) {
+        return;
+    }
+    auto removed = std::vector<std::string>(names.begin() + static_cast<long>(keepCount), names.end());
+    names.resize(keepCount);
+    write();
+    for (auto &name : removed) {
+        removeSegment(name);
+    }
+}
@@ -0,0 +1,42 @@
+//
+//  segment_manifest.hpp
+//  blocksci
+//
+
+#ifndef segment_manifest_hpp
+#define segment_manifest_hpp
+
+#include <string>
+#include <vector>
+
+/* Ordered list of segment directories making up one of the segmented indexes (balance history, address prefix).
+ *
+ * Segments are never modified in place: replacements are written to new directories and published by atomically
+ * rewriting the manifest before the old directories are removed, so readers always see a consistent list. */
+class SegmentManifest {
+    std::string baseDirectory;
+    std::string manifestPath;
+
+public:
+    std::vector<std::string> names;
+
+    SegmentManifest(std::string baseDirectory, std::string manifestPath, std::vector<std::string> names);
+
+    const std::string &directory() const {
+        return baseDirectory;
+    }
+
+    std::string segmentDirectory(const std::string &name) const;
+
+    // Name for a new segment directory, never reusing one left behind by an interrupted update
+    std::string nextSegmentName() const;
+
+    void write() const;
+
+    void removeSegment(const std::string &name) const;
+
+    // Drops the segments from keepCount on, publishing the shortened manifest before removing them
+    void truncate(size_t keepCount);
+};
+
+#endif /* segment_manifest_hpp */